@@ -0,0 +1,506 @@
+#include "BlockCompression.h"
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <gsl/gsl>
+
+#include "render/TextureFile.h"
+#include "utils/ThreadPool.h"
+
+namespace {
+
+	constexpr auto pixels_per_block = size_t{ 16 };
+
+	using Color = std::array<float, 4>;
+
+	/**
+	Writes values of any size (up to 32 bits) into a block, starting by the least significant bit
+	*/
+	class BitWriter {
+	public:
+		explicit BitWriter(unsigned char* destination) noexcept : m_destination(destination) {}
+
+		auto write(uint32_t value, uint32_t bit_count) noexcept -> void {
+			[[gsl::suppress(bounds.1)]]{
+			for (auto bit = uint32_t{ 0 }; bit < bit_count; ++bit, ++m_position) {
+				if ((value >> bit) & 1) {
+					m_destination[m_position / 8] |= gsl::narrow_cast<unsigned char>(1 << (m_position % 8));
+				}
+			}
+			}
+		}
+
+	private:
+		unsigned char* m_destination{ nullptr };
+		uint32_t m_position{ 0 };
+	};
+
+	auto squaredDistance(const Color& a, const Color& b, size_t channels) noexcept -> float {
+		auto distance = 0.0f;
+		for (auto channel = size_t{ 0 }; channel < channels; ++channel) {
+			const auto difference = a[channel] - b[channel];
+			distance += difference * difference;
+		}
+		return distance;
+	}
+
+	/**
+	Finds the line that best fits the colors provided: their mean and the
+	principal axis of their covariance, found with a few power iterations.
+	The colors that are not used don't take part in the fit.
+
+	@return true if the colors are not all the same
+	*/
+	auto fitLine(
+		const Color* colors,
+		const bool* used,
+		size_t channels,
+		Color& mean,
+		Color& axis) noexcept -> bool {
+
+		mean = Color{};
+		auto count = 0.0f;
+		auto minimum = Color{ 255.0f, 255.0f, 255.0f, 255.0f };
+		auto maximum = Color{};
+
+		[[gsl::suppress(bounds.1, bounds.4)]]{
+		for (auto pixel = size_t{ 0 }; pixel < pixels_per_block; ++pixel) {
+			if (!used[pixel]) {
+				continue;
+			}
+			for (auto channel = size_t{ 0 }; channel < channels; ++channel) {
+				mean[channel] += colors[pixel][channel];
+				minimum[channel] = std::min(minimum[channel], colors[pixel][channel]);
+				maximum[channel] = std::max(maximum[channel], colors[pixel][channel]);
+			}
+			count += 1.0f;
+		}
+		if (count == 0.0f) {
+			return false;
+		}
+		for (auto channel = size_t{ 0 }; channel < channels; ++channel) {
+			mean[channel] /= count;
+		}
+
+		float covariance[4][4]{};
+		for (auto pixel = size_t{ 0 }; pixel < pixels_per_block; ++pixel) {
+			if (!used[pixel]) {
+				continue;
+			}
+			for (auto row = size_t{ 0 }; row < channels; ++row) {
+				for (auto column = size_t{ 0 }; column < channels; ++column) {
+					covariance[row][column] +=
+						(colors[pixel][row] - mean[row]) * (colors[pixel][column] - mean[column]);
+				}
+			}
+		}
+
+		/*
+		The diagonal of the bounding box is a good start for the iterations
+		*/
+		auto length = 0.0f;
+		for (auto channel = size_t{ 0 }; channel < channels; ++channel) {
+			axis[channel] = maximum[channel] - minimum[channel];
+			length += axis[channel] * axis[channel];
+		}
+		if (length == 0.0f) {
+			return false;
+		}
+
+		for (auto iteration = 0; iteration < 8; ++iteration) {
+			auto next = Color{};
+			for (auto row = size_t{ 0 }; row < channels; ++row) {
+				for (auto column = size_t{ 0 }; column < channels; ++column) {
+					next[row] += covariance[row][column] * axis[column];
+				}
+			}
+
+			length = std::sqrt(squaredDistance(next, Color{}, channels));
+			if (length < std::numeric_limits<float>::epsilon()) {
+				break;
+			}
+			for (auto channel = size_t{ 0 }; channel < channels; ++channel) {
+				axis[channel] = next[channel] / length;
+			}
+		}
+
+		length = std::sqrt(squaredDistance(axis, Color{}, channels));
+		for (auto channel = size_t{ 0 }; channel < channels; ++channel) {
+			axis[channel] /= length;
+		}
+		}
+		return true;
+	}
+
+	/**
+	Ends of the segment of the fitted line that covers every used color
+	*/
+	auto findEndpoints(
+		const Color* colors,
+		const bool* used,
+		size_t channels,
+		Color& endpoint_0,
+		Color& endpoint_1) noexcept -> void {
+
+		auto mean = Color{};
+		auto axis = Color{};
+		if (!fitLine(colors, used, channels, mean, axis)) {
+			endpoint_0 = mean;
+			endpoint_1 = mean;
+			return;
+		}
+
+		auto minimum = std::numeric_limits<float>::max();
+		auto maximum = std::numeric_limits<float>::lowest();
+		[[gsl::suppress(bounds.1, bounds.4)]]{
+		for (auto pixel = size_t{ 0 }; pixel < pixels_per_block; ++pixel) {
+			if (!used[pixel]) {
+				continue;
+			}
+			auto projection = 0.0f;
+			for (auto channel = size_t{ 0 }; channel < channels; ++channel) {
+				projection += (colors[pixel][channel] - mean[channel]) * axis[channel];
+			}
+			minimum = std::min(minimum, projection);
+			maximum = std::max(maximum, projection);
+		}
+		for (auto channel = size_t{ 0 }; channel < channels; ++channel) {
+			endpoint_0[channel] = std::clamp(mean[channel] + axis[channel] * maximum, 0.0f, 255.0f);
+			endpoint_1[channel] = std::clamp(mean[channel] + axis[channel] * minimum, 0.0f, 255.0f);
+		}
+		}
+	}
+
+	auto toRgb565(const Color& color) noexcept -> uint16_t {
+		const auto red = gsl::narrow_cast<uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+		const auto green = gsl::narrow_cast<uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+		const auto blue = gsl::narrow_cast<uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+		return gsl::narrow_cast<uint16_t>((red << 11) | (green << 5) | blue);
+	}
+
+	auto fromRgb565(uint16_t color) noexcept -> Color {
+		const auto red = (color >> 11) & 31;
+		const auto green = (color >> 5) & 63;
+		const auto blue = color & 31;
+		return {
+			gsl::narrow_cast<float>((red << 3) | (red >> 2)),
+			gsl::narrow_cast<float>((green << 2) | (green >> 4)),
+			gsl::narrow_cast<float>((blue << 3) | (blue >> 2)),
+			255.0f
+		};
+	}
+
+	/**
+	Writes the 8 bytes of a BC1 color block.
+
+	@param The colors of the block
+	@param The pixels that are transparent, only when the 3 color mode is allowed (otherwise nullptr)
+	@param Where to write the block
+	*/
+	auto compressColorBlock(
+		const Color* colors,
+		const bool* transparent,
+		unsigned char* destination) noexcept -> void {
+
+		auto used = std::array<bool, pixels_per_block>{};
+		auto three_colors = false;
+		[[gsl::suppress(bounds.1)]]{
+		for (auto pixel = size_t{ 0 }; pixel < pixels_per_block; ++pixel) {
+			used[pixel] = !transparent || !transparent[pixel];
+			three_colors = three_colors || !used[pixel];
+		}
+		}
+
+		auto endpoint_0 = Color{};
+		auto endpoint_1 = Color{};
+		[[gsl::suppress(bounds.3)]]{
+		findEndpoints(colors, used.data(), 3, endpoint_0, endpoint_1);
+		}
+
+		auto color_0 = toRgb565(endpoint_0);
+		auto color_1 = toRgb565(endpoint_1);
+
+		/*
+		The order of the endpoints selects the mode: color_0 > color_1 is the
+		4 color mode, otherwise the 3 color mode with a transparent index.
+		*/
+		if (three_colors ? color_0 > color_1 : color_0 < color_1) {
+			std::swap(color_0, color_1);
+		}
+
+		auto palette = std::array<Color, 4>{};
+		palette[0] = fromRgb565(color_0);
+		palette[1] = fromRgb565(color_1);
+		auto palette_size = size_t{ 4 };
+
+		for (auto channel = size_t{ 0 }; channel < 3; ++channel) {
+			if (three_colors) {
+				palette[2][channel] = (palette[0][channel] + palette[1][channel]) / 2.0f;
+				palette_size = 3;
+			}
+			else {
+				palette[2][channel] = (2.0f * palette[0][channel] + palette[1][channel]) / 3.0f;
+				palette[3][channel] = (palette[0][channel] + 2.0f * palette[1][channel]) / 3.0f;
+			}
+		}
+
+		/*
+		Both endpoints are the same color in 4 color mode, so every index is 0
+		*/
+		if (color_0 == color_1 && !three_colors) {
+			palette_size = 1;
+		}
+
+		auto indices = uint32_t{ 0 };
+		[[gsl::suppress(bounds.1)]]{
+		for (auto pixel = size_t{ 0 }; pixel < pixels_per_block; ++pixel) {
+			auto best_index = uint32_t{ 3 };
+			if (used[pixel]) {
+				auto best_distance = std::numeric_limits<float>::max();
+				for (auto index = size_t{ 0 }; index < palette_size; ++index) {
+					const auto distance = squaredDistance(colors[pixel], palette[index], 3);
+					if (distance < best_distance) {
+						best_distance = distance;
+						best_index = gsl::narrow_cast<uint32_t>(index);
+					}
+				}
+			}
+			indices |= best_index << (pixel * 2);
+		}
+		}
+
+		auto writer = BitWriter{ destination };
+		writer.write(color_0, 16);
+		writer.write(color_1, 16);
+		writer.write(indices, 32);
+	}
+
+	/**
+	Writes the 8 bytes of a BC3 alpha block, always in the 8 values mode
+	*/
+	auto compressAlphaBlock(const Color* colors, unsigned char* destination) noexcept -> void {
+
+		auto alpha_0 = 0;
+		auto alpha_1 = 255;
+		[[gsl::suppress(bounds.1)]]{
+		for (auto pixel = size_t{ 0 }; pixel < pixels_per_block; ++pixel) {
+			const auto alpha = gsl::narrow_cast<int>(colors[pixel][3]);
+			alpha_0 = std::max(alpha_0, alpha);
+			alpha_1 = std::min(alpha_1, alpha);
+		}
+		}
+
+		auto writer = BitWriter{ destination };
+		writer.write(gsl::narrow_cast<uint32_t>(alpha_0), 8);
+		writer.write(gsl::narrow_cast<uint32_t>(alpha_1), 8);
+
+		if (alpha_0 == alpha_1) {
+			writer.write(0, 32);
+			writer.write(0, 16);
+			return;
+		}
+
+		auto palette = std::array<int, 8>{ alpha_0, alpha_1 };
+		for (auto index = 2; index < 8; ++index) {
+			[[gsl::suppress(bounds.4)]]{
+			palette[index] = ((8 - index) * alpha_0 + (index - 1) * alpha_1 + 3) / 7;
+			}
+		}
+
+		[[gsl::suppress(bounds.1, bounds.4)]]{
+		for (auto pixel = size_t{ 0 }; pixel < pixels_per_block; ++pixel) {
+			const auto alpha = gsl::narrow_cast<int>(colors[pixel][3]);
+			auto best_index = uint32_t{ 0 };
+			auto best_distance = std::numeric_limits<int>::max();
+			for (auto index = size_t{ 0 }; index < palette.size(); ++index) {
+				const auto distance = std::abs(palette[index] - alpha);
+				if (distance < best_distance) {
+					best_distance = distance;
+					best_index = gsl::narrow_cast<uint32_t>(index);
+				}
+			}
+			writer.write(best_index, 3);
+		}
+		}
+	}
+
+	constexpr int bc7_weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	/**
+	Writes the 16 bytes of a BC7 block in mode 6
+	*/
+	auto compressBc7Block(const Color* colors, unsigned char* destination) noexcept -> void {
+
+		auto used = std::array<bool, pixels_per_block>{};
+		used.fill(true);
+
+		auto endpoint_0 = Color{};
+		auto endpoint_1 = Color{};
+		[[gsl::suppress(bounds.3)]]{
+		findEndpoints(colors, used.data(), 4, endpoint_0, endpoint_1);
+		}
+
+		auto best_error = std::numeric_limits<float>::max();
+		auto best_endpoints = std::array<std::array<uint32_t, 4>, 2>{};
+		auto best_shared_bits = std::array<uint32_t, 2>{};
+		auto best_indices = std::array<uint32_t, pixels_per_block>{};
+
+		/*
+		The shared bit is the lowest bit of every channel of its endpoint
+		*/
+		[[gsl::suppress(bounds.1, bounds.2, bounds.4)]]{
+		for (auto shared_bits = uint32_t{ 0 }; shared_bits < 4; ++shared_bits) {
+			const auto shared_bit = std::array<uint32_t, 2>{ shared_bits & 1, shared_bits >> 1 };
+
+			auto endpoints = std::array<std::array<uint32_t, 4>, 2>{};
+			auto ends = std::array<Color, 2>{};
+			for (auto channel = size_t{ 0 }; channel < 4; ++channel) {
+				for (auto end = size_t{ 0 }; end < 2; ++end) {
+					const auto value = (end == 0 ? endpoint_0 : endpoint_1)[channel];
+					const auto quantized = std::clamp(
+						std::lround((value - gsl::narrow_cast<float>(shared_bit[end])) / 2.0f), 0l, 127l);
+					endpoints[end][channel] = gsl::narrow_cast<uint32_t>(quantized);
+					ends[end][channel] = gsl::narrow_cast<float>((quantized << 1) | shared_bit[end]);
+				}
+			}
+
+			auto palette = std::array<Color, 16>{};
+			for (auto index = size_t{ 0 }; index < palette.size(); ++index) {
+				for (auto channel = size_t{ 0 }; channel < 4; ++channel) {
+					const auto value =
+						(64 - bc7_weights[index]) * gsl::narrow_cast<int>(ends[0][channel]) +
+						bc7_weights[index] * gsl::narrow_cast<int>(ends[1][channel]) + 32;
+					palette[index][channel] = gsl::narrow_cast<float>(value >> 6);
+				}
+			}
+
+			auto error = 0.0f;
+			auto indices = std::array<uint32_t, pixels_per_block>{};
+			for (auto pixel = size_t{ 0 }; pixel < pixels_per_block; ++pixel) {
+				auto best_distance = std::numeric_limits<float>::max();
+				for (auto index = size_t{ 0 }; index < palette.size(); ++index) {
+					const auto distance = squaredDistance(colors[pixel], palette[index], 4);
+					if (distance < best_distance) {
+						best_distance = distance;
+						indices[pixel] = gsl::narrow_cast<uint32_t>(index);
+					}
+				}
+				error += best_distance;
+			}
+
+			if (error < best_error) {
+				best_error = error;
+				best_endpoints = endpoints;
+				best_shared_bits = shared_bit;
+				best_indices = indices;
+			}
+		}
+		}
+
+		/*
+		The highest bit of the index of the first pixel is implicitly 0, when it
+		is not we swap the endpoints, which mirrors every index.
+		*/
+		if (best_indices[0] >= 8) {
+			std::swap(best_endpoints[0], best_endpoints[1]);
+			std::swap(best_shared_bits[0], best_shared_bits[1]);
+			for (auto& index : best_indices) {
+				index = 15 - index;
+			}
+		}
+
+		auto writer = BitWriter{ destination };
+		writer.write(1 << 6, 7);	// Mode 6
+		[[gsl::suppress(bounds.4)]]{
+		for (auto channel = size_t{ 0 }; channel < 4; ++channel) {
+			writer.write(best_endpoints[0][channel], 7);
+			writer.write(best_endpoints[1][channel], 7);
+		}
+		}
+		writer.write(best_shared_bits[0], 1);
+		writer.write(best_shared_bits[1], 1);
+		writer.write(best_indices[0], 3);
+		[[gsl::suppress(bounds.4)]]{
+		for (auto pixel = size_t{ 1 }; pixel < pixels_per_block; ++pixel) {
+			writer.write(best_indices[pixel], 4);
+		}
+		}
+	}
+}
+
+auto compressBlock(const unsigned char* pixels, VkFormat format, unsigned char* destination) noexcept -> void {
+
+	auto colors = std::array<Color, pixels_per_block>{};
+	auto transparent = std::array<bool, pixels_per_block>{};
+	auto any_transparent = false;
+
+	[[gsl::suppress(bounds.1, bounds.4)]]{
+	for (auto pixel = size_t{ 0 }; pixel < pixels_per_block; ++pixel) {
+		for (auto channel = size_t{ 0 }; channel < 4; ++channel) {
+			colors[pixel][channel] = pixels[pixel * 4 + channel];
+		}
+		transparent[pixel] = pixels[pixel * 4 + 3] < 128;
+		any_transparent = any_transparent || transparent[pixel];
+	}
+	}
+
+	memset(destination, 0, getBlockBytes(format));
+
+	[[gsl::suppress(bounds.1, bounds.3)]]{
+	switch (format) {
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK: {
+		compressColorBlock(colors.data(), any_transparent ? transparent.data() : nullptr, destination);
+		break;
+	}
+	case VK_FORMAT_BC3_UNORM_BLOCK: {
+		compressAlphaBlock(colors.data(), destination);
+		compressColorBlock(colors.data(), nullptr, destination + 8);
+		break;
+	}
+	case VK_FORMAT_BC7_UNORM_BLOCK: {
+		compressBc7Block(colors.data(), destination);
+		break;
+	}
+	default: {
+		compressColorBlock(colors.data(), nullptr, destination);
+		break;
+	}
+	}
+	}
+}
+
+auto compressImage(
+	const unsigned char* pixels,
+	uint32_t width,
+	uint32_t height,
+	VkFormat format,
+	ThreadPool& thread_pool,
+	unsigned char* destination) -> void {
+
+	const auto blocks_x = (width + 3) / 4;
+	const auto blocks_y = (height + 3) / 4;
+	const auto block_bytes = getBlockBytes(format);
+
+	thread_pool.parallelFor(blocks_y, [&](size_t begin, size_t end) {
+		unsigned char block[pixels_per_block * 4];
+
+		[[gsl::suppress(bounds.1, bounds.3)]]{
+		for (auto block_y = begin; block_y < end; ++block_y) {
+			for (auto block_x = size_t{ 0 }; block_x < blocks_x; ++block_x) {
+
+				for (auto y = size_t{ 0 }; y < 4; ++y) {
+					const auto source_y = std::min<size_t>(block_y * 4 + y, height - 1);
+					for (auto x = size_t{ 0 }; x < 4; ++x) {
+						const auto source_x = std::min<size_t>(block_x * 4 + x, width - 1);
+						memcpy(&block[(y * 4 + x) * 4], &pixels[(source_y * width + source_x) * 4], 4);
+					}
+				}
+
+				compressBlock(block, format, destination + (block_y * blocks_x + block_x) * block_bytes);
+			}
+		}
+		}
+	});
+}
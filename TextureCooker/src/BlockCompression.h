@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+class ThreadPool;
+
+/*
+Block compression encoders.
+
+Every 4x4 block of pixels is compressed independently, the blocks on the right
+and bottom borders of images whose size is not a multiple of 4 repeat their
+last column and row.
+
+	- BC1: two RGB565 endpoints along the principal axis of the colors of the
+	block and 2 bit indices. With VK_FORMAT_BC1_RGBA_UNORM_BLOCK the blocks
+	with transparent pixels use the 3 color mode, where the index 3 is black
+	and transparent.
+	- BC3: the BC1 color block (always in 4 color mode) after a block with two
+	8 bit alpha endpoints and 3 bit indices.
+	- BC7: only the mode 6, one subset with RGBA 7.7.7.7 endpoints plus a shared
+	bit per endpoint and 4 bit indices. Every combination of shared bits is
+	tried and the one with the smallest error is kept.
+
+The encoders aim for a reasonable quality in little time, they don't search
+the endpoints iteratively like the production encoders do.
+*/
+
+/**
+Compresses a block of pixels.
+
+@param The 16 RGBA8 pixels of the block, row by row
+@param The format to compress the block to: BC1 (RGB or RGBA), BC3 or BC7
+@param Where to write the block, 8 bytes for BC1 and 16 for the rest
+*/
+auto compressBlock(const unsigned char* pixels, VkFormat format, unsigned char* destination) noexcept -> void;
+
+/**
+Compresses an RGBA8 image, the rows of blocks are split between the threads of the pool.
+
+@param The pixels of the image
+@param Width of the image
+@param Height of the image
+@param The format to compress the image to: BC1 (RGB or RGBA), BC3 or BC7
+@param The threads that compress the blocks
+@param Where to write the blocks, row by row
+*/
+auto compressImage(
+	const unsigned char* pixels,
+	uint32_t width,
+	uint32_t height,
+	VkFormat format,
+	ThreadPool& thread_pool,
+	unsigned char* destination) -> void;
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <gsl/gsl>
+
+#include "render/MipGenerator.h"
+#include "render/TextureFile.h"
+#include "utils/ThreadPool.h"
+#include "BlockCompression.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+namespace {
+
+	auto parseFormat(const std::string& name, bool has_alpha, VkFormat& format) noexcept -> bool {
+		if (name == "auto") {
+			format = has_alpha ? VK_FORMAT_BC3_UNORM_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		}
+		else if (name == "bc1") {
+			format = has_alpha ? VK_FORMAT_BC1_RGBA_UNORM_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		}
+		else if (name == "bc3") {
+			format = VK_FORMAT_BC3_UNORM_BLOCK;
+		}
+		else if (name == "bc7") {
+			format = VK_FORMAT_BC7_UNORM_BLOCK;
+		}
+		else {
+			return false;
+		}
+		return true;
+	}
+
+	auto getFormatName(VkFormat format) noexcept -> const char* {
+		switch (format) {
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK: return "BC1 (RGB)";
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK: return "BC1 (RGBA)";
+		case VK_FORMAT_BC3_UNORM_BLOCK: return "BC3";
+		default: return "BC7";
+		}
+	}
+}
+
+/**
+Cooks a texture for VR_ButNotReally: reads any image stb_image can read,
+builds its whole mip chain and compresses every level into BC1, BC3 or BC7
+blocks, then writes it as a .ktx2 file the renderer loads without decoding.
+
+Usage: TextureCooker <image> [output.ktx2] [auto | bc1 | bc3 | bc7]
+
+By default the output is written next to the image with the .ktx2 extension
+and the format is BC1 for opaque images and BC3 for images with transparency.
+*/
+auto main(int argc, char** argv) -> int {
+
+	if (argc < 2 || argc > 4) {
+		std::cerr << "Usage: TextureCooker <image> [output.ktx2] [auto | bc1 | bc3 | bc7]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const auto arguments = std::vector<std::string>(argv, argv + argc);
+	const auto& input_path = arguments[1];
+	const auto output_path = argc > 2 ? arguments[2] : getCookedTexturePath(input_path);
+	const auto format_name = argc > 3 ? arguments[3] : std::string{ "auto" };
+
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	auto width = 0;
+	auto height = 0;
+	auto channels = 0;
+	auto pixels = stbi_load(input_path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+	if (!pixels) {
+		std::cerr << "We couldn't load the image [" << input_path << "]: " << stbi_failure_reason() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const auto pixel_count = size_t{ gsl::narrow_cast<size_t>(width) } * gsl::narrow_cast<size_t>(height);
+	auto has_alpha = false;
+	[[gsl::suppress(bounds.1)]]{
+	for (auto pixel = size_t{ 0 }; pixel < pixel_count && !has_alpha; ++pixel) {
+		has_alpha = pixels[pixel * 4 + 3] != 255;
+	}
+	}
+
+	auto texture = CookedTexture{};
+	if (!parseFormat(format_name, has_alpha, texture.format)) {
+		std::cerr << "Unknown format [" << format_name << "], it must be auto, bc1, bc3 or bc7" << std::endl;
+		stbi_image_free(pixels);
+		return EXIT_FAILURE;
+	}
+
+	texture.width = gsl::narrow_cast<uint32_t>(width);
+	texture.height = gsl::narrow_cast<uint32_t>(height);
+
+	const auto mip_chain = generateMipChain(
+		pixels,
+		texture.width,
+		texture.height,
+		getMipLevelCount(texture.width, texture.height));
+	stbi_image_free(pixels);
+
+	/*
+	Every level is compressed in turn, the blocks of a level split between the workers
+	*/
+	auto thread_pool = ThreadPool{};
+
+	auto compressed_bytes = uint64_t{ 0 };
+	for (const auto& level : mip_chain.levels) {
+		texture.levels.push_back({ compressed_bytes, level.width, level.height });
+		compressed_bytes += getCompressedLevelBytes(texture.format, level.width, level.height);
+	}
+	texture.data.resize(gsl::narrow<size_t>(compressed_bytes));
+
+	[[gsl::suppress(bounds.1)]]{
+	for (auto level = size_t{ 0 }; level < mip_chain.levels.size(); ++level) {
+		compressImage(
+			mip_chain.pixels.data() + mip_chain.levels[level].offset,
+			mip_chain.levels[level].width,
+			mip_chain.levels[level].height,
+			texture.format,
+			thread_pool,
+			texture.data.data() + texture.levels[level].offset);
+	}
+	}
+
+	if (!writeCookedTexture(output_path, texture)) {
+		std::cerr << "We couldn't write the cooked texture [" << output_path << "]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const auto milliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::high_resolution_clock::now() - start).count();
+
+	std::cout << "[" << input_path << "] cooked into [" << output_path << "]" << std::endl;
+	std::cout << "\t" << width << "x" << height << ", " << texture.levels.size() << " mip levels in "
+		<< getFormatName(texture.format) << std::endl;
+	std::cout << "\t" << mip_chain.pixels.size() / 1024 << " KiB as RGBA8, "
+		<< compressed_bytes / 1024 << " KiB compressed" << std::endl;
+	std::cout << "\tCooked in " << milliseconds << " ms" << std::endl;
+
+	return EXIT_SUCCESS;
+}
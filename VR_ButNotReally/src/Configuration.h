@@ -76,6 +76,228 @@ namespace config {
 	const auto shader_path = std::string{ "./res/shaders/" };
 	const auto model_path = std::string{ "./res/models/" };
 
+	/*
+	Binary mesh cache written next to every loaded model, it lets us skip
+	the parsing of the model on the following launches.
+	*/
+	constexpr auto mesh_cache_enabled = true;
+	const auto mesh_cache_extension = std::string{ ".meshcache" };
+
+	/*
+	Deduplicate the vertices of every shape of a model in parallel and
+	merge them afterwards instead of using a single table.
+	*/
+	constexpr auto parallel_vertex_deduplication = true;
+
+	/*
+	Optimization passes applied to the meshes after loading them, changing
+	them rebuilds the mesh caches.
+
+	@see MeshOptimizer.h
+	*/
+	constexpr auto mesh_optimization_enabled = true;
+	constexpr auto vertex_cache_size = 16u;
+	constexpr auto overdraw_optimization_enabled = true;
+	constexpr auto overdraw_threshold = 1.05f;
+
+	/*
+	Split the meshes with more than 65536 vertices in sub-meshes that can
+	be drawn with 16 bit indices.
+	*/
+	constexpr auto split_for_short_indices = true;
+
+	/*
+	Chain of simplified versions of every mesh stored after the full one in
+	the index buffer. Every level keeps lod_reduction of the triangles of the
+	previous one, the chain ends after lod_max_levels levels or when the error
+	of the next level would be more than lod_max_error (relative to the size of
+	the mesh). Every frame we draw the coarsest level whose error projected on
+	the screen is below lod_error_threshold pixels.
+
+	@see MeshSimplifier.h
+	*/
+	constexpr auto lod_enabled = true;
+	constexpr auto lod_max_levels = 5u;
+	constexpr auto lod_reduction = 0.5f;
+	constexpr auto lod_max_error = 0.05f;
+	constexpr auto lod_error_threshold = 1.0f;
+
+	/*
+	When enabled the CPU benchmarks are run instead of the renderer.
+
+	@see Benchmarks.h
+	*/
+	constexpr auto benchmarks_enabled = false;
+	constexpr auto benchmark_iterations = 5;
+	constexpr auto benchmark_grid_size = 1200;
+
+
+	/*
+	Upload the vertices quantized (12 bytes per vertex) instead of with
+	full precision (32 bytes per vertex).
+
+	@see CompactVertex
+	*/
+	constexpr auto compact_vertices_enabled = true;
+
+	/*
+	Split the meshes in meshlets of at most meshlet_max_vertices vertices and
+	meshlet_max_triangles triangles and cull them on the CPU every frame,
+	only the visible ones are drawn (through an indirect buffer).
+
+	@see Meshlet.h
+	*/
+	constexpr auto meshlet_culling_enabled = true;
+	constexpr auto meshlet_max_vertices = 64u;
+	constexpr auto meshlet_max_triangles = 124u;
+
+	/*
+	Load the scene in the background instead of during the initialization,
+	it appears once its mesh and texture have been uploaded. Every frame at
+	most streaming_upload_budget bytes (or a single asset) start uploading.
+
+	@see AssetStreamer.h
+	*/
+	constexpr auto asset_streaming_enabled = true;
+	constexpr auto streaming_threads = 2u;
+	constexpr auto streaming_upload_budget = size_t{ 32 } * 1024 * 1024;
+
+	/*
+	Bytes of the staging ring of the streamer, the workers write the decoded
+	assets into it and wait for room when it is full. Assets bigger than half
+	the ring get a staging buffer of their own, created and destroyed with
+	their upload.
+
+	@see AssetStreamer.h
+	@see StagingRing.h
+	*/
+	constexpr auto streaming_staging_ring_size = VkDeviceSize{ 64 } * 1024 * 1024;
+
+	/*
+	Bytes of the staging ring the uploads of the scene go through. Uploads
+	bigger than half the ring are split in chunks, and when it is full the
+	uploads recorded so far are submitted and we wait for the oldest ones.
+
+	@see StagingRing.h
+	*/
+	constexpr auto staging_ring_size = VkDeviceSize{ 64 } * 1024 * 1024;
+
+	/*
+	Command buffers (each with its fence) reused by the single time commands
+	and the upload batches of every queue. When all of them are in flight
+	the oldest is waited for.
+
+	@see CommandBufferPool.h
+	*/
+	constexpr auto command_buffer_pool_size = size_t{ 8 };
+
+	/*
+	Vertices and indices of the arenas every mesh is drawn from. When a mesh
+	doesn't fit in any free range the meshes are moved together to close the
+	holes left by the freed ones.
+
+	@see GeometryPool.h
+	*/
+	constexpr auto geometry_pool_vertex_capacity = uint32_t{ 1 } << 20;
+	constexpr auto geometry_pool_index_capacity = uint32_t{ 1 } << 22;
+
+	/*
+	Build the full mip chain of every texture. It is blitted on the GPU when
+	the format supports linear blits and filtered on the CPU otherwise.
+
+	@see MipBlit.h
+	@see MipGenerator.h
+	*/
+	constexpr auto mipmaps_enabled = true;
+
+	/*
+	Load the cooked version of a texture (the .ktx2 file next to it built by
+	the TextureCooker) instead of decoding it, when the device supports BC
+	textures.
+
+	@see TextureFile.h
+	*/
+	constexpr auto cooked_textures_enabled = true;
+
+	/*
+	Store the decoded mip chain of every texture that is not cooked in a file
+	next to it, so the next launches don't decode it again. The least recently
+	used files are deleted when they take more than the size cap.
+
+	The cached textures are read into the heap, so while it is enabled no
+	texture is decoded straight into staging memory. That
+	only happens with the cache disabled, for the textures that are neither
+	cooked nor layers of an array.
+
+	@see TextureCache.h
+	@see StagingDecoder.h
+	*/
+	constexpr auto texture_cache_enabled = true;
+	const auto texture_cache_index_path = std::string{ "./texture_cache.index" };
+	constexpr auto texture_cache_size_cap = uint64_t{ 512 } * 1024 * 1024;
+
+	/*
+	Load the diffuse textures of the materials of the model into the layers
+	of a texture array and draw the unpacked model (one texture per material)
+	instead of the one packed by hand into a single texture. The textures of
+	the materials must have the same size.
+
+	@see MaterialLibrary.h
+	*/
+	constexpr auto material_textures_enabled = true;
+
+	/*
+	Pack the diffuse textures of the materials into a single atlas when the
+	model is loaded instead of a texture array. The textures can have
+	different sizes, but the mip chain of the atlas stops at the level where
+	the gutter between them is 1 texel wide.
+
+	@see TextureAtlas.h
+	*/
+	constexpr auto texture_atlas_enabled = false;
+	constexpr auto texture_atlas_gutter = 8u;
+	constexpr auto texture_atlas_max_size = 4096u;
+
+	/*
+	Draw Tarzan.smd animated instead of the static .obj. Its vertices are
+	skinned on the CPU every frame into the vertex buffer of the command
+	buffer, so it is drawn with full vertices, a single level of detail and
+	without meshlet culling. The file only has the reference pose, so without
+	an animation every bone sways with the amplitude (in radians) below.
+
+	@see Skinning.h
+	*/
+	constexpr auto skinning_enabled = false;
+	constexpr auto skinning_sway_amplitude = 0.08f;
+	constexpr auto skinning_sway_frames = 60u;
+	constexpr auto skinning_frame_rate = 30.0f;
+	constexpr auto benchmark_skinned_characters = 256u;
+
+	/*
+	Skin the vertices of the skinned scene with a compute shader before the
+	render pass instead of on the CPU, the CPU only writes the palette. The
+	time the GPU spends skinning is measured with timestamp queries and shown
+	in the title of the window. Falls back to the CPU when the graphics queue
+	can't run compute shaders.
+
+	@see skinning.comp
+	*/
+	constexpr auto gpu_skinning_enabled = false;
+
+	/*
+	Cook the clip of the skinned scene into compressed keyframe tracks when
+	it is loaded and sample those instead of the raw poses, which are freed.
+	The skin error is the largest distance a vertex may move from where the
+	raw poses put it, in model units (Tarzan.smd is about 300 units tall).
+	The benchmarks also cook a clip with the frames below to compare the
+	memory of a long clip.
+
+	@see AnimationCooker.h
+	*/
+	constexpr auto animation_cooking_enabled = true;
+	constexpr auto animation_skin_error = 0.1f;
+	constexpr auto benchmark_animation_frames = 900u;
+
 
 	const auto clear_color = VkClearValue{ 0.0f, 0.0f, 0.0f, 1.0f };
 
@@ -1,5 +1,6 @@
 #include "./render/Renderer.h"
 #include "./utils/Utils.h"
+#include "./bench/Benchmarks.h"
 
 int main() {
 
@@ -13,6 +14,12 @@ int main() {
 
 	{
 		try {
+			if (config::benchmarks_enabled) {
+				runBenchmarks();
+				pressToContinue();
+				return EXIT_SUCCESS;
+			}
+
 			Renderer renderer;
 			while (!renderer.shouldClose()) {
 				glfwPollEvents();
@@ -0,0 +1,460 @@
+#include "Benchmarks.h"
+#include "../render/ObjParser.h"
+#include "../render/VertexDeduplicator.h"
+#include "../render/MaterialLibrary.h"
+#include "../render/TextureBatch.h"
+#include "../render/Skinning.h"
+#include "../render/AnimationCooker.h"
+#include "../Configuration.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <gsl/gsl>
+
+#pragma warning(push)
+#include <CppCoreCheck/Warnings.h>
+#pragma warning(disable: ALL_CPPCORECHECK_WARNINGS)
+#include <tiny_obj_loader.h>
+#pragma warning(pop)
+
+namespace {
+
+	/**
+	Calls the function config::benchmark_iterations times and returns the
+	fastest run in milliseconds.
+	*/
+	template<typename Function>
+	auto measureMilliseconds(Function&& function) -> double {
+		auto best = std::numeric_limits<double>::max();
+		for (auto i = 0; i < config::benchmark_iterations; ++i) {
+			const auto start = std::chrono::high_resolution_clock::now();
+			function();
+			const auto end = std::chrono::high_resolution_clock::now();
+			best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+		return best;
+	}
+
+	auto getFileSize(const std::string& path) -> size_t {
+		auto file = std::ifstream(path, std::ios::ate | std::ios::binary);
+		return file.is_open() ? gsl::narrow<size_t>(file.tellg()) : 0;
+	}
+
+	/**
+	Writes a grid of grid_size x grid_size quads (two triangles each) with
+	positions, texture coordinates and normals.
+	*/
+	auto writeSyntheticObj(const std::string& path, int grid_size) -> void {
+		auto file = std::ofstream(path, std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("We couldn't create the synthetic obj file for the benchmark");
+		}
+
+		const auto side = grid_size + 1;
+		file << std::fixed << std::setprecision(6);
+		file << "o synthetic_grid\n";
+
+		for (auto y = 0; y < side; ++y) {
+			for (auto x = 0; x < side; ++x) {
+				const auto u = static_cast<float>(x) / grid_size;
+				const auto v = static_cast<float>(y) / grid_size;
+				file << "v " << u * 10.0f - 5.0f << ' ' << (u * v) - 0.5f << ' ' << v * 10.0f - 5.0f << '\n';
+				file << "vt " << u << ' ' << v << '\n';
+			}
+		}
+		file << "vn 0.000000 1.000000 0.000000\n";
+
+		for (auto y = 0; y < grid_size; ++y) {
+			for (auto x = 0; x < grid_size; ++x) {
+				const auto a = y * side + x + 1;
+				const auto b = a + 1;
+				const auto c = a + side;
+				const auto d = c + 1;
+				file << "f " << a << '/' << a << "/1 " << c << '/' << c << "/1 " << b << '/' << b << "/1\n";
+				file << "f " << b << '/' << b << "/1 " << c << '/' << c << "/1 " << d << '/' << d << "/1\n";
+			}
+		}
+	}
+
+	/**
+	Writes the synthetic .obj on construction and deletes it on destruction
+	*/
+	struct ScopedSyntheticObj {
+		const std::string path{ "./synthetic_benchmark.obj" };
+
+		ScopedSyntheticObj() { writeSyntheticObj(path, config::benchmark_grid_size); }
+		ScopedSyntheticObj(const ScopedSyntheticObj&) = delete;
+		ScopedSyntheticObj& operator=(const ScopedSyntheticObj&) = delete;
+		~ScopedSyntheticObj() { std::remove(path.c_str()); }
+	};
+
+	auto getBundledModelPaths() -> std::vector<std::string> {
+		return {
+			config::model_path + "obj/tarzan/Tarzan.obj",
+			config::model_path + "obj/tarzan/Tarzan_packed/Tarzan_packed.obj",
+			config::model_path + "obj/tarzan/Tarzan_packed/tarzan_scaled.obj"
+		};
+	}
+
+	/**
+	The hash loadScene used before the VertexDeduplicator
+	*/
+	struct LegacyVertexHash {
+		size_t operator()(Vertex const& vertex) const {
+			return(
+				(std::hash<glm::vec3>()(vertex.pos) ^
+				(std::hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
+				(std::hash<glm::vec2>()(vertex.tex_coord) << 1);
+		}
+	};
+
+	/**
+	Deduplicates the corners with an std::unordered_map the way loadScene used
+	to (count() and then operator[]) and prints its time and collisions.
+	*/
+	template<typename Hash>
+	auto benchmarkUnorderedMap(const char* name, const std::vector<Vertex>& corners) -> void {
+
+		auto unique_vertices = std::unordered_map<Vertex, uint32_t, Hash>{};
+		auto indices = std::vector<uint32_t>{};
+
+		const auto time = measureMilliseconds([&]() {
+			unique_vertices = std::unordered_map<Vertex, uint32_t, Hash>{};
+			indices.clear();
+			auto vertex_count = uint32_t{ 0 };
+
+			for (const auto& vertex : corners) {
+				if (unique_vertices.count(vertex) == 0) {
+					unique_vertices[vertex] = vertex_count++;
+				}
+				indices.push_back(unique_vertices[vertex]);
+			}
+		});
+
+		/*
+		Vertices that share the full hash with another one and the
+		biggest bucket of the map.
+		*/
+		auto hashes = std::unordered_set<size_t>{};
+		auto largest_bucket = size_t{ 0 };
+		for (const auto& entry : unique_vertices) {
+			hashes.insert(Hash()(entry.first));
+		}
+		for (auto i = size_t{ 0 }; i < unique_vertices.bucket_count(); ++i) {
+			largest_bucket = std::max(largest_bucket, unique_vertices.bucket_size(i));
+		}
+
+		std::cout << "\t\t" << name << std::fixed << std::setprecision(2)
+			<< time * 1e6 / corners.size() << " ns/corner, "
+			<< unique_vertices.size() - hashes.size() << " full hash collisions, "
+			<< "largest bucket " << largest_bucket << std::endl;
+	}
+
+	auto printDeduplicationStatistics(const char* name, double time, const DeduplicationStatistics& statistics) -> void {
+		std::cout << "\t\t" << name << std::fixed << std::setprecision(2)
+			<< time * 1e6 / statistics.corners << " ns/corner, "
+			<< static_cast<double>(statistics.probes) / statistics.corners << " probes/corner, "
+			<< statistics.collisions << " collisions, "
+			<< "longest probe " << statistics.longest_probe << ", "
+			<< statistics.capacity << " slots" << std::endl;
+	}
+
+	auto benchmarkObjFile(const std::string& path, ThreadPool& thread_pool) -> void {
+
+		auto tinyobj_triangles = size_t{ 0 };
+		const auto tinyobj_time = measureMilliseconds([&]() {
+			tinyobj::attrib_t attributes;
+			std::vector<tinyobj::shape_t> shapes;
+			std::vector<tinyobj::material_t> materials;
+			std::string err;
+
+			if (!tinyobj::LoadObj(&attributes, &shapes, &materials, &err, path.c_str())) {
+				throw std::runtime_error(err);
+			}
+
+			tinyobj_triangles = 0;
+			for (const auto& shape : shapes) {
+				tinyobj_triangles += shape.mesh.indices.size() / 3;
+			}
+		});
+
+		auto parser_triangles = size_t{ 0 };
+		const auto parser_time = measureMilliseconds([&]() {
+			const auto model = parseObj(path, thread_pool);
+
+			parser_triangles = 0;
+			for (const auto& shape : model.shapes) {
+				parser_triangles += shape.indices.size() / 3;
+			}
+		});
+
+		const auto megabytes = static_cast<double>(getFileSize(path)) / (1024.0 * 1024.0);
+
+		std::cout << "\t[" << path << "] " << std::fixed << std::setprecision(2) << megabytes << " MB, "
+			<< parser_triangles << " triangles" << std::endl;
+		std::cout << "\t\ttinyobj::LoadObj: " << tinyobj_time << " ms (" << megabytes * 1000.0 / tinyobj_time << " MB/s)" << std::endl;
+		std::cout << "\t\tparseObj:         " << parser_time << " ms (" << megabytes * 1000.0 / parser_time << " MB/s)" << std::endl;
+		std::cout << "\t\tSpeedup:          " << tinyobj_time / parser_time << "x" << std::endl;
+
+		if (tinyobj_triangles != parser_triangles) {
+			std::cerr << "\t\tThe triangle count doesn't match tinyobj (" << tinyobj_triangles << ")" << std::endl;
+		}
+		std::cout << std::endl;
+	}
+}
+
+auto runBenchmarks() -> void {
+
+	auto thread_pool = ThreadPool{};
+
+	std::cout << "Running benchmarks with " << thread_pool.getThreadCount() << " worker threads, best of "
+		<< config::benchmark_iterations << " iterations" << std::endl << std::endl;
+
+	benchmarkObjParser(thread_pool);
+	benchmarkVertexDeduplication(thread_pool);
+	benchmarkTextureDecoding(thread_pool);
+	benchmarkSkinning(thread_pool);
+	benchmarkAnimationSampling();
+}
+
+auto benchmarkObjParser(ThreadPool& thread_pool) -> void {
+
+	std::cout << "Benchmarking the obj parser" << std::endl;
+
+	const auto synthetic_obj = ScopedSyntheticObj{};
+	for (const auto& path : getBundledModelPaths()) {
+		benchmarkObjFile(path, thread_pool);
+	}
+	benchmarkObjFile(synthetic_obj.path, thread_pool);
+}
+
+auto benchmarkVertexDeduplication(ThreadPool& thread_pool) -> void {
+
+	std::cout << "Benchmarking the vertex deduplication" << std::endl;
+
+	const auto synthetic_obj = ScopedSyntheticObj{};
+	auto paths = getBundledModelPaths();
+	paths.push_back(synthetic_obj.path);
+
+	for (const auto& path : paths) {
+		const auto model = parseObj(path, thread_pool);
+
+		/*
+		The std::unordered_map versions get the corners already built so they
+		are not charged for makeVertex, the VertexDeduplicator versions are.
+		*/
+		auto corners = std::vector<Vertex>{};
+		for (const auto& shape : model.shapes) {
+			for (const auto& index : shape.indices) {
+				corners.push_back(makeVertex(model.attributes, index));
+			}
+		}
+
+		std::cout << "\t[" << path << "] " << corners.size() << " corners" << std::endl;
+
+		benchmarkUnorderedMap<LegacyVertexHash>("std::unordered_map, XOR hash:  ", corners);
+		benchmarkUnorderedMap<std::hash<Vertex>>("std::unordered_map, new hash:  ", corners);
+
+		auto serial = DeduplicatedMesh{};
+		const auto serial_time = measureMilliseconds([&]() { serial = deduplicateVertices(model, nullptr); });
+		printDeduplicationStatistics("VertexDeduplicator, serial:    ", serial_time, serial.statistics);
+
+		auto parallel = DeduplicatedMesh{};
+		const auto parallel_time = measureMilliseconds([&]() { parallel = deduplicateVertices(model, &thread_pool); });
+		printDeduplicationStatistics("VertexDeduplicator, parallel:  ", parallel_time, parallel.statistics);
+
+		if (serial.indices != parallel.indices || serial.vertices.size() != parallel.vertices.size()) {
+			std::cerr << "\t\tThe serial and parallel modes don't match" << std::endl;
+		}
+		std::cout << "\t\t" << serial.vertices.size() << " unique vertices" << std::endl << std::endl;
+	}
+}
+
+auto benchmarkTextureDecoding(ThreadPool& thread_pool) -> void {
+
+	std::cout << "Benchmarking the texture decoding" << std::endl;
+
+	const auto object_path = config::model_path + "obj/tarzan/Tarzan.obj";
+	const auto paths = getMaterialTextures(parseObj(object_path, thread_pool), object_path).texture_paths;
+	if (paths.empty()) {
+		std::cerr << "\tThe materials of [" << object_path << "] have no textures" << std::endl << std::endl;
+		return;
+	}
+
+	/*
+	Without the texture cache, every texture is decoded and its mip chain
+	filtered on every iteration
+	*/
+	auto serial = TextureBatch{};
+	const auto serial_time = measureMilliseconds([&]() { serial = decodeTextureBatch(paths, nullptr, true, nullptr); });
+
+	auto parallel = TextureBatch{};
+	const auto parallel_time = measureMilliseconds([&]() { parallel = decodeTextureBatch(paths, nullptr, true, &thread_pool); });
+
+	std::cout << "\t[" << object_path << "] " << paths.size() << " textures" << std::endl;
+	[[gsl::suppress(bounds.4)]]{
+	for (auto i = size_t{ 0 }; i < paths.size(); ++i) {
+		std::cout << "\t\t[" << paths[i] << "] " << serial.timings[i].width << "x" << serial.timings[i].height
+			<< std::fixed << std::setprecision(2) << ", " << serial.timings[i].decode_milliseconds << " ms alone, "
+			<< parallel.timings[i].decode_milliseconds << " ms in the batch" << std::endl;
+	}
+	}
+
+	std::cout << "\t\tSerial:   " << serial_time << " ms" << std::endl;
+	std::cout << "\t\tParallel: " << parallel_time << " ms with " << parallel.thread_count << " threads, "
+		<< serial_time / parallel_time << "x" << std::endl << std::endl;
+}
+
+auto benchmarkSkinning(ThreadPool& thread_pool) -> void {
+
+	std::cout << "Benchmarking the skinning" << std::endl;
+
+	const auto model_path = config::model_path + "obj/tarzan/Tarzan.smd";
+	auto mesh = loadSkinnedMesh(model_path);
+	if (mesh.clip.frame_count == 0) {
+		mesh.clip = makeSwayClip(
+			mesh.skeleton,
+			mesh.reference_pose,
+			config::skinning_sway_frames,
+			config::skinning_frame_rate,
+			config::skinning_sway_amplitude);
+	}
+
+	const auto character_count = size_t{ config::benchmark_skinned_characters };
+	const auto bone_count = mesh.skeleton.boneCount();
+	const auto vertex_count = character_count * mesh.vertices.size();
+
+	/*
+	Every character is at a different time of the clip
+	*/
+	auto palettes = std::vector<glm::mat4>(character_count * bone_count);
+	auto pose = std::vector<BonePose>{};
+	const auto palette_time = measureMilliseconds([&]() {
+		for (auto character = size_t{ 0 }; character < character_count; ++character) {
+			sampleClip(mesh.clip, character * 0.1f, pose);
+			[[gsl::suppress(bounds.1)]]{
+			computeSkinningPalette(mesh.skeleton, pose, palettes.data() + character * bone_count);
+			}
+		}
+	});
+
+	auto skinned = std::vector<Vertex>(vertex_count);
+
+	std::cout << "\t[" << model_path << "] " << mesh.vertices.size() << " vertices, " << bone_count << " bones, "
+		<< character_count << " characters" << std::endl;
+	std::cout << "\t\tPalettes: " << std::fixed << std::setprecision(2) << palette_time << " ms, "
+		<< palette_time * 1000.0 / character_count << " us per character" << std::endl;
+
+	/*
+	Vertices per second of every kernel in this thread, that is per core
+	*/
+	for (const auto kernel : { SkinningKernel::scalar, SkinningKernel::sse, SkinningKernel::avx2 }) {
+		if (!isSkinningKernelSupported(kernel)) {
+			std::cout << "\t\t" << getSkinningKernelName(kernel) << ": not supported" << std::endl;
+			continue;
+		}
+
+		const auto time = measureMilliseconds([&]() {
+			skinCharacters(mesh, palettes.data(), character_count, skinned.data(), nullptr, kernel);
+		});
+		std::cout << "\t\t" << getSkinningKernelName(kernel) << ": " << time << " ms, "
+			<< vertex_count / time / 1000.0 << " M vertices/s per core" << std::endl;
+	}
+
+	const auto kernel = getBestSkinningKernel();
+	const auto serial_time = measureMilliseconds([&]() {
+		skinCharacters(mesh, palettes.data(), character_count, skinned.data(), nullptr, kernel);
+	});
+	const auto parallel_time = measureMilliseconds([&]() {
+		skinCharacters(mesh, palettes.data(), character_count, skinned.data(), &thread_pool, kernel);
+	});
+
+	const auto thread_count = thread_pool.getThreadCount();
+	std::cout << "\t\t" << getSkinningKernelName(kernel) << " on " << thread_count << " threads: " << parallel_time << " ms, "
+		<< vertex_count / parallel_time / 1000.0 << " M vertices/s, "
+		<< vertex_count / parallel_time / 1000.0 / thread_count << " M vertices/s per core, "
+		<< serial_time / parallel_time << "x" << std::endl << std::endl;
+}
+
+auto benchmarkAnimationSampling() -> void {
+
+	std::cout << "Benchmarking the animation sampling" << std::endl;
+
+	const auto model_path = config::model_path + "obj/tarzan/Tarzan.smd";
+	const auto mesh = loadSkinnedMesh(model_path);
+	const auto bone_count = mesh.skeleton.boneCount();
+	const auto character_count = size_t{ config::benchmark_skinned_characters };
+
+	/*
+	Every character plays the clip for a second at 60 frames per second, from
+	a different time. Seeking jumps a few frames every sample, so the cooked
+	samplers decode their tracks almost every time.
+	*/
+	constexpr auto steps = 60u;
+	const auto bone_samples = static_cast<double>(steps) * character_count * bone_count;
+
+	for (const auto frame_count : { config::skinning_sway_frames, config::benchmark_animation_frames }) {
+		const auto clip = makeSwayClip(
+			mesh.skeleton,
+			mesh.reference_pose,
+			frame_count,
+			config::skinning_frame_rate,
+			config::skinning_sway_amplitude);
+
+		const auto cook_start = std::chrono::high_resolution_clock::now();
+		const auto cooked = cookAnimationClip(mesh, clip, config::animation_skin_error);
+		const auto cook_time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - cook_start).count();
+		const auto& statistics = cooked.statistics;
+
+		std::cout << "\t[" << model_path << "] " << bone_count << " bones, " << frame_count << " frames, "
+			<< character_count << " characters" << std::endl;
+		std::cout << "\t\tCooked in " << std::fixed << std::setprecision(2) << cook_time << " ms: "
+			<< statistics.raw_bytes / 1024.0 << " KB to " << statistics.cooked_bytes / 1024.0 << " KB, "
+			<< static_cast<double>(statistics.raw_bytes) / statistics.cooked_bytes << "x, "
+			<< statistics.rotation_keys << " rotation and " << statistics.translation_keys << " translation keys of "
+			<< statistics.raw_keys << ", " << statistics.constant_tracks << " constant tracks" << std::endl;
+		std::cout << "\t\tMax skin error: " << std::setprecision(4) << statistics.max_skin_error
+			<< " (" << config::animation_skin_error << " asked)" << std::endl;
+
+		auto pose = std::vector<BonePose>{};
+		const auto raw_time = measureMilliseconds([&]() {
+			for (auto step = 0u; step < steps; ++step) {
+				for (auto character = size_t{ 0 }; character < character_count; ++character) {
+					sampleClip(clip, character * 0.1f + step / 60.0f, pose);
+				}
+			}
+		});
+
+		auto samplers = std::vector<CookedClipSampler>(character_count, CookedClipSampler(cooked));
+		const auto playing_time = measureMilliseconds([&]() {
+			for (auto step = 0u; step < steps; ++step) {
+				for (auto character = size_t{ 0 }; character < character_count; ++character) {
+					samplers[character].sample(character * 0.1f + step / 60.0f, pose);
+				}
+			}
+		});
+		const auto seeking_time = measureMilliseconds([&]() {
+			for (auto step = 0u; step < steps; ++step) {
+				for (auto character = size_t{ 0 }; character < character_count; ++character) {
+					samplers[character].sample(character * 0.1f + step * 0.37f, pose);
+				}
+			}
+		});
+
+		std::cout << std::setprecision(2);
+		std::cout << "\t\tRaw: " << raw_time << " ms, " << bone_samples / raw_time / 1000.0 << " M bones/s" << std::endl;
+		std::cout << "\t\tCooked playing: " << playing_time << " ms, " << bone_samples / playing_time / 1000.0 << " M bones/s, "
+			<< raw_time / playing_time << "x" << std::endl;
+		std::cout << "\t\tCooked seeking: " << seeking_time << " ms, " << bone_samples / seeking_time / 1000.0 << " M bones/s, "
+			<< raw_time / seeking_time << "x" << std::endl;
+	}
+	std::cout << std::endl;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../utils/ThreadPool.h"
+
+/*
+Benchmarks of the CPU side of the asset pipeline.
+
+They don't need a window or a Vulkan device, so when config::benchmarks_enabled
+is set they are run from main before the renderer is created and the results
+are printed to the standard output.
+*/
+
+/**
+Runs every benchmark
+*/
+auto runBenchmarks() -> void;
+
+/**
+Compares our multithreaded .obj parser against tinyobj::LoadObj on the bundled
+Tarzan models and on a synthetic grid with several million faces.
+
+@param The thread pool our parser uses
+*/
+auto benchmarkObjParser(ThreadPool& thread_pool) -> void;
+
+/**
+Compares the vertex deduplication of loadScene before the flat table (an
+std::unordered_map with the old XOR combined hash), an std::unordered_map with
+the new hash and the VertexDeduplicator in its serial and parallel modes.
+Reports the time per corner and the collision statistics of every table.
+
+@param The thread pool for the parallel mode
+*/
+auto benchmarkVertexDeduplication(ThreadPool& thread_pool) -> void;
+
+/**
+Decodes the textures of the materials of Tarzan.obj with their mip chains one
+after another and then in parallel with decodeTextureBatch, and reports the
+time of every texture and the speedup of the batch.
+
+@param The thread pool for the parallel decoding
+*/
+auto benchmarkTextureDecoding(ThreadPool& thread_pool) -> void;
+
+/**
+Skins the vertices of Tarzan.smd for config::benchmark_skinned_characters
+characters, each one at a different time of the animation. Reports the time
+to compute their palettes and the skinned vertices per second per core of
+every kernel, and of the fastest one on the thread pool.
+
+@param The thread pool for the parallel skinning
+*/
+auto benchmarkSkinning(ThreadPool& thread_pool) -> void;
+
+/**
+Cooks a clip of Tarzan.smd with config::skinning_sway_frames and another one
+with config::benchmark_animation_frames. Reports the memory of every clip raw
+and cooked, the error of the skin, and the bones per second sampled from the
+raw clip and from the cooked one, playing it and seeking.
+*/
+auto benchmarkAnimationSampling() -> void;
@@ -0,0 +1,483 @@
+#include "AnimationCooker.h"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <gsl/gsl>
+
+namespace {
+
+	/*
+	The largest component of a unit quaternion is at least 1/2, so the other
+	three are at most 1/sqrt(2) in absolute value.
+	*/
+	constexpr auto smallest_three_range = 0.70710678f;
+	constexpr auto max_rotation_value = 32767.0f;
+	constexpr auto max_translation_value = 65535.0f;
+
+	/*
+	Times the tracks are cooked with a smaller tolerance before giving up on
+	the error of the skin, the statistics have the error of the last one.
+	*/
+	constexpr auto max_cooking_passes = 6u;
+
+	auto quantizeComponent(float value) noexcept -> uint16_t {
+		const auto normalized = std::min(std::max(value / smallest_three_range * 0.5f + 0.5f, 0.0f), 1.0f);
+		return gsl::narrow_cast<uint16_t>(std::lround(normalized * max_rotation_value));
+	}
+
+	auto dequantizeComponent(uint16_t value) noexcept -> float {
+		return (value / max_rotation_value * 2.0f - 1.0f) * smallest_three_range;
+	}
+
+	/**
+	Keeps the three smallest components of the quaternion, with the sign
+	that makes the largest one positive. The index of the largest one goes
+	in the top bits of the first two.
+	*/
+	auto packRotation(const glm::quat& rotation) noexcept -> std::array<uint16_t, 3> {
+		const auto components = std::array<float, 4>{ rotation.x, rotation.y, rotation.z, rotation.w };
+
+		auto largest = size_t{ 0 };
+		for (auto i = size_t{ 1 }; i < components.size(); ++i) {
+			if (std::fabs(components[i]) > std::fabs(components[largest])) {
+				largest = i;
+			}
+		}
+		const auto sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+		auto packed = std::array<uint16_t, 3>{};
+		auto kept = size_t{ 0 };
+		for (auto i = size_t{ 0 }; i < components.size(); ++i) {
+			if (i != largest) {
+				packed[kept++] = quantizeComponent(components[i] * sign);
+			}
+		}
+		packed[0] |= gsl::narrow_cast<uint16_t>((largest & 1) << 15);
+		packed[1] |= gsl::narrow_cast<uint16_t>((largest >> 1) << 15);
+		return packed;
+	}
+
+	auto unpackRotation(const std::array<uint16_t, 3>& packed) noexcept -> glm::quat {
+		const auto a = dequantizeComponent(packed[0] & 0x7fff);
+		const auto b = dequantizeComponent(packed[1] & 0x7fff);
+		const auto c = dequantizeComponent(packed[2] & 0x7fff);
+		const auto largest = std::sqrt(std::max(1.0f - a * a - b * b - c * c, 0.0f));
+
+		auto rotation = glm::quat{};
+		switch ((packed[0] >> 15) | ((packed[1] >> 15) << 1)) {
+		case 0:
+			rotation = glm::quat(c, largest, a, b);
+			break;
+		case 1:
+			rotation = glm::quat(c, a, largest, b);
+			break;
+		case 2:
+			rotation = glm::quat(c, a, b, largest);
+			break;
+		default:
+			rotation = glm::quat(largest, a, b, c);
+			break;
+		}
+		return glm::normalize(rotation);
+	}
+
+	auto packTranslation(const glm::vec3& translation, const glm::vec3& minimum, const glm::vec3& extent) noexcept -> std::array<uint16_t, 3> {
+		auto packed = std::array<uint16_t, 3>{};
+		for (auto i = 0; i < 3; ++i) {
+			if (extent[i] > 0.0f) {
+				const auto normalized = std::min(std::max((translation[i] - minimum[i]) / extent[i], 0.0f), 1.0f);
+				packed[i] = gsl::narrow_cast<uint16_t>(std::lround(normalized * max_translation_value));
+			}
+		}
+		return packed;
+	}
+
+	auto unpackTranslation(const std::array<uint16_t, 3>& packed, const glm::vec3& minimum, const glm::vec3& extent) noexcept -> glm::vec3 {
+		return minimum + glm::vec3(packed[0], packed[1], packed[2]) / max_translation_value * extent;
+	}
+
+	auto interpolateRotation(const glm::quat& rotation_0, const glm::quat& rotation_1, float t) noexcept -> glm::quat {
+		const auto shortest_1 = glm::dot(rotation_0, rotation_1) < 0.0f ? -rotation_1 : rotation_1;
+		return glm::normalize(rotation_0 * (1.0f - t) + shortest_1 * t);
+	}
+
+	/**
+	Angle of the rotation between the two, it is accurate for small angles
+	unlike the acos of their dot product.
+	*/
+	auto getRotationError(const glm::quat& a, const glm::quat& b) noexcept -> float {
+		const auto difference = glm::conjugate(a) * b;
+		const auto sine = std::sqrt(difference.x * difference.x + difference.y * difference.y + difference.z * difference.z);
+		return 2.0f * std::atan2(sine, std::fabs(difference.w));
+	}
+
+	/**
+	Keeps the keys of a looping track, samples[frame_count] is samples[0]
+	again. A track within the threshold of its first sample has a single key,
+	otherwise every key is extended as far as the frames between it and the
+	previous one can be interpolated from their quantized values.
+
+	@return The frames of the keys
+	*/
+	template<typename Sample, typename Quantize, typename Error, typename Interpolate>
+	auto reduceKeys(
+		const std::vector<Sample>& samples,
+		float threshold,
+		Quantize&& quantize,
+		Error&& error,
+		Interpolate&& interpolate) -> std::vector<uint16_t> {
+
+		const auto last = samples.size() - 1;
+
+		const auto first = quantize(samples[0]);
+		const auto constant = std::all_of(samples.begin(), samples.end(), [&](const Sample& sample) {
+			return error(first, sample) <= threshold;
+		});
+		if (constant) {
+			return { 0 };
+		}
+
+		auto fits = [&](size_t begin, size_t end) {
+			const auto sample_0 = quantize(samples[begin]);
+			const auto sample_1 = quantize(samples[end]);
+			for (auto frame = begin + 1; frame < end; ++frame) {
+				const auto t = gsl::narrow_cast<float>(frame - begin) / (end - begin);
+				if (error(interpolate(sample_0, sample_1, t), samples[frame]) > threshold) {
+					return false;
+				}
+			}
+			return true;
+		};
+
+		auto frames = std::vector<uint16_t>{ 0 };
+		auto begin = size_t{ 0 };
+		while (begin < last) {
+			auto end = begin + 1;
+			while (end < last && fits(begin, end + 1)) {
+				++end;
+			}
+			frames.push_back(gsl::narrow_cast<uint16_t>(end));
+			begin = end;
+		}
+		return frames;
+	}
+
+	/**
+	Distance from every bone to the farthest vertex that it or its descendants
+	move in the reference pose, 0 for the bones that move no vertex.
+	*/
+	auto computeBoneReaches(const SkinnedMesh& mesh) -> std::vector<float> {
+		const auto& skeleton = mesh.skeleton;
+		const auto bone_count = skeleton.boneCount();
+
+		auto positions = std::vector<glm::vec3>(bone_count);
+		for (auto bone = size_t{ 0 }; bone < bone_count; ++bone) {
+			positions[bone] = glm::vec3(glm::inverse(skeleton.inverse_bind[bone])[3]);
+		}
+
+		auto reaches = std::vector<float>(bone_count, 0.0f);
+		for (auto vertex = size_t{ 0 }; vertex < mesh.vertices.size(); ++vertex) {
+			const auto& position = mesh.vertices[vertex].pos;
+			const auto& weights = mesh.weights[vertex];
+
+			for (auto influence = size_t{ 0 }; influence < max_bone_influences; ++influence) {
+				if (weights.weights[influence] <= 0.0f) {
+					break;
+				}
+				for (auto bone = int32_t{ weights.bones[influence] }; bone >= 0; bone = skeleton.parents[bone]) {
+					reaches[bone] = std::max(reaches[bone], glm::length(position - positions[bone]));
+				}
+			}
+		}
+		return reaches;
+	}
+
+	/**
+	Largest distance between the vertices skinned with the raw poses and with
+	the cooked ones, in every frame of the clip.
+	*/
+	auto measureSkinError(const SkinnedMesh& mesh, const AnimationClip& clip, const CookedClip& cooked) -> float {
+		const auto bone_count = mesh.skeleton.boneCount();
+
+		auto raw_pose = std::vector<BonePose>(bone_count);
+		auto cooked_pose = std::vector<BonePose>{};
+		auto sampler = CookedClipSampler(cooked);
+		auto raw_palette = std::vector<glm::mat4>(bone_count);
+		auto cooked_palette = std::vector<glm::mat4>(bone_count);
+		auto raw_vertices = std::vector<Vertex>(mesh.vertices.size());
+		auto cooked_vertices = std::vector<Vertex>(mesh.vertices.size());
+		const auto kernel = getBestSkinningKernel();
+
+		auto max_error = 0.0f;
+		for (auto frame = uint32_t{ 0 }; frame < clip.frame_count; ++frame) {
+			std::copy_n(clip.poses.begin() + size_t{ frame } * bone_count, bone_count, raw_pose.begin());
+			sampler.sample(frame / cooked.frame_rate, cooked_pose);
+
+			computeSkinningPalette(mesh.skeleton, raw_pose, raw_palette.data());
+			computeSkinningPalette(mesh.skeleton, cooked_pose, cooked_palette.data());
+			skinVertices(mesh, raw_palette.data(), raw_vertices.data(), 0, raw_vertices.size(), kernel);
+			skinVertices(mesh, cooked_palette.data(), cooked_vertices.data(), 0, cooked_vertices.size(), kernel);
+
+			for (auto vertex = size_t{ 0 }; vertex < raw_vertices.size(); ++vertex) {
+				max_error = std::max(max_error, glm::length(raw_vertices[vertex].pos - cooked_vertices[vertex].pos));
+			}
+		}
+		return max_error;
+	}
+
+	/**
+	Reduces and quantizes the tracks of every bone so each of them alone moves
+	the vertices at most the tolerance.
+	*/
+	auto cookTracks(const AnimationClip& clip, const std::vector<float>& reaches, float tolerance) -> CookedClip {
+		const auto bone_count = reaches.size();
+
+		auto cooked = CookedClip{};
+		cooked.frame_rate = clip.frame_rate;
+		cooked.frame_count = clip.frame_count;
+		cooked.bone_count = gsl::narrow<uint32_t>(bone_count);
+		cooked.rotation_offsets.reserve(bone_count + 1);
+		cooked.translation_offsets.reserve(bone_count + 1);
+		cooked.translation_minimums.reserve(bone_count);
+		cooked.translation_extents.reserve(bone_count);
+
+		/*
+		The samples of a track, with the first frame again at the end
+		*/
+		auto rotations = std::vector<glm::quat>(size_t{ clip.frame_count } + 1);
+		auto translations = std::vector<glm::vec3>(size_t{ clip.frame_count } + 1);
+
+		for (auto bone = size_t{ 0 }; bone < bone_count; ++bone) {
+			for (auto frame = size_t{ 0 }; frame < rotations.size(); ++frame) {
+				const auto& pose = clip.poses[(frame % clip.frame_count) * bone_count + bone];
+				rotations[frame] = pose.rotation;
+				translations[frame] = pose.translation;
+			}
+
+			/*
+			A bone that moves no vertex may have any pose
+			*/
+			const auto rotation_threshold = reaches[bone] > 0.0f ? tolerance / reaches[bone] : std::numeric_limits<float>::max();
+			const auto translation_threshold = reaches[bone] > 0.0f ? tolerance : std::numeric_limits<float>::max();
+
+			const auto rotation_frames = reduceKeys(
+				rotations,
+				rotation_threshold,
+				[](const glm::quat& rotation) { return unpackRotation(packRotation(rotation)); },
+				getRotationError,
+				interpolateRotation);
+
+			cooked.rotation_offsets.push_back(gsl::narrow<uint32_t>(cooked.rotation_keys.size()));
+			for (const auto frame : rotation_frames) {
+				cooked.rotation_frames.push_back(frame);
+				cooked.rotation_keys.push_back(packRotation(rotations[frame]));
+			}
+
+			auto minimum = translations[0];
+			auto maximum = translations[0];
+			for (const auto& translation : translations) {
+				minimum = glm::min(minimum, translation);
+				maximum = glm::max(maximum, translation);
+			}
+			const auto extent = maximum - minimum;
+
+			const auto translation_frames = reduceKeys(
+				translations,
+				translation_threshold,
+				[&](const glm::vec3& translation) { return unpackTranslation(packTranslation(translation, minimum, extent), minimum, extent); },
+				[](const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b); },
+				[](const glm::vec3& a, const glm::vec3& b, float t) { return a + (b - a) * t; });
+
+			cooked.translation_offsets.push_back(gsl::narrow<uint32_t>(cooked.translation_keys.size()));
+			cooked.translation_minimums.push_back(minimum);
+			cooked.translation_extents.push_back(extent);
+			for (const auto frame : translation_frames) {
+				cooked.translation_frames.push_back(frame);
+				cooked.translation_keys.push_back(packTranslation(translations[frame], minimum, extent));
+			}
+
+			cooked.statistics.constant_tracks += (rotation_frames.size() == 1 ? 1 : 0) + (translation_frames.size() == 1 ? 1 : 0);
+		}
+		cooked.rotation_offsets.push_back(gsl::narrow<uint32_t>(cooked.rotation_keys.size()));
+		cooked.translation_offsets.push_back(gsl::narrow<uint32_t>(cooked.translation_keys.size()));
+
+		return cooked;
+	}
+}
+
+auto cookAnimationClip(const SkinnedMesh& mesh, const AnimationClip& clip, float skin_error) -> CookedClip {
+
+	const auto bone_count = mesh.skeleton.boneCount();
+	if (clip.frame_count == 0 || clip.poses.size() != size_t{ clip.frame_count } * bone_count) {
+		throw std::runtime_error("We couldn't cook the animation clip, it is empty or its bones are not the ones of the skeleton");
+	}
+	if (clip.frame_count > std::numeric_limits<uint16_t>::max()) {
+		throw std::runtime_error("We couldn't cook the animation clip, it has more than 65535 frames");
+	}
+
+	/*
+	The errors of the bones of a chain add up, so the tolerance of the tracks
+	is halved until the error measured on the skin is within the one asked.
+	*/
+	const auto reaches = computeBoneReaches(mesh);
+	auto tolerance = skin_error;
+	auto cooked = cookTracks(clip, reaches, tolerance);
+	auto max_skin_error = measureSkinError(mesh, clip, cooked);
+	for (auto pass = 1u; pass < max_cooking_passes && max_skin_error > skin_error; ++pass) {
+		tolerance *= 0.5f;
+		cooked = cookTracks(clip, reaches, tolerance);
+		max_skin_error = measureSkinError(mesh, clip, cooked);
+	}
+
+	cooked.statistics.raw_bytes = clip.poses.size() * sizeof(BonePose);
+	cooked.statistics.cooked_bytes = getCookedClipSize(cooked);
+	cooked.statistics.raw_keys = clip.poses.size();
+	cooked.statistics.rotation_keys = cooked.rotation_keys.size();
+	cooked.statistics.translation_keys = cooked.translation_keys.size();
+	cooked.statistics.max_skin_error = max_skin_error;
+
+	return cooked;
+}
+
+CookedClipSampler::CookedClipSampler(const CookedClip& clip) : m_clip(&clip) {
+	for (auto segments : { &m_rotations, &m_translations }) {
+		segments->key.assign(clip.bone_count, 0);
+		segments->begin.assign(clip.bone_count, 0.0f);
+		segments->end.assign(clip.bone_count, 0.0f);
+		segments->inverse_length.assign(clip.bone_count, 0.0f);
+		for (auto component = size_t{ 0 }; component < 4; ++component) {
+			segments->start[component].assign(clip.bone_count, 0.0f);
+			segments->delta[component].assign(clip.bone_count, 0.0f);
+		}
+	}
+}
+
+auto CookedClipSampler::sample(float time, std::vector<BonePose>& pose) -> void {
+
+	const auto& clip = *m_clip;
+	pose.resize(clip.bone_count);
+
+	auto position = std::fmod(time * clip.frame_rate, gsl::narrow_cast<float>(clip.frame_count));
+	if (position < 0.0f) {
+		position += clip.frame_count;
+	}
+
+	for (auto bone = uint32_t{ 0 }; bone < clip.bone_count; ++bone) {
+		if (position < m_rotations.begin[bone] || position >= m_rotations.end[bone]) {
+			decodeRotation(bone, position);
+		}
+		if (position < m_translations.begin[bone] || position >= m_translations.end[bone]) {
+			decodeTranslation(bone, position);
+		}
+	}
+
+	[[gsl::suppress(bounds.4)]]{
+	const auto* begin = m_rotations.begin.data();
+	const auto* inverse_length = m_rotations.inverse_length.data();
+	for (auto bone = uint32_t{ 0 }; bone < clip.bone_count; ++bone) {
+		const auto t = (position - begin[bone]) * inverse_length[bone];
+		const auto x = m_rotations.start[0][bone] + m_rotations.delta[0][bone] * t;
+		const auto y = m_rotations.start[1][bone] + m_rotations.delta[1][bone] * t;
+		const auto z = m_rotations.start[2][bone] + m_rotations.delta[2][bone] * t;
+		const auto w = m_rotations.start[3][bone] + m_rotations.delta[3][bone] * t;
+		const auto inverse_norm = 1.0f / std::sqrt(x * x + y * y + z * z + w * w);
+		pose[bone].rotation = glm::quat(w * inverse_norm, x * inverse_norm, y * inverse_norm, z * inverse_norm);
+	}
+
+	begin = m_translations.begin.data();
+	inverse_length = m_translations.inverse_length.data();
+	for (auto bone = uint32_t{ 0 }; bone < clip.bone_count; ++bone) {
+		const auto t = (position - begin[bone]) * inverse_length[bone];
+		pose[bone].translation = glm::vec3(
+			m_translations.start[0][bone] + m_translations.delta[0][bone] * t,
+			m_translations.start[1][bone] + m_translations.delta[1][bone] * t,
+			m_translations.start[2][bone] + m_translations.delta[2][bone] * t);
+	}
+	}
+}
+
+auto CookedClipSampler::findSegment(
+	const std::vector<uint16_t>& frames,
+	uint32_t begin,
+	uint32_t end,
+	float position,
+	Segments& segments,
+	uint32_t bone) const noexcept -> uint32_t {
+
+	/*
+	A constant track covers every frame
+	*/
+	if (end - begin == 1) {
+		segments.begin[bone] = 0.0f;
+		segments.end[bone] = std::numeric_limits<float>::max();
+		segments.inverse_length[bone] = 0.0f;
+		return begin;
+	}
+
+	/*
+	Playing forward the frame is usually in the segment after the previous
+	one. The last key of the track is past any frame.
+	*/
+	const auto frame = std::min(gsl::narrow_cast<uint16_t>(position), gsl::narrow_cast<uint16_t>(m_clip->frame_count - 1));
+	auto key = segments.key[bone] + 1;
+	if (key < begin || key + 1 >= end || frame < frames[key] || frame >= frames[key + 1]) {
+		const auto next = std::upper_bound(frames.begin() + begin, frames.begin() + end, frame) - frames.begin();
+		key = gsl::narrow_cast<uint32_t>(next - 1);
+	}
+
+	segments.key[bone] = key;
+	segments.begin[bone] = frames[key];
+	segments.end[bone] = frames[key + 1];
+	segments.inverse_length[bone] = 1.0f / (frames[key + 1] - frames[key]);
+	return key;
+}
+
+auto CookedClipSampler::decodeRotation(uint32_t bone, float position) noexcept -> void {
+	const auto& clip = *m_clip;
+	const auto begin = clip.rotation_offsets[bone];
+	const auto end = clip.rotation_offsets[bone + 1];
+	const auto key = findSegment(clip.rotation_frames, begin, end, position, m_rotations, bone);
+
+	const auto rotation_0 = unpackRotation(clip.rotation_keys[key]);
+	auto rotation_1 = end - begin == 1 ? rotation_0 : unpackRotation(clip.rotation_keys[key + 1]);
+	if (glm::dot(rotation_0, rotation_1) < 0.0f) {
+		rotation_1 = -rotation_1;
+	}
+
+	const auto components_0 = std::array<float, 4>{ rotation_0.x, rotation_0.y, rotation_0.z, rotation_0.w };
+	const auto components_1 = std::array<float, 4>{ rotation_1.x, rotation_1.y, rotation_1.z, rotation_1.w };
+	for (auto component = size_t{ 0 }; component < 4; ++component) {
+		m_rotations.start[component][bone] = components_0[component];
+		m_rotations.delta[component][bone] = components_1[component] - components_0[component];
+	}
+}
+
+auto CookedClipSampler::decodeTranslation(uint32_t bone, float position) noexcept -> void {
+	const auto& clip = *m_clip;
+	const auto begin = clip.translation_offsets[bone];
+	const auto end = clip.translation_offsets[bone + 1];
+	const auto key = findSegment(clip.translation_frames, begin, end, position, m_translations, bone);
+
+	const auto& minimum = clip.translation_minimums[bone];
+	const auto& extent = clip.translation_extents[bone];
+	const auto translation_0 = unpackTranslation(clip.translation_keys[key], minimum, extent);
+	const auto translation_1 = end - begin == 1 ? translation_0 : unpackTranslation(clip.translation_keys[key + 1], minimum, extent);
+
+	for (auto component = 0; component < 3; ++component) {
+		m_translations.start[component][bone] = translation_0[component];
+		m_translations.delta[component][bone] = translation_1[component] - translation_0[component];
+	}
+}
+
+auto getCookedClipSize(const CookedClip& clip) noexcept -> size_t {
+	return
+		clip.rotation_offsets.size() * sizeof(uint32_t) +
+		clip.rotation_frames.size() * sizeof(uint16_t) +
+		clip.rotation_keys.size() * sizeof(std::array<uint16_t, 3>) +
+		clip.translation_offsets.size() * sizeof(uint32_t) +
+		clip.translation_frames.size() * sizeof(uint16_t) +
+		clip.translation_keys.size() * sizeof(std::array<uint16_t, 3>) +
+		clip.translation_minimums.size() * sizeof(glm::vec3) +
+		clip.translation_extents.size() * sizeof(glm::vec3);
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#include "Skinning.h"
+
+/*
+Compressed animation clips.
+
+A raw AnimationClip keeps the translation and rotation of every bone in every
+frame (28 bytes per bone and frame), most of it repeated: bones that don't
+move, or that move smoothly enough to be interpolated between a few frames.
+The cooker turns every bone of a clip into two tracks, its rotation and its
+translation, and for each of them:
+
+	- Keeps only the keyframes needed to interpolate the rest within the error
+	  threshold of the track. A track that never moves keeps a single key.
+	- Quantizes the keys. Rotations are stored as their three smallest
+	  components in 15 bits each, the largest one is rebuilt from them and
+	  its index goes in the spare bits (6 bytes per key). Translations are
+	  16 bits per component relative to the range of the track.
+
+The error is measured on the skin: every track gets its own threshold so the
+vertices it moves are displaced at most a tolerance. A rotation moves a vertex
+by the angle times its distance to the bone, so the rotation threshold of a
+bone is the tolerance over the reach of the bone (the farthest vertex that it
+or its descendants move) and bones that move no vertex keep a single key. The
+errors of the bones of a chain add up, so the clip is skinned with the raw and
+the cooked poses in every frame and, while the vertices are further apart
+than skin_error, cooked again with half the tolerance. The statistics have the
+error of the last try.
+
+The keys of all the tracks are in a few contiguous streams, the tracks in the
+order of the bones. CookedClipSampler keeps the two keys around the current
+time of every track decoded in arrays of floats, one per component, so only
+the tracks that cross a key are decoded and the pose of all the bones is a
+single sweep over those arrays. The clip loops, the frame after the last one
+is the first.
+*/
+
+/**
+Information about how much a clip was compressed
+*/
+struct AnimationCookingStatistics {
+	size_t raw_bytes{};				// Poses of the AnimationClip
+	size_t cooked_bytes{};			// Keys, frames and ranges of the CookedClip
+	size_t raw_keys{};				// Frames times bones
+	size_t rotation_keys{};
+	size_t translation_keys{};
+	size_t constant_tracks{};		// Tracks with a single key, of both kinds
+	float max_skin_error{};			// Largest displacement of a vertex in any frame, in model units
+};
+
+struct CookedClip {
+	float frame_rate{ 30.0f };
+	uint32_t frame_count{};
+	uint32_t bone_count{};
+
+	/*
+	The keys of the bone i are [offsets[i], offsets[i + 1]), with the frames
+	of the keys in increasing order. The last key of a track with more than
+	one is at frame_count, the first frame again.
+	*/
+	std::vector<uint32_t> rotation_offsets{};
+	std::vector<uint16_t> rotation_frames{};
+	std::vector<std::array<uint16_t, 3>> rotation_keys{};		// Smallest three components
+
+	std::vector<uint32_t> translation_offsets{};
+	std::vector<uint16_t> translation_frames{};
+	std::vector<std::array<uint16_t, 3>> translation_keys{};	// Relative to the range of the bone
+	std::vector<glm::vec3> translation_minimums{};				// One per bone
+	std::vector<glm::vec3> translation_extents{};				// One per bone
+
+	AnimationCookingStatistics statistics{};
+
+	auto duration() const noexcept -> float { return frame_count / frame_rate; }
+};
+
+/**
+Compresses a clip of a skinned mesh.
+
+@param The mesh, its vertices and weights give the reach of every bone
+@param The clip, with the bones of the skeleton of the mesh
+@param The largest displacement of a vertex, in model units
+@return The cooked clip with its statistics
+@throws std::runtime_error if the clip is empty, doesn't match the skeleton or has more than 65535 frames
+*/
+auto cookAnimationClip(const SkinnedMesh& mesh, const AnimationClip& clip, float skin_error) -> CookedClip;
+
+/**
+Samples a looping cooked clip, interpolating between the keys around the time.
+Every character playing the clip needs its own sampler, it is fastest when the
+time moves forward a bit every sample. The decoded segments take 96 bytes per
+bone. The clip must outlive the sampler.
+*/
+class CookedClipSampler {
+public:
+	CookedClipSampler() = default;
+	explicit CookedClipSampler(const CookedClip& clip);
+
+	/**
+	@param The time in seconds, it wraps around the duration of the clip
+	@param Where to write the pose, one per bone
+	*/
+	auto sample(float time, std::vector<BonePose>& pose) -> void;
+
+private:
+
+	/*
+	The interpolation of every track between its keys, the value at a frame
+	in [begin, end) is start + delta * (frame - begin) * inverse_length.
+	Rotations use the four components, translations the first three.
+	*/
+	struct Segments {
+		std::vector<uint32_t> key{};	// Index of the key at begin
+		std::vector<float> begin{};
+		std::vector<float> end{};
+		std::vector<float> inverse_length{};
+		std::array<std::vector<float>, 4> start{};
+		std::array<std::vector<float>, 4> delta{};
+	};
+
+	/**
+	Finds the key of the track of the bone before the position and sets the
+	frames of its segment.
+
+	@return The index of the key
+	*/
+	auto findSegment(
+		const std::vector<uint16_t>& frames,
+		uint32_t begin,
+		uint32_t end,
+		float position,
+		Segments& segments,
+		uint32_t bone) const noexcept -> uint32_t;
+
+	auto decodeRotation(uint32_t bone, float position) noexcept -> void;
+
+	auto decodeTranslation(uint32_t bone, float position) noexcept -> void;
+
+	const CookedClip* m_clip{ nullptr };
+
+	Segments m_rotations{};
+	Segments m_translations{};
+};
+
+/**
+@return The bytes of the keys, frames and ranges of the clip
+*/
+auto getCookedClipSize(const CookedClip& clip) noexcept -> size_t;
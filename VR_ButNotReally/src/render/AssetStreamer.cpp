@@ -0,0 +1,842 @@
+#include "AssetStreamer.h"
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+
+#include "MeshLoader.h"
+#include "TextureAtlas.h"
+#include "StagingDecoder.h"
+#include "MipBlit.h"
+
+#pragma warning(push)
+#include <CppCoreCheck/Warnings.h>
+#pragma warning(disable: ALL_CPPCORECHECK_WARNINGS)
+#include <stb_image.h>
+#pragma warning(pop)
+
+AssetStreamer::AssetStreamer(const AssetStreamerContext& context, size_t thread_count) : m_context(context) {
+
+	std::cout << "Creating Asset Streamer" << std::endl;
+
+	if (m_context.thread_pool == nullptr) {
+		throw std::runtime_error("We can't stream meshes without a thread pool to parse them");
+	}
+
+	if (m_context.command_buffers == nullptr) {
+		throw std::runtime_error("We can't stream assets without the command buffers of the transfer queue");
+	}
+
+	if (m_context.geometry_pool == nullptr || !m_context.compact_geometry) {
+		throw std::runtime_error("We can't stream meshes without a geometry pool to upload them into");
+	}
+
+	m_staging_ring = std::make_unique<StagingRing>(m_context.allocator, config::streaming_staging_ring_size);
+
+	m_workers = std::make_unique<ThreadPool>(thread_count);
+
+	std::cout << "\tAsset Streamer Created with " << m_workers->getThreadCount() << " workers and a "
+		<< m_staging_ring->getCapacity() / 1024 << " KiB staging ring" << std::endl << std::endl;
+}
+
+AssetStreamer::~AssetStreamer() {
+
+	/*
+	The workers skip the requests they haven't started, we wait for the rest
+	*/
+	m_stopping = true;
+	{
+		/*
+		A worker waiting for staging memory checks m_stopping under the lock,
+		taking it makes sure it sees the flag or gets the notification
+		*/
+		auto lock = std::unique_lock<std::mutex>(m_staging_mutex);
+	}
+	m_staging_released.notify_all();
+	m_workers.reset();
+
+	for (const auto handle : m_uploading) {
+		m_context.command_buffers->wait(m_assets.at(handle)->ticket);
+	}
+
+	for (auto& asset : m_assets) {
+		releaseAsset(*asset);
+	}
+}
+
+auto AssetStreamer::requestMesh(const std::string& path) -> AssetHandle {
+	return request(AssetType::mesh, path);
+}
+
+auto AssetStreamer::requestTexture(const std::string& path) -> AssetHandle {
+	return request(AssetType::texture, path);
+}
+
+auto AssetStreamer::requestTexture(const std::vector<std::string>& paths) -> AssetHandle {
+	if (paths.size() == 1) {
+		return requestTexture(paths.front());
+	}
+	return request(AssetType::texture, paths.front(), paths);
+}
+
+auto AssetStreamer::request(AssetType type, const std::string& path, std::vector<std::string> layer_paths) -> AssetHandle {
+
+	const auto handle = gsl::narrow<AssetHandle>(m_assets.size());
+
+	auto asset = std::make_unique<Asset>();
+	asset->type = type;
+	asset->path = path;
+	asset->layer_paths = std::move(layer_paths);
+	asset->request_time = std::chrono::high_resolution_clock::now();
+
+	auto& queued_asset = *asset;
+	m_assets.push_back(std::move(asset));
+
+	m_workers->enqueue([this, handle, &queued_asset]() { decode(handle, queued_asset); });
+
+	std::cout << "Streaming [" << path << "]";
+	if (queued_asset.layer_paths.size() > 1) {
+		std::cout << " and " << queued_asset.layer_paths.size() - 1 << " more layers";
+	}
+	std::cout << std::endl;
+
+	return handle;
+}
+
+auto AssetStreamer::poll() -> std::vector<AssetHandle> {
+
+	auto finished = std::vector<AssetHandle>{};
+
+	/*
+	Uploads done by the GPU, their staging memory is not needed anymore
+	*/
+	auto still_uploading = std::vector<AssetHandle>{};
+	for (const auto handle : m_uploading) {
+		auto& asset = *m_assets.at(handle);
+
+		if (!m_context.command_buffers->isComplete(asset.ticket)) {
+			still_uploading.push_back(handle);
+			continue;
+		}
+		asset.ticket = 0;
+
+		releaseStaging(asset);
+		asset.state = AssetState::ready;
+
+		const auto total_milliseconds = std::chrono::duration<double, std::milli>(
+			std::chrono::high_resolution_clock::now() - asset.request_time).count();
+		std::cout << "Asset [" << asset.path << "] streamed in " << total_milliseconds << " ms ("
+			<< asset.decode_milliseconds << " ms decoding, " << asset.upload_bytes << " bytes uploaded)" << std::endl << std::endl;
+
+		finished.push_back(handle);
+	}
+	m_uploading.swap(still_uploading);
+
+	/*
+	Decoded assets, we upload them in order until we run out of budget
+	*/
+	auto decoded = std::vector<AssetHandle>{};
+	{
+		auto lock = std::unique_lock<std::mutex>(m_decoded_mutex);
+		decoded.swap(m_decoded);
+	}
+
+	auto uploaded_bytes = VkDeviceSize{ 0 };
+	auto next = decoded.begin();
+	for (; next != decoded.end(); ++next) {
+		auto& asset = *m_assets.at(*next);
+
+		if (!asset.error.empty()) {
+			std::cerr << "We couldn't stream the asset [" << asset.path << "]: " << asset.error << std::endl;
+			asset.state = AssetState::failed;
+			finished.push_back(*next);
+			continue;
+		}
+
+		if (uploaded_bytes > 0 && uploaded_bytes + asset.upload_bytes > config::streaming_upload_budget) {
+			break;
+		}
+
+		if (asset.type == AssetType::mesh) {
+			auto allocated = false;
+			try {
+				allocated = allocateGeometry(asset);
+			}
+			catch (const std::exception& exception) {
+				std::cerr << "We couldn't stream the asset [" << asset.path << "]: " << exception.what() << std::endl;
+				releaseAsset(asset);
+				asset.state = AssetState::failed;
+				finished.push_back(*next);
+				continue;
+			}
+
+			if (!allocated) {
+				break;
+			}
+		}
+
+		submitUpload(asset);
+		uploaded_bytes += asset.upload_bytes;
+		asset.state = AssetState::uploading;
+		m_uploading.push_back(*next);
+	}
+
+	/*
+	The ones left go before the ones decoded meanwhile so they keep their order
+	*/
+	if (next != decoded.end()) {
+		auto lock = std::unique_lock<std::mutex>(m_decoded_mutex);
+		m_decoded.insert(m_decoded.begin(), next, decoded.end());
+	}
+
+	return finished;
+}
+
+auto AssetStreamer::getState(AssetHandle handle) const -> AssetState {
+	return m_assets.at(handle)->state;
+}
+
+auto AssetStreamer::takeMesh(AssetHandle handle) -> StreamedMesh {
+
+	auto& asset = *m_assets.at(handle);
+	if (asset.type != AssetType::mesh || asset.state != AssetState::ready) {
+		throw std::runtime_error("We can't take an asset that is not a ready mesh");
+	}
+
+	auto mesh = std::move(asset.mesh);
+	asset.mesh = StreamedMesh{};
+	return mesh;
+}
+
+auto AssetStreamer::takeTexture(AssetHandle handle) -> StreamedTexture {
+
+	auto& asset = *m_assets.at(handle);
+	if (asset.type != AssetType::texture || asset.state != AssetState::ready) {
+		throw std::runtime_error("We can't take an asset that is not a ready texture");
+	}
+
+	const auto texture = asset.texture;
+	asset.texture = StreamedTexture{};
+	return texture;
+}
+
+auto AssetStreamer::getPendingCount() const noexcept -> size_t {
+	return gsl::narrow_cast<size_t>(std::count_if(m_assets.begin(), m_assets.end(), [](const std::unique_ptr<Asset>& asset) noexcept {
+		return asset->state == AssetState::loading || asset->state == AssetState::uploading;
+	}));
+}
+
+auto AssetStreamer::decode(AssetHandle handle, Asset& asset) -> void {
+
+	if (m_stopping) {
+		return;
+	}
+
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	try {
+		switch (asset.type) {
+		case AssetType::mesh: {
+			decodeMesh(asset);
+			break;
+		}
+		case AssetType::texture: {
+			decodeTexture(asset);
+			break;
+		}
+		}
+	}
+	catch (const std::exception& exception) {
+		asset.error = exception.what();
+		releaseAsset(asset);
+	}
+
+	asset.decode_milliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::high_resolution_clock::now() - start).count();
+
+	auto lock = std::unique_lock<std::mutex>(m_decoded_mutex);
+	m_decoded.push_back(handle);
+}
+
+auto AssetStreamer::decodeMesh(Asset& asset) -> void {
+
+	auto& scene = asset.mesh.scene;
+	loadMesh(asset.path, scene, *m_context.thread_pool);
+
+	if (scene.vertexCount() == 0 || scene.indexCount() == 0) {
+		throw std::runtime_error("The mesh is empty");
+	}
+	if (!setIndexType(scene, m_context.index_type)) {
+		throw std::runtime_error("The mesh needs bigger indices than the ones we upload");
+	}
+
+	asset.vertex_bytes = VkDeviceSize{ getVertexStride(m_context.vertex_format) * scene.vertexCount() };
+	const auto index_bytes = VkDeviceSize{ getIndexSize(scene.index_type) * scene.indexCount() };
+	asset.upload_bytes = asset.vertex_bytes + index_bytes;
+
+	/*
+	One staging range with the vertices followed by the indices, both
+	written straight in their final format.
+	*/
+	stageUpload(asset);
+
+	[[gsl::suppress(type.1)]]{
+	const auto staging_data = reinterpret_cast<char*>(asset.staging.data);
+	writeVertexBufferData(scene, m_context.vertex_format, staging_data);
+	[[gsl::suppress(bounds.1)]]{
+	writeIndexBufferData(scene, staging_data + asset.vertex_bytes);
+	}
+	}
+
+}
+
+auto AssetStreamer::decodeTexture(Asset& asset) -> void {
+
+	if (!asset.layer_paths.empty()) {
+		decodeTextureArray(asset);
+		return;
+	}
+
+	if (m_context.cooked_textures && decodeCookedTexture(asset)) {
+		return;
+	}
+
+	if (m_context.texture_cache) {
+		decodeCachedTexture(asset);
+		return;
+	}
+
+	/*
+	The texture is decoded straight into the staging buffer, see StagingDecoder.h
+	*/
+	auto source = MappedFile{};
+	if (!source.open(asset.path)) {
+		throw std::runtime_error("We couldn't read the texture [" + asset.path + "]");
+	}
+
+	if (!readTextureSize(source, asset.texture.width, asset.texture.height)) {
+		throw std::runtime_error(std::string{ "Couldn't load provided texture image: " } + stbi_failure_reason());
+	}
+	asset.texture.mip_levels = config::mipmaps_enabled ?
+		getMipLevelCount(asset.texture.width, asset.texture.height) : 1;
+
+	/*
+	Without blits the worker builds the whole chain, so the upload only copies it
+	*/
+	const auto cpu_mip_chain = asset.texture.mip_levels > 1 && !m_context.blit_mipmaps;
+	asset.mip_chain_levels = getMipChainLevels(asset.texture.width, asset.texture.height, cpu_mip_chain ? asset.texture.mip_levels : 1);
+	asset.upload_bytes = getMipChainSize(asset.mip_chain_levels);
+
+	/*
+	The spare byte lets the JPEG decoder write into the staging memory too
+	*/
+	stageUpload(asset, 1);
+	decodeTextureInto(source, asset.path, asset.staging.data, gsl::narrow<size_t>(asset.staging.size), asset.texture.width, asset.texture.height);
+	writeMipChain(asset.staging.data, asset.mip_chain_levels);
+
+	createTextureImage(asset);
+}
+
+auto AssetStreamer::decodeCookedTexture(Asset& asset) -> bool {
+
+	const auto cooked_path = getCookedTexturePath(asset.path);
+	if (!std::ifstream(cooked_path).good()) {
+		return false;
+	}
+
+	auto texture = CookedTexture{};
+	try {
+		texture = readCookedTexture(cooked_path);
+	}
+	catch (const std::exception& exception) {
+		std::cout << "\tWe couldn't use the cooked texture: " << exception.what() << std::endl;
+		return false;
+	}
+
+	asset.texture.format = texture.format;
+	asset.texture.width = texture.width;
+	asset.texture.height = texture.height;
+	asset.texture.mip_levels = gsl::narrow<uint>(texture.levels.size());
+	asset.mip_chain_levels = std::move(texture.levels);
+	asset.upload_bytes = VkDeviceSize{ texture.data.size() };
+
+	stageUpload(asset);
+	memcpy(asset.staging.data, texture.data.data(), texture.data.size());
+
+	createTextureImage(asset);
+	return true;
+}
+
+auto AssetStreamer::decodeCachedTexture(Asset& asset) -> void {
+
+	const auto texture = m_context.texture_cache->decode(asset.path, config::mipmaps_enabled);
+
+	asset.texture.width = texture.width;
+	asset.texture.height = texture.height;
+	asset.texture.mip_levels = gsl::narrow<uint>(texture.levels.size());
+	asset.mip_chain_levels = texture.levels;
+	asset.upload_bytes = VkDeviceSize{ texture.size() };
+
+	stageUpload(asset);
+	memcpy(asset.staging.data, texture.data(), texture.size());
+
+	createTextureImage(asset);
+}
+
+auto AssetStreamer::decodeTextureArray(Asset& asset) -> void {
+
+	const auto texture = config::texture_atlas_enabled ?
+		decodeTextureAtlas(
+			asset.layer_paths,
+			packTextureAtlas(asset.layer_paths, config::texture_atlas_gutter),
+			m_context.texture_cache,
+			config::mipmaps_enabled,
+			m_context.thread_pool) :
+		::decodeTextureArray(asset.layer_paths, m_context.texture_cache, config::mipmaps_enabled, m_context.thread_pool);
+
+	asset.texture.width = texture.width;
+	asset.texture.height = texture.height;
+	asset.texture.mip_levels = gsl::narrow<uint>(texture.levels.size());
+	asset.texture.layers = texture.layer_count;
+	asset.mip_chain_levels = texture.levels;
+	asset.upload_bytes = VkDeviceSize{ texture.pixels.size() };
+
+	stageUpload(asset);
+	memcpy(asset.staging.data, texture.pixels.data(), texture.pixels.size());
+
+	createTextureImage(asset);
+}
+
+auto AssetStreamer::createTextureImage(Asset& asset) -> void {
+
+	const auto blit_mipmaps = asset.mip_chain_levels.size() < asset.texture.mip_levels;
+
+	auto create_info = VkImageCreateInfo{};
+	{
+		create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		create_info.imageType = VK_IMAGE_TYPE_2D;
+		create_info.extent.width = asset.texture.width;
+		create_info.extent.height = asset.texture.height;
+		create_info.extent.depth = 1;
+		create_info.mipLevels = asset.texture.mip_levels;
+		create_info.arrayLayers = asset.texture.layers;
+		create_info.format = asset.texture.format;
+		create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+		create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		create_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+			(blit_mipmaps ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0);
+		create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+		create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	}
+
+	auto vma_create_info = VmaAllocationCreateInfo{};
+	vma_create_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+	if (vmaCreateImage(
+		m_context.allocator,
+		&create_info,
+		&vma_create_info,
+		&asset.texture.image.image,
+		&asset.texture.image.allocation,
+		&asset.texture.image.allocation_info) != VK_SUCCESS) {
+		throw std::runtime_error("We couldn't create a vulkan image to hold the texture image");
+	}
+}
+
+auto AssetStreamer::allocateGeometry(Asset& asset) -> bool {
+
+	auto& pool = *m_context.geometry_pool;
+	const auto vertex_count = gsl::narrow<uint32_t>(asset.mesh.scene.vertexCount());
+	const auto index_count = gsl::narrow<uint32_t>(asset.mesh.scene.indexCount());
+
+	asset.mesh.geometry = pool.allocate(vertex_count, index_count);
+	if (asset.mesh.geometry != invalid_geometry) {
+		return true;
+	}
+
+	if (!pool.fitsAfterCompaction(vertex_count, index_count)) {
+		throw std::runtime_error("The mesh doesn't fit in the geometry pool");
+	}
+
+	/*
+	The compaction would move the ranges still being written or not acquired
+	yet, the mesh waits for them instead
+	*/
+	if (hasPendingGeometry()) {
+		return false;
+	}
+
+	m_context.compact_geometry();
+	asset.mesh.geometry = pool.allocate(vertex_count, index_count);
+	if (asset.mesh.geometry == invalid_geometry) {
+		throw std::runtime_error("The mesh doesn't fit in the geometry pool");
+	}
+	return true;
+}
+
+auto AssetStreamer::hasPendingGeometry() const noexcept -> bool {
+	return std::any_of(m_assets.begin(), m_assets.end(), [](const std::unique_ptr<Asset>& asset) noexcept {
+		return asset->type == AssetType::mesh &&
+			asset->mesh.geometry != invalid_geometry &&
+			(asset->state == AssetState::uploading || asset->state == AssetState::ready);
+	});
+}
+
+auto AssetStreamer::submitUpload(Asset& asset) -> void {
+
+	const auto command_buffer = m_context.command_buffers->begin();
+
+	switch (asset.type) {
+	case AssetType::mesh: {
+		const auto& pool = *m_context.geometry_pool;
+		const auto& range = pool.getRange(asset.mesh.geometry);
+
+		auto vertex_region = VkBufferCopy{};
+		vertex_region.srcOffset = asset.staging.offset;
+		vertex_region.dstOffset = pool.getVertexStride() * range.first_vertex;
+		vertex_region.size = asset.vertex_bytes;
+		vkCmdCopyBuffer(command_buffer, asset.staging.buffer, pool.getVertexBuffer(), 1, &vertex_region);
+
+		auto index_region = VkBufferCopy{};
+		index_region.srcOffset = asset.staging.offset + asset.vertex_bytes;
+		index_region.dstOffset = pool.getIndexSize() * range.first_index;
+		index_region.size = asset.upload_bytes - asset.vertex_bytes;
+		vkCmdCopyBuffer(command_buffer, asset.staging.buffer, pool.getIndexBuffer(), 1, &index_region);
+
+		/*
+		Release of the ranges to the graphics family, recordAcquire() records
+		the other half. In the same family the barrier makes the copies
+		visible to the vertex input of the frames submitted after them.
+		*/
+		auto barriers = getOwnershipBarriers(asset.mesh);
+		for (auto& barrier : barriers) {
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = needsOwnershipTransfer() ? 0 : VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+		}
+
+		vkCmdPipelineBarrier(
+			command_buffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			needsOwnershipTransfer() ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			0,
+			0, nullptr,
+			gsl::narrow_cast<uint>(barriers.size()), barriers.data(),
+			0, nullptr);
+		break;
+	}
+	case AssetType::texture: {
+		recordTextureUpload(command_buffer, asset);
+		break;
+	}
+	}
+
+	asset.ticket = m_context.command_buffers->submit(command_buffer);
+}
+
+auto AssetStreamer::recordTextureUpload(VkCommandBuffer command_buffer, const Asset& asset) noexcept -> void {
+
+	auto barrier = VkImageMemoryBarrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = asset.texture.image.image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = asset.texture.mip_levels;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = asset.texture.layers;
+
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	vkCmdPipelineBarrier(
+		command_buffer,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0,
+		0, nullptr,
+		0, nullptr,
+		1, &barrier);
+
+	auto regions = getMipCopyRegions(
+		asset.mip_chain_levels,
+		asset.texture.layers,
+		asset.upload_bytes / asset.texture.layers);
+	for (auto& region : regions) {
+		region.bufferOffset += asset.staging.offset;
+	}
+
+	vkCmdCopyBufferToImage(
+		command_buffer,
+		asset.staging.buffer,
+		asset.texture.image.image,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		gsl::narrow_cast<uint>(regions.size()),
+		regions.data());
+
+	/*
+	Only the level 0 was uploaded, the rest are blitted from it. The streamer
+	only blits when the transfer family is the graphics one.
+	*/
+	if (asset.mip_chain_levels.size() < asset.texture.mip_levels) {
+		recordMipBlitChain(
+			command_buffer,
+			asset.texture.image.image,
+			asset.texture.width,
+			asset.texture.height,
+			asset.texture.mip_levels,
+			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0,
+			asset.texture.layers);
+		return;
+	}
+
+	/*
+	The transfer queue may not support the fragment shader stage, the fence
+	already orders this upload before the graphics submissions that sample it.
+	With a family of its own the layout transition is also the release of
+	the image to the graphics family, recordAcquire() records the other half.
+	*/
+	barrier = getOwnershipBarrier(asset.texture);
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	vkCmdPipelineBarrier(
+		command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		0,
+		0, nullptr,
+		0, nullptr,
+		1, &barrier);
+}
+
+auto AssetStreamer::recordAcquire(
+	VkCommandBuffer command_buffer,
+	const StreamedMesh& mesh,
+	VkPipelineStageFlags destination_stage,
+	VkAccessFlags destination_access) const -> void {
+
+	if (!needsOwnershipTransfer()) {
+		return;
+	}
+
+	auto barriers = getOwnershipBarriers(mesh);
+	for (auto& barrier : barriers) {
+		barrier.dstAccessMask = destination_access;
+	}
+
+	vkCmdPipelineBarrier(
+		command_buffer,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		destination_stage,
+		0,
+		0, nullptr,
+		gsl::narrow_cast<uint>(barriers.size()), barriers.data(),
+		0, nullptr);
+}
+
+auto AssetStreamer::recordAcquire(
+	VkCommandBuffer command_buffer,
+	const StreamedTexture& texture,
+	VkPipelineStageFlags destination_stage,
+	VkAccessFlags destination_access) const noexcept -> void {
+
+	/*
+	Blitted textures never leave the graphics family
+	*/
+	if (!needsOwnershipTransfer()) {
+		return;
+	}
+
+	auto barrier = getOwnershipBarrier(texture);
+	barrier.dstAccessMask = destination_access;
+
+	vkCmdPipelineBarrier(
+		command_buffer,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		destination_stage,
+		0,
+		0, nullptr,
+		0, nullptr,
+		1, &barrier);
+}
+
+auto AssetStreamer::needsOwnershipTransfer() const noexcept -> bool {
+	return m_context.transfer_family != m_context.graphics_family;
+}
+
+auto AssetStreamer::getOwnershipBarriers(const StreamedMesh& mesh) const -> std::array<VkBufferMemoryBarrier, 2> {
+
+	const auto& pool = *m_context.geometry_pool;
+	const auto& range = pool.getRange(mesh.geometry);
+
+	auto barriers = std::array<VkBufferMemoryBarrier, 2>{};
+	for (auto& barrier : barriers) {
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = needsOwnershipTransfer() ? m_context.transfer_family : VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = needsOwnershipTransfer() ? m_context.graphics_family : VK_QUEUE_FAMILY_IGNORED;
+	}
+
+	barriers.at(0).buffer = pool.getVertexBuffer();
+	barriers.at(0).offset = pool.getVertexStride() * range.first_vertex;
+	barriers.at(0).size = pool.getVertexStride() * range.vertex_count;
+
+	barriers.at(1).buffer = pool.getIndexBuffer();
+	barriers.at(1).offset = pool.getIndexSize() * range.first_index;
+	barriers.at(1).size = pool.getIndexSize() * range.index_count;
+	return barriers;
+}
+
+auto AssetStreamer::getOwnershipBarrier(const StreamedTexture& texture) const noexcept -> VkImageMemoryBarrier {
+
+	auto barrier = VkImageMemoryBarrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcQueueFamilyIndex = needsOwnershipTransfer() ? m_context.transfer_family : VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = needsOwnershipTransfer() ? m_context.graphics_family : VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = texture.image.image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = texture.mip_levels;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = texture.layers;
+	return barrier;
+}
+
+auto AssetStreamer::stageUpload(Asset& asset, VkDeviceSize spare_bytes) -> void {
+
+	const auto staging_bytes = asset.upload_bytes + spare_bytes;
+
+	if (staging_bytes > m_staging_ring->getMaxAllocationSize()) {
+		createBuffer(
+			staging_bytes,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VMA_MEMORY_USAGE_CPU_TO_GPU,
+			VMA_ALLOCATION_CREATE_MAPPED_BIT,
+			asset.staging_buffer,
+			VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+
+		asset.staging.buffer = asset.staging_buffer.buffer;
+		asset.staging.offset = 0;
+		asset.staging.size = staging_bytes;
+		asset.staging.data = static_cast<unsigned char*>(asset.staging_buffer.allocation_info.pMappedData);
+		return;
+	}
+
+	/*
+	poll() releases the ranges as their uploads finish and wakes us up
+	*/
+	auto lock = std::unique_lock<std::mutex>(m_staging_mutex);
+	m_staging_released.wait(lock, [this, &asset, staging_bytes]() {
+		if (m_stopping) {
+			return true;
+		}
+		asset.staging = m_staging_ring->allocate(staging_bytes, m_context.staging_alignment);
+		return asset.staging.data != nullptr;
+	});
+
+	if (asset.staging.data == nullptr) {
+		throw std::runtime_error("The streamer stopped while the asset waited for staging memory");
+	}
+
+	asset.staging_end = m_staging_ring->getHead();
+	m_staging_ranges.push_back(StagingRange{ asset.staging_end, false });
+}
+
+auto AssetStreamer::releaseStaging(Asset& asset) noexcept -> void {
+
+	destroyBuffer(asset.staging_buffer);
+
+	if (asset.staging_end != 0) {
+		{
+			auto lock = std::unique_lock<std::mutex>(m_staging_mutex);
+
+			for (auto& range : m_staging_ranges) {
+				if (range.end == asset.staging_end) {
+					range.released = true;
+				}
+			}
+
+			/*
+			The ring only moves its tail forward, a range done before the ones
+			taken earlier stays in use until they are done too
+			*/
+			while (!m_staging_ranges.empty() && m_staging_ranges.front().released) {
+				m_staging_ring->release(m_staging_ranges.front().end);
+				m_staging_ranges.pop_front();
+			}
+		}
+		m_staging_released.notify_all();
+	}
+
+	asset.staging = StagingAllocation{};
+	asset.staging_end = 0;
+}
+
+auto AssetStreamer::createBuffer(
+	VkDeviceSize size,
+	VkBufferUsageFlags usage,
+	VmaMemoryUsage allocation_usage,
+	VmaAllocationCreateFlags allocation_flags,
+	AllocatedBuffer& buffer,
+	VkMemoryPropertyFlags preferred_properties) -> void {
+
+	auto buffer_create_info = VkBufferCreateInfo{};
+	buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	buffer_create_info.size = size;
+	buffer_create_info.usage = usage;
+	buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	auto allocation_create_info = VmaAllocationCreateInfo{};
+	allocation_create_info.usage = allocation_usage;
+	allocation_create_info.flags = allocation_flags;
+	allocation_create_info.preferredFlags = preferred_properties;
+
+	/*
+	The mapped buffers are never flushed, cached memory has to be coherent too
+	*/
+	if (preferred_properties & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) {
+		allocation_create_info.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	}
+
+	if (vmaCreateBuffer(
+		m_context.allocator,
+		&buffer_create_info,
+		&allocation_create_info,
+		&buffer.buffer,
+		&buffer.allocation,
+		&buffer.allocation_info) != VK_SUCCESS) {
+		throw std::runtime_error("We couldn't create a buffer for a streamed asset");
+	}
+}
+
+auto AssetStreamer::destroyBuffer(AllocatedBuffer& buffer) noexcept -> void {
+	if (buffer.buffer != VK_NULL_HANDLE) {
+		vmaDestroyBuffer(m_context.allocator, buffer.buffer, buffer.allocation);
+	}
+	buffer = AllocatedBuffer{};
+}
+
+auto AssetStreamer::destroyImage(AllocatedImage& image) noexcept -> void {
+	if (image.image != VK_NULL_HANDLE) {
+		vmaDestroyImage(m_context.allocator, image.image, image.allocation);
+	}
+	image = AllocatedImage{};
+}
+
+auto AssetStreamer::releaseAsset(Asset& asset) noexcept -> void {
+
+	releaseStaging(asset);
+	destroyImage(asset.texture.image);
+
+	/*
+	Only the thread of poll() takes ranges, the workers never get here with one
+	*/
+	if (asset.mesh.geometry != invalid_geometry) {
+		m_context.geometry_pool->free(asset.mesh.geometry);
+		asset.mesh.geometry = invalid_geometry;
+	}
+}
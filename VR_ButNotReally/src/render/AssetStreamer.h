@@ -0,0 +1,421 @@
+#pragma once
+#include <array>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <functional>
+#include <cstdint>
+
+#include "RenderData.h"
+#include "MipGenerator.h"
+#include "TextureFile.h"
+#include "TextureCache.h"
+#include "StagingRing.h"
+#include "CommandBufferPool.h"
+#include "GeometryPool.h"
+#include "../utils/ThreadPool.h"
+
+/*
+Background streaming of meshes and textures.
+
+Requests are pushed to a queue served by the worker threads of the streamer,
+they read and decode the files (the whole mesh loading and stb_image for the
+textures), create the final resources and fill the staging memory, so none
+of the slow work happens in the render loop.
+
+The staging memory is taken from a staging ring of the streamer, created
+once, instead of a buffer per asset. A worker that finds the ring full waits
+until poll() releases the ranges of the uploads whose fence is signaled, the
+ranges are released in the order they were taken. Only the assets bigger
+than half the ring get a staging buffer of their own.
+
+Every frame the render loop calls poll(), which records the copies of the
+decoded assets into command buffers of the transfer command buffer pool of
+the renderer and submits them without waiting for them. The assets whose
+submission is complete release their staging memory and are reported as
+ready, then the renderer takes their resources and starts drawing with them.
+
+Vulkan queues must be externally synchronized so the submissions happen in
+poll(), in the same thread as the rest of the submissions of the renderer.
+The resources are exclusive to the transfer family while they are uploaded.
+When the graphics family is another one the uploads end with a release of
+the resources to it, and the renderer records the matching acquire with
+recordAcquire() before its first use of them. The graphics queue only uses
+them after the host has seen the fence of their upload signaled, which
+orders the release before the acquire.
+
+Meshes are copied from the staging memory straight into a range of the
+geometry pool of the renderer, taken when their upload is submitted. The
+arenas belong to the graphics family, the transfer queue writes the range
+without acquiring it (its old contents don't matter) and releases it like
+any other resource. Compacting the pool moves the ranges, so it waits until
+no streamed range is uploading or waiting to be taken: a mesh that needs the
+compaction stays decoded until then.
+*/
+
+using AssetHandle = uint32_t;
+
+constexpr auto invalid_asset = std::numeric_limits<AssetHandle>::max();
+
+enum class AssetType {
+	mesh,
+	texture
+};
+
+/**
+Stages an asset goes through, in order
+*/
+enum class AssetState {
+	loading,	// Waiting for or being decoded by a worker
+	uploading,	// Copies submitted to the transfer queue, waiting for their ticket
+	ready,		// The resources can be used (or have been taken)
+	failed
+};
+
+/**
+Mesh uploaded by the streamer, with the CPU side data used for culling and
+the selection of the level of detail.
+*/
+struct StreamedMesh {
+	SimpleObjScene scene{};		// Its texture members are not used
+	GeometryHandle geometry{ invalid_geometry };	// Range of the geometry pool with the mesh, whoever takes the mesh frees it
+};
+
+/**
+Texture uploaded by the streamer, in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+*/
+struct StreamedTexture {
+	AllocatedImage image{};
+	VkFormat format{ VK_FORMAT_R8G8B8A8_UNORM };
+	uint width{};
+	uint height{};
+	uint mip_levels{ 1 };
+	uint layers{ 1 };
+};
+
+/**
+Vulkan objects and settings the streamer works with, owned by the renderer
+*/
+struct AssetStreamerContext {
+	VkDevice device{};
+	VmaAllocator allocator{};
+	CommandBufferPool* command_buffers{ nullptr };	// Of the transfer queue, the uploads are submitted through it, required
+	uint transfer_family{};
+	uint graphics_family{};	// Takes the resources over once they are uploaded
+	VkDeviceSize staging_alignment{ 16 };	// Of the ranges of the staging ring, valid for the copies to images
+	VertexFormat vertex_format{};
+	VkIndexType index_type{ VK_INDEX_TYPE_UINT32 };	// Of the indices uploaded, a mesh that needs more bits fails to load
+	ThreadPool* thread_pool{ nullptr };	// For the parallel parts of the mesh loading and the layers of the texture arrays, required
+	GeometryPool* geometry_pool{ nullptr };	// The meshes are uploaded into ranges of its arenas, required
+	std::function<void()> compact_geometry{};	// Compacts the geometry pool, required
+	bool blit_mipmaps{ false };		// Textures get their mip chain blitted in the transfer queue instead of built by the workers
+	bool cooked_textures{ false };	// Textures are read from their cooked version when there is one
+	TextureCache* texture_cache{ nullptr };	// Decodes the textures that are not cooked, optional
+};
+
+/**
+Loads meshes and textures in the background and uploads them through the
+transfer queue.
+
+Every function must be called from the thread that submits to the queues.
+*/
+class AssetStreamer {
+public:
+
+	/**
+	Creates the staging ring of the uploads and starts the workers.
+
+	@param The Vulkan objects to create and upload the resources with
+	@param The amount of worker threads decoding assets
+	*/
+	AssetStreamer(const AssetStreamerContext& context, size_t thread_count);
+
+	AssetStreamer(const AssetStreamer&) = delete;
+	AssetStreamer& operator=(const AssetStreamer&) = delete;
+	AssetStreamer(AssetStreamer&&) = delete;
+	AssetStreamer& operator=(AssetStreamer&&) = delete;
+
+	/**
+	Drops the requests not started yet, waits for the ones being decoded and
+	uploaded and destroys every resource that has not been taken.
+	*/
+	~AssetStreamer();
+
+	/**
+	Queues the loading of an .obj model.
+
+	@param The path to the .obj model
+	@return The handle to follow the asset with
+	*/
+	auto requestMesh(const std::string& path) -> AssetHandle;
+
+	/**
+	Queues the loading of a texture, any format stb_image can read. Its
+	cooked version is loaded instead when there is one and the context allows it.
+
+	@param The path to the texture
+	@return The handle to follow the asset with
+	*/
+	auto requestTexture(const std::string& path) -> AssetHandle;
+
+	/**
+	Queues the loading of a texture array with a layer for every texture
+	provided, they must have the same size. When the atlas is enabled they
+	are packed into a single layer instead. A single texture is loaded like
+	the overload above.
+
+	@param The path of the texture of every layer
+	@return The handle to follow the asset with
+	*/
+	auto requestTexture(const std::vector<std::string>& paths) -> AssetHandle;
+
+	/**
+	Finishes the uploads whose submission is complete and submits the uploads
+	of the decoded assets, up to config::streaming_upload_budget bytes (and at
+	least one asset) every call. It only waits for the GPU when every command
+	buffer of the transfer command buffer pool is in flight.
+
+	@return The handles of the assets that became ready (or failed) in this call
+	*/
+	auto poll() -> std::vector<AssetHandle>;
+
+	/**
+	@param The handle of the asset
+	@return The current state of the asset
+	*/
+	auto getState(AssetHandle handle) const -> AssetState;
+
+	/**
+	Moves the resources of a ready mesh out of the streamer, from then on
+	the caller has to destroy them.
+
+	@param The handle of a ready mesh
+	@return The mesh and its buffers
+	*/
+	auto takeMesh(AssetHandle handle) -> StreamedMesh;
+
+	/**
+	Moves the resources of a ready texture out of the streamer, from then on
+	the caller has to destroy them.
+
+	@param The handle of a ready texture
+	@return The texture and its image
+	*/
+	auto takeTexture(AssetHandle handle) -> StreamedTexture;
+
+	/**
+	@return The amount of assets still loading or uploading
+	*/
+	auto getPendingCount() const noexcept -> size_t;
+
+	/**
+	Records the acquire of the buffers of a taken mesh by the graphics family,
+	nothing when the transfer family is the graphics one.
+
+	@param A command buffer of the graphics queue, submitted before any other use of the mesh
+	@param The mesh
+	@param The stages of the first use of the buffers
+	@param The accesses of the first use of the buffers
+	*/
+	auto recordAcquire(
+		VkCommandBuffer command_buffer,
+		const StreamedMesh& mesh,
+		VkPipelineStageFlags destination_stage,
+		VkAccessFlags destination_access) const -> void;
+
+	/**
+	Records the acquire of the image of a taken texture by the graphics family,
+	nothing when the transfer family is the graphics one.
+
+	@param A command buffer of the graphics queue, submitted before any other use of the texture
+	@param The texture
+	@param The stages of the first use of the image
+	@param The accesses of the first use of the image
+	*/
+	auto recordAcquire(
+		VkCommandBuffer command_buffer,
+		const StreamedTexture& texture,
+		VkPipelineStageFlags destination_stage,
+		VkAccessFlags destination_access) const noexcept -> void;
+
+	/**
+	@return true if the resources move from the transfer to the graphics family
+	*/
+	auto needsOwnershipTransfer() const noexcept -> bool;
+
+private:
+
+	struct Asset {
+		AssetType type{};
+		std::string path{};
+		std::vector<std::string> layer_paths{};	// Textures of the layers of a texture array, empty otherwise
+		AssetState state{ AssetState::loading };
+
+		StreamedMesh mesh{};
+		StreamedTexture texture{};
+
+		/*
+		Filled by the worker, read by poll() once the asset is in m_decoded
+		*/
+		StagingAllocation staging{};	// Where the upload is copied from
+		uint64_t staging_end{};			// Position of the ring after the range, 0 when it has a staging buffer of its own
+		AllocatedBuffer staging_buffer{};	// Only for the assets too big for the ring
+		VkDeviceSize upload_bytes{};	// Used bytes of the staging memory
+		VkDeviceSize vertex_bytes{};	// Meshes store the indices right after the vertices
+		std::vector<MipLevel> mip_chain_levels{};	// Texture levels in the staging buffer, only the level 0 when they are blitted
+		std::string error{};
+		double decode_milliseconds{};
+
+		uint64_t ticket{};	// Of the submission of the upload to the transfer command buffer pool
+		std::chrono::high_resolution_clock::time_point request_time{};
+	};
+
+	/**
+	Queues the asset provided and the task that decodes it
+	*/
+	auto request(AssetType type, const std::string& path, std::vector<std::string> layer_paths = {}) -> AssetHandle;
+
+	/**
+	Worker side: decodes the asset and creates and fills its resources, then
+	hands it to poll() through m_decoded.
+	*/
+	auto decode(AssetHandle handle, Asset& asset) -> void;
+
+	auto decodeMesh(Asset& asset) -> void;
+
+	auto decodeTexture(Asset& asset) -> void;
+
+	/**
+	Reads the cooked version of the texture of the asset, if there is one.
+
+	@return true if the texture has been read from its cooked version
+	*/
+	auto decodeCookedTexture(Asset& asset) -> bool;
+
+	/**
+	Reads the texture of the asset through the texture cache, with its whole mip chain
+	*/
+	auto decodeCachedTexture(Asset& asset) -> void;
+
+	/**
+	Reads the textures of the layers of a texture array, with their whole mip
+	chain, or packs them into an atlas when it is enabled
+	*/
+	auto decodeTextureArray(Asset& asset) -> void;
+
+	/**
+	Creates the image of a texture whose levels are in the staging buffer,
+	with the usage the blits need when only the level 0 is there.
+	*/
+	auto createTextureImage(Asset& asset) -> void;
+
+	/**
+	Takes the range of the geometry pool a decoded mesh is uploaded into,
+	compacting the pool when that makes room for it and no other streamed
+	range would move.
+
+	@return false if the mesh has to wait for the streamed ranges before the compaction
+	@throws std::runtime_error if the mesh doesn't fit in the pool even after a compaction
+	*/
+	auto allocateGeometry(Asset& asset) -> bool;
+
+	/**
+	@return true while the range of a streamed mesh is uploading or waiting to be taken
+	*/
+	auto hasPendingGeometry() const noexcept -> bool;
+
+	/**
+	Records the copies of the asset into a command buffer of the transfer
+	command buffer pool and submits it.
+	*/
+	auto submitUpload(Asset& asset) -> void;
+
+	auto recordTextureUpload(VkCommandBuffer command_buffer, const Asset& asset) noexcept -> void;
+
+	/**
+	Barriers of the ownership transfer of the vertex and index ranges of a
+	mesh in the arenas of the geometry pool, without their access masks
+	*/
+	auto getOwnershipBarriers(const StreamedMesh& mesh) const -> std::array<VkBufferMemoryBarrier, 2>;
+
+	/**
+	Barrier of the last layout transition of a texture, which is also its
+	ownership transfer when needsOwnershipTransfer(), without its access masks
+	*/
+	auto getOwnershipBarrier(const StreamedTexture& texture) const noexcept -> VkImageMemoryBarrier;
+
+	/**
+	Worker side: takes the staging memory of the upload_bytes of the asset,
+	from the ring (waiting for room in it) or from a buffer of its own.
+
+	@param The asset
+	@param Bytes past the upload the worker may write into, they are not copied
+	@throws std::runtime_error if the streamer stops while waiting, or the buffer can't be created
+	*/
+	auto stageUpload(Asset& asset, VkDeviceSize spare_bytes = 0) -> void;
+
+	/**
+	Gives back the staging memory of the asset, the GPU must be done with it
+	*/
+	auto releaseStaging(Asset& asset) noexcept -> void;
+
+	/**
+	Creates a buffer exclusive to the transfer family. The memory properties
+	provided are preferred, with VK_MEMORY_PROPERTY_HOST_CACHED_BIT the memory
+	is also required to be coherent.
+	*/
+	auto createBuffer(
+		VkDeviceSize size,
+		VkBufferUsageFlags usage,
+		VmaMemoryUsage allocation_usage,
+		VmaAllocationCreateFlags allocation_flags,
+		AllocatedBuffer& buffer,
+		VkMemoryPropertyFlags preferred_properties = 0) -> void;
+
+	auto destroyBuffer(AllocatedBuffer& buffer) noexcept -> void;
+
+	auto destroyImage(AllocatedImage& image) noexcept -> void;
+
+	/**
+	Destroys every resource the asset still owns
+	*/
+	auto releaseAsset(Asset& asset) noexcept -> void;
+
+
+	AssetStreamerContext m_context{};
+
+	/*
+	Assets are never removed so a handle is an index into this vector, the
+	workers keep a reference to their asset so they are stored by pointer.
+	*/
+	std::vector<std::unique_ptr<Asset>> m_assets{};
+
+	std::vector<AssetHandle> m_uploading{};
+
+	std::mutex m_decoded_mutex{};
+	std::vector<AssetHandle> m_decoded{};
+
+	std::atomic<bool> m_stopping{ false };
+
+	/*
+	Ranges of the ring in the order they were taken, each one is released once
+	it and every range before it are done with
+	*/
+	struct StagingRange {
+		uint64_t end{};
+		bool released{ false };
+	};
+
+	std::unique_ptr<StagingRing> m_staging_ring{};
+	std::mutex m_staging_mutex{};
+	std::condition_variable m_staging_released{};
+	std::deque<StagingRange> m_staging_ranges{};
+
+	std::unique_ptr<ThreadPool> m_workers{};
+};
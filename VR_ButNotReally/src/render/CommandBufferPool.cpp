@@ -0,0 +1,200 @@
+#include "CommandBufferPool.h"
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+CommandBufferPool::CommandBufferPool(const CommandBufferPoolContext& context, size_t size) : m_context(context) {
+
+	/*
+	The command buffers are reset one by one when they are taken again
+	*/
+	auto command_pool_create_info = VkCommandPoolCreateInfo{};
+	command_pool_create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	command_pool_create_info.queueFamilyIndex = m_context.queue_family;
+	command_pool_create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+	if (vkCreateCommandPool(m_context.device, &command_pool_create_info, nullptr, &m_command_pool) != VK_SUCCESS) {
+		throw std::runtime_error("We couldn't create the command pool of a command buffer pool");
+	}
+
+	auto command_buffers = std::vector<VkCommandBuffer>(std::max(size, size_t{ 1 }));
+
+	auto allocate_info = VkCommandBufferAllocateInfo{};
+	allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocate_info.commandPool = m_command_pool;
+	allocate_info.commandBufferCount = gsl::narrow<uint32_t>(command_buffers.size());
+
+	if (vkAllocateCommandBuffers(m_context.device, &allocate_info, command_buffers.data()) != VK_SUCCESS) {
+		vkDestroyCommandPool(m_context.device, m_command_pool, nullptr);
+		throw std::runtime_error("We couldn't allocate the command buffers of a command buffer pool");
+	}
+
+	m_slots.reserve(command_buffers.size());
+	for (const auto command_buffer : command_buffers) {
+		auto slot = Slot{};
+		slot.command_buffer = command_buffer;
+
+		auto fence_create_info = VkFenceCreateInfo{};
+		fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		if (vkCreateFence(m_context.device, &fence_create_info, nullptr, &slot.fence) != VK_SUCCESS) {
+			for (const auto& created_slot : m_slots) {
+				vkDestroyFence(m_context.device, created_slot.fence, nullptr);
+			}
+			vkDestroyCommandPool(m_context.device, m_command_pool, nullptr);
+			throw std::runtime_error("We couldn't create the fences of a command buffer pool");
+		}
+		m_slots.push_back(slot);
+	}
+}
+
+CommandBufferPool::~CommandBufferPool() {
+
+	waitIdle();
+
+	for (const auto& slot : m_slots) {
+		vkDestroyFence(m_context.device, slot.fence, nullptr);
+	}
+
+	/*
+	This also frees the command buffers it contains
+	*/
+	vkDestroyCommandPool(m_context.device, m_command_pool, nullptr);
+}
+
+auto CommandBufferPool::begin() noexcept -> VkCommandBuffer {
+
+	auto slot = std::find_if(m_slots.begin(), m_slots.end(), [this](Slot& candidate) {
+		return candidate.state == SlotState::free || (candidate.state == SlotState::in_flight && pollSlot(candidate));
+	});
+
+	/*
+	Every command buffer is in flight or recording, the oldest submission is
+	the one most likely to be done
+	*/
+	if (slot == m_slots.end()) {
+		slot = std::min_element(m_slots.begin(), m_slots.end(), [](const Slot& a, const Slot& b) {
+			if (a.state != b.state) {
+				return a.state == SlotState::in_flight;
+			}
+			return a.ticket < b.ticket;
+		});
+		waitSlot(*slot);
+	}
+
+	vkResetCommandBuffer(slot->command_buffer, 0);
+
+	auto begin_info = VkCommandBufferBeginInfo{};
+	begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkBeginCommandBuffer(slot->command_buffer, &begin_info);
+	slot->state = SlotState::recording;
+
+	return slot->command_buffer;
+}
+
+auto CommandBufferPool::submit(VkCommandBuffer command_buffer, VkSubmitInfo submit_info) -> uint64_t {
+
+	const auto slot = findSlot(command_buffer);
+	if (slot == nullptr || slot->state != SlotState::recording) {
+		throw std::runtime_error("We can't submit a command buffer that isn't recording from the pool");
+	}
+
+	if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+		slot->state = SlotState::free;
+		throw std::runtime_error("We couldn't record a command buffer of the pool");
+	}
+
+	submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit_info.commandBufferCount = 1;
+	submit_info.pCommandBuffers = &command_buffer;
+
+	vkResetFences(m_context.device, 1, &slot->fence);
+	if (vkQueueSubmit(m_context.queue, 1, &submit_info, slot->fence) != VK_SUCCESS) {
+		slot->state = SlotState::free;
+		throw std::runtime_error("We couldn't submit a command buffer of the pool");
+	}
+
+	slot->ticket = m_next_ticket++;
+	slot->state = SlotState::in_flight;
+	return slot->ticket;
+}
+
+auto CommandBufferPool::discard(VkCommandBuffer command_buffer) noexcept -> void {
+
+	const auto slot = findSlot(command_buffer);
+	if (slot != nullptr && slot->state == SlotState::recording) {
+		slot->state = SlotState::free;
+	}
+}
+
+auto CommandBufferPool::isComplete(uint64_t ticket) noexcept -> bool {
+
+	/*
+	A ticket without a slot in flight was already seen complete (and its
+	command buffer maybe taken again)
+	*/
+	const auto slot = findInFlightSlot(ticket);
+	return slot == nullptr || pollSlot(*slot);
+}
+
+auto CommandBufferPool::wait(uint64_t ticket) noexcept -> void {
+
+	const auto slot = findInFlightSlot(ticket);
+	if (slot != nullptr) {
+		waitSlot(*slot);
+	}
+}
+
+auto CommandBufferPool::waitIdle() noexcept -> void {
+
+	for (auto& slot : m_slots) {
+		if (slot.state == SlotState::in_flight) {
+			waitSlot(slot);
+		}
+	}
+}
+
+auto CommandBufferPool::getInFlightCount() const noexcept -> size_t {
+	return gsl::narrow_cast<size_t>(std::count_if(m_slots.begin(), m_slots.end(), [](const Slot& slot) {
+		return slot.state == SlotState::in_flight;
+	}));
+}
+
+auto CommandBufferPool::findSlot(VkCommandBuffer command_buffer) noexcept -> Slot* {
+
+	const auto slot = std::find_if(m_slots.begin(), m_slots.end(), [command_buffer](const Slot& candidate) {
+		return candidate.command_buffer == command_buffer;
+	});
+	return slot == m_slots.end() ? nullptr : &*slot;
+}
+
+auto CommandBufferPool::findInFlightSlot(uint64_t ticket) noexcept -> Slot* {
+
+	if (ticket == 0) {
+		return nullptr;
+	}
+
+	const auto slot = std::find_if(m_slots.begin(), m_slots.end(), [ticket](const Slot& candidate) {
+		return candidate.state == SlotState::in_flight && candidate.ticket == ticket;
+	});
+	return slot == m_slots.end() ? nullptr : &*slot;
+}
+
+auto CommandBufferPool::pollSlot(Slot& slot) noexcept -> bool {
+
+	if (slot.state == SlotState::in_flight && vkGetFenceStatus(m_context.device, slot.fence) == VK_SUCCESS) {
+		slot.state = SlotState::free;
+	}
+	return slot.state == SlotState::free;
+}
+
+auto CommandBufferPool::waitSlot(Slot& slot) noexcept -> void {
+
+	if (slot.state == SlotState::in_flight) {
+		vkWaitForFences(m_context.device, 1, &slot.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+		slot.state = SlotState::free;
+	}
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "RenderData.h"
+
+/*
+Reusable command buffers of a queue.
+
+Every single time command used to allocate a command buffer, submit it, wait
+for the whole queue with vkQueueWaitIdle and free it. A CommandBufferPool
+allocates its command buffers once, each with a fence, and hands them out
+again once the GPU is done with them.
+
+A submission doesn't wait, it returns a ticket that can be polled with
+isComplete() or waited for with wait(), which only waits for the fence of
+that submission instead of the whole queue. So whatever else the queue (or
+another queue) is running keeps running while we wait for our commands.
+
+When every command buffer is in flight begin() waits for the oldest one, so
+the pool never grows past the size it was created with. At most size - 1
+command buffers can be recording at the same time. It is not thread safe,
+the renderer records and submits from a single thread.
+*/
+
+/**
+Vulkan objects the pool works with, owned by the renderer
+*/
+struct CommandBufferPoolContext {
+	VkDevice device{};
+	VkQueue queue{};
+	uint32_t queue_family{};	// Of the queue
+};
+
+class CommandBufferPool {
+public:
+
+	/**
+	Creates the command pool of the queue family and allocates the command
+	buffers and their fences.
+
+	@param The Vulkan objects to record and submit with
+	@param The amount of command buffers of the pool
+	@throws std::runtime_error if the command buffers or the fences can't be created
+	*/
+	CommandBufferPool(const CommandBufferPoolContext& context, size_t size);
+
+	CommandBufferPool(const CommandBufferPool&) = delete;
+	CommandBufferPool& operator=(const CommandBufferPool&) = delete;
+	CommandBufferPool(CommandBufferPool&&) = delete;
+	CommandBufferPool& operator=(CommandBufferPool&&) = delete;
+
+	/**
+	Waits for the command buffers in flight and destroys the pool.
+	*/
+	~CommandBufferPool();
+
+	/**
+	Takes a command buffer and starts recording into it, waiting for the
+	oldest one in flight when there is no free one.
+
+	@return The command buffer, until it is submitted or given back
+	*/
+	auto begin() noexcept -> VkCommandBuffer;
+
+	/**
+	Ends a command buffer of begin() and submits it to the queue with its
+	fence. It doesn't wait.
+
+	@param The command buffer
+	@param The semaphores to wait for and to signal, and their stages, in the
+	submit info (its command buffers are set by the pool)
+	@return The ticket of the submission
+	@throws std::runtime_error if it can't be submitted
+	*/
+	auto submit(VkCommandBuffer command_buffer, VkSubmitInfo submit_info = {}) -> uint64_t;
+
+	/**
+	Gives back a command buffer of begin() that won't be submitted.
+
+	@param The command buffer
+	*/
+	auto discard(VkCommandBuffer command_buffer) noexcept -> void;
+
+	/**
+	@param A ticket of submit(), 0 is always complete
+	@return true if the submission has been executed
+	*/
+	auto isComplete(uint64_t ticket) noexcept -> bool;
+
+	/**
+	Waits until a submission has been executed.
+
+	@param A ticket of submit(), 0 returns right away
+	*/
+	auto wait(uint64_t ticket) noexcept -> void;
+
+	/**
+	Waits until every submission has been executed.
+	*/
+	auto waitIdle() noexcept -> void;
+
+	/**
+	@return The submissions whose fence has not been seen signaled yet
+	*/
+	auto getInFlightCount() const noexcept -> size_t;
+
+	auto getSize() const noexcept -> size_t { return m_slots.size(); }
+
+private:
+
+	enum class SlotState {
+		free,
+		recording,
+		in_flight
+	};
+
+	struct Slot {
+		VkCommandBuffer command_buffer{};
+		VkFence fence{};
+		uint64_t ticket{};		// Of the last submission
+		SlotState state{ SlotState::free };
+	};
+
+	auto findSlot(VkCommandBuffer command_buffer) noexcept -> Slot*;
+	auto findInFlightSlot(uint64_t ticket) noexcept -> Slot*;
+
+	/**
+	Marks the slot free if its fence is signaled
+
+	@return true if the slot is free now
+	*/
+	auto pollSlot(Slot& slot) noexcept -> bool;
+	auto waitSlot(Slot& slot) noexcept -> void;
+
+
+	CommandBufferPoolContext m_context{};
+
+	VkCommandPool m_command_pool{};
+
+	std::vector<Slot> m_slots{};
+
+	/*
+	Ticket of the next submission, they start at 1
+	*/
+	uint64_t m_next_ticket{ 1 };
+};
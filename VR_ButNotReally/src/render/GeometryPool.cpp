@@ -0,0 +1,299 @@
+#include "GeometryPool.h"
+#include <stdexcept>
+#include <algorithm>
+#include <numeric>
+
+RangeAllocator::RangeAllocator(uint32_t capacity) : m_capacity(capacity) {
+	reset(0);
+}
+
+auto RangeAllocator::allocate(uint32_t count) -> uint32_t {
+
+	if (count == 0) {
+		return 0;
+	}
+
+	const auto best_fit = m_free_ranges_by_size.lower_bound(count);
+	if (best_fit == m_free_ranges_by_size.end()) {
+		return invalid_range;
+	}
+
+	const auto offset = best_fit->second;
+	const auto range_count = best_fit->first;
+	eraseFreeRange(m_free_ranges.find(offset));
+
+	if (range_count > count) {
+		insertFreeRange(offset + count, range_count - count);
+	}
+	return offset;
+}
+
+auto RangeAllocator::free(uint32_t offset, uint32_t count) -> void {
+
+	if (count == 0) {
+		return;
+	}
+
+	auto begin = offset;
+	auto end = offset + count;
+
+	/*
+	Merged with the free range right after it and the one right before it
+	*/
+	const auto next = m_free_ranges.lower_bound(offset);
+	if (next != m_free_ranges.end() && next->first == end) {
+		end += next->second;
+		eraseFreeRange(next);
+	}
+
+	auto previous = m_free_ranges.lower_bound(offset);
+	if (previous != m_free_ranges.begin()) {
+		--previous;
+		if (previous->first + previous->second == begin) {
+			begin = previous->first;
+			eraseFreeRange(previous);
+		}
+	}
+
+	insertFreeRange(begin, end - begin);
+}
+
+auto RangeAllocator::reset(uint32_t used) -> void {
+
+	m_free_ranges.clear();
+	m_free_ranges_by_size.clear();
+	m_free_count = 0;
+
+	if (used < m_capacity) {
+		insertFreeRange(used, m_capacity - used);
+	}
+}
+
+auto RangeAllocator::getLargestFreeRange() const noexcept -> uint32_t {
+	return m_free_ranges_by_size.empty() ? 0 : m_free_ranges_by_size.rbegin()->first;
+}
+
+auto RangeAllocator::insertFreeRange(uint32_t offset, uint32_t count) -> void {
+	m_free_ranges.emplace(offset, count);
+	m_free_ranges_by_size.emplace(count, offset);
+	m_free_count += count;
+}
+
+auto RangeAllocator::eraseFreeRange(std::map<uint32_t, uint32_t>::iterator range) -> void {
+
+	const auto same_size = m_free_ranges_by_size.equal_range(range->second);
+	const auto by_size = std::find_if(same_size.first, same_size.second, [range](const auto& candidate) {
+		return candidate.second == range->first;
+	});
+	m_free_ranges_by_size.erase(by_size);
+
+	m_free_count -= range->second;
+	m_free_ranges.erase(range);
+}
+
+GeometryPool::GeometryPool(const GeometryPoolContext& context) :
+	m_context(context),
+	m_vertices(context.vertex_capacity),
+	m_indices(context.index_capacity) {
+
+	m_arenas = createArenas();
+}
+
+GeometryPool::~GeometryPool() {
+	destroyArenas(m_arenas);
+}
+
+auto GeometryPool::allocate(uint32_t vertex_count, uint32_t index_count) -> GeometryHandle {
+
+	const auto first_vertex = m_vertices.allocate(vertex_count);
+	if (first_vertex == RangeAllocator::invalid_range) {
+		return invalid_geometry;
+	}
+
+	const auto first_index = m_indices.allocate(index_count);
+	if (first_index == RangeAllocator::invalid_range) {
+		m_vertices.free(first_vertex, vertex_count);
+		return invalid_geometry;
+	}
+
+	auto range = GeometryRange{};
+	range.first_vertex = first_vertex;
+	range.vertex_count = vertex_count;
+	range.first_index = first_index;
+	range.index_count = index_count;
+
+	if (m_free_handles.empty()) {
+		m_ranges.push_back(range);
+		m_ranges_in_use.push_back(true);
+		return gsl::narrow<GeometryHandle>(m_ranges.size() - 1);
+	}
+
+	const auto handle = m_free_handles.back();
+	m_free_handles.pop_back();
+	m_ranges.at(handle) = range;
+	m_ranges_in_use.at(handle) = true;
+	return handle;
+}
+
+auto GeometryPool::free(GeometryHandle handle) -> void {
+
+	if (handle >= m_ranges.size() || !m_ranges_in_use.at(handle)) {
+		return;
+	}
+
+	const auto& range = m_ranges.at(handle);
+	m_vertices.free(range.first_vertex, range.vertex_count);
+	m_indices.free(range.first_index, range.index_count);
+
+	m_ranges_in_use.at(handle) = false;
+	m_free_handles.push_back(handle);
+}
+
+auto GeometryPool::getRange(GeometryHandle handle) const -> const GeometryRange& {
+	return m_ranges.at(handle);
+}
+
+auto GeometryPool::fitsAfterCompaction(uint32_t vertex_count, uint32_t index_count) const noexcept -> bool {
+	return vertex_count <= m_vertices.getFreeCount() && index_count <= m_indices.getFreeCount();
+}
+
+auto GeometryPool::compact(VkCommandBuffer command_buffer) -> GeometryArenas {
+
+	auto old_arenas = m_arenas;
+	m_arenas = createArenas();
+
+	auto handles = std::vector<GeometryHandle>{};
+	for (auto handle = GeometryHandle{ 0 }; handle < m_ranges.size(); ++handle) {
+		if (m_ranges_in_use.at(handle)) {
+			handles.push_back(handle);
+		}
+	}
+
+	/*
+	Whatever was uploaded into the old arenas before has to be there before
+	we copy it
+	*/
+	auto barrier = VkMemoryBarrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	vkCmdPipelineBarrier(
+		command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0,
+		1, &barrier,
+		0, nullptr,
+		0, nullptr);
+
+	/*
+	The ranges keep their order in every arena, so the meshes stay where they
+	were relative to each other
+	*/
+	auto pack = [&](
+		uint32_t GeometryRange::* first,
+		uint32_t GeometryRange::* count,
+		VkDeviceSize element_size,
+		VkBuffer source,
+		VkBuffer destination) -> uint32_t {
+
+		std::sort(handles.begin(), handles.end(), [&](GeometryHandle a, GeometryHandle b) {
+			return m_ranges.at(a).*first < m_ranges.at(b).*first;
+		});
+
+		auto regions = std::vector<VkBufferCopy>{};
+		auto used = uint32_t{ 0 };
+		for (const auto handle : handles) {
+			auto& range = m_ranges.at(handle);
+			if (range.*count == 0) {
+				range.*first = 0;
+				continue;
+			}
+
+			auto region = VkBufferCopy{};
+			region.srcOffset = VkDeviceSize{ range.*first } * element_size;
+			region.dstOffset = VkDeviceSize{ used } * element_size;
+			region.size = VkDeviceSize{ range.*count } * element_size;
+			regions.push_back(region);
+
+			range.*first = used;
+			used += range.*count;
+		}
+
+		if (!regions.empty()) {
+			vkCmdCopyBuffer(command_buffer, source, destination, gsl::narrow<uint32_t>(regions.size()), regions.data());
+		}
+		return used;
+	};
+
+	m_vertices.reset(pack(
+		&GeometryRange::first_vertex,
+		&GeometryRange::vertex_count,
+		m_context.vertex_stride,
+		old_arenas.vertex_buffer.buffer,
+		m_arenas.vertex_buffer.buffer));
+
+	m_indices.reset(pack(
+		&GeometryRange::first_index,
+		&GeometryRange::index_count,
+		getIndexSize(),
+		old_arenas.index_buffer.buffer,
+		m_arenas.index_buffer.buffer));
+
+	return old_arenas;
+}
+
+auto GeometryPool::destroyArenas(GeometryArenas& arenas) noexcept -> void {
+
+	if (arenas.vertex_buffer.buffer != VK_NULL_HANDLE) {
+		vmaDestroyBuffer(m_context.allocator, arenas.vertex_buffer.buffer, arenas.vertex_buffer.allocation);
+	}
+	if (arenas.index_buffer.buffer != VK_NULL_HANDLE) {
+		vmaDestroyBuffer(m_context.allocator, arenas.index_buffer.buffer, arenas.index_buffer.allocation);
+	}
+	arenas = GeometryArenas{};
+}
+
+auto GeometryPool::getIndexSize() const noexcept -> VkDeviceSize {
+	return VkDeviceSize{ ::getIndexSize(m_context.index_type) };
+}
+
+auto GeometryPool::getRangeCount() const noexcept -> size_t {
+	return gsl::narrow_cast<size_t>(std::count(m_ranges_in_use.begin(), m_ranges_in_use.end(), true));
+}
+
+auto GeometryPool::createArenas() -> GeometryArenas {
+
+	auto createArena = [this](VkDeviceSize size, VkBufferUsageFlags usage, AllocatedBuffer& buffer) {
+
+		/*
+		The transfer source is for the compaction. Only the graphics queue
+		touches the arenas, they are exclusive to its family.
+		*/
+		auto buffer_create_info = VkBufferCreateInfo{};
+		buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		buffer_create_info.size = std::max(size, VkDeviceSize{ 4 });
+		buffer_create_info.usage = usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		auto allocation_create_info = VmaAllocationCreateInfo{};
+		allocation_create_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+		return vmaCreateBuffer(
+			m_context.allocator,
+			&buffer_create_info,
+			&allocation_create_info,
+			&buffer.buffer,
+			&buffer.allocation,
+			&buffer.allocation_info) == VK_SUCCESS;
+	};
+
+	auto arenas = GeometryArenas{};
+	if (!createArena(m_context.vertex_stride * m_context.vertex_capacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, arenas.vertex_buffer) ||
+		!createArena(getIndexSize() * m_context.index_capacity, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, arenas.index_buffer)) {
+		destroyArenas(arenas);
+		throw std::runtime_error("We couldn't create the arenas of the geometry pool");
+	}
+	return arenas;
+}
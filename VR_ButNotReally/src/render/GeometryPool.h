@@ -0,0 +1,220 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <vector>
+
+#include "RenderData.h"
+
+/*
+Shared vertex and index buffers of every mesh.
+
+Every mesh used to get its own vertex and index buffers, each created with
+its own createBuffer, so a scene with thousands of meshes needed thousands of
+buffers and a bind per mesh. A GeometryPool creates one big device local
+arena for the vertices and another for the indices, and hands out ranges of
+them: every mesh is drawn with the vertexOffset and firstIndex of its range,
+and all of them share a single vkCmdBindVertexBuffers and vkCmdBindIndexBuffer.
+
+The ranges are taken from a free list per arena (best fit, freed ranges are
+merged with their neighbours), in vertices and indices instead of bytes. The
+indices of every mesh are written with the index type of the pool.
+
+Streamed meshes come and go and leave holes between the ranges. compact()
+copies the ranges in use one after the other into new arenas, the ranges
+are identified by handles so they can be moved. The old arenas are returned
+to be destroyed once the GPU is done with them.
+*/
+
+using GeometryHandle = uint32_t;
+
+constexpr auto invalid_geometry = std::numeric_limits<GeometryHandle>::max();
+
+/**
+Range of the arenas of a mesh, its sub-meshes and meshlets are relative to it
+*/
+struct GeometryRange {
+	uint32_t first_vertex{};
+	uint32_t vertex_count{};
+	uint32_t first_index{};
+	uint32_t index_count{};
+};
+
+/**
+Vertex and index buffers of a pool
+*/
+struct GeometryArenas {
+	AllocatedBuffer vertex_buffer{};
+	AllocatedBuffer index_buffer{};
+};
+
+/**
+Vulkan objects and settings the pool works with, owned by the renderer
+*/
+struct GeometryPoolContext {
+	VmaAllocator allocator{};
+	VkDeviceSize vertex_stride{};
+	VkIndexType index_type{ VK_INDEX_TYPE_UINT16 };
+	uint32_t vertex_capacity{};
+	uint32_t index_capacity{};
+};
+
+/**
+Free list of the ranges of an arena, in elements
+*/
+class RangeAllocator {
+public:
+
+	/**
+	@param The amount of elements of the arena, all of them free
+	*/
+	explicit RangeAllocator(uint32_t capacity = 0);
+
+	/**
+	Takes the smallest free range with room for the elements provided.
+
+	@param The amount of elements, 0 takes nothing
+	@return The first element of the range, invalid_range if no free range is big enough
+	*/
+	auto allocate(uint32_t count) -> uint32_t;
+
+	/**
+	Gives back a range, it is merged with the free ranges next to it.
+
+	@param The first element of the range
+	@param The amount of elements of the range
+	*/
+	auto free(uint32_t offset, uint32_t count) -> void;
+
+	/**
+	Leaves the elements before the one provided in use and the rest free
+
+	@param The amount of elements in use, from the start of the arena
+	*/
+	auto reset(uint32_t used) -> void;
+
+	auto getCapacity() const noexcept -> uint32_t { return m_capacity; }
+	auto getFreeCount() const noexcept -> uint32_t { return m_free_count; }
+	auto getFreeRangeCount() const noexcept -> size_t { return m_free_ranges.size(); }
+
+	/**
+	@return The elements of the biggest free range
+	*/
+	auto getLargestFreeRange() const noexcept -> uint32_t;
+
+	static constexpr auto invalid_range = std::numeric_limits<uint32_t>::max();
+
+private:
+
+	auto insertFreeRange(uint32_t offset, uint32_t count) -> void;
+	auto eraseFreeRange(std::map<uint32_t, uint32_t>::iterator range) -> void;
+
+
+	uint32_t m_capacity{};
+	uint32_t m_free_count{};
+
+	/*
+	Free ranges by their first element and by their size, with the same ranges
+	*/
+	std::map<uint32_t, uint32_t> m_free_ranges{};
+	std::multimap<uint32_t, uint32_t> m_free_ranges_by_size{};
+};
+
+class GeometryPool {
+public:
+
+	/**
+	Creates the arenas.
+
+	@param The Vulkan objects and the sizes of the arenas
+	@throws std::runtime_error if the arenas can't be created
+	*/
+	explicit GeometryPool(const GeometryPoolContext& context);
+
+	GeometryPool(const GeometryPool&) = delete;
+	GeometryPool& operator=(const GeometryPool&) = delete;
+	GeometryPool(GeometryPool&&) = delete;
+	GeometryPool& operator=(GeometryPool&&) = delete;
+
+	/**
+	Destroys the arenas, the GPU must be done with them.
+	*/
+	~GeometryPool();
+
+	/**
+	Takes a range of the arenas for a mesh.
+
+	@param The vertices of the mesh, 0 when they live somewhere else
+	@param The indices of the mesh
+	@return The handle of the range, invalid_geometry if the arenas don't have a
+	free range big enough (they may have one after compact())
+	*/
+	auto allocate(uint32_t vertex_count, uint32_t index_count) -> GeometryHandle;
+
+	/**
+	Gives back the range of a mesh, the GPU must be done with it.
+
+	@param The handle of the range
+	*/
+	auto free(GeometryHandle handle) -> void;
+
+	/**
+	@param The handle of a range
+	@return The range, it changes with compact()
+	*/
+	auto getRange(GeometryHandle handle) const -> const GeometryRange&;
+
+	/**
+	@return true if compact() would leave room for a range of the size provided
+	*/
+	auto fitsAfterCompaction(uint32_t vertex_count, uint32_t index_count) const noexcept -> bool;
+
+	/**
+	Creates new arenas and records the copies of the ranges in use into them,
+	one after the other. The copies wait for the transfers recorded before
+	them, the commands that read the new arenas have to wait for the copies.
+
+	@param The command buffer to record the copies into
+	@return The old arenas, to destroy with destroyArenas() once the GPU is done with them
+	@throws std::runtime_error if the new arenas can't be created
+	*/
+	auto compact(VkCommandBuffer command_buffer) -> GeometryArenas;
+
+	/**
+	@param Arenas returned by compact()
+	*/
+	auto destroyArenas(GeometryArenas& arenas) noexcept -> void;
+
+	auto getVertexBuffer() const noexcept -> VkBuffer { return m_arenas.vertex_buffer.buffer; }
+	auto getIndexBuffer() const noexcept -> VkBuffer { return m_arenas.index_buffer.buffer; }
+	auto getVertexStride() const noexcept -> VkDeviceSize { return m_context.vertex_stride; }
+	auto getIndexType() const noexcept -> VkIndexType { return m_context.index_type; }
+	auto getIndexSize() const noexcept -> VkDeviceSize;
+
+	auto getVertices() const noexcept -> const RangeAllocator& { return m_vertices; }
+	auto getIndices() const noexcept -> const RangeAllocator& { return m_indices; }
+
+	/**
+	@return The amount of ranges in use
+	*/
+	auto getRangeCount() const noexcept -> size_t;
+
+private:
+
+	auto createArenas() -> GeometryArenas;
+
+
+	GeometryPoolContext m_context{};
+
+	GeometryArenas m_arenas{};
+
+	RangeAllocator m_vertices{};
+	RangeAllocator m_indices{};
+
+	/*
+	Range of every handle, the handles of the freed ones are reused
+	*/
+	std::vector<GeometryRange> m_ranges{};
+	std::vector<bool> m_ranges_in_use{};
+	std::vector<GeometryHandle> m_free_handles{};
+};
@@ -0,0 +1,160 @@
+#include "MaterialLibrary.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <gsl/gsl>
+
+#include "../utils/Utils.h"
+
+namespace {
+
+	/**
+	@return The directory of the path provided with its trailing separator,
+	empty if the path has no directory
+	*/
+	auto getDirectory(const std::string& path) -> std::string {
+		const auto separator = path.find_last_of("/\\");
+		return separator == std::string::npos ? std::string{} : path.substr(0, separator + 1);
+	}
+
+	/**
+	The arguments of map_Kd are the options followed by the file name, the
+	file name can have spaces so it is everything after the last option.
+	*/
+	auto readTextureName(std::istringstream& stream) -> std::string {
+
+		auto token = std::string{};
+		while (stream >> token) {
+			if (token.empty() || token.front() != '-') {
+				auto rest = std::string{};
+				std::getline(stream, rest);
+				return token + rest.substr(0, rest.find_last_not_of(" \t\r") + 1);
+			}
+
+			/*
+			Every option we may find has at most 3 values, the ones that are
+			not numbers belong to the file name.
+			*/
+			for (auto value = 0; value < 3; ++value) {
+				const auto position = stream.tellg();
+				auto number = 0.0;
+				if (!(stream >> number)) {
+					stream.clear();
+					stream.seekg(position);
+					break;
+				}
+			}
+		}
+		return {};
+	}
+}
+
+auto parseMaterialLibrary(const std::string& path) -> std::vector<ObjMaterial> {
+
+	auto file = std::ifstream(path);
+	if (!file.is_open()) {
+		throw std::runtime_error("We couldn't read the material library [" + path + "]");
+	}
+
+	auto materials = std::vector<ObjMaterial>{};
+	auto line = std::string{};
+	while (std::getline(file, line)) {
+		auto stream = std::istringstream{ line };
+		auto keyword = std::string{};
+		if (!(stream >> keyword)) {
+			continue;
+		}
+
+		if (keyword == "newmtl") {
+			auto material = ObjMaterial{};
+			std::getline(stream >> std::ws, material.name);
+			material.name.erase(material.name.find_last_not_of(" \t\r") + 1);
+			materials.push_back(std::move(material));
+		}
+		else if (keyword == "map_Kd" && !materials.empty()) {
+			materials.back().diffuse_texture = readTextureName(stream);
+		}
+	}
+
+	return materials;
+}
+
+auto getMaterialTextures(const ObjModel& model, const std::string& object_path) -> MaterialTextures {
+
+	auto textures = MaterialTextures{};
+	if (model.material_library.empty() || model.material_names.empty()) {
+		return textures;
+	}
+
+	const auto library_path = getDirectory(object_path) + model.material_library;
+
+	auto materials = std::vector<ObjMaterial>{};
+	try {
+		materials = parseMaterialLibrary(library_path);
+	}
+	catch (const std::exception& exception) {
+		std::cout << "\t" << exception.what() << ", the model has no material textures" << std::endl;
+		return textures;
+	}
+
+	const auto texture_directory = getDirectory(library_path);
+
+	textures.material_layers.reserve(model.material_names.size());
+	for (const auto& name : model.material_names) {
+		const auto material = std::find_if(materials.begin(), materials.end(), [&name](const ObjMaterial& material) {
+			return material.name == name;
+		});
+
+		if (material == materials.end() || material->diffuse_texture.empty()) {
+			textures.material_layers.push_back(0);
+			continue;
+		}
+
+		const auto texture_path = texture_directory + material->diffuse_texture;
+		const auto layer = std::find(textures.texture_paths.begin(), textures.texture_paths.end(), texture_path);
+		textures.material_layers.push_back(gsl::narrow<uint32_t>(layer - textures.texture_paths.begin()));
+		if (layer == textures.texture_paths.end()) {
+			textures.texture_paths.push_back(texture_path);
+		}
+	}
+
+	if (textures.texture_paths.empty()) {
+		textures.material_layers.clear();
+	}
+	return textures;
+}
+
+auto makeMaterialLibraryKey(const MappedFile& object, const std::string& object_path) -> MaterialLibraryKey {
+
+	auto key = MaterialLibraryKey{};
+
+	const auto material_library = findObjMaterialLibrary(object.data(), object.size());
+	if (material_library.empty()) {
+		return key;
+	}
+
+	const auto library_path = getDirectory(object_path) + material_library;
+	auto library = MappedFile{};
+	if (!library.open(library_path)) {
+		return key;
+	}
+
+	key.hash = hashBytes(library.data(), library.size());
+
+	const auto texture_directory = getDirectory(library_path);
+	for (const auto& material : parseMaterialLibrary(library_path)) {
+		if (material.diffuse_texture.empty()) {
+			continue;
+		}
+
+		/*
+		The terminator is hashed too so the paths can't run into each other
+		*/
+		key.texture_paths.push_back(texture_directory + material.diffuse_texture);
+		key.hash = hashBytes(key.texture_paths.back().c_str(), key.texture_paths.back().size() + 1, key.hash);
+	}
+
+	return key;
+}
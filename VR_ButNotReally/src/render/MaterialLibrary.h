@@ -0,0 +1,76 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "ObjParser.h"
+#include "../utils/MappedFile.h"
+
+/*
+Materials of the .obj models.
+
+Only the diffuse texture (map_Kd) of the materials is used. Every different
+texture of the materials of a model becomes a layer of a single texture array,
+in the order the materials are used by the model, and every vertex stores the
+layer of the material of its triangle. That way a model with several materials
+is drawn with one descriptor set and one draw, without packing its textures
+into an atlas by hand.
+
+Only the statements we use are understood: newmtl and map_Kd. The options of
+map_Kd (-bm, -o...) are skipped.
+*/
+
+struct ObjMaterial {
+	std::string name{};
+	std::string diffuse_texture{};	// Path relative to the .mtl file, empty if it has none
+};
+
+/**
+Textures of the materials of a model and the layer every material uses
+*/
+struct MaterialTextures {
+	std::vector<std::string> texture_paths{};	// One per layer of the texture array
+	std::vector<uint32_t> material_layers{};	// One per material, in the order of ObjModel::material_names
+};
+
+/**
+What the material textures of a model depend on, known without parsing the
+model. It covers every texture of the library, not only the ones the model
+uses.
+*/
+struct MaterialLibraryKey {
+	uint64_t hash{};	// Hash of the contents of the library and of the path of its textures
+	std::vector<std::string> texture_paths{};	// Path of every texture of the library, like getMaterialTextures() resolves them
+};
+
+/**
+Parses a .mtl file.
+
+@param The path of the .mtl file
+@return The materials of the file, in the order they are defined
+@throws std::runtime_error if the file can't be read
+*/
+auto parseMaterialLibrary(const std::string& path) -> std::vector<ObjMaterial>;
+
+/**
+Reads the material library of the model and assigns a layer to every
+different diffuse texture. The materials without a texture (or not found in
+the library) use the layer 0.
+
+@param The parsed .obj model
+@param The path of the .obj model, the material library is relative to it
+@return The texture of every layer and the layer of every material, both
+empty when the model has no textures in its materials
+*/
+auto getMaterialTextures(const ObjModel& model, const std::string& object_path) -> MaterialTextures;
+
+/**
+Creates the key of the material library of the .obj contents provided, it
+changes when the library is edited or its textures move.
+
+@param The contents of the .obj model
+@param The path of the .obj model, the material library is relative to it
+@return The key, with a hash of 0 and no textures when the model has no
+material library or it can't be read
+*/
+auto makeMaterialLibraryKey(const MappedFile& object, const std::string& object_path) -> MaterialLibraryKey;
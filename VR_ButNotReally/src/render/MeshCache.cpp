@@ -0,0 +1,260 @@
+#include "MeshCache.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+namespace {
+
+	constexpr auto mesh_cache_alignment = uint64_t{ 64 };
+
+	auto alignOffset(uint64_t offset) noexcept -> uint64_t {
+		return (offset + mesh_cache_alignment - 1) & ~(mesh_cache_alignment - 1);
+	}
+
+	auto writePadding(std::ofstream& file, uint64_t offset) -> void {
+		const auto padding = std::vector<char>(gsl::narrow_cast<size_t>(alignOffset(offset) - offset), 0);
+		if (!padding.empty()) {
+			file.write(padding.data(), padding.size());
+		}
+	}
+}
+
+auto getVertexLayoutHash() noexcept -> uint64_t {
+
+	const auto binding_description = Vertex::getBindingDescription();
+	const auto attribute_descriptions = Vertex::getAttributeDescriptions();
+
+	auto hash = hashBytes(&binding_description, sizeof(binding_description));
+	hash = hashBytes(attribute_descriptions.data(), sizeof(attribute_descriptions), hash);
+
+	const auto vertex_size = uint64_t{ sizeof(Vertex) };
+	return hashBytes(&vertex_size, sizeof(vertex_size), hash);
+}
+
+auto makeMeshCacheKey(const MappedFile& source, uint64_t options_hash) noexcept -> MeshCacheKey {
+
+	auto key = MeshCacheKey{};
+	key.source_hash = hashBytes(source.data(), source.size());
+	key.source_size = source.size();
+	key.layout_hash = getVertexLayoutHash();
+	key.options_hash = options_hash;
+	return key;
+}
+
+auto loadMeshCache(
+	const std::string& path,
+	const MeshCacheKey& key,
+	SimpleObjScene& scene) -> bool {
+
+	auto file = MappedFile{};
+	if (!file.open(path) || file.size() < sizeof(MeshCacheHeader)) {
+		return false;
+	}
+
+	auto header = MeshCacheHeader{};
+	memcpy(&header, file.data(), sizeof(header));
+
+	if (header.magic != mesh_cache_magic ||
+		header.version != mesh_cache_version ||
+		header.key.source_hash != key.source_hash ||
+		header.key.source_size != key.source_size ||
+		header.key.layout_hash != key.layout_hash ||
+		header.key.options_hash != key.options_hash) {
+		std::cout << "\tThe mesh cache [" << path << "] is stale and will be rebuilt" << std::endl;
+		return false;
+	}
+
+	/*
+	Every count is bounded by the elements the whole file could hold, and
+	every offset by its size, before they are multiplied and added, so a
+	corrupted header can't overflow them
+	*/
+	const auto file_size = uint64_t{ file.size() };
+	if (header.vertex_count > file_size / sizeof(Vertex) ||
+		header.index_count > file_size / sizeof(uint32_t) ||
+		header.sub_mesh_count > file_size / sizeof(SubMesh) ||
+		header.lod_count > file_size / sizeof(MeshLod) ||
+		header.texture_paths_size > file_size ||
+		header.vertices_offset > file_size ||
+		header.indices_offset > file_size ||
+		header.sub_meshes_offset > file_size ||
+		header.lods_offset > file_size ||
+		header.texture_paths_offset > file_size) {
+		std::cout << "\tThe mesh cache [" << path << "] is corrupted and will be rebuilt" << std::endl;
+		return false;
+	}
+
+	const auto vertices_end = header.vertices_offset + header.vertex_count * sizeof(Vertex);
+	const auto indices_end = header.indices_offset + header.index_count * sizeof(uint32_t);
+	const auto sub_meshes_end = header.sub_meshes_offset + header.sub_mesh_count * sizeof(SubMesh);
+	const auto lods_end = header.lods_offset + header.lod_count * sizeof(MeshLod);
+	const auto texture_paths_end = header.texture_paths_offset + header.texture_paths_size;
+
+	if (header.vertices_offset < sizeof(MeshCacheHeader) ||
+		header.indices_offset < vertices_end ||
+		header.sub_meshes_offset < indices_end ||
+		header.sub_mesh_count == 0 ||
+		header.lods_offset < sub_meshes_end ||
+		header.lod_count == 0 ||
+		header.texture_paths_offset < lods_end ||
+		texture_paths_end > file.size()) {
+		std::cout << "\tThe mesh cache [" << path << "] is corrupted and will be rebuilt" << std::endl;
+		return false;
+	}
+
+	/*
+	The sub-meshes index into the vertices and the indices and the levels of
+	detail into the sub-meshes, a range past them would be read out of bounds
+	when the indices and the draws are written
+	*/
+	auto sub_meshes = std::vector<SubMesh>(gsl::narrow<size_t>(header.sub_mesh_count));
+	[[gsl::suppress(bounds.1)]]{
+	memcpy(sub_meshes.data(), file.data() + header.sub_meshes_offset, sub_meshes.size() * sizeof(SubMesh));
+	}
+
+	const auto sub_mesh_out_of_bounds = std::any_of(sub_meshes.begin(), sub_meshes.end(), [&header](const SubMesh& sub_mesh) {
+		return uint64_t{ sub_mesh.first_index } + sub_mesh.index_count > header.index_count ||
+			sub_mesh.vertex_offset < 0 ||
+			uint64_t{ gsl::narrow_cast<uint32_t>(sub_mesh.vertex_offset) } + sub_mesh.vertex_count > header.vertex_count;
+	});
+
+	auto lods = std::vector<MeshLod>(gsl::narrow<size_t>(header.lod_count));
+	[[gsl::suppress(bounds.1)]]{
+	memcpy(lods.data(), file.data() + header.lods_offset, lods.size() * sizeof(MeshLod));
+	}
+
+	const auto lod_out_of_bounds = std::any_of(lods.begin(), lods.end(), [&header](const MeshLod& lod) {
+		return uint64_t{ lod.first_sub_mesh } + lod.sub_mesh_count > header.sub_mesh_count;
+	});
+	/*
+	The indices of a sub-mesh are relative to its first vertex, the meshlets
+	read the vertices they point to
+	*/
+	const auto index_out_of_bounds = !sub_mesh_out_of_bounds && std::any_of(sub_meshes.begin(), sub_meshes.end(), [&](const SubMesh& sub_mesh) {
+		[[gsl::suppress(type.1, bounds.1)]]{
+		const auto indices = reinterpret_cast<const uint32_t*>(file.data() + header.indices_offset) + sub_mesh.first_index;
+		return std::any_of(indices, indices + sub_mesh.index_count, [&sub_mesh](uint32_t index) noexcept {
+			return index >= sub_mesh.vertex_count;
+		});
+		}
+	});
+
+	if (sub_mesh_out_of_bounds || index_out_of_bounds || lod_out_of_bounds) {
+		std::cout << "\tThe mesh cache [" << path << "] is corrupted and will be rebuilt" << std::endl;
+		return false;
+	}
+
+	[[gsl::suppress(type.1, bounds.1)]]{
+	scene.cached_vertices = reinterpret_cast<const Vertex*>(file.data() + header.vertices_offset);
+	scene.cached_indices = reinterpret_cast<const uint32_t*>(file.data() + header.indices_offset);
+	}
+	scene.cached_vertex_count = gsl::narrow<size_t>(header.vertex_count);
+	scene.cached_index_count = gsl::narrow<size_t>(header.index_count);
+	scene.bounds.min = glm::vec3(header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]);
+	scene.bounds.max = glm::vec3(header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]);
+	scene.sub_meshes = std::move(sub_meshes);
+	scene.lods = std::move(lods);
+
+	scene.texture_paths.clear();
+	[[gsl::suppress(bounds.1)]]{
+	auto texture_paths = std::istringstream{ std::string(
+		file.data() + header.texture_paths_offset,
+		gsl::narrow<size_t>(header.texture_paths_size)) };
+	auto texture_path = std::string{};
+	while (std::getline(texture_paths, texture_path)) {
+		scene.texture_paths.push_back(texture_path);
+	}
+	}
+	scene.index_type = selectIndexType(scene.sub_meshes);
+	scene.cached_mesh = std::move(file);
+
+	return true;
+}
+
+auto writeMeshCache(
+	const std::string& path,
+	const MeshCacheKey& key,
+	const SimpleObjScene& scene) -> bool {
+
+	auto header = MeshCacheHeader{};
+	header.key = key;
+	header.vertex_count = scene.vertexCount();
+	header.index_count = scene.indexCount();
+	header.vertices_offset = alignOffset(sizeof(MeshCacheHeader));
+	header.indices_offset = alignOffset(header.vertices_offset + header.vertex_count * sizeof(Vertex));
+	header.sub_mesh_count = scene.sub_meshes.size();
+	header.sub_meshes_offset = alignOffset(header.indices_offset + header.index_count * sizeof(uint32_t));
+	header.lod_count = scene.lods.size();
+	header.lods_offset = alignOffset(header.sub_meshes_offset + header.sub_mesh_count * sizeof(SubMesh));
+
+	auto texture_paths = std::string{};
+	for (const auto& texture_path : scene.texture_paths) {
+		texture_paths += texture_path + '\n';
+	}
+	header.texture_paths_size = texture_paths.size();
+	header.texture_paths_offset = alignOffset(header.lods_offset + header.lod_count * sizeof(MeshLod));
+
+	[[gsl::suppress(bounds.2)]]{
+	for (auto i = 0; i < 3; ++i) {
+		header.bounds_min[i] = scene.bounds.min[i];
+		header.bounds_max[i] = scene.bounds.max[i];
+	}
+	}
+
+	/*
+	We write into a temporary file and then replace the old cache so a crash
+	in the middle of the write never leaves a half written cache behind.
+	*/
+	const auto temporary_path = path + ".tmp";
+	{
+		auto file = std::ofstream(temporary_path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		[[gsl::suppress(type.1)]]{
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		writePadding(file, sizeof(header));
+
+		file.write(
+			reinterpret_cast<const char*>(scene.vertexData()),
+			gsl::narrow<std::streamsize>(header.vertex_count * sizeof(Vertex)));
+		writePadding(file, header.vertices_offset + header.vertex_count * sizeof(Vertex));
+
+		file.write(
+			reinterpret_cast<const char*>(scene.indexData()),
+			gsl::narrow<std::streamsize>(header.index_count * sizeof(uint32_t)));
+		writePadding(file, header.indices_offset + header.index_count * sizeof(uint32_t));
+
+		file.write(
+			reinterpret_cast<const char*>(scene.sub_meshes.data()),
+			gsl::narrow<std::streamsize>(header.sub_mesh_count * sizeof(SubMesh)));
+		writePadding(file, header.sub_meshes_offset + header.sub_mesh_count * sizeof(SubMesh));
+
+		file.write(
+			reinterpret_cast<const char*>(scene.lods.data()),
+			gsl::narrow<std::streamsize>(header.lod_count * sizeof(MeshLod)));
+		writePadding(file, header.lods_offset + header.lod_count * sizeof(MeshLod));
+
+		file.write(texture_paths.data(), gsl::narrow<std::streamsize>(texture_paths.size()));
+		}
+
+		if (!file.good()) {
+			return false;
+		}
+	}
+
+	std::remove(path.c_str());
+	if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+		std::remove(temporary_path.c_str());
+		return false;
+	}
+
+	std::cout << "\tMesh cache written to [" << path << "]" << std::endl;
+	return true;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+#include "RenderData.h"
+#include "../utils/MappedFile.h"
+
+/*
+Binary mesh cache.
+
+Parsing an .obj file and deduplicating its vertices is slow, so the first time
+we load a model we store the final vertices, indices and bounds of the mesh in a
+binary file next to it. The following launches map that file and upload the
+data straight from the mapping without parsing anything.
+
+Layout of the file (all values little endian):
+
+	MeshCacheHeader
+	padding up to MeshCacheHeader::vertices_offset
+	Vertex[vertex_count]
+	padding up to MeshCacheHeader::indices_offset
+	uint32_t[index_count]
+	padding up to MeshCacheHeader::sub_meshes_offset
+	SubMesh[sub_mesh_count]
+	padding up to MeshCacheHeader::lods_offset
+	MeshLod[lod_count]
+	padding up to MeshCacheHeader::texture_paths_offset
+	The texture path of every layer, each one ended by a '\n' (texture_paths_size bytes)
+
+The cache is only used when the hash of the source file, the hash of the
+vertex layout and the hash of the processing options (optimization passes,
+material library and the paths of its textures) match the ones stored in the
+header, so a stale cache is rebuilt instead of being used.
+*/
+
+constexpr auto mesh_cache_magic = uint32_t{ 0x434D5256 }; // "VRMC"
+constexpr auto mesh_cache_version = uint32_t{ 5 };
+
+/**
+Identifies the contents a mesh cache was built from
+*/
+struct MeshCacheKey {
+	uint64_t source_hash{};
+	uint64_t source_size{};
+	uint64_t layout_hash{};
+	uint64_t options_hash{};	// Hash of the processing options the mesh went through
+};
+
+/**
+Header at the beginning of every mesh cache file
+*/
+struct MeshCacheHeader {
+	uint32_t magic{ mesh_cache_magic };
+	uint32_t version{ mesh_cache_version };
+	MeshCacheKey key{};
+	uint64_t vertex_count{};
+	uint64_t index_count{};
+	uint64_t vertices_offset{};
+	uint64_t indices_offset{};
+	uint64_t sub_mesh_count{};
+	uint64_t sub_meshes_offset{};
+	uint64_t lod_count{};
+	uint64_t lods_offset{};
+	uint64_t texture_paths_size{};
+	uint64_t texture_paths_offset{};
+	float bounds_min[3]{};
+	float bounds_max[3]{};
+};
+
+/**
+Calculates a hash of the memory layout of our Vertex struct as seen by
+the graphics pipeline (stride, formats and offsets of every attribute).
+
+@return The hash of the vertex layout
+*/
+auto getVertexLayoutHash() noexcept -> uint64_t;
+
+/**
+Creates the key that identifies a mesh cache built from the source file provided.
+
+@param The source file (.obj) already mapped in memory
+@param Hash of the options used to process the mesh after loading it
+@return The key for the mesh cache of that source file
+*/
+auto makeMeshCacheKey(const MappedFile& source, uint64_t options_hash) noexcept -> MeshCacheKey;
+
+/**
+Maps the mesh cache file and points the scene to its vertices and indices if
+the cache is valid for the key provided. The sub-meshes and the levels of
+detail and the texture paths are copied into the scene.
+
+@param The path of the mesh cache file
+@param The key the cache must have been built with
+@param The scene that will read the mesh from the cache
+@return true if the cache was valid and the scene uses it, false otherwise
+*/
+auto loadMeshCache(
+	const std::string& path,
+	const MeshCacheKey& key,
+	SimpleObjScene& scene) -> bool;
+
+/**
+Writes the vertices, indices, sub-meshes, levels of detail, texture paths and
+bounds of the scene into a mesh cache file.
+
+@param The path of the mesh cache file
+@param The key the cache is being built with
+@param The scene with the mesh to store
+@return true if the file has been written, false otherwise
+*/
+auto writeMeshCache(
+	const std::string& path,
+	const MeshCacheKey& key,
+	const SimpleObjScene& scene) -> bool;
@@ -0,0 +1,107 @@
+#include "MeshLoader.h"
+#include <iostream>
+
+#include "MeshCache.h"
+#include "ObjParser.h"
+#include "MaterialLibrary.h"
+#include "TextureAtlas.h"
+#include "VertexDeduplicator.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Meshlet.h"
+
+auto loadMesh(
+	const std::string& object_path,
+	SimpleObjScene& scene,
+	ThreadPool& thread_pool) -> void {
+
+	scene.indices.clear();
+	scene.vertices.clear();
+	scene.sub_meshes.clear();
+	scene.meshlets.clear();
+	scene.lods.clear();
+	scene.texture_paths.clear();
+	scene.cached_mesh.close();
+
+	/*
+	If we have a valid binary cache of this mesh we read it straight from
+	the mapped file and skip the parsing of the .obj entirely.
+	*/
+	const auto cache_path = object_path + config::mesh_cache_extension;
+	const auto optimization_settings = MeshOptimizationSettings{};
+	auto cache_key = MeshCacheKey{};
+
+	if (config::mesh_cache_enabled) {
+		/*
+		The layers and texture coordinates of the vertices depend on whether the
+		material textures are used and packed into an atlas, and on the material
+		library and the textures it points to. The atlas also depends on the size
+		of every texture and the maximum size of the atlas.
+		*/
+		const auto source = MappedFile{ object_path };
+		const auto material_library = config::material_textures_enabled ? makeMaterialLibraryKey(source, object_path) : MaterialLibraryKey{};
+
+		const uint64_t material_options[] = {
+			config::material_textures_enabled ? 1u : 0u,
+			config::texture_atlas_enabled ? 1u : 0u,
+			config::texture_atlas_gutter,
+			config::texture_atlas_max_size,
+			material_library.hash };
+		auto options_hash = hashBytes(material_options, sizeof(material_options), hashMeshOptimizationSettings(optimization_settings));
+
+		if (config::texture_atlas_enabled) {
+			for (const auto& path : material_library.texture_paths) {
+				const auto size = readTextureSize(path);
+				const uint32_t texture_size[] = { size.first, size.second };
+				options_hash = hashBytes(texture_size, sizeof(texture_size), options_hash);
+			}
+		}
+
+		cache_key = makeMeshCacheKey(source, options_hash);
+
+		if (loadMeshCache(cache_path, cache_key, scene)) {
+			std::cout << "Mesh [" << object_path << "] loaded from the mesh cache with "
+				<< scene.vertexCount() << " vertices and " << scene.indexCount() << " indices" << std::endl << std::endl;
+			buildSceneMeshlets(scene, config::meshlet_max_vertices, config::meshlet_max_triangles);
+			return;
+		}
+	}
+
+	const auto model = parseObj(object_path, thread_pool);
+
+	auto material_textures = MaterialTextures{};
+	if (config::material_textures_enabled) {
+		material_textures = getMaterialTextures(model, object_path);
+		scene.texture_paths = std::move(material_textures.texture_paths);
+	}
+
+	auto mesh = deduplicateVertices(
+		model,
+		config::parallel_vertex_deduplication ? &thread_pool : nullptr,
+		material_textures.material_layers);
+
+	scene.vertices = std::move(mesh.vertices);
+	scene.indices = std::move(mesh.indices);
+
+	if (config::texture_atlas_enabled && scene.texture_paths.size() > 1) {
+		remapToAtlas(scene.vertices, packTextureAtlas(scene.texture_paths, config::texture_atlas_gutter));
+	}
+
+	optimizeMesh(scene.vertices, scene.indices, optimization_settings);
+
+	scene.sub_meshes = buildSubMeshes(scene.vertices, scene.indices, optimization_settings.split_for_short_indices);
+	scene.lods = buildLodChain(scene.vertices, scene.indices, scene.sub_meshes, optimization_settings);
+	scene.index_type = selectIndexType(scene.sub_meshes);
+
+	scene.bounds = computeMeshBounds(scene.vertices.data(), scene.vertices.size());
+
+	/*
+	Meshlets follow the order of the indices so they are cheap to rebuild
+	and they are not stored in the mesh cache.
+	*/
+	buildSceneMeshlets(scene, config::meshlet_max_vertices, config::meshlet_max_triangles);
+
+	if (config::mesh_cache_enabled && !writeMeshCache(cache_path, cache_key, scene)) {
+		std::cerr << "\tWe couldn't write the mesh cache [" << cache_path << "]" << std::endl;
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+
+#include "RenderData.h"
+#include "../utils/ThreadPool.h"
+
+/*
+CPU side loading of a mesh: read from the mesh cache when it is valid or
+parsed, deduplicated, optimized, split and simplified otherwise (writing the
+cache for the next time). It doesn't touch Vulkan so it can run in any thread.
+*/
+
+/**
+Loads the mesh of an .obj model into the scene, with the paths of the textures
+of its materials when they are enabled. The texture of the scene is not modified.
+
+@param The path to the .obj model
+@param The scene whose mesh is replaced
+@param The thread pool for the parallel parts of the parsing, it must not be
+the pool running this call
+@see MeshCache.h
+*/
+auto loadMesh(
+	const std::string& object_path,
+	SimpleObjScene& scene,
+	ThreadPool& thread_pool) -> void;
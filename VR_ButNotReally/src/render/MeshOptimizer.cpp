@@ -0,0 +1,615 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+	constexpr auto unused_vertex = std::numeric_limits<uint32_t>::max();
+
+	/**
+	Triangles that use every vertex, stored contiguously
+	*/
+	struct VertexAdjacency {
+		std::vector<uint32_t> offsets{};	// vertex_count + 1 entries
+		std::vector<uint32_t> triangles{};
+	};
+
+	auto buildAdjacency(const std::vector<uint32_t>& indices, size_t vertex_count) -> VertexAdjacency {
+
+		auto adjacency = VertexAdjacency{};
+		adjacency.offsets.assign(vertex_count + 1, 0);
+		adjacency.triangles.resize(indices.size());
+
+		for (const auto index : indices) {
+			++adjacency.offsets[index + 1];
+		}
+		for (auto i = size_t{ 1 }; i <= vertex_count; ++i) {
+			adjacency.offsets[i] += adjacency.offsets[i - 1];
+		}
+
+		auto next = std::vector<uint32_t>(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+		for (auto i = size_t{ 0 }; i < indices.size(); ++i) {
+			adjacency.triangles[next[indices[i]]++] = gsl::narrow_cast<uint32_t>(i / 3);
+		}
+
+		return adjacency;
+	}
+
+	/**
+	Simulates a FIFO vertex cache and returns how many vertices every triangle
+	had to transform. A vertex is in the cache while less than cache_size
+	misses happened after it was inserted.
+	*/
+	auto countCacheMisses(
+		const std::vector<uint32_t>& indices,
+		size_t vertex_count,
+		uint32_t cache_size) -> std::vector<uint8_t> {
+
+		auto triangle_misses = std::vector<uint8_t>(indices.size() / 3, 0);
+		auto inserted_at = std::vector<size_t>(vertex_count, 0);
+		auto misses = size_t{ 0 };
+
+		for (auto i = size_t{ 0 }; i < triangle_misses.size() * 3; ++i) {
+			const auto index = indices[i];
+			if (inserted_at[index] != 0 && misses - inserted_at[index] < cache_size) {
+				continue;
+			}
+
+			++misses;
+			inserted_at[index] = misses;
+			++triangle_misses[i / 3];
+		}
+
+		return triangle_misses;
+	}
+
+	/*
+	Resolution of every view of the CPU rasterizer used to estimate the overdraw
+	*/
+	constexpr auto overdraw_resolution = 256;
+
+	/*
+	Clusters of the overdraw pass are never smaller than this, tiny clusters
+	cost cache efficiency and don't occlude much.
+	*/
+	constexpr auto min_cluster_triangles = size_t{ 16 };
+
+	struct RasterPoint {
+		float x{};
+		float y{};
+		float depth{};
+	};
+
+	/**
+	Rasterizes the triangle on the depth buffer counting the pixels that pass the
+	depth test, the depth buffer keeps the biggest depth (closest to the viewer).
+	*/
+	auto rasterizeTriangle(
+		const RasterPoint& a,
+		const RasterPoint& b,
+		const RasterPoint& c,
+		std::vector<float>& depth_buffer) -> size_t {
+
+		const auto area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+		if (area <= 0.0f) {
+			return 0;
+		}
+
+		const auto min_x = std::max(0, static_cast<int>(std::floor(std::min({ a.x, b.x, c.x }))));
+		const auto min_y = std::max(0, static_cast<int>(std::floor(std::min({ a.y, b.y, c.y }))));
+		const auto max_x = std::min(overdraw_resolution - 1, static_cast<int>(std::ceil(std::max({ a.x, b.x, c.x }))));
+		const auto max_y = std::min(overdraw_resolution - 1, static_cast<int>(std::ceil(std::max({ a.y, b.y, c.y }))));
+
+		auto edge = [](const RasterPoint& from, const RasterPoint& to, float x, float y) noexcept {
+			return (to.x - from.x) * (y - from.y) - (to.y - from.y) * (x - from.x);
+		};
+
+		auto shaded = size_t{ 0 };
+		for (auto y = min_y; y <= max_y; ++y) {
+			for (auto x = min_x; x <= max_x; ++x) {
+				const auto center_x = x + 0.5f;
+				const auto center_y = y + 0.5f;
+				const auto w0 = edge(b, c, center_x, center_y);
+				const auto w1 = edge(c, a, center_x, center_y);
+				const auto w2 = edge(a, b, center_x, center_y);
+
+				if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+					continue;
+				}
+
+				const auto depth = (w0 * a.depth + w1 * b.depth + w2 * c.depth) / area;
+				auto& stored_depth = depth_buffer[gsl::narrow_cast<size_t>(y * overdraw_resolution + x)];
+				if (depth > stored_depth) {
+					stored_depth = depth;
+					++shaded;
+				}
+			}
+		}
+
+		return shaded;
+	}
+
+	auto triangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) noexcept -> glm::vec3 {
+		return glm::cross(b - a, c - a);
+	}
+}
+
+auto analyzeVertexCache(
+	const std::vector<uint32_t>& indices,
+	size_t vertex_count,
+	uint32_t cache_size) -> VertexCacheStatistics {
+
+	auto statistics = VertexCacheStatistics{};
+	if (indices.empty() || vertex_count == 0) {
+		return statistics;
+	}
+
+	const auto triangle_misses = countCacheMisses(indices, vertex_count, cache_size);
+	for (const auto misses : triangle_misses) {
+		statistics.transformed_vertices += misses;
+	}
+
+	auto used = std::vector<bool>(vertex_count, false);
+	auto referenced_vertices = size_t{ 0 };
+	for (const auto index : indices) {
+		if (!used[index]) {
+			used[index] = true;
+			++referenced_vertices;
+		}
+	}
+
+	statistics.acmr = static_cast<float>(statistics.transformed_vertices) / triangle_misses.size();
+	statistics.atvr = static_cast<float>(statistics.transformed_vertices) / referenced_vertices;
+	return statistics;
+}
+
+auto optimizeVertexCache(
+	std::vector<uint32_t>& indices,
+	size_t vertex_count,
+	uint32_t cache_size) -> void {
+
+	const auto triangle_count = indices.size() / 3;
+	if (triangle_count == 0 || vertex_count == 0) {
+		return;
+	}
+
+	const auto adjacency = buildAdjacency(indices, vertex_count);
+
+	/*
+	live_triangles: triangles of every vertex that are still not emitted.
+	cache_time: when the vertex entered the simulated cache.
+	dead_ends: recently used vertices to continue from when the fanning vertex
+	has nothing left to emit.
+	*/
+	auto live_triangles = std::vector<uint32_t>(vertex_count);
+	for (auto i = size_t{ 0 }; i < vertex_count; ++i) {
+		live_triangles[i] = adjacency.offsets[i + 1] - adjacency.offsets[i];
+	}
+
+	auto cache_time = std::vector<size_t>(vertex_count, 0);
+	auto emitted = std::vector<bool>(triangle_count, false);
+	auto dead_ends = std::vector<uint32_t>{};
+	auto candidates = std::vector<uint32_t>{};
+	auto result = std::vector<uint32_t>{};
+	result.reserve(indices.size());
+
+	auto time = size_t{ cache_size } + 1;
+	auto cursor = size_t{ 0 };
+	auto fanning = uint32_t{ 0 };
+
+	auto skipDeadEnd = [&]() -> uint32_t {
+		while (!dead_ends.empty()) {
+			const auto vertex = dead_ends.back();
+			dead_ends.pop_back();
+			if (live_triangles[vertex] > 0) {
+				return vertex;
+			}
+		}
+		while (cursor < vertex_count) {
+			const auto vertex = gsl::narrow_cast<uint32_t>(cursor++);
+			if (live_triangles[vertex] > 0) {
+				return vertex;
+			}
+		}
+		return unused_vertex;
+	};
+
+	while (fanning != unused_vertex) {
+		candidates.clear();
+
+		/*
+		Emit every triangle of the fanning vertex
+		*/
+		for (auto i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; ++i) {
+			const auto triangle = adjacency.triangles[i];
+			if (emitted[triangle]) {
+				continue;
+			}
+
+			for (auto corner = size_t{ 0 }; corner < 3; ++corner) {
+				const auto vertex = indices[triangle * 3 + corner];
+				result.push_back(vertex);
+				dead_ends.push_back(vertex);
+				candidates.push_back(vertex);
+				--live_triangles[vertex];
+
+				if (time - cache_time[vertex] > cache_size) {
+					cache_time[vertex] = time++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+
+		/*
+		The next fanning vertex is the candidate that will still be in the cache after
+		emitting all its triangles and that entered the cache the earliest.
+		*/
+		auto next = unused_vertex;
+		auto best_priority = -1;
+		for (const auto vertex : candidates) {
+			if (live_triangles[vertex] == 0) {
+				continue;
+			}
+
+			auto priority = 0;
+			const auto age = time - cache_time[vertex];
+			if (age + 2 * live_triangles[vertex] <= cache_size) {
+				priority = gsl::narrow_cast<int>(age);
+			}
+
+			if (priority > best_priority) {
+				best_priority = priority;
+				next = vertex;
+			}
+		}
+
+		fanning = next != unused_vertex ? next : skipDeadEnd();
+	}
+
+	indices = std::move(result);
+}
+
+auto analyzeOverdraw(
+	const std::vector<Vertex>& vertices,
+	const std::vector<uint32_t>& indices) -> OverdrawStatistics {
+
+	auto statistics = OverdrawStatistics{};
+	if (indices.empty() || vertices.empty()) {
+		return statistics;
+	}
+
+	const auto bounds = computeMeshBounds(vertices.data(), vertices.size());
+	const auto extent = bounds.max - bounds.min;
+	const auto scale = (overdraw_resolution - 1) / std::max({ extent.x, extent.y, extent.z, 1e-6f });
+	const auto lowest_depth = -std::numeric_limits<float>::max();
+	auto depth_buffer = std::vector<float>{};
+
+	/*
+	For every axis we look at the mesh from the positive and the negative side.
+	The other two axes are taken in cyclic order (x -> y, z) so a counter
+	clockwise triangle facing the viewer on the positive side has a positive
+	area and the depth grows towards the viewer.
+	*/
+	for (auto axis = 0; axis < 3; ++axis) {
+		const auto u_axis = (axis + 1) % 3;
+		const auto v_axis = (axis + 2) % 3;
+
+		for (const auto side : { 1.0f, -1.0f }) {
+			depth_buffer.assign(overdraw_resolution * overdraw_resolution, lowest_depth);
+
+			auto project = [&](const Vertex& vertex) noexcept {
+				const auto position = (vertex.pos - bounds.min) * scale;
+				/*
+				Looking from the negative side mirrors the image, which
+				also flips the winding of the triangles.
+				*/
+				return RasterPoint{
+					side > 0.0f ? position[u_axis] : (overdraw_resolution - 1) - position[u_axis],
+					position[v_axis],
+					side * position[axis] };
+			};
+
+			for (auto i = size_t{ 0 }; i + 2 < indices.size(); i += 3) {
+				statistics.pixels_shaded += rasterizeTriangle(
+					project(vertices[indices[i + 0]]),
+					project(vertices[indices[i + 1]]),
+					project(vertices[indices[i + 2]]),
+					depth_buffer);
+			}
+
+			for (const auto depth : depth_buffer) {
+				if (depth != lowest_depth) {
+					++statistics.pixels_covered;
+				}
+			}
+		}
+	}
+
+	statistics.overdraw = statistics.pixels_covered == 0 ?
+		0.0f :
+		static_cast<float>(statistics.pixels_shaded) / statistics.pixels_covered;
+
+	return statistics;
+}
+
+auto optimizeOverdraw(
+	const std::vector<Vertex>& vertices,
+	std::vector<uint32_t>& indices,
+	uint32_t cache_size,
+	float threshold) -> void {
+
+	const auto triangle_count = indices.size() / 3;
+	if (triangle_count <= min_cluster_triangles || vertices.empty()) {
+		return;
+	}
+
+	const auto triangle_misses = countCacheMisses(indices, vertices.size(), cache_size);
+
+	/*
+	Hard boundaries: triangles that transform all their vertices, the cache is
+	cold there so starting a new cluster costs nothing.
+	*/
+	auto hard_boundaries = std::vector<size_t>{};
+	for (auto triangle = size_t{ 0 }; triangle < triangle_count; ++triangle) {
+		if (triangle == 0 || triangle_misses[triangle] == 3) {
+			hard_boundaries.push_back(triangle);
+		}
+	}
+	hard_boundaries.push_back(triangle_count);
+
+	/*
+	Soft boundaries: inside every hard cluster we start a new cluster as soon as
+	the ACMR of the current one is within the threshold of the hard cluster ACMR.
+	*/
+	auto clusters = std::vector<size_t>{};
+	for (auto i = size_t{ 0 }; i + 1 < hard_boundaries.size(); ++i) {
+		const auto begin = hard_boundaries[i];
+		const auto end = hard_boundaries[i + 1];
+
+		auto hard_misses = size_t{ 0 };
+		for (auto triangle = begin; triangle < end; ++triangle) {
+			hard_misses += triangle_misses[triangle];
+		}
+		const auto hard_acmr = static_cast<float>(hard_misses) / (end - begin);
+
+		/*
+		Clusters smaller than the minimum are merged with the previous one
+		*/
+		if (clusters.empty() || begin - clusters.back() >= min_cluster_triangles) {
+			clusters.push_back(begin);
+		}
+
+		auto cluster_misses = size_t{ 0 };
+		for (auto triangle = begin; triangle < end; ++triangle) {
+			cluster_misses += triangle_misses[triangle];
+			const auto cluster_size = triangle + 1 - clusters.back();
+
+			if (cluster_size >= min_cluster_triangles &&
+				end - (triangle + 1) >= min_cluster_triangles &&
+				static_cast<float>(cluster_misses) / cluster_size <= threshold * hard_acmr) {
+				clusters.push_back(triangle + 1);
+				cluster_misses = 0;
+			}
+		}
+	}
+	clusters.push_back(triangle_count);
+
+	/*
+	Area weighted centroid and normal of every cluster and of the whole mesh
+	*/
+	struct Cluster {
+		size_t begin{};
+		size_t end{};
+		glm::vec3 centroid{};
+		glm::vec3 normal{};
+		float area{};
+		float sort_key{};
+	};
+
+	auto sorted_clusters = std::vector<Cluster>{};
+	sorted_clusters.reserve(clusters.size() - 1);
+	auto mesh_centroid = glm::vec3(0.0f);
+	auto mesh_area = 0.0f;
+
+	for (auto i = size_t{ 0 }; i + 1 < clusters.size(); ++i) {
+		auto cluster = Cluster{};
+		cluster.begin = clusters[i];
+		cluster.end = clusters[i + 1];
+
+		for (auto triangle = cluster.begin; triangle < cluster.end; ++triangle) {
+			const auto& a = vertices[indices[triangle * 3 + 0]].pos;
+			const auto& b = vertices[indices[triangle * 3 + 1]].pos;
+			const auto& c = vertices[indices[triangle * 3 + 2]].pos;
+
+			const auto normal = triangleNormal(a, b, c);
+			const auto area = glm::length(normal) * 0.5f;
+
+			cluster.normal += normal;
+			cluster.centroid += (a + b + c) * (area / 3.0f);
+			cluster.area += area;
+		}
+
+		mesh_centroid += cluster.centroid;
+		mesh_area += cluster.area;
+		sorted_clusters.push_back(cluster);
+	}
+
+	if (mesh_area > 0.0f) {
+		mesh_centroid /= mesh_area;
+	}
+
+	/*
+	Clusters far from the center of the mesh that face away from it are on the
+	outer side and get drawn first.
+	*/
+	for (auto& cluster : sorted_clusters) {
+		if (cluster.area > 0.0f) {
+			cluster.centroid /= cluster.area;
+		}
+
+		const auto normal_length = glm::length(cluster.normal);
+		const auto normal = normal_length > 0.0f ? cluster.normal / normal_length : glm::vec3(0.0f);
+		cluster.sort_key = glm::dot(cluster.centroid - mesh_centroid, normal);
+	}
+
+	std::stable_sort(sorted_clusters.begin(), sorted_clusters.end(), [](const Cluster& a, const Cluster& b) {
+		return a.sort_key > b.sort_key;
+	});
+
+	auto result = std::vector<uint32_t>{};
+	result.reserve(indices.size());
+	for (const auto& cluster : sorted_clusters) {
+		result.insert(result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+	}
+
+	indices = std::move(result);
+}
+
+auto optimizeVertexFetch(
+	std::vector<Vertex>& vertices,
+	std::vector<uint32_t>& indices) -> void {
+
+	auto remap = std::vector<uint32_t>(vertices.size(), unused_vertex);
+	auto reordered = std::vector<Vertex>{};
+	reordered.reserve(vertices.size());
+
+	for (auto& index : indices) {
+		if (remap[index] == unused_vertex) {
+			remap[index] = gsl::narrow<uint32_t>(reordered.size());
+			reordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	vertices = std::move(reordered);
+}
+
+auto buildSubMeshes(
+	std::vector<Vertex>& vertices,
+	std::vector<uint32_t>& indices,
+	bool split_for_short_indices) -> std::vector<SubMesh> {
+
+	if (!split_for_short_indices || vertices.size() <= max_short_index_vertices) {
+		auto sub_mesh = SubMesh{};
+		sub_mesh.index_count = gsl::narrow<uint32_t>(indices.size());
+		sub_mesh.vertex_count = gsl::narrow<uint32_t>(vertices.size());
+		return { sub_mesh };
+	}
+
+	auto sub_meshes = std::vector<SubMesh>{};
+	auto split_vertices = std::vector<Vertex>{};
+	auto split_indices = std::vector<uint32_t>{};
+	split_vertices.reserve(vertices.size());
+	split_indices.reserve(indices.size());
+
+	/*
+	owner: last sub-mesh that copied the vertex, local: its index in that sub-mesh
+	*/
+	auto owner = std::vector<uint32_t>(vertices.size(), unused_vertex);
+	auto local = std::vector<uint32_t>(vertices.size(), 0);
+	auto current = SubMesh{};
+	auto current_id = uint32_t{ 0 };
+
+	for (auto i = size_t{ 0 }; i + 2 < indices.size(); i += 3) {
+		const uint32_t triangle[] = { indices[i + 0], indices[i + 1], indices[i + 2] };
+
+		auto new_vertices = size_t{ 0 };
+		for (auto corner = 0; corner < 3; ++corner) {
+			const auto vertex = triangle[corner];
+			const auto repeated = (corner > 0 && triangle[0] == vertex) || (corner > 1 && triangle[1] == vertex);
+			if (owner[vertex] != current_id && !repeated) {
+				++new_vertices;
+			}
+		}
+
+		if (current.vertex_count + new_vertices > max_short_index_vertices) {
+			sub_meshes.push_back(current);
+			++current_id;
+			current = SubMesh{};
+			current.first_index = gsl::narrow<uint32_t>(split_indices.size());
+			current.vertex_offset = gsl::narrow<int32_t>(split_vertices.size());
+		}
+
+		for (const auto vertex : triangle) {
+			if (owner[vertex] != current_id) {
+				owner[vertex] = current_id;
+				local[vertex] = current.vertex_count++;
+				split_vertices.push_back(vertices[vertex]);
+			}
+			split_indices.push_back(local[vertex]);
+		}
+		current.index_count += 3;
+	}
+	sub_meshes.push_back(current);
+
+	std::cout << "\tMesh split in " << sub_meshes.size() << " sub-meshes for 16 bit indices ("
+		<< split_vertices.size() - vertices.size() << " vertices duplicated)" << std::endl << std::endl;
+
+	vertices = std::move(split_vertices);
+	indices = std::move(split_indices);
+	return sub_meshes;
+}
+
+auto hashMeshOptimizationSettings(const MeshOptimizationSettings& settings) noexcept -> uint64_t {
+
+	const auto floatBits = [](float value) noexcept {
+		auto bits = uint32_t{};
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	};
+
+	const uint64_t values[] = {
+		settings.enabled ? 1u : 0u,
+		settings.vertex_cache_size,
+		settings.overdraw_enabled ? 1u : 0u,
+		floatBits(settings.overdraw_threshold),
+		settings.split_for_short_indices ? 1u : 0u,
+		settings.lod_enabled ? 1u : 0u,
+		settings.lod_max_levels,
+		floatBits(settings.lod_reduction),
+		floatBits(settings.lod_max_error)
+	};
+
+	return hashBytes(values, sizeof(values));
+}
+
+auto optimizeMesh(
+	std::vector<Vertex>& vertices,
+	std::vector<uint32_t>& indices,
+	const MeshOptimizationSettings& settings) -> void {
+
+	auto printStatistics = [&](const char* stage) {
+		const auto statistics = analyzeVertexCache(indices, vertices.size(), settings.vertex_cache_size);
+		const auto overdraw = analyzeOverdraw(vertices, indices);
+		std::cout << "\t\t" << stage << std::fixed << std::setprecision(3)
+			<< "ACMR " << statistics.acmr << ", ATVR " << statistics.atvr
+			<< ", overdraw " << overdraw.overdraw << std::endl;
+	};
+
+	/*
+	We still report the efficiency of the mesh as loaded so both
+	settings can be compared.
+	*/
+	if (!settings.enabled) {
+		std::cout << "\tMesh optimization disabled" << std::endl;
+		printStatistics("Loaded: ");
+		std::cout << std::endl;
+		return;
+	}
+
+	std::cout << "\tOptimizing mesh with " << indices.size() / 3 << " triangles" << std::endl;
+	printStatistics("Before: ");
+
+	optimizeVertexCache(indices, vertices.size(), settings.vertex_cache_size);
+	if (settings.overdraw_enabled) {
+		optimizeOverdraw(vertices, indices, settings.vertex_cache_size, settings.overdraw_threshold);
+	}
+	optimizeVertexFetch(vertices, indices);
+
+	printStatistics("After:  ");
+	std::cout << "\tMesh Optimized" << std::endl << std::endl;
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "RenderData.h"
+#include "../Configuration.h"
+
+/*
+Mesh optimization passes run on the deduplicated meshes before they are
+uploaded (and stored in the mesh cache).
+
+	- optimizeVertexCache: Reorders the triangles so the vertices recently
+	transformed by the GPU are reused as much as possible (Tipsify).
+	- optimizeOverdraw: Splits the cache optimized triangles in clusters and
+	sorts the clusters so the ones likely to occlude others are drawn first.
+	- optimizeVertexFetch: Reorders the vertices in the order the triangles use
+	them for the first time so the vertex fetches are mostly sequential.
+
+Tipsify and the clustering of the overdraw pass are described in "Fast
+Triangle Reordering for Vertex Locality and Reduced Overdraw" (Sander, Nehab
+and Barczak, SIGGRAPH 2007).
+*/
+
+/**
+Settings of the optimization passes applied to every mesh
+*/
+struct MeshOptimizationSettings {
+	bool enabled{ config::mesh_optimization_enabled };
+	uint32_t vertex_cache_size{ config::vertex_cache_size };
+	bool overdraw_enabled{ config::overdraw_optimization_enabled };
+	float overdraw_threshold{ config::overdraw_threshold };
+	bool split_for_short_indices{ config::split_for_short_indices };
+	bool lod_enabled{ config::lod_enabled };
+	uint32_t lod_max_levels{ config::lod_max_levels };
+	float lod_reduction{ config::lod_reduction };
+	float lod_max_error{ config::lod_max_error };
+};
+
+/**
+Efficiency of an index buffer with a FIFO post transform vertex cache
+*/
+struct VertexCacheStatistics {
+	size_t transformed_vertices{};
+	float acmr{};	// Average cache miss ratio, transformed vertices per triangle (0.5 - 3.0)
+	float atvr{};	// Average transformed vertex ratio, transformed vertices per vertex (1.0 - 6.0)
+};
+
+/**
+Overdraw of a mesh rendered with depth test and back face culling
+*/
+struct OverdrawStatistics {
+	size_t pixels_covered{};
+	size_t pixels_shaded{};
+	float overdraw{};	// Shaded pixels per covered pixel, 1.0 is no overdraw at all
+};
+
+/**
+Simulates a FIFO post transform vertex cache rendering the indices provided.
+
+@param The indices of the triangles
+@param The amount of vertices the indices point to
+@param The amount of entries of the simulated cache
+@return The statistics of the simulation
+*/
+auto analyzeVertexCache(
+	const std::vector<uint32_t>& indices,
+	size_t vertex_count,
+	uint32_t cache_size) -> VertexCacheStatistics;
+
+/**
+Reorders the triangles of the index buffer to improve the hit rate of the post
+transform vertex cache. The triangles keep the winding of their corners.
+
+@param The indices of the triangles, they are reordered in place
+@param The amount of vertices the indices point to
+@param The amount of entries of the cache we optimize for
+*/
+auto optimizeVertexCache(
+	std::vector<uint32_t>& indices,
+	size_t vertex_count,
+	uint32_t cache_size) -> void;
+
+/**
+Estimates the overdraw of the mesh rasterizing it on the CPU, in the order of
+the indices, from the 6 axis aligned directions with an orthographic projection.
+
+@param The vertices of the mesh
+@param The indices of the triangles
+@return The statistics of all the directions together
+*/
+auto analyzeOverdraw(
+	const std::vector<Vertex>& vertices,
+	const std::vector<uint32_t>& indices) -> OverdrawStatistics;
+
+/**
+Reorders the triangles to reduce overdraw keeping most of the vertex cache
+efficiency. The indices should already be optimized for the vertex cache.
+
+The triangles are split in clusters where the vertex cache starts cold anyway
+and, inside those, where the ACMR of the cluster so far is not worse than
+threshold times the ACMR of the whole cold cluster. The clusters are then sorted
+by how much they face away from the center of the mesh, the ones on the outer
+side of the mesh are more likely to hide the others.
+
+@param The vertices of the mesh
+@param The indices of the triangles, they are reordered in place
+@param The amount of entries of the vertex cache
+@param Values above 1.0 allow more clusters (less overdraw) at a higher ACMR,
+1.05 allows 5% more cache misses in every cluster
+*/
+auto optimizeOverdraw(
+	const std::vector<Vertex>& vertices,
+	std::vector<uint32_t>& indices,
+	uint32_t cache_size,
+	float threshold) -> void;
+
+/**
+Reorders the vertices in the order in which the indices reference them for the
+first time and updates the indices. Vertices not referenced are removed.
+
+@param The vertices, they are reordered in place
+@param The indices, they are remapped in place
+*/
+auto optimizeVertexFetch(
+	std::vector<Vertex>& vertices,
+	std::vector<uint32_t>& indices) -> void;
+
+/**
+Creates the sub-meshes the mesh is drawn with. Meshes with more vertices than
+16 bit indices can address are optionally split, in the order of the triangles,
+in sub-meshes that each fit. Vertices shared by two sub-meshes are duplicated
+and the indices are rewritten relative to the sub-mesh they belong to.
+
+@param The vertices, they are rewritten if the mesh is split
+@param The indices, they are rewritten if the mesh is split
+@param Whether to split the meshes that don't fit in 16 bit indices
+@return The sub-meshes, just one when the mesh is not split
+*/
+auto buildSubMeshes(
+	std::vector<Vertex>& vertices,
+	std::vector<uint32_t>& indices,
+	bool split_for_short_indices) -> std::vector<SubMesh>;
+
+/**
+Calculates a hash of the settings, meshes processed with different
+settings must not share a mesh cache.
+
+@param The settings to hash
+@return The hash of the settings
+*/
+auto hashMeshOptimizationSettings(const MeshOptimizationSettings& settings) noexcept -> uint64_t;
+
+/**
+Runs every enabled optimization pass over the mesh and prints the
+efficiency of the vertex cache and the overdraw before and after them.
+
+@param The vertices of the mesh, they are reordered in place
+@param The indices of the mesh, they are reordered in place
+@param The settings of the passes
+*/
+auto optimizeMesh(
+	std::vector<Vertex>& vertices,
+	std::vector<uint32_t>& indices,
+	const MeshOptimizationSettings& settings) -> void;
@@ -0,0 +1,455 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <unordered_map>
+#include <limits>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+namespace {
+
+	constexpr auto no_vertex = std::numeric_limits<uint32_t>::max();
+
+	/*
+	Every level must have at least this fraction less indices than the
+	previous one, otherwise the chain ends.
+	*/
+	constexpr auto min_lod_reduction = 0.1f;
+
+	/**
+	Sum of the squared distances to a set of planes, weighted by the area of
+	the triangle every plane comes from. Stored as the symmetric 4x4 matrix
+	(A b; b c) so the error at p is p'Ap + 2b'p + c.
+	*/
+	struct Quadric {
+		double a00{}, a11{}, a22{}, a01{}, a02{}, a12{};
+		double b0{}, b1{}, b2{};
+		double c{};
+		double weight{};
+
+		auto operator+=(const Quadric& other) noexcept -> Quadric& {
+			a00 += other.a00; a11 += other.a11; a22 += other.a22;
+			a01 += other.a01; a02 += other.a02; a12 += other.a12;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+			weight += other.weight;
+			return *this;
+		}
+
+		/**
+		Weighted average of the squared distances from the point to the planes
+		*/
+		auto error(const glm::vec3& point) const noexcept -> double {
+			const auto x = double{ point.x };
+			const auto y = double{ point.y };
+			const auto z = double{ point.z };
+
+			const auto distance =
+				a00 * x * x + a11 * y * y + a22 * z * z +
+				2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+				2.0 * (b0 * x + b1 * y + b2 * z) +
+				c;
+
+			return weight > 0.0 ? std::max(distance, 0.0) / weight : 0.0;
+		}
+	};
+
+	auto makePlaneQuadric(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) noexcept -> Quadric {
+
+		const auto normal = glm::cross(b - a, c - a);
+		const auto length = glm::length(normal);
+
+		auto quadric = Quadric{};
+		if (length == 0.0f) {
+			return quadric;
+		}
+
+		const auto nx = double{ normal.x } / length;
+		const auto ny = double{ normal.y } / length;
+		const auto nz = double{ normal.z } / length;
+		const auto d = -(nx * a.x + ny * a.y + nz * a.z);
+		const auto area = double{ length } * 0.5;
+
+		quadric.a00 = area * nx * nx; quadric.a11 = area * ny * ny; quadric.a22 = area * nz * nz;
+		quadric.a01 = area * nx * ny; quadric.a02 = area * nx * nz; quadric.a12 = area * ny * nz;
+		quadric.b0 = area * nx * d; quadric.b1 = area * ny * d; quadric.b2 = area * nz * d;
+		quadric.c = area * d * d;
+		quadric.weight = area;
+		return quadric;
+	}
+
+	/**
+	Marks the vertices that can be moved: the ones that are the only vertex
+	at their position (not on a seam of the attributes) and whose edges are
+	all shared by exactly two triangles (not on a border).
+	*/
+	auto findMovableVertices(
+		const Vertex* vertices,
+		size_t vertex_count,
+		const std::vector<uint32_t>& indices) -> std::vector<bool> {
+
+		auto movable = std::vector<bool>(vertex_count, true);
+
+		/*
+		Vertices that share the position with another one are on a seam, the
+		edges are compared between the first vertex of every position.
+		*/
+		auto position_owner = std::vector<uint32_t>(vertex_count, no_vertex);
+		{
+			auto first_at_position = std::unordered_map<glm::vec3, uint32_t>{};
+			first_at_position.reserve(vertex_count);
+
+			[[gsl::suppress(bounds.1)]]{
+			for (auto i = uint32_t{ 0 }; i < vertex_count; ++i) {
+				/*
+				Adding 0 turns -0 into 0, they compare equal but don't hash equal
+				*/
+				const auto result = first_at_position.emplace(vertices[i].pos + glm::vec3(0.0f), i);
+				position_owner[i] = result.first->second;
+				if (!result.second) {
+					movable[i] = false;
+					movable[result.first->second] = false;
+				}
+			}
+			}
+		}
+
+		auto edges = std::unordered_map<uint64_t, uint32_t>{};
+		edges.reserve(indices.size());
+
+		const auto edgeKey = [](uint32_t from, uint32_t to) noexcept {
+			return (uint64_t{ from } << 32) | to;
+		};
+
+		for (auto i = size_t{ 0 }; i + 2 < indices.size(); i += 3) {
+			for (auto corner = 0; corner < 3; ++corner) {
+				const auto from = position_owner[indices[i + corner]];
+				const auto to = position_owner[indices[i + (corner + 1) % 3]];
+				++edges[edgeKey(from, to)];
+			}
+		}
+
+		for (auto i = size_t{ 0 }; i + 2 < indices.size(); i += 3) {
+			for (auto corner = 0; corner < 3; ++corner) {
+				const auto from = position_owner[indices[i + corner]];
+				const auto to = position_owner[indices[i + (corner + 1) % 3]];
+				const auto opposite = edges.find(edgeKey(to, from));
+
+				if (edges[edgeKey(from, to)] != 1 || opposite == edges.end() || opposite->second != 1) {
+					movable[indices[i + corner]] = false;
+					movable[indices[i + (corner + 1) % 3]] = false;
+				}
+			}
+		}
+
+		return movable;
+	}
+
+	/**
+	Moving vertex to target must not turn around any of the triangles that
+	remain, the ones that use vertex but not target.
+	*/
+	auto collapseFlipsTriangles(
+		const Vertex* vertices,
+		const std::vector<uint32_t>& indices,
+		const std::vector<uint32_t>& triangles,
+		uint32_t vertex,
+		uint32_t target) noexcept -> bool {
+
+		[[gsl::suppress(bounds.1)]]{
+		const auto& new_position = vertices[target].pos;
+
+		for (const auto triangle : triangles) {
+			const uint32_t corners[] = { indices[triangle * 3 + 0], indices[triangle * 3 + 1], indices[triangle * 3 + 2] };
+			if (corners[0] == target || corners[1] == target || corners[2] == target) {
+				continue;
+			}
+
+			glm::vec3 before[3];
+			glm::vec3 after[3];
+			for (auto corner = 0; corner < 3; ++corner) {
+				before[corner] = vertices[corners[corner]].pos;
+				after[corner] = corners[corner] == vertex ? new_position : before[corner];
+			}
+
+			const auto normal_before = glm::cross(before[1] - before[0], before[2] - before[0]);
+			const auto normal_after = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+			if (glm::dot(normal_before, normal_after) <= 0.0f) {
+				return true;
+			}
+		}
+		}
+
+		return false;
+	}
+
+	struct Collapse {
+		uint32_t vertex{};
+		uint32_t target{};
+		double error{};	// Squared distance
+	};
+}
+
+auto simplifyMesh(
+	const Vertex* vertices,
+	size_t vertex_count,
+	const std::vector<uint32_t>& indices,
+	size_t target_index_count,
+	float max_error) -> SimplifiedMesh {
+
+	auto result = SimplifiedMesh{};
+	result.indices = indices;
+
+	if (indices.size() <= target_index_count) {
+		return result;
+	}
+
+	const auto movable = findMovableVertices(vertices, vertex_count, indices);
+
+	auto quadrics = std::vector<Quadric>(vertex_count);
+	[[gsl::suppress(bounds.1)]]{
+	for (auto i = size_t{ 0 }; i + 2 < indices.size(); i += 3) {
+		const auto quadric = makePlaneQuadric(
+			vertices[indices[i + 0]].pos,
+			vertices[indices[i + 1]].pos,
+			vertices[indices[i + 2]].pos);
+
+		for (auto corner = 0; corner < 3; ++corner) {
+			quadrics[indices[i + corner]] += quadric;
+		}
+	}
+	}
+
+	const auto max_squared_error = double{ max_error } * max_error;
+	auto collapses = std::vector<Collapse>{};
+	auto remap = std::vector<uint32_t>(vertex_count);
+	auto locked = std::vector<bool>(vertex_count);
+	auto vertex_triangles = std::vector<std::vector<uint32_t>>(vertex_count);
+
+	/*
+	Every pass picks the best collapse of every movable vertex and applies, from
+	the cheapest, the ones that don't touch the triangles of a previous collapse
+	of the same pass (their costs and flip checks would be stale).
+	*/
+	while (result.indices.size() > target_index_count) {
+
+		for (auto& triangles : vertex_triangles) {
+			triangles.clear();
+		}
+		for (auto i = size_t{ 0 }; i < result.indices.size(); ++i) {
+			vertex_triangles[result.indices[i]].push_back(gsl::narrow_cast<uint32_t>(i / 3));
+		}
+
+		collapses.clear();
+		for (auto vertex = uint32_t{ 0 }; vertex < vertex_count; ++vertex) {
+			if (!movable[vertex] || vertex_triangles[vertex].empty()) {
+				continue;
+			}
+
+			auto best = Collapse{ vertex, no_vertex, std::numeric_limits<double>::max() };
+			for (const auto triangle : vertex_triangles[vertex]) {
+				for (auto corner = 0; corner < 3; ++corner) {
+					const auto target = result.indices[triangle * 3 + corner];
+					if (target == vertex || target == best.target) {
+						continue;
+					}
+
+					[[gsl::suppress(bounds.1)]]{
+					const auto error = quadrics[vertex].error(vertices[target].pos);
+					if (error < best.error && !collapseFlipsTriangles(vertices, result.indices, vertex_triangles[vertex], vertex, target)) {
+						best.target = target;
+						best.error = error;
+					}
+					}
+				}
+			}
+
+			if (best.target != no_vertex && best.error <= max_squared_error) {
+				collapses.push_back(best);
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) noexcept {
+			return a.error < b.error;
+		});
+
+		for (auto i = uint32_t{ 0 }; i < vertex_count; ++i) {
+			remap[i] = i;
+		}
+		std::fill(locked.begin(), locked.end(), false);
+
+		const auto triangles_to_remove = (result.indices.size() - target_index_count) / 3;
+		auto triangles_removed = size_t{ 0 };
+		auto collapses_applied = size_t{ 0 };
+
+		for (const auto& collapse : collapses) {
+			if (triangles_removed >= triangles_to_remove) {
+				break;
+			}
+			if (locked[collapse.vertex] || locked[collapse.target]) {
+				continue;
+			}
+
+			remap[collapse.vertex] = collapse.target;
+			quadrics[collapse.target] += quadrics[collapse.vertex];
+			result.error = std::max(result.error, gsl::narrow_cast<float>(std::sqrt(collapse.error)));
+			++collapses_applied;
+
+			for (const auto triangle : vertex_triangles[collapse.vertex]) {
+				auto has_target = false;
+				for (auto corner = 0; corner < 3; ++corner) {
+					const auto index = result.indices[triangle * 3 + corner];
+					locked[index] = true;
+					has_target = has_target || index == collapse.target;
+				}
+				triangles_removed += has_target ? 1 : 0;
+			}
+		}
+
+		if (collapses_applied == 0) {
+			break;
+		}
+
+		/*
+		The triangles that had the collapsed edge are now degenerate
+		*/
+		auto write = size_t{ 0 };
+		for (auto i = size_t{ 0 }; i + 2 < result.indices.size(); i += 3) {
+			const auto a = remap[result.indices[i + 0]];
+			const auto b = remap[result.indices[i + 1]];
+			const auto c = remap[result.indices[i + 2]];
+
+			if (a != b && b != c && a != c) {
+				result.indices[write++] = a;
+				result.indices[write++] = b;
+				result.indices[write++] = c;
+			}
+		}
+		result.indices.resize(write);
+	}
+
+	return result;
+}
+
+auto buildLodChain(
+	const std::vector<Vertex>& vertices,
+	std::vector<uint32_t>& indices,
+	std::vector<SubMesh>& sub_meshes,
+	const MeshOptimizationSettings& settings) -> std::vector<MeshLod> {
+
+	auto lods = std::vector<MeshLod>(1);
+	lods[0].sub_mesh_count = gsl::narrow<uint32_t>(sub_meshes.size());
+
+	if (!settings.lod_enabled || vertices.empty()) {
+		return lods;
+	}
+
+	std::cout << "\tBuilding levels of detail" << std::endl;
+
+	const auto bounds = computeMeshBounds(vertices.data(), vertices.size());
+	const auto max_error = settings.lod_max_error * glm::length(bounds.max - bounds.min);
+
+	/*
+	Every level is simplified from the full mesh so its error is measured
+	against the original surface.
+	*/
+	const auto full_sub_meshes = sub_meshes;
+	auto previous_index_count = indices.size();
+
+	for (auto level = 1u; level < settings.lod_max_levels; ++level) {
+
+		const auto ratio = std::pow(settings.lod_reduction, gsl::narrow_cast<float>(level));
+		auto lod = MeshLod{};
+		lod.first_sub_mesh = gsl::narrow<uint32_t>(sub_meshes.size());
+
+		const auto first_new_index = indices.size();
+		auto level_index_count = size_t{ 0 };
+
+		for (const auto& sub_mesh : full_sub_meshes) {
+			const auto begin = indices.begin() + sub_mesh.first_index;
+			const auto full_indices = std::vector<uint32_t>(begin, begin + sub_mesh.index_count);
+			const auto target_index_count = gsl::narrow_cast<size_t>(sub_mesh.index_count * ratio) / 3 * 3;
+
+			auto simplified = simplifyMesh(
+				vertices.data() + sub_mesh.vertex_offset,
+				sub_mesh.vertex_count,
+				full_indices,
+				target_index_count,
+				max_error);
+
+			if (settings.enabled) {
+				optimizeVertexCache(simplified.indices, sub_mesh.vertex_count, settings.vertex_cache_size);
+			}
+
+			auto lod_sub_mesh = sub_mesh;
+			lod_sub_mesh.first_index = gsl::narrow<uint32_t>(indices.size());
+			lod_sub_mesh.index_count = gsl::narrow<uint32_t>(simplified.indices.size());
+			sub_meshes.push_back(lod_sub_mesh);
+			indices.insert(indices.end(), simplified.indices.begin(), simplified.indices.end());
+
+			lod.error = std::max(lod.error, simplified.error);
+			level_index_count += simplified.indices.size();
+		}
+
+		if (level_index_count > previous_index_count * (1.0f - min_lod_reduction)) {
+			indices.resize(first_new_index);
+			sub_meshes.resize(lod.first_sub_mesh);
+			break;
+		}
+
+		lod.sub_mesh_count = gsl::narrow<uint32_t>(sub_meshes.size()) - lod.first_sub_mesh;
+		lods.push_back(lod);
+		previous_index_count = level_index_count;
+
+		std::cout << "\t\tLevel " << level << ": " << level_index_count / 3 << " triangles, error "
+			<< std::fixed << std::setprecision(5) << lod.error << std::endl;
+	}
+
+	std::cout << "\t" << lods.size() << " Levels of detail built" << std::endl << std::endl;
+
+	return lods;
+}
+
+auto selectLod(
+	const std::vector<MeshLod>& lods,
+	const MeshBounds& bounds,
+	const glm::mat4& model,
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	float viewport_height,
+	float error_threshold) noexcept -> uint32_t {
+
+	if (lods.size() <= 1) {
+		return 0;
+	}
+
+	/*
+	The error of a level is projected at the point of the bounding sphere of
+	the mesh closest to the camera, the worst case for the whole mesh.
+	*/
+	const auto scale = std::max({
+		glm::length(glm::vec3(model[0])),
+		glm::length(glm::vec3(model[1])),
+		glm::length(glm::vec3(model[2])) });
+
+	const auto center = (bounds.min + bounds.max) * 0.5f;
+	const auto radius = glm::length(bounds.max - bounds.min) * 0.5f * scale;
+	const auto view_center = view * model * glm::vec4(center, 1.0f);
+	const auto distance = -view_center.z - radius;
+
+	if (distance <= 0.0f) {
+		return 0;
+	}
+
+	const auto pixels_per_unit = std::abs(projection[1][1]) * viewport_height * 0.5f / distance;
+
+	for (auto level = gsl::narrow<uint32_t>(lods.size()) - 1; level > 0; --level) {
+		[[gsl::suppress(bounds.4)]]{
+		if (lods[level].error * scale * pixels_per_unit <= error_threshold) {
+			return level;
+		}
+		}
+	}
+	return 0;
+}
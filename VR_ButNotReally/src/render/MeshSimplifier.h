@@ -0,0 +1,88 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "RenderData.h"
+#include "MeshOptimizer.h"
+
+/*
+Mesh simplification and levels of detail.
+
+The simplified levels only have new indices, they reuse the vertices of the
+full mesh so the whole chain shares the vertex buffer and the levels are
+stored one after the other in the index buffer.
+
+The simplification collapses edges moving one vertex onto one of its neighbours
+picking the collapses that add less error as measured by the quadrics of the
+planes of the triangles around every vertex, from "Surface Simplification
+Using Quadric Error Metrics" (Garland and Heckbert, SIGGRAPH 1997). Only
+vertices inside a continuous part of the surface are moved, the ones on open
+borders or on seams of the attributes (texture coordinates) stay where they
+are so the silhouette and the texture mapping are kept.
+*/
+
+/**
+Indices of a simplified mesh
+*/
+struct SimplifiedMesh {
+	std::vector<uint32_t> indices{};
+	float error{};	// Biggest distance from the collapsed vertices to the original surface
+};
+
+/**
+Simplifies the mesh until it has target_index_count indices or until the
+next collapse would add more than max_error.
+
+@param The vertices of the mesh
+@param The amount of vertices
+@param The indices of the mesh
+@param The amount of indices we would like to reach
+@param The maximum error, in object space, of any collapse
+@return The indices of the simplified mesh and the error of the simplification
+*/
+auto simplifyMesh(
+	const Vertex* vertices,
+	size_t vertex_count,
+	const std::vector<uint32_t>& indices,
+	size_t target_index_count,
+	float max_error) -> SimplifiedMesh;
+
+/**
+Builds the levels of detail of the mesh. The indices of the simplified levels
+are appended to the indices and their sub-meshes to the sub-meshes, every
+sub-mesh is simplified on its own.
+
+@param The vertices of the mesh
+@param The indices of the mesh, the ones of the levels are appended
+@param The sub-meshes of the mesh, the ones of the levels are appended
+@param The settings with the parameters of the chain
+@return The levels of detail, just the full mesh if they are disabled
+*/
+auto buildLodChain(
+	const std::vector<Vertex>& vertices,
+	std::vector<uint32_t>& indices,
+	std::vector<SubMesh>& sub_meshes,
+	const MeshOptimizationSettings& settings) -> std::vector<MeshLod>;
+
+/**
+Picks the coarsest level of detail whose error, projected on the screen, is
+not bigger than the threshold.
+
+@param The levels of detail of the mesh
+@param The bounds of the mesh
+@param The model matrix of the mesh
+@param The view matrix of the camera
+@param The projection matrix of the camera
+@param The height of the viewport in pixels
+@param The biggest error allowed in pixels
+@return The index of the level of detail to draw
+*/
+auto selectLod(
+	const std::vector<MeshLod>& lods,
+	const MeshBounds& bounds,
+	const glm::mat4& model,
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	float viewport_height,
+	float error_threshold) noexcept -> uint32_t;
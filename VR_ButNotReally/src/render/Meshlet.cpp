@@ -0,0 +1,306 @@
+#include "Meshlet.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <cmath>
+
+namespace {
+
+	constexpr auto no_meshlet = std::numeric_limits<uint32_t>::max();
+
+	/*
+	Below this dot product between the axis of the cone and one of the normals
+	the cone is too wide to ever cull the meshlet.
+	*/
+	constexpr auto min_cone_dot = 0.1f;
+
+	/**
+	Calculates the bounding sphere and the normal cone of the triangles of the meshlet
+	*/
+	auto computeMeshletBounds(
+		const Vertex* vertices,
+		const uint32_t* indices,
+		Meshlet& meshlet) noexcept -> void {
+
+		[[gsl::suppress(bounds.1)]]{
+		const auto first_vertex = vertices + meshlet.vertex_offset;
+		const auto first_index = indices + meshlet.first_index;
+
+		/*
+		The center of the sphere is the center of the box around the vertices,
+		not the smallest sphere but close enough for clusters this small.
+		*/
+		auto min = glm::vec3(std::numeric_limits<float>::max());
+		auto max = glm::vec3(std::numeric_limits<float>::lowest());
+		for (auto i = uint32_t{ 0 }; i < meshlet.index_count; ++i) {
+			const auto& position = first_vertex[first_index[i]].pos;
+			min = glm::min(min, position);
+			max = glm::max(max, position);
+		}
+		meshlet.center = (min + max) * 0.5f;
+
+		auto radius_squared = 0.0f;
+		for (auto i = uint32_t{ 0 }; i < meshlet.index_count; ++i) {
+			const auto offset = first_vertex[first_index[i]].pos - meshlet.center;
+			radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+		}
+		meshlet.radius = std::sqrt(radius_squared);
+
+		/*
+		The axis of the cone is the average of the normals of the triangles and
+		its angle the widest between the axis and one of the normals.
+		*/
+		auto normals = std::vector<glm::vec3>{};
+		normals.reserve(meshlet.index_count / 3);
+		auto axis = glm::vec3(0.0f);
+
+		for (auto i = uint32_t{ 0 }; i + 2 < meshlet.index_count; i += 3) {
+			const auto& a = first_vertex[first_index[i + 0]].pos;
+			const auto& b = first_vertex[first_index[i + 1]].pos;
+			const auto& c = first_vertex[first_index[i + 2]].pos;
+
+			const auto normal = glm::cross(b - a, c - a);
+			const auto length = glm::length(normal);
+			if (length > 0.0f) {
+				normals.push_back(normal / length);
+				axis += normals.back();
+			}
+		}
+
+		const auto axis_length = glm::length(axis);
+		if (normals.empty() || axis_length == 0.0f) {
+			meshlet.cone_cutoff = 1.0f;
+			return;
+		}
+		meshlet.cone_axis = axis / axis_length;
+
+		auto min_dot = 1.0f;
+		for (const auto& normal : normals) {
+			min_dot = std::min(min_dot, glm::dot(meshlet.cone_axis, normal));
+		}
+
+		/*
+		The triangles face away from every point that sees the whole cone of
+		normals from behind, widened by 90 degrees. cos(angle + 90) = -sin(angle)
+		so we store the sine and flip the comparison when culling.
+		*/
+		meshlet.cone_cutoff = min_dot <= min_cone_dot ? 1.0f : std::sqrt(1.0f - min_dot * min_dot);
+		}
+	}
+
+	/**
+	Extracts the 6 planes of the frustum of the matrix provided (Gribb and
+	Hartmann), normalized and with the normals pointing inside.
+	*/
+	auto extractFrustumPlanes(const glm::mat4& matrix) noexcept -> std::array<glm::vec4, 6> {
+
+		const auto row = [&matrix](int i) noexcept {
+			return glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]);
+		};
+
+		auto planes = std::array<glm::vec4, 6>{
+			row(3) + row(0),	// Left
+			row(3) - row(0),	// Right
+			row(3) + row(1),	// Bottom
+			row(3) - row(1),	// Top
+			row(3) + row(2),	// Near, conservative with the [0, 1] depth range of Vulkan
+			row(3) - row(2)		// Far
+		};
+
+		for (auto& plane : planes) {
+			plane /= glm::length(glm::vec3(plane));
+		}
+		return planes;
+	}
+}
+
+auto buildMeshlets(
+	const Vertex* vertices,
+	const uint32_t* indices,
+	const std::vector<SubMesh>& sub_meshes,
+	uint32_t max_vertices,
+	uint32_t max_triangles) -> std::vector<Meshlet> {
+
+	auto meshlets = std::vector<Meshlet>{};
+
+	for (const auto& sub_mesh : sub_meshes) {
+
+		/*
+		Last meshlet that used every vertex of the sub-mesh
+		*/
+		auto owner = std::vector<uint32_t>(sub_mesh.vertex_count, no_meshlet);
+
+		auto current = Meshlet{};
+		current.first_index = sub_mesh.first_index;
+		current.vertex_offset = sub_mesh.vertex_offset;
+		auto current_id = gsl::narrow<uint32_t>(meshlets.size());
+
+		const auto finishMeshlet = [&]() {
+			computeMeshletBounds(vertices, indices, current);
+			meshlets.push_back(current);
+
+			current.first_index += current.index_count;
+			current.index_count = 0;
+			current.vertex_count = 0;
+			current_id = gsl::narrow<uint32_t>(meshlets.size());
+		};
+
+		[[gsl::suppress(bounds.1)]]{
+		for (auto i = sub_mesh.first_index; i + 2 < sub_mesh.first_index + sub_mesh.index_count; i += 3) {
+			const uint32_t triangle[] = { indices[i + 0], indices[i + 1], indices[i + 2] };
+
+			auto new_vertices = uint32_t{ 0 };
+			for (auto corner = 0; corner < 3; ++corner) {
+				const auto vertex = triangle[corner];
+				const auto repeated = (corner > 0 && triangle[0] == vertex) || (corner > 1 && triangle[1] == vertex);
+				if (owner[vertex] != current_id && !repeated) {
+					++new_vertices;
+				}
+			}
+
+			if (current.vertex_count + new_vertices > max_vertices || current.index_count / 3 >= max_triangles) {
+				finishMeshlet();
+			}
+
+			for (const auto vertex : triangle) {
+				if (owner[vertex] != current_id) {
+					owner[vertex] = current_id;
+					++current.vertex_count;
+				}
+			}
+			current.index_count += 3;
+		}
+		}
+
+		if (current.index_count > 0) {
+			finishMeshlet();
+		}
+	}
+
+	return meshlets;
+}
+
+auto buildSceneMeshlets(
+	SimpleObjScene& scene,
+	uint32_t max_vertices,
+	uint32_t max_triangles) -> void {
+
+	scene.meshlets.clear();
+
+	for (auto& lod : scene.lods) {
+		const auto first_sub_mesh = scene.sub_meshes.begin() + lod.first_sub_mesh;
+		const auto lod_meshlets = buildMeshlets(
+			scene.vertexData(),
+			scene.indexData(),
+			std::vector<SubMesh>(first_sub_mesh, first_sub_mesh + lod.sub_mesh_count),
+			max_vertices,
+			max_triangles);
+
+		lod.first_meshlet = gsl::narrow<uint32_t>(scene.meshlets.size());
+		lod.meshlet_count = gsl::narrow<uint32_t>(lod_meshlets.size());
+		scene.meshlets.insert(scene.meshlets.end(), lod_meshlets.begin(), lod_meshlets.end());
+	}
+}
+
+auto writeSubMeshDraws(
+	const SubMesh* sub_meshes,
+	size_t sub_mesh_count,
+	VkDrawIndexedIndirectCommand* commands,
+	size_t command_count,
+	uint32_t first_index,
+	int32_t vertex_offset) noexcept -> uint32_t {
+
+	[[gsl::suppress(bounds.1)]]{
+	for (auto i = size_t{ 0 }; i < command_count; ++i) {
+		commands[i] = VkDrawIndexedIndirectCommand{};
+		if (i < sub_mesh_count) {
+			commands[i].indexCount = sub_meshes[i].index_count;
+			commands[i].instanceCount = 1;
+			commands[i].firstIndex = first_index + sub_meshes[i].first_index;
+			commands[i].vertexOffset = vertex_offset + sub_meshes[i].vertex_offset;
+		}
+	}
+	}
+
+	return gsl::narrow_cast<uint32_t>(std::min(sub_mesh_count, command_count));
+}
+
+auto cullMeshlets(
+	const Meshlet* meshlets,
+	size_t meshlet_count,
+	const glm::mat4& model,
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	VkDrawIndexedIndirectCommand* commands,
+	size_t command_count,
+	uint32_t first_index,
+	int32_t vertex_offset) noexcept -> MeshletCullingStatistics {
+
+	/*
+	We cull in object space so the bounds of the meshlets don't need to be
+	transformed, the planes come from the whole model view projection matrix
+	and the camera is moved into object space.
+	*/
+	const auto planes = extractFrustumPlanes(projection * view * model);
+	const auto camera_position = glm::vec3(glm::inverse(view * model) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+	auto statistics = MeshletCullingStatistics{};
+	auto draw = VkDrawIndexedIndirectCommand{};
+
+	[[gsl::suppress(bounds.1)]]{
+	const auto flushDraw = [&]() noexcept {
+		if (draw.indexCount > 0) {
+			draw.firstIndex += first_index;
+			draw.vertexOffset += vertex_offset;
+			commands[statistics.draw_count++] = draw;
+			draw = VkDrawIndexedIndirectCommand{};
+		}
+	};
+
+	for (auto i = size_t{ 0 }; i < meshlet_count; ++i) {
+		const auto& meshlet = meshlets[i];
+
+		const auto outside = std::any_of(planes.begin(), planes.end(), [&meshlet](const glm::vec4& plane) noexcept {
+			return glm::dot(glm::vec3(plane), meshlet.center) + plane.w < -meshlet.radius;
+		});
+		if (outside) {
+			++statistics.frustum_culled;
+			flushDraw();
+			continue;
+		}
+
+		const auto to_center = meshlet.center - camera_position;
+		if (glm::dot(to_center, meshlet.cone_axis) >= meshlet.cone_cutoff * glm::length(to_center) + meshlet.radius) {
+			++statistics.backface_culled;
+			flushDraw();
+			continue;
+		}
+
+		++statistics.visible_meshlets;
+
+		/*
+		Consecutive visible meshlets of the same sub-mesh are merged
+		*/
+		if (draw.indexCount > 0 &&
+			draw.vertexOffset == meshlet.vertex_offset &&
+			draw.firstIndex + draw.indexCount == meshlet.first_index) {
+			draw.indexCount += meshlet.index_count;
+			continue;
+		}
+
+		flushDraw();
+		draw.indexCount = meshlet.index_count;
+		draw.instanceCount = 1;
+		draw.firstIndex = meshlet.first_index;
+		draw.vertexOffset = meshlet.vertex_offset;
+		draw.firstInstance = 0;
+	}
+	flushDraw();
+
+	for (auto i = size_t{ statistics.draw_count }; i < command_count; ++i) {
+		commands[i] = VkDrawIndexedIndirectCommand{};
+	}
+	}
+
+	return statistics;
+}
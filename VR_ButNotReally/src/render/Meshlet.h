@@ -0,0 +1,111 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "RenderData.h"
+
+/*
+Meshlets and per meshlet culling.
+
+The triangles of every sub-mesh are split, in the order of the index buffer, in
+small clusters (meshlets) of a limited amount of vertices and triangles. Since
+the index buffer is already optimized for the vertex cache and the overdraw
+the triangles of a meshlet are close to each other, so every meshlet gets a
+tight bounding sphere and a narrow cone with the normals of its triangles.
+
+Every frame the meshlets are culled on the CPU against the view frustum (with
+the bounding sphere) and against the camera position (with the normal cone,
+a meshlet whose triangles all face away from the camera is not drawn). The
+visible meshlets are written into an indirect buffer as draw commands, the
+consecutive ones merged in a single command.
+
+The cone culling test is the one described in "Optimizing the Graphics
+Pipeline with Compute" (Wihlidal, GDC 2016) and used by meshoptimizer.
+*/
+
+/**
+Result of culling the meshlets of a frame
+*/
+struct MeshletCullingStatistics {
+	uint32_t visible_meshlets{};
+	uint32_t frustum_culled{};
+	uint32_t backface_culled{};
+	uint32_t draw_count{};		// Draw commands written, consecutive visible meshlets share one
+};
+
+/**
+Splits the sub-meshes in meshlets following the order of the indices.
+
+@param The vertices of the mesh
+@param The indices of the mesh, relative to the vertex offset of their sub-mesh
+@param The sub-meshes of the mesh
+@param The maximum amount of distinct vertices of every meshlet
+@param The maximum amount of triangles of every meshlet
+@return The meshlets of every sub-mesh, in order
+*/
+auto buildMeshlets(
+	const Vertex* vertices,
+	const uint32_t* indices,
+	const std::vector<SubMesh>& sub_meshes,
+	uint32_t max_vertices,
+	uint32_t max_triangles) -> std::vector<Meshlet>;
+
+/**
+Builds the meshlets of every level of detail of the scene, the meshlets of a
+level are stored after the ones of the previous level.
+
+@param The scene, its meshlets and the meshlet ranges of its levels are updated
+@param The maximum amount of distinct vertices of every meshlet
+@param The maximum amount of triangles of every meshlet
+*/
+auto buildSceneMeshlets(
+	SimpleObjScene& scene,
+	uint32_t max_vertices,
+	uint32_t max_triangles) -> void;
+
+/**
+Writes a draw command per sub-mesh, used when the meshlets are not culled.
+
+@param The sub-meshes to draw
+@param The amount of sub-meshes
+@param Where to write the draw commands, the ones after the sub-meshes are
+written with instanceCount 0.
+@param The amount of draw commands, at least one per sub-mesh
+@param The first index of the mesh in the index buffer, added to the sub-meshes
+@param The first vertex of the mesh in the vertex buffer, added to the sub-meshes
+@return The amount of draw commands used
+*/
+auto writeSubMeshDraws(
+	const SubMesh* sub_meshes,
+	size_t sub_mesh_count,
+	VkDrawIndexedIndirectCommand* commands,
+	size_t command_count,
+	uint32_t first_index = 0,
+	int32_t vertex_offset = 0) noexcept -> uint32_t;
+
+/**
+Culls the meshlets and writes the draw commands of the visible ones.
+
+@param The meshlets to cull (the ones of the level of detail drawn)
+@param The amount of meshlets
+@param The model matrix of the mesh (the one the meshlet bounds are relative to)
+@param The view matrix of the camera
+@param The projection matrix of the camera
+@param Where to write the draw commands, the ones after the last visible
+meshlet are written with instanceCount 0.
+@param The amount of draw commands, at least one per meshlet
+@param The first index of the mesh in the index buffer, added to the meshlets
+@param The first vertex of the mesh in the vertex buffer, added to the meshlets
+@return The statistics of the culling
+*/
+auto cullMeshlets(
+	const Meshlet* meshlets,
+	size_t meshlet_count,
+	const glm::mat4& model,
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	VkDrawIndexedIndirectCommand* commands,
+	size_t command_count,
+	uint32_t first_index = 0,
+	int32_t vertex_offset = 0) noexcept -> MeshletCullingStatistics;
@@ -0,0 +1,123 @@
+#include "MipBlit.h"
+#include <algorithm>
+#include <gsl/gsl>
+
+auto supportsLinearBlit(VkPhysicalDevice physical_device, VkFormat format) noexcept -> bool {
+
+	auto properties = VkFormatProperties{};
+	vkGetPhysicalDeviceFormatProperties(physical_device, format, &properties);
+
+	const auto required_features =
+		VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+		VK_FORMAT_FEATURE_BLIT_DST_BIT |
+		VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+	return (properties.optimalTilingFeatures & required_features) == required_features;
+}
+
+auto recordMipBlitChain(
+	VkCommandBuffer command_buffer,
+	VkImage image,
+	uint32_t width,
+	uint32_t height,
+	uint32_t level_count,
+	VkPipelineStageFlags destination_stage,
+	VkAccessFlags destination_access,
+	uint32_t layer_count) noexcept -> void {
+
+	auto barrier = VkImageMemoryBarrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = layer_count;
+
+	auto level_width = gsl::narrow_cast<int32_t>(width);
+	auto level_height = gsl::narrow_cast<int32_t>(height);
+
+	for (auto level = uint32_t{ 1 }; level < level_count; ++level) {
+
+		/*
+		The previous level has been written (copied or blitted), now we read from it
+		*/
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		vkCmdPipelineBarrier(
+			command_buffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0,
+			0, nullptr,
+			0, nullptr,
+			1, &barrier);
+
+		const auto next_width = std::max(level_width / 2, 1);
+		const auto next_height = std::max(level_height / 2, 1);
+
+		auto blit = VkImageBlit{};
+		blit.srcOffsets[0] = { 0, 0, 0 };
+		blit.srcOffsets[1] = { level_width, level_height, 1 };
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = level - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = layer_count;
+		blit.dstOffsets[0] = { 0, 0, 0 };
+		blit.dstOffsets[1] = { next_width, next_height, 1 };
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = level;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = layer_count;
+
+		vkCmdBlitImage(
+			command_buffer,
+			image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1, &blit,
+			VK_FILTER_LINEAR);
+
+		/*
+		The previous level is done
+		*/
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = destination_access;
+
+		vkCmdPipelineBarrier(
+			command_buffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			destination_stage,
+			0,
+			0, nullptr,
+			0, nullptr,
+			1, &barrier);
+
+		level_width = next_width;
+		level_height = next_height;
+	}
+
+	/*
+	The last level is only written
+	*/
+	barrier.subresourceRange.baseMipLevel = level_count - 1;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = destination_access;
+
+	vkCmdPipelineBarrier(
+		command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		destination_stage,
+		0,
+		0, nullptr,
+		0, nullptr,
+		1, &barrier);
+}
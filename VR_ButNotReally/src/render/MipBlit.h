@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+/*
+Mipmaps of the textures blitted on the GPU.
+
+When the format of the texture supports linear filtering in blits (and the
+command buffer belongs to a queue with graphics support) every level is
+blitted from the previous one, in the same command buffer that uploads the
+texture. Otherwise the chain is built on the CPU, see MipGenerator.h.
+*/
+
+/**
+Checks if images of the format can be blitted with linear filtering.
+
+@param The physical device that will blit
+@param The format of the image
+@return true if the mip chain can be built with blits
+*/
+auto supportsLinearBlit(VkPhysicalDevice physical_device, VkFormat format) noexcept -> bool;
+
+/**
+Records the blits that fill every level from the previous one. Every level
+must be in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL and the level 0 already
+written, they all end in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+
+@param The command buffer, of a queue family with graphics support
+@param The image
+@param Width of the level 0
+@param Height of the level 0
+@param The amount of levels of the image
+@param The stage that reads the image afterwards
+@param The access of the stage that reads the image afterwards
+@param The amount of layers of the image, all of them are blitted together
+*/
+auto recordMipBlitChain(
+	VkCommandBuffer command_buffer,
+	VkImage image,
+	uint32_t width,
+	uint32_t height,
+	uint32_t level_count,
+	VkPipelineStageFlags destination_stage,
+	VkAccessFlags destination_access,
+	uint32_t layer_count = 1) noexcept -> void;
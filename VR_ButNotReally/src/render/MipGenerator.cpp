@@ -0,0 +1,291 @@
+#include "MipGenerator.h"
+#include <algorithm>
+#include <cstring>
+#include <gsl/gsl>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define MIP_GENERATOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+	constexpr auto bytes_per_pixel = size_t{ 4 };
+
+	/**
+	Averages the 2x2 block of pixels starting at the column provided of both
+	rows, every channel rounded to the nearest.
+	*/
+	auto averageBlock(
+		const unsigned char* row_0,
+		const unsigned char* row_1,
+		uint32_t x_0,
+		uint32_t x_1,
+		unsigned char* destination) noexcept -> void {
+
+		[[gsl::suppress(bounds.1)]]{
+		for (auto channel = size_t{ 0 }; channel < bytes_per_pixel; ++channel) {
+			const auto sum =
+				row_0[x_0 * bytes_per_pixel + channel] + row_0[x_1 * bytes_per_pixel + channel] +
+				row_1[x_0 * bytes_per_pixel + channel] + row_1[x_1 * bytes_per_pixel + channel];
+			destination[channel] = gsl::narrow_cast<unsigned char>((sum + 2) / 4);
+		}
+		}
+	}
+
+#ifdef MIP_GENERATOR_SSE2
+	/**
+	Adds every pair of neighbour pixels of the 16 bit sums of 2 pixels provided,
+	the result is in the lower 64 bits.
+	*/
+	inline auto addPixelPair(__m128i pixels) noexcept -> __m128i {
+		return _mm_add_epi16(pixels, _mm_srli_si128(pixels, 8));
+	}
+
+	/**
+	Averages the 2x2 blocks of 8 pixels of both rows into 4 pixels
+	*/
+	inline auto averageBlocks4(const unsigned char* row_0, const unsigned char* row_1, unsigned char* destination) noexcept -> void {
+
+		const auto zero = _mm_setzero_si128();
+
+		[[gsl::suppress(type.1, bounds.1)]]{
+		const auto top_0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row_0));
+		const auto top_1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row_0 + 16));
+		const auto bottom_0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row_1));
+		const auto bottom_1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row_1 + 16));
+
+		/*
+		Vertical sums in 16 bits, two source pixels per register
+		*/
+		const auto sum_0 = _mm_add_epi16(_mm_unpacklo_epi8(top_0, zero), _mm_unpacklo_epi8(bottom_0, zero));
+		const auto sum_1 = _mm_add_epi16(_mm_unpackhi_epi8(top_0, zero), _mm_unpackhi_epi8(bottom_0, zero));
+		const auto sum_2 = _mm_add_epi16(_mm_unpacklo_epi8(top_1, zero), _mm_unpacklo_epi8(bottom_1, zero));
+		const auto sum_3 = _mm_add_epi16(_mm_unpackhi_epi8(top_1, zero), _mm_unpackhi_epi8(bottom_1, zero));
+
+		/*
+		Horizontal sums, one destination pixel per 64 bits
+		*/
+		const auto rounding = _mm_set1_epi16(2);
+		const auto pixels_01 = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(addPixelPair(sum_0), addPixelPair(sum_1)), rounding), 2);
+		const auto pixels_23 = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(addPixelPair(sum_2), addPixelPair(sum_3)), rounding), 2);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_packus_epi16(pixels_01, pixels_23));
+		}
+	}
+#endif
+
+	/**
+	Source texels of a texel of the next level along one axis and their weights
+	*/
+	struct AxisTaps {
+		uint32_t texels[3];
+		float weights[3];
+	};
+
+	/*
+	An even size averages every pair of texels and a size of 1 uses its only
+	texel. An odd size 2n + 1 spreads its texels over the n of the next level,
+	every one covering 3 texels weighted (n - i, n, i + 1) / (2n + 1), so every
+	texel of the source weighs the same like in a linear blit of the whole
+	extent and the last one isn't dropped.
+	*/
+	auto getAxisTaps(uint32_t size, uint32_t index) noexcept -> AxisTaps {
+
+		if (size == 1) {
+			return AxisTaps{ { 0, 0, 0 }, { 1.0f, 0.0f, 0.0f } };
+		}
+		if (size % 2 == 0) {
+			return AxisTaps{ { 2 * index, 2 * index + 1, 2 * index + 1 }, { 0.5f, 0.5f, 0.0f } };
+		}
+
+		const auto half = size / 2;
+		const auto total = static_cast<float>(size);
+		return AxisTaps{
+			{ 2 * index, 2 * index + 1, 2 * index + 2 },
+			{ static_cast<float>(half - index) / total, static_cast<float>(half) / total, static_cast<float>(index + 1) / total } };
+	}
+
+	/**
+	Filters an RGBA8 image with an odd size into the next level, 3x3 texels
+	weighted by getAxisTaps() per texel
+	*/
+	auto downsampleWeighted(
+		const unsigned char* source,
+		uint32_t width,
+		uint32_t height,
+		uint32_t destination_width,
+		uint32_t destination_height,
+		unsigned char* destination) noexcept -> void {
+
+		const auto source_stride = size_t{ width } * bytes_per_pixel;
+
+		[[gsl::suppress(bounds.1, bounds.2, bounds.4)]]{
+		for (auto y = uint32_t{ 0 }; y < destination_height; ++y) {
+			const auto rows = getAxisTaps(height, y);
+			const auto output = destination + size_t{ y } * destination_width * bytes_per_pixel;
+
+			for (auto x = uint32_t{ 0 }; x < destination_width; ++x) {
+				const auto columns = getAxisTaps(width, x);
+
+				float sums[bytes_per_pixel] = {};
+				for (auto row = 0; row < 3; ++row) {
+					const auto row_pixels = source + rows.texels[row] * source_stride;
+					for (auto column = 0; column < 3; ++column) {
+						const auto weight = rows.weights[row] * columns.weights[column];
+						const auto pixel = row_pixels + columns.texels[column] * bytes_per_pixel;
+						for (auto channel = size_t{ 0 }; channel < bytes_per_pixel; ++channel) {
+							sums[channel] += weight * pixel[channel];
+						}
+					}
+				}
+
+				for (auto channel = size_t{ 0 }; channel < bytes_per_pixel; ++channel) {
+					output[size_t{ x } * bytes_per_pixel + channel] = gsl::narrow_cast<unsigned char>(std::min(sums[channel] + 0.5f, 255.0f));
+				}
+			}
+		}
+		}
+	}
+}
+
+auto getMipLevelCount(uint32_t width, uint32_t height) noexcept -> uint32_t {
+
+	auto level_count = uint32_t{ 1 };
+	auto size = std::max(width, height);
+	while (size > 1) {
+		size /= 2;
+		++level_count;
+	}
+	return level_count;
+}
+
+auto downsampleBox(
+	const unsigned char* source,
+	uint32_t width,
+	uint32_t height,
+	unsigned char* destination) noexcept -> void {
+
+	const auto destination_width = std::max(width / 2, uint32_t{ 1 });
+	const auto destination_height = std::max(height / 2, uint32_t{ 1 });
+
+	/*
+	Odd sizes need 3 texels per texel of the next level along that axis
+	*/
+	if ((width > 1 && width % 2 != 0) || (height > 1 && height % 2 != 0)) {
+		downsampleWeighted(source, width, height, destination_width, destination_height, destination);
+		return;
+	}
+
+	const auto source_stride = size_t{ width } * bytes_per_pixel;
+
+	[[gsl::suppress(bounds.1)]]{
+	for (auto y = uint32_t{ 0 }; y < destination_height; ++y) {
+		const auto row_0 = source + std::min(2 * y, height - 1) * source_stride;
+		const auto row_1 = source + std::min(2 * y + 1, height - 1) * source_stride;
+		const auto output = destination + size_t{ y } * destination_width * bytes_per_pixel;
+
+		auto x = uint32_t{ 0 };
+
+#ifdef MIP_GENERATOR_SSE2
+		/*
+		With at least 2 columns every block of the destination has both of its
+		source columns inside the image, 4 blocks at a time.
+		*/
+		if (width >= 2) {
+			for (; x + 4 <= destination_width; x += 4) {
+				averageBlocks4(row_0 + size_t{ 2 } * x * bytes_per_pixel, row_1 + size_t{ 2 } * x * bytes_per_pixel, output + size_t{ x } * bytes_per_pixel);
+			}
+		}
+#endif
+
+		for (; x < destination_width; ++x) {
+			averageBlock(row_0, row_1, std::min(2 * x, width - 1), std::min(2 * x + 1, width - 1), output + size_t{ x } * bytes_per_pixel);
+		}
+	}
+	}
+}
+
+auto generateMipChain(
+	const unsigned char* pixels,
+	uint32_t width,
+	uint32_t height,
+	uint32_t level_count) -> MipChain {
+
+	auto chain = MipChain{};
+	chain.levels = getMipChainLevels(width, height, level_count);
+	chain.pixels.resize(gsl::narrow<size_t>(getMipChainSize(chain.levels)));
+	if (chain.levels.empty()) {
+		return chain;
+	}
+
+	memcpy(chain.pixels.data(), pixels, size_t{ width } * height * bytes_per_pixel);
+	writeMipChain(chain.pixels.data(), chain.levels);
+
+	return chain;
+}
+
+auto getMipChainLevels(uint32_t width, uint32_t height, uint32_t level_count) -> std::vector<MipLevel> {
+
+	auto levels = std::vector<MipLevel>{};
+	levels.reserve(level_count);
+
+	auto offset = VkDeviceSize{ 0 };
+	for (auto level = uint32_t{ 0 }; level < level_count; ++level) {
+		levels.push_back({ offset, width, height });
+		offset += VkDeviceSize{ width } * height * bytes_per_pixel;
+		width = std::max(width / 2, uint32_t{ 1 });
+		height = std::max(height / 2, uint32_t{ 1 });
+	}
+	return levels;
+}
+
+auto getMipChainSize(const std::vector<MipLevel>& levels) noexcept -> VkDeviceSize {
+	if (levels.empty()) {
+		return 0;
+	}
+	return levels.back().offset + VkDeviceSize{ levels.back().width } * levels.back().height * bytes_per_pixel;
+}
+
+auto writeMipChain(unsigned char* chain, const std::vector<MipLevel>& levels) noexcept -> void {
+
+	[[gsl::suppress(bounds.1, bounds.4)]]{
+	for (auto level = size_t{ 1 }; level < levels.size(); ++level) {
+		const auto& previous = levels[level - 1];
+		downsampleBox(
+			chain + previous.offset,
+			previous.width,
+			previous.height,
+			chain + levels[level].offset);
+	}
+	}
+}
+
+auto getMipCopyRegions(
+	const std::vector<MipLevel>& levels,
+	uint32_t layer_count,
+	VkDeviceSize layer_size) -> std::vector<VkBufferImageCopy> {
+
+	auto regions = std::vector<VkBufferImageCopy>{};
+	regions.reserve(levels.size() * layer_count);
+
+	for (auto layer = uint32_t{ 0 }; layer < layer_count; ++layer) {
+		for (auto level = size_t{ 0 }; level < levels.size(); ++level) {
+			auto region = VkBufferImageCopy{};
+			region.bufferOffset = layer * layer_size + levels[level].offset;
+			region.bufferRowLength = 0;
+			region.bufferImageHeight = 0;
+
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = gsl::narrow<uint32_t>(level);
+			region.imageSubresource.baseArrayLayer = layer;
+			region.imageSubresource.layerCount = 1;
+
+			region.imageOffset = { 0, 0, 0 };
+			region.imageExtent = { levels[level].width, levels[level].height, 1 };
+			regions.push_back(region);
+		}
+	}
+
+	return regions;
+}
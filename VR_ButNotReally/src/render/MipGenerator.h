@@ -0,0 +1,117 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <vulkan/vulkan.h>
+
+/*
+Mipmaps of the textures built on the CPU.
+
+When the levels can't be blitted on the GPU (see MipBlit.h) the chain is built
+with a 2x2 box filter, vectorized with SSE2 when available, and every level is
+uploaded from the staging buffer. Only RGBA8 pixels are filtered on the CPU,
+which is the only format we load.
+
+Nothing here calls into Vulkan, only its types are used, so the tools that
+cook the textures can compile it without linking the Vulkan loader.
+*/
+
+/**
+Level of a mip chain stored in a single buffer
+*/
+struct MipLevel {
+	VkDeviceSize offset{};	// Bytes from the start of the chain
+	uint32_t width{};
+	uint32_t height{};
+};
+
+/**
+Mip chain of an RGBA8 texture, every level right after the previous one
+*/
+struct MipChain {
+	std::vector<unsigned char> pixels{};
+	std::vector<MipLevel> levels{};
+};
+
+/**
+Amount of levels of a full mip chain, down to 1x1
+
+@param Width of the level 0
+@param Height of the level 0
+@return The amount of mip levels
+*/
+auto getMipLevelCount(uint32_t width, uint32_t height) noexcept -> uint32_t;
+
+/**
+Halves an RGBA8 image with a box filter over the whole image. The sizes are
+halved rounding down and a size of 1 stays 1. Even sizes average every 2x2
+block of pixels, an odd size 2n + 1 spreads its pixels over the n of the next
+level with 3 weighted taps each, so the last row or column isn't dropped and
+the level matches a linear blit of the whole extent.
+
+@param The pixels of the image
+@param Width of the image
+@param Height of the image
+@param Where to write the pixels of the next level, max(1, width / 2) x max(1, height / 2) of them
+*/
+auto downsampleBox(
+	const unsigned char* source,
+	uint32_t width,
+	uint32_t height,
+	unsigned char* destination) noexcept -> void;
+
+/**
+Layout of the mip chain of an RGBA8 image, the levels one after the other
+from the level 0.
+
+@param Width of the level 0
+@param Height of the level 0
+@param The amount of levels, including the level 0
+@return The levels of the chain
+*/
+auto getMipChainLevels(uint32_t width, uint32_t height, uint32_t level_count) -> std::vector<MipLevel>;
+
+/**
+@param The levels of a chain
+@return The bytes of the whole chain
+*/
+auto getMipChainSize(const std::vector<MipLevel>& levels) noexcept -> VkDeviceSize;
+
+/**
+Builds the levels of a mip chain from its level 0, in place.
+
+@param The memory of the chain, with the level 0 already written
+@param The levels of the chain, see getMipChainLevels
+*/
+auto writeMipChain(unsigned char* chain, const std::vector<MipLevel>& levels) noexcept -> void;
+
+/**
+Builds the mip chain of an RGBA8 image on the CPU.
+
+@param The pixels of the level 0
+@param Width of the level 0
+@param Height of the level 0
+@param The amount of levels to build, including the level 0
+@return The levels of the chain, the level 0 is a copy of the pixels
+*/
+auto generateMipChain(
+	const unsigned char* pixels,
+	uint32_t width,
+	uint32_t height,
+	uint32_t level_count) -> MipChain;
+
+/**
+Copy regions to upload every level of a mip chain from a buffer with its pixels.
+The layers of a texture array are stored one after the other, each with its
+whole chain laid out as the levels describe.
+
+@param The levels of the chain
+@param The amount of layers of the image
+@param The bytes between the start of one layer and the next one in the buffer
+@return One copy region per level and layer
+*/
+auto getMipCopyRegions(
+	const std::vector<MipLevel>& levels,
+	uint32_t layer_count = 1,
+	VkDeviceSize layer_size = 0) -> std::vector<VkBufferImageCopy>;
@@ -0,0 +1,545 @@
+#include "ObjParser.h"
+#include "../utils/MappedFile.h"
+#include <gsl/gsl>
+#include <stdexcept>
+#include <sstream>
+#include <future>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+	/*
+	Chunks smaller than this are not worth a task of their own. We create several
+	chunks per worker because the vertex and face sections of a file don't cost
+	the same to parse, so the workers that finish first pick up the remaining ones.
+	*/
+	constexpr auto min_chunk_size = size_t{ 256 * 1024 };
+	constexpr auto chunks_per_thread = size_t{ 4 };
+
+	/*
+	Material of the faces before the first "usemtl" of a chunk, it is
+	whatever material was active at the end of the previous chunk.
+	*/
+	constexpr auto inherited_material = -2;
+
+	constexpr double powers_of_ten[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	enum class IndexComponent : uint8_t {
+		vertex = 1,
+		normal = 2,
+		texcoord = 4
+	};
+
+	/**
+	Index of a chunk that was relative to the end of the chunk (negative in the
+	file) and still needs the amount of elements of the previous chunks added.
+	*/
+	struct RelativeIndex {
+		size_t shape{};
+		size_t corner{};
+		IndexComponent component{};
+	};
+
+	struct FaceCorner {
+		ObjIndex index{};
+		uint8_t relative_mask{};
+	};
+
+	/**
+	Everything parsed from one chunk of the file. The first shape is the
+	continuation of the last shape of the previous chunk.
+	*/
+	struct ObjChunk {
+		ObjAttributes attributes{};
+		std::vector<ObjShape> shapes = std::vector<ObjShape>(1);
+		std::vector<std::string> material_names{};
+		std::vector<RelativeIndex> relative_indices{};
+		std::string material_library{};
+		int last_material{ inherited_material };
+	};
+
+	auto isSpace(char character) noexcept -> bool {
+		return character == ' ' || character == '\t' || character == '\r';
+	}
+
+	auto isDigit(char character) noexcept -> bool {
+		return character >= '0' && character <= '9';
+	}
+
+	[[gsl::suppress(bounds.1)]]
+	auto skipSpaces(const char*& cursor, const char* end) noexcept -> void {
+		while (cursor < end && isSpace(*cursor)) {
+			++cursor;
+		}
+	}
+
+	[[gsl::suppress(bounds.1)]]
+	auto skipLine(const char*& cursor, const char* end) noexcept -> void {
+		while (cursor < end && *cursor != '\n') {
+			++cursor;
+		}
+		if (cursor < end) {
+			++cursor;
+		}
+	}
+
+	/**
+	Checks that the line starts with the keyword provided followed by a space
+	and moves the cursor past it if it does.
+	*/
+	[[gsl::suppress(bounds.1)]]
+	auto consumeKeyword(const char*& cursor, const char* end, const char* keyword) noexcept -> bool {
+		const auto length = strlen(keyword);
+		if (gsl::narrow_cast<size_t>(end - cursor) <= length ||
+			memcmp(cursor, keyword, length) != 0 ||
+			!isSpace(cursor[length])) {
+			return false;
+		}
+		cursor += length;
+		return true;
+	}
+
+	[[gsl::suppress(bounds.1)]]
+	auto readRestOfLine(const char*& cursor, const char* end) -> std::string {
+		skipSpaces(cursor, end);
+		const auto begin = cursor;
+		auto last = cursor;
+		while (cursor < end && *cursor != '\n') {
+			if (!isSpace(*cursor)) {
+				last = cursor + 1;
+			}
+			++cursor;
+		}
+		return std::string(begin, last);
+	}
+
+	[[gsl::suppress(bounds.1)]]
+	auto parseInt(const char*& cursor, const char* end, int& value) noexcept -> bool {
+		auto negative = false;
+		if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+			negative = *cursor == '-';
+			++cursor;
+		}
+
+		if (cursor >= end || !isDigit(*cursor)) {
+			return false;
+		}
+
+		auto result = 0;
+		while (cursor < end && isDigit(*cursor)) {
+			result = result * 10 + (*cursor - '0');
+			++cursor;
+		}
+
+		value = negative ? -result : result;
+		return true;
+	}
+
+	/*
+	Locale independent float parsing. We gather up to 19 significant digits in an
+	integer and scale it once by a power of ten, which is exact up to 10^22.
+	*/
+	[[gsl::suppress(bounds.1, bounds.2, bounds.4)]]
+	auto parseFloat(const char*& cursor, const char* end) noexcept -> float {
+		skipSpaces(cursor, end);
+
+		auto negative = false;
+		if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+			negative = *cursor == '-';
+			++cursor;
+		}
+
+		auto mantissa = uint64_t{ 0 };
+		auto significant_digits = 0;
+		auto exponent = 0;
+
+		auto addDigit = [&](char digit, bool fraction) noexcept {
+			if (significant_digits < 19) {
+				mantissa = mantissa * 10 + gsl::narrow_cast<uint64_t>(digit - '0');
+				if (mantissa != 0) {
+					++significant_digits;
+				}
+				if (fraction) {
+					--exponent;
+				}
+			}
+			else if (!fraction) {
+				++exponent;
+			}
+		};
+
+		while (cursor < end && isDigit(*cursor)) {
+			addDigit(*cursor, false);
+			++cursor;
+		}
+
+		if (cursor < end && *cursor == '.') {
+			++cursor;
+			while (cursor < end && isDigit(*cursor)) {
+				addDigit(*cursor, true);
+				++cursor;
+			}
+		}
+
+		if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+			++cursor;
+			auto exponent_value = 0;
+			if (parseInt(cursor, end, exponent_value)) {
+				exponent += std::clamp(exponent_value, -1000, 1000);
+			}
+		}
+
+		auto value = static_cast<double>(mantissa);
+		if (mantissa != 0 && exponent != 0) {
+			const auto magnitude = std::abs(exponent);
+			const auto scale = magnitude <= 22 ? powers_of_ten[magnitude] : std::pow(10.0, magnitude);
+			value = exponent < 0 ? value / scale : value * scale;
+		}
+
+		return static_cast<float>(negative ? -value : value);
+	}
+
+	/**
+	Converts an index of the file (1 based or negative) into a 0 based index. Negative
+	indices are made relative to the beginning of the chunk and flagged so the
+	elements of the previous chunks are added to them when merging.
+	*/
+	auto resolveIndex(int index, size_t chunk_count, IndexComponent component, uint8_t& relative_mask) noexcept -> int {
+		if (index > 0) {
+			return index - 1;
+		}
+		if (index < 0) {
+			relative_mask |= static_cast<uint8_t>(component);
+			return gsl::narrow_cast<int>(chunk_count) + index;
+		}
+		return -1;
+	}
+
+	[[gsl::suppress(bounds.1)]]
+	auto parseFaceCorner(const char*& cursor, const char* end, const ObjChunk& chunk, FaceCorner& corner) noexcept -> bool {
+
+		const auto& attributes = chunk.attributes;
+		auto value = 0;
+
+		corner = FaceCorner{};
+		if (!parseInt(cursor, end, value)) {
+			return false;
+		}
+		corner.index.vertex_index = resolveIndex(
+			value, attributes.vertices.size() / 3, IndexComponent::vertex, corner.relative_mask);
+
+		if (cursor < end && *cursor == '/') {
+			++cursor;
+			if (parseInt(cursor, end, value)) {
+				corner.index.texcoord_index = resolveIndex(
+					value, attributes.texcoords.size() / 2, IndexComponent::texcoord, corner.relative_mask);
+			}
+			if (cursor < end && *cursor == '/') {
+				++cursor;
+				if (parseInt(cursor, end, value)) {
+					corner.index.normal_index = resolveIndex(
+						value, attributes.normals.size() / 3, IndexComponent::normal, corner.relative_mask);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	auto findOrAddMaterial(std::vector<std::string>& names, const std::string& name) -> int {
+		const auto found = std::find(names.begin(), names.end(), name);
+		if (found != names.end()) {
+			return gsl::narrow<int>(found - names.begin());
+		}
+		names.push_back(name);
+		return gsl::narrow<int>(names.size() - 1);
+	}
+
+	[[gsl::suppress(bounds.1)]]
+	auto parseChunk(const char* cursor, const char* end, ObjChunk& chunk) -> void {
+
+		auto& attributes = chunk.attributes;
+		auto face = std::vector<FaceCorner>{};
+		auto material = inherited_material;
+
+		while (cursor < end) {
+			skipSpaces(cursor, end);
+			if (cursor >= end) {
+				break;
+			}
+
+			if (consumeKeyword(cursor, end, "v")) {
+				attributes.vertices.push_back(parseFloat(cursor, end));
+				attributes.vertices.push_back(parseFloat(cursor, end));
+				attributes.vertices.push_back(parseFloat(cursor, end));
+			}
+			else if (consumeKeyword(cursor, end, "vt")) {
+				attributes.texcoords.push_back(parseFloat(cursor, end));
+				attributes.texcoords.push_back(parseFloat(cursor, end));
+			}
+			else if (consumeKeyword(cursor, end, "vn")) {
+				attributes.normals.push_back(parseFloat(cursor, end));
+				attributes.normals.push_back(parseFloat(cursor, end));
+				attributes.normals.push_back(parseFloat(cursor, end));
+			}
+			else if (consumeKeyword(cursor, end, "f")) {
+				face.clear();
+				auto corner = FaceCorner{};
+				skipSpaces(cursor, end);
+				while (cursor < end && *cursor != '\n' && parseFaceCorner(cursor, end, chunk, corner)) {
+					face.push_back(corner);
+					skipSpaces(cursor, end);
+				}
+
+				/*
+				Polygons with more than 3 corners are triangulated as a fan
+				*/
+				auto& shape = chunk.shapes.back();
+				for (auto i = size_t{ 2 }; i < face.size(); ++i) {
+					for (const auto& triangle_corner : { face[0], face[i - 1], face[i] }) {
+						for (const auto component : { IndexComponent::vertex, IndexComponent::normal, IndexComponent::texcoord }) {
+							if (triangle_corner.relative_mask & static_cast<uint8_t>(component)) {
+								chunk.relative_indices.push_back({ chunk.shapes.size() - 1, shape.indices.size(), component });
+							}
+						}
+						shape.indices.push_back(triangle_corner.index);
+					}
+					shape.material_ids.push_back(material);
+				}
+			}
+			else if (consumeKeyword(cursor, end, "o") || consumeKeyword(cursor, end, "g")) {
+				chunk.shapes.emplace_back();
+				chunk.shapes.back().name = readRestOfLine(cursor, end);
+			}
+			else if (consumeKeyword(cursor, end, "usemtl")) {
+				material = findOrAddMaterial(chunk.material_names, readRestOfLine(cursor, end));
+			}
+			else if (consumeKeyword(cursor, end, "mtllib")) {
+				chunk.material_library = readRestOfLine(cursor, end);
+			}
+
+			skipLine(cursor, end);
+		}
+
+		chunk.last_material = material;
+	}
+
+	[[gsl::suppress(bounds.1)]]
+	auto findChunkBoundaries(const char* data, size_t size, size_t chunk_count) -> std::vector<size_t> {
+
+		auto boundaries = std::vector<size_t>(chunk_count + 1, size);
+		boundaries[0] = 0;
+
+		for (auto i = size_t{ 1 }; i < chunk_count; ++i) {
+			auto position = std::max(size * i / chunk_count, boundaries[i - 1]);
+			while (position > 0 && position < size && data[position - 1] != '\n') {
+				++position;
+			}
+			boundaries[i] = position;
+		}
+
+		return boundaries;
+	}
+
+	auto validateIndex(int index, size_t count, bool optional) -> void {
+		if ((index < 0 && !optional) || (index >= 0 && gsl::narrow_cast<size_t>(index) >= count)) {
+			auto ss = std::stringstream{};
+			ss << "We couldn't parse the obj file, the index [" << index << "] is out of range";
+			throw std::runtime_error(ss.str());
+		}
+	}
+}
+
+auto parseObj(const std::string& path, ThreadPool& thread_pool) -> ObjModel {
+
+	auto file = MappedFile{};
+	if (!file.open(path)) {
+		auto ss = std::stringstream{};
+		ss << "We could not read the file [" << path << "]";
+		throw std::runtime_error(ss.str());
+	}
+
+	return parseObj(file.data(), file.size(), thread_pool);
+}
+
+auto parseObj(const char* data, size_t size, ThreadPool& thread_pool) -> ObjModel {
+
+	const auto chunk_count = std::clamp(
+		size / min_chunk_size,
+		size_t{ 1 },
+		thread_pool.getThreadCount() * chunks_per_thread);
+
+	const auto boundaries = findChunkBoundaries(data, size, chunk_count);
+	auto chunks = std::vector<ObjChunk>(chunk_count);
+
+	/*
+	Parse every chunk on its own
+	*/
+	{
+		auto pending = std::vector<std::future<void>>{};
+		pending.reserve(chunk_count);
+
+		for (auto i = size_t{ 0 }; i < chunk_count; ++i) {
+			pending.push_back(thread_pool.enqueue([data, &boundaries, &chunks, i]() {
+				[[gsl::suppress(bounds.1, bounds.4)]]{
+				parseChunk(data + boundaries[i], data + boundaries[i + 1], chunks[i]);
+				}
+			}));
+		}
+
+		for (auto& chunk : pending) {
+			chunk.wait();
+		}
+		for (auto& chunk : pending) {
+			chunk.get();
+		}
+	}
+
+	/*
+	Sequential pass to know where the elements of every chunk go in the merged
+	arrays and which global material every local material of a chunk is.
+	*/
+	struct ChunkOffsets {
+		size_t vertices{};
+		size_t normals{};
+		size_t texcoords{};
+		int inherited_material{ -1 };
+		std::vector<int> material_remap{};
+	};
+
+	auto model = ObjModel{};
+	auto offsets = std::vector<ChunkOffsets>(chunk_count);
+	auto totals = ChunkOffsets{};
+	auto current_material = -1;
+
+	for (auto i = size_t{ 0 }; i < chunk_count; ++i) {
+		const auto& chunk = chunks[i];
+		auto& chunk_offsets = offsets[i];
+
+		chunk_offsets.vertices = totals.vertices;
+		chunk_offsets.normals = totals.normals;
+		chunk_offsets.texcoords = totals.texcoords;
+		totals.vertices += chunk.attributes.vertices.size();
+		totals.normals += chunk.attributes.normals.size();
+		totals.texcoords += chunk.attributes.texcoords.size();
+
+		for (const auto& name : chunk.material_names) {
+			chunk_offsets.material_remap.push_back(findOrAddMaterial(model.material_names, name));
+		}
+
+		chunk_offsets.inherited_material = current_material;
+		if (chunk.last_material != inherited_material) {
+			current_material = chunk_offsets.material_remap[chunk.last_material];
+		}
+
+		if (!chunk.material_library.empty()) {
+			model.material_library = chunk.material_library;
+		}
+	}
+
+	model.attributes.vertices.resize(totals.vertices);
+	model.attributes.normals.resize(totals.normals);
+	model.attributes.texcoords.resize(totals.texcoords);
+
+	const auto vertex_count = totals.vertices / 3;
+	const auto normal_count = totals.normals / 3;
+	const auto texcoord_count = totals.texcoords / 2;
+
+	/*
+	Parallel pass that copies the attributes of every chunk into place, fixes
+	its relative indices and materials and validates every index.
+	*/
+	thread_pool.parallelFor(chunk_count, [&](size_t begin, size_t end) {
+		for (auto i = begin; i < end; ++i) {
+			auto& chunk = chunks[i];
+			const auto& chunk_offsets = offsets[i];
+
+			std::copy(chunk.attributes.vertices.begin(), chunk.attributes.vertices.end(),
+				model.attributes.vertices.begin() + chunk_offsets.vertices);
+			std::copy(chunk.attributes.normals.begin(), chunk.attributes.normals.end(),
+				model.attributes.normals.begin() + chunk_offsets.normals);
+			std::copy(chunk.attributes.texcoords.begin(), chunk.attributes.texcoords.end(),
+				model.attributes.texcoords.begin() + chunk_offsets.texcoords);
+			chunk.attributes = ObjAttributes{};
+
+			for (const auto& relative : chunk.relative_indices) {
+				auto& index = chunk.shapes[relative.shape].indices[relative.corner];
+				switch (relative.component) {
+				case IndexComponent::vertex:
+					index.vertex_index += gsl::narrow<int>(chunk_offsets.vertices / 3);
+					break;
+				case IndexComponent::normal:
+					index.normal_index += gsl::narrow<int>(chunk_offsets.normals / 3);
+					break;
+				case IndexComponent::texcoord:
+					index.texcoord_index += gsl::narrow<int>(chunk_offsets.texcoords / 2);
+					break;
+				}
+			}
+
+			for (auto& shape : chunk.shapes) {
+				for (auto& material : shape.material_ids) {
+					material = material == inherited_material ?
+						chunk_offsets.inherited_material :
+						chunk_offsets.material_remap[material];
+				}
+
+				for (const auto& index : shape.indices) {
+					validateIndex(index.vertex_index, vertex_count, false);
+					validateIndex(index.normal_index, normal_count, true);
+					validateIndex(index.texcoord_index, texcoord_count, true);
+				}
+			}
+		}
+	});
+
+	/*
+	Stitch the shapes together, the first shape of every chunk continues
+	the last shape we have so far.
+	*/
+	for (auto& chunk : chunks) {
+		auto first = true;
+		for (auto& shape : chunk.shapes) {
+			if (first && !model.shapes.empty()) {
+				auto& last = model.shapes.back();
+				last.indices.insert(last.indices.end(), shape.indices.begin(), shape.indices.end());
+				last.material_ids.insert(last.material_ids.end(), shape.material_ids.begin(), shape.material_ids.end());
+			}
+			else {
+				model.shapes.push_back(std::move(shape));
+			}
+			first = false;
+		}
+	}
+
+	model.shapes.erase(
+		std::remove_if(model.shapes.begin(), model.shapes.end(), [](const ObjShape& shape) { return shape.indices.empty(); }),
+		model.shapes.end());
+
+	return model;
+}
+
+auto findObjMaterialLibrary(const char* data, size_t size) -> std::string {
+
+	auto material_library = std::string{};
+
+	[[gsl::suppress(bounds.1)]]{
+	auto cursor = data;
+	const auto end = data + size;
+	while (cursor < end) {
+		skipSpaces(cursor, end);
+		if (consumeKeyword(cursor, end, "mtllib")) {
+			material_library = readRestOfLine(cursor, end);
+		}
+		skipLine(cursor, end);
+	}
+	}
+
+	return material_library;
+}
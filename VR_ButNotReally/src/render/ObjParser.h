@@ -0,0 +1,86 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "../utils/ThreadPool.h"
+
+/*
+Multithreaded Wavefront .obj parser.
+
+The file is mapped in memory and split on line boundaries in several chunks
+that are parsed in parallel by the thread pool. Every chunk fills its own
+v/vt/vn/f streams and those are merged afterwards into the same arrays
+tinyobj::attrib_t would give us, so the loading code doesn't change much.
+
+Only the statements we use are understood: v, vt, vn, f, o, g, usemtl and
+mtllib. Anything else is skipped. Polygons are triangulated as a fan and
+negative (relative) indices are resolved, even when they point into a
+previous chunk.
+*/
+
+/**
+Indices of one corner of a face, -1 when the attribute is not present.
+They already point to the element (not the float) and start at 0.
+*/
+struct ObjIndex {
+	int vertex_index{ -1 };
+	int normal_index{ -1 };
+	int texcoord_index{ -1 };
+};
+
+/**
+Same layout as tinyobj::attrib_t
+*/
+struct ObjAttributes {
+	std::vector<float> vertices{};	// x, y, z
+	std::vector<float> normals{};	// x, y, z
+	std::vector<float> texcoords{};	// u, v
+};
+
+/**
+Triangles between two "o" or "g" statements
+*/
+struct ObjShape {
+	std::string name{};
+	std::vector<ObjIndex> indices{};	// 3 per triangle
+	std::vector<int> material_ids{};	// 1 per triangle, index in ObjModel::material_names or -1
+};
+
+struct ObjModel {
+	ObjAttributes attributes{};
+	std::vector<ObjShape> shapes{};
+	std::vector<std::string> material_names{};
+	std::string material_library{};
+};
+
+/**
+Parses the .obj file provided using the workers of the thread pool.
+
+@param The path of the .obj file
+@param The thread pool to parse the chunks of the file with
+@return The parsed model
+@throws std::runtime_error if the file can't be read or an index is out of range
+*/
+auto parseObj(const std::string& path, ThreadPool& thread_pool) -> ObjModel;
+
+/**
+Parses .obj contents already in memory using the workers of the thread pool.
+
+@param Pointer to the beginning of the contents
+@param The size in bytes of the contents
+@param The thread pool to parse the chunks of the contents with
+@return The parsed model
+@throws std::runtime_error if an index is out of range
+*/
+auto parseObj(const char* data, size_t size, ThreadPool& thread_pool) -> ObjModel;
+
+/**
+Finds the material library of .obj contents without parsing the rest of the
+statements. Like parseObj() the last mtllib of the contents is the one used.
+
+@param Pointer to the beginning of the contents
+@param The size in bytes of the contents
+@return The material library, empty if the contents have none
+*/
+auto findObjMaterialLibrary(const char* data, size_t size) -> std::string;
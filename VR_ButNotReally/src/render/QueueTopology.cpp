@@ -0,0 +1,100 @@
+#include "QueueTopology.h"
+#include <sstream>
+#include <gsl/gsl>
+
+auto planQueueTopology(
+	const std::vector<VkQueueFamilyProperties>& queue_families,
+	const std::vector<bool>& present_support) -> QueueFamilyIndices {
+
+	auto has = [](const VkQueueFamilyProperties& family, VkQueueFlags flags) noexcept {
+		return (family.queueFlags & flags) == flags;
+	};
+
+	auto async_compute = [&](const VkQueueFamilyProperties& family) {
+		return has(family, VK_QUEUE_COMPUTE_BIT) && !has(family, VK_QUEUE_GRAPHICS_BIT);
+	};
+
+	auto can_present = [&](int index) {
+		return gsl::narrow<size_t>(index) < present_support.size() && present_support.at(index);
+	};
+
+	/*
+	First family with queues that passes the predicate, -1 if none
+	*/
+	auto findFamily = [&](auto predicate) -> int {
+		for (auto i = 0; i < gsl::narrow<int>(queue_families.size()); ++i) {
+			const auto& family = queue_families.at(i);
+			if (family.queueCount > 0 && predicate(family, i)) {
+				return i;
+			}
+		}
+		return -1;
+	};
+
+	auto indices = QueueFamilyIndices{};
+
+	indices.graphics_family = findFamily([&](const auto& family, int index) {
+		return has(family, VK_QUEUE_GRAPHICS_BIT) && can_present(index);
+	});
+	if (indices.graphics_family >= 0) {
+		indices.present_family = indices.graphics_family;
+	}
+	else {
+		indices.graphics_family = findFamily([&](const auto& family, int) {
+			return has(family, VK_QUEUE_GRAPHICS_BIT);
+		});
+		indices.present_family = findFamily([&](const auto&, int index) {
+			return can_present(index);
+		});
+	}
+
+	/*
+	Compute families can transfer even without the transfer bit
+	*/
+	indices.transfer_family = findFamily([&](const auto& family, int) {
+		return has(family, VK_QUEUE_TRANSFER_BIT) && (family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0;
+	});
+	if (indices.transfer_family < 0) {
+		indices.transfer_family = findFamily([&](const auto& family, int) {
+			return async_compute(family);
+		});
+	}
+	if (indices.transfer_family < 0) {
+		indices.transfer_family = indices.graphics_family;
+	}
+
+	return indices;
+}
+
+auto describeQueueTopology(
+	const QueueFamilyIndices& indices,
+	const std::vector<VkQueueFamilyProperties>& queue_families) -> std::string {
+
+	auto ss = std::stringstream{};
+
+	auto describe = [&](const char* role, int family, const char* dedicated) {
+		ss << " - " << role << ": ";
+		if (family < 0) {
+			ss << "none" << std::endl;
+			return;
+		}
+
+		ss << "family " << family << " ";
+		if (family == indices.graphics_family && role != std::string{ "graphics" }) {
+			ss << "(shared with graphics) ";
+		}
+		else if (dedicated != nullptr) {
+			ss << "(" << dedicated << ") ";
+		}
+		ss << getVulkanQueueFlagNames(queue_families.at(family).queueFlags) << std::endl;
+	};
+
+	const auto& transfer_flags = indices.transfer_family >= 0 ? queue_families.at(indices.transfer_family).queueFlags : VkQueueFlags{};
+	const auto dma = (transfer_flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0;
+
+	describe("graphics", indices.graphics_family, nullptr);
+	describe("present", indices.present_family, nullptr);
+	describe("transfer", indices.transfer_family, dma ? "dedicated DMA" : "separate");
+
+	return ss.str();
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "RenderUtils.h"
+
+/*
+Queue families the renderer works with.
+
+The first family that could do graphics, present and transfer used to get
+every role, so the transfer queue was almost always the graphics queue and
+the uploads ran in between the frames instead of next to them. The resources
+were also created concurrent between the families and the swap chain shared
+between all of them, which some drivers pay for on every access.
+
+planQueueTopology() picks a family per role:
+ - graphics: a graphics family that can present, so the swap chain images
+   are exclusive to it
+ - present: the graphics family, or the first family that can present
+ - transfer: a dedicated DMA family (transfer without graphics or compute),
+   then any other family without graphics (compute families can always
+   transfer), then the graphics family
+
+There is no compute role. The skinning dispatch is recorded in the frame
+command buffer of the graphics queue, so a queue of a compute family would
+never get a submission.
+
+When the transfer family isn't the graphics family every resource is
+exclusive to one family at a time and moves between them with a release
+barrier on one queue and an acquire barrier on the other.
+*/
+
+/**
+Picks the queue family of every role.
+
+@param The queue families of the physical device
+@param Whether every queue family can present to the surface, in the same order
+@return The indices of the families, a role without a family is -1
+*/
+auto planQueueTopology(
+	const std::vector<VkQueueFamilyProperties>& queue_families,
+	const std::vector<bool>& present_support) -> QueueFamilyIndices;
+
+/**
+Describes the family chosen for every role and whether it is shared with
+the graphics family, one role per line.
+
+@param The indices of planQueueTopology()
+@param The queue families they index
+@return The description
+*/
+auto describeQueueTopology(
+	const QueueFamilyIndices& indices,
+	const std::vector<VkQueueFamilyProperties>& queue_families) -> std::string;
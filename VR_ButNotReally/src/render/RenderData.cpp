@@ -1 +1,180 @@
 #include "RenderData.h"
+
+#pragma warning(push)
+#include <CppCoreCheck/Warnings.h>
+#pragma warning(disable: ALL_CPPCORECHECK_WARNINGS)
+#include <glm/gtc/matrix_transform.hpp>
+#pragma warning(pop)
+
+auto computeMeshBounds(const Vertex* vertices, size_t vertex_count) noexcept -> MeshBounds {
+
+	auto bounds = MeshBounds{};
+
+	if (vertices == nullptr || vertex_count == 0) {
+		return bounds;
+	}
+
+	[[gsl::suppress(bounds.1)]]{
+	bounds.min = vertices[0].pos;
+	bounds.max = vertices[0].pos;
+
+	for (size_t i = 1; i < vertex_count; ++i) {
+		bounds.min = glm::min(bounds.min, vertices[i].pos);
+		bounds.max = glm::max(bounds.max, vertices[i].pos);
+	}
+	}
+
+	return bounds;
+}
+
+auto getVertexStride(VertexFormat format) noexcept -> size_t {
+	switch (format) {
+	case VertexFormat::compact:
+		return sizeof(CompactVertex);
+	case VertexFormat::full:
+	default:
+		return sizeof(Vertex);
+	}
+}
+
+auto floatToHalf(float value) noexcept -> uint16_t {
+
+	auto bits = uint32_t{};
+	memcpy(&bits, &value, sizeof(bits));
+
+	const auto sign = gsl::narrow_cast<uint16_t>((bits >> 16) & 0x8000u);
+	const auto float_exponent = gsl::narrow_cast<int>((bits >> 23) & 0xFFu);
+	auto mantissa = bits & 0x7FFFFFu;
+
+	/*
+	Infinity and NaN
+	*/
+	if (float_exponent == 0xFF) {
+		return gsl::narrow_cast<uint16_t>(sign | 0x7C00u | (mantissa != 0 ? 0x200u : 0u));
+	}
+
+	const auto exponent = float_exponent - 127 + 15;
+
+	/*
+	Too big, it becomes infinity
+	*/
+	if (exponent >= 31) {
+		return gsl::narrow_cast<uint16_t>(sign | 0x7C00u);
+	}
+
+	/*
+	Too small for a normal half float, it becomes a denormal or zero
+	*/
+	if (exponent <= 0) {
+		if (exponent < -10) {
+			return sign;
+		}
+		mantissa |= 0x800000u;
+		const auto shift = gsl::narrow_cast<uint32_t>(14 - exponent);
+		auto half = mantissa >> shift;
+		if ((mantissa >> (shift - 1)) & 1u) {
+			++half;
+		}
+		return gsl::narrow_cast<uint16_t>(sign | half);
+	}
+
+	/*
+	Rounding can carry into the exponent, which is still the right result
+	*/
+	auto half = (gsl::narrow_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+	if (mantissa & 0x1000u) {
+		++half;
+	}
+	return gsl::narrow_cast<uint16_t>(sign | half);
+}
+
+auto compactVertices(
+	const Vertex* vertices,
+	size_t vertex_count,
+	const MeshBounds& bounds,
+	CompactVertex* output) noexcept -> void {
+
+	const auto extent = bounds.max - bounds.min;
+
+	auto quantize = [](float value, float min, float extent) noexcept {
+		if (extent <= 0.0f) {
+			return uint16_t{ 0 };
+		}
+		const auto normalized = glm::clamp((value - min) / extent, 0.0f, 1.0f);
+		return gsl::narrow_cast<uint16_t>(normalized * 65535.0f + 0.5f);
+	};
+
+	[[gsl::suppress(bounds.1)]]{
+	for (size_t i = 0; i < vertex_count; ++i) {
+		const auto& vertex = vertices[i];
+		auto& compact = output[i];
+
+		compact.pos[0] = quantize(vertex.pos.x, bounds.min.x, extent.x);
+		compact.pos[1] = quantize(vertex.pos.y, bounds.min.y, extent.y);
+		compact.pos[2] = quantize(vertex.pos.z, bounds.min.z, extent.z);
+		compact.pos[3] = gsl::narrow_cast<uint16_t>(vertex.texture_layer);
+		compact.tex_coord[0] = floatToHalf(vertex.tex_coord.x);
+		compact.tex_coord[1] = floatToHalf(vertex.tex_coord.y);
+	}
+	}
+}
+
+auto getDequantizationMatrix(const MeshBounds& bounds) noexcept -> glm::mat4 {
+	const auto translation = glm::translate(glm::mat4(1.0f), bounds.min);
+	return glm::scale(translation, bounds.max - bounds.min);
+}
+
+auto selectIndexType(const std::vector<SubMesh>& sub_meshes) noexcept -> VkIndexType {
+	for (const auto& sub_mesh : sub_meshes) {
+		if (sub_mesh.vertex_count > max_short_index_vertices) {
+			return VK_INDEX_TYPE_UINT32;
+		}
+	}
+	return VK_INDEX_TYPE_UINT16;
+}
+
+auto getIndexSize(VkIndexType index_type) noexcept -> size_t {
+	return index_type == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+auto writeVertexBufferData(
+	const SimpleObjScene& scene,
+	VertexFormat format,
+	void* destination) noexcept -> void {
+
+	if (format == VertexFormat::compact) {
+		compactVertices(scene.vertexData(), scene.vertexCount(), scene.bounds, static_cast<CompactVertex*>(destination));
+	}
+	else {
+		memcpy(destination, scene.vertexData(), sizeof(Vertex) * scene.vertexCount());
+	}
+}
+
+auto writeIndexBufferData(
+	const SimpleObjScene& scene,
+	void* destination) noexcept -> void {
+
+	if (scene.index_type == VK_INDEX_TYPE_UINT16) {
+		const auto source = scene.indexData();
+		const auto output = static_cast<uint16_t*>(destination);
+		[[gsl::suppress(bounds.1)]]{
+		for (auto i = size_t{ 0 }; i < scene.indexCount(); ++i) {
+			output[i] = gsl::narrow_cast<uint16_t>(source[i]);
+		}
+		}
+	}
+	else {
+		memcpy(destination, scene.indexData(), sizeof(uint32_t) * scene.indexCount());
+	}
+}
+
+auto setIndexType(
+	SimpleObjScene& scene,
+	VkIndexType index_type) noexcept -> bool {
+
+	if (index_type == VK_INDEX_TYPE_UINT16 && selectIndexType(scene.sub_meshes) != VK_INDEX_TYPE_UINT16) {
+		return false;
+	}
+	scene.index_type = index_type;
+	return true;
+}
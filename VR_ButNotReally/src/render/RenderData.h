@@ -1,6 +1,9 @@
 #pragma once
 #include <vector>
 #include <array>
+#include <string>
+#include <cstring>
+#include <cstdint>
 #include <gsl/gsl>
 
 
@@ -15,6 +18,7 @@
 #include <vulkan/vulkan.h>
 
 #include "../utils/Utils.h"
+#include "../utils/MappedFile.h"
 #include "./RenderUtils.h"
 #include "../Configuration.h"
 
@@ -78,6 +82,15 @@ struct WrappedCommandBuffer {
 	bool recording{ false };
 };
 
+/**
+Identifies a submission of single time commands, to poll or wait for
+it. An empty ticket (value 0) is always complete.
+*/
+struct CommandTicket {
+	CommandType type{};
+	uint64_t value{};
+};
+
 /**
 Wraps a Vulkan Render Target with all the relevant information to
 render to it like the image, memory, view, width, heigth and if it has
@@ -96,17 +109,30 @@ struct WrappedRenderTarget {
 	bool init{ false };
 };
 
+/**
+Memory layouts the vertices of a mesh can be uploaded with
+
+	- full: Vertex, 36 bytes per vertex.
+	- compact: CompactVertex, quantized to 12 bytes per vertex.
+*/
+enum class VertexFormat {
+	full,
+	compact
+};
+
 /**
 Struct that holds dynamic configuration parameters of the renderer
 */
 struct RenderConfiguration {
 	short multisampling_samples{ config::initial_multisampling_samples };
+	VertexFormat vertex_format{ config::compact_vertices_enabled && !config::skinning_enabled ? VertexFormat::compact : VertexFormat::full };
 };
 
 struct Vertex {
 	glm::vec3 pos{};
 	glm::vec3 color{};
 	glm::vec2 tex_coord{};
+	uint32_t texture_layer{};	// Layer of the texture array with the texture of its material
 
 	auto static getBindingDescription() noexcept ->VkVertexInputBindingDescription {
 
@@ -119,9 +145,9 @@ struct Vertex {
 		return binding_description;
 	}
 
-	auto static getAttributeDescriptions() noexcept->std::array<VkVertexInputAttributeDescription, 3> {
+	auto static getAttributeDescriptions() noexcept->std::array<VkVertexInputAttributeDescription, 4> {
 
-		auto attribute_descriptions = std::array<VkVertexInputAttributeDescription, 3>{};
+		auto attribute_descriptions = std::array<VkVertexInputAttributeDescription, 4>{};
 
 		attribute_descriptions[0].binding = 0;
 		attribute_descriptions[0].location = 0;
@@ -138,23 +164,132 @@ struct Vertex {
 		attribute_descriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
 		attribute_descriptions[2].offset = offsetof(Vertex, tex_coord);
 
+		attribute_descriptions[3].binding = 0;
+		attribute_descriptions[3].location = 3;
+		attribute_descriptions[3].format = VK_FORMAT_R32_UINT;
+		attribute_descriptions[3].offset = offsetof(Vertex, texture_layer);
+
 		return attribute_descriptions;
 	}
 
 	auto operator==(const Vertex& other) const ->bool {
 		return	pos == other.pos &&
 				color == other.color &&
-				tex_coord == other.tex_coord;
+				tex_coord == other.tex_coord &&
+				texture_layer == other.texture_layer;
+	}
+};
+
+/**
+Quantized version of Vertex, 12 bytes instead of 36.
+
+The position is stored as 16 bit unsigned normalized values relative to the
+bounds of the mesh so the vertex shader reads values in [0, 1]. Moving them
+back to the bounds of the mesh is done by the model matrix.
+The texture coordinates are half floats, that way coordinates outside of
+[0, 1] (repeating textures) still work.
+
+The 4th component of the position holds the texture layer as an integer.
+There is no room for the color, loadScene never fills it. The color attribute
+reads that same component as a normalized value, layer / 65535, which is still
+black for any amount of layers we can have.
+
+@see getDequantizationMatrix
+*/
+struct CompactVertex {
+	uint16_t pos[4]{};
+	uint16_t tex_coord[2]{};
+
+	auto static getBindingDescription() noexcept ->VkVertexInputBindingDescription {
+
+		auto binding_description = VkVertexInputBindingDescription{};
+
+		binding_description.binding = 0;
+		binding_description.stride = sizeof(CompactVertex);
+		binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		return binding_description;
+	}
+
+	auto static getAttributeDescriptions() noexcept->std::array<VkVertexInputAttributeDescription, 4> {
+
+		auto attribute_descriptions = std::array<VkVertexInputAttributeDescription, 4>{};
+
+		/*
+		We use the 4 component format since 3 component 16 bit formats don't need
+		to be supported as vertex buffer formats, the shader ignores the 4th one.
+		*/
+		attribute_descriptions[0].binding = 0;
+		attribute_descriptions[0].location = 0;
+		attribute_descriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+		attribute_descriptions[0].offset = offsetof(CompactVertex, pos);
+
+		attribute_descriptions[1].binding = 0;
+		attribute_descriptions[1].location = 1;
+		attribute_descriptions[1].format = VK_FORMAT_R16_UNORM;
+		attribute_descriptions[1].offset = offsetof(CompactVertex, pos) + 3 * sizeof(uint16_t);
+
+		attribute_descriptions[2].binding = 0;
+		attribute_descriptions[2].location = 2;
+		attribute_descriptions[2].format = VK_FORMAT_R16G16_SFLOAT;
+		attribute_descriptions[2].offset = offsetof(CompactVertex, tex_coord);
+
+		attribute_descriptions[3].binding = 0;
+		attribute_descriptions[3].location = 3;
+		attribute_descriptions[3].format = VK_FORMAT_R16_UINT;
+		attribute_descriptions[3].offset = offsetof(CompactVertex, pos) + 3 * sizeof(uint16_t);
+
+		return attribute_descriptions;
 	}
 };
 
+/**
+Calculates a well mixed hash of the raw bytes of a vertex. Every float is hashed
+by its bits, except -0.0f that is hashed as 0.0f since both compare equal, and
+the texture layer by its value.
+
+@param The vertex to hash
+@return The 64 bit hash of the vertex
+*/
+inline auto hashVertex(const Vertex& vertex) noexcept -> uint64_t {
+
+	constexpr auto float_count = offsetof(Vertex, texture_layer) / sizeof(float);
+	constexpr auto word_count = (sizeof(Vertex) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+	static_assert(offsetof(Vertex, texture_layer) + sizeof(uint32_t) == sizeof(Vertex), "The layer must be the last member of the vertex");
+
+	/*
+	The last word is only half used by the layer, the rest stays 0
+	*/
+	float floats[float_count];
+	uint64_t words[word_count]{};
+
+	[[gsl::suppress(bounds.2, bounds.3, bounds.4, type.1)]]{
+	memcpy(floats, &vertex, sizeof(floats));
+	for (auto& value : floats) {
+		if (value == 0.0f) {
+			value = 0.0f;
+		}
+	}
+	memcpy(words, floats, sizeof(floats));
+	memcpy(reinterpret_cast<char*>(words) + sizeof(floats), &vertex.texture_layer, sizeof(vertex.texture_layer));
+
+	auto hash = uint64_t{ 0x9E3779B97F4A7C15ull };
+	for (const auto word : words) {
+		hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+		hash ^= hash >> 32;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xC4CEB9FE1A85EC53ull;
+	hash ^= hash >> 33;
+	return hash;
+	}
+}
+
 namespace std {
 	template<> struct hash<Vertex> {
-		size_t operator()(Vertex const& vertex) const {
-			return(
-				(hash<glm::vec3>()(vertex.pos) ^
-				(hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
-				(hash<glm::vec2>()(vertex.tex_coord) << 1);
+		size_t operator()(Vertex const& vertex) const noexcept {
+			return static_cast<size_t>(hashVertex(vertex));
 		}
 	};
 }
@@ -172,13 +307,208 @@ struct UniformBufferObject {
 };
 
 
+/**
+Axis aligned bounding box of a mesh
+*/
+struct MeshBounds {
+	glm::vec3 min{};
+	glm::vec3 max{};
+};
+
+/**
+Calculates the axis aligned bounding box of the vertices provided.
+
+@param The vertices to calculate the bounds of
+@param The amount of vertices
+@return The bounds of the vertices, zero sized if there are no vertices
+*/
+auto computeMeshBounds(const Vertex* vertices, size_t vertex_count) noexcept -> MeshBounds;
+
+/**
+Size in bytes of every vertex with the format provided
+
+@param The format of the vertices
+@return The stride of the vertex buffer
+*/
+auto getVertexStride(VertexFormat format) noexcept -> size_t;
+
+/**
+Converts a float to a half float (IEEE 754 binary16) rounding to the nearest.
+
+@param The value to convert
+@return The bits of the half float
+*/
+auto floatToHalf(float value) noexcept -> uint16_t;
+
+/**
+Quantizes the vertices into the compact format.
+
+@param The vertices to quantize
+@param The amount of vertices
+@param The bounds of the vertices, the positions are stored relative to them
+@param Where to write the compact vertices, room for vertex_count of them
+*/
+auto compactVertices(
+	const Vertex* vertices,
+	size_t vertex_count,
+	const MeshBounds& bounds,
+	CompactVertex* output) noexcept -> void;
+
+/**
+Matrix that moves positions in [0, 1] (the compact positions as read by the
+vertex shader) back into the bounds of the mesh. It goes to the right of the
+model matrix.
+
+@param The bounds the positions were quantized against
+@return The dequantization matrix
+*/
+auto getDequantizationMatrix(const MeshBounds& bounds) noexcept -> glm::mat4;
+
+/**
+Biggest amount of vertices a mesh can have to be drawn with 16 bit indices
+*/
+constexpr auto max_short_index_vertices = size_t{ 65536 };
+
+/**
+Part of a mesh drawn with one vkCmdDrawIndexed. Its indices are relative to
+vertex_offset, so a mesh split in sub-meshes of at most max_short_index_vertices
+vertices can use 16 bit indices even when the whole mesh has more vertices.
+*/
+struct SubMesh {
+	uint32_t first_index{};
+	uint32_t index_count{};
+	int32_t vertex_offset{};
+	uint32_t vertex_count{};
+};
+
+/**
+Cluster of triangles of a sub-mesh drawn with one indexed draw
+
+@see Meshlet.h
+*/
+struct Meshlet {
+	uint32_t first_index{};
+	uint32_t index_count{};
+	int32_t vertex_offset{};	// The one of the sub-mesh the meshlet belongs to
+	uint32_t vertex_count{};	// Distinct vertices used by the meshlet
+
+	glm::vec3 center{};			// Bounding sphere in object space
+	float radius{};
+
+	glm::vec3 cone_axis{};		// Average normal of the triangles
+	float cone_cutoff{ 1.0f };	// Sine of the angle of the normal cone, 1.0 never culls
+};
+
+/**
+Level of detail of a mesh. The sub-meshes (and meshlets) of every level are
+stored one level after the other, level 0 is the full mesh.
+
+@see MeshSimplifier.h
+*/
+struct MeshLod {
+	float error{};				// Biggest distance to the full mesh, in object space
+	uint32_t first_sub_mesh{};
+	uint32_t sub_mesh_count{};
+	uint32_t first_meshlet{};	// Meshlets are not stored in the mesh cache, they are rebuilt
+	uint32_t meshlet_count{};
+};
+
+/**
+Picks the smallest index type able to address the vertices of every sub-mesh.
+
+@param The sub-meshes of the mesh
+@return VK_INDEX_TYPE_UINT16 if every sub-mesh fits in 16 bits, VK_INDEX_TYPE_UINT32 otherwise
+*/
+auto selectIndexType(const std::vector<SubMesh>& sub_meshes) noexcept -> VkIndexType;
+
+/**
+Size in bytes of every index of the type provided
+
+@param The type of the indices
+@return The size of one index
+*/
+auto getIndexSize(VkIndexType index_type) noexcept -> size_t;
+
 struct SimpleObjScene {
 	std::vector<Vertex> vertices;
 	std::vector<uint32_t> indices;
+	std::vector<SubMesh> sub_meshes;
+	std::vector<Meshlet> meshlets;
+	std::vector<MeshLod> lods;
+	VkIndexType index_type{ VK_INDEX_TYPE_UINT32 };
+	MeshBounds bounds{};
+	std::vector<std::string> texture_paths;	// Texture of every layer the vertices use, empty if the materials have none
 	AllocatedImage m_texture_image{};
 	VkImageView m_texture_image_view{};
+	uint m_texture_mip_levels{ 1 };
+	uint m_texture_layers{ 1 };
+	VkFormat m_texture_format{ VK_FORMAT_R8G8B8A8_UNORM };
+
+	/**
+	When the mesh is read from the binary mesh cache the vertices and indices
+	are not copied into the vectors, they are read straight from this mapping.
+
+	@see MeshCache.h
+	*/
+	MappedFile cached_mesh{};
+	const Vertex* cached_vertices{ nullptr };
+	size_t cached_vertex_count{ 0 };
+	const uint32_t* cached_indices{ nullptr };
+	size_t cached_index_count{ 0 };
+
+	auto vertexData() const noexcept -> const Vertex* {
+		return cached_mesh.isOpen() ? cached_vertices : vertices.data();
+	}
+
+	auto vertexCount() const noexcept -> size_t {
+		return cached_mesh.isOpen() ? cached_vertex_count : vertices.size();
+	}
+
+	auto indexData() const noexcept -> const uint32_t* {
+		return cached_mesh.isOpen() ? cached_indices : indices.data();
+	}
+
+	auto indexCount() const noexcept -> size_t {
+		return cached_mesh.isOpen() ? cached_index_count : indices.size();
+	}
 };
 
+/**
+Writes the vertices of the scene with the format provided, compact vertices
+are quantized against the bounds of the scene.
+
+@param The scene with the vertices
+@param The format of the vertex buffer
+@param Where to write the vertices, room for vertexCount() * getVertexStride(format) bytes
+*/
+auto writeVertexBufferData(
+	const SimpleObjScene& scene,
+	VertexFormat format,
+	void* destination) noexcept -> void;
+
+/**
+Writes the indices of the scene with its index type. 16 bit indices are
+narrowed, every sub-mesh has at most max_short_index_vertices vertices so they fit.
+
+@param The scene with the indices
+@param Where to write the indices, room for indexCount() * getIndexSize(scene.index_type) bytes
+*/
+auto writeIndexBufferData(
+	const SimpleObjScene& scene,
+	void* destination) noexcept -> void;
+
+/**
+Changes the type the indices of the scene are written with, when every
+sub-mesh can be addressed with it.
+
+@param The scene
+@param The index type of the buffer the indices are written to
+@return false if the type is too small for the sub-meshes, the scene is not changed
+*/
+auto setIndexType(
+	SimpleObjScene& scene,
+	VkIndexType index_type) noexcept -> bool;
+
 #if 0
 #pragma warning(push)
 #include <CppCoreCheck/Warnings.h>
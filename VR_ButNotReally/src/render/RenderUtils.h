@@ -19,8 +19,10 @@ enum class CommandType {
 };
 
 /**
-Stores the queue indices for the graphics and presentation
+Stores the queue indices for the graphics, presentation and transfer
 queues in a vulkan physical device.
+
+@see QueueTopology.h
 */
 struct QueueFamilyIndices {
 	int graphics_family = -1;
@@ -28,8 +30,8 @@ struct QueueFamilyIndices {
 	int transfer_family = -1;
 
 	/**
-	Returns wether all the data members have been filled with 
-	valid queue indices.
+	Returns wether all the required data members have been filled
+	with valid queue indices.
 	
 	return true if all the indices have been correctly filled, false otherwise
 	*/
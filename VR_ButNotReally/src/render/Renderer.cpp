@@ -7,6 +7,9 @@
 #include <algorithm>
 #include <unordered_map>
 #include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <fstream>
 #include <CppCoreCheck/Warnings.h>
 
 
@@ -35,6 +38,14 @@ Include section without warnings from GSL
 
 #pragma warning(disable: 6001 6308 6262 6387 28182)
 
+/*
+stb_image allocates through the hooks of the staging decoder, so it can decode
+straight into a staging buffer. See StagingDecoder.h
+*/
+#define STBI_MALLOC(size) stagingDecoderMalloc(size)
+#define STBI_REALLOC(pointer, size) stagingDecoderRealloc(pointer, size)
+#define STBI_FREE(pointer) stagingDecoderFree(pointer)
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
@@ -49,6 +60,7 @@ We include the compiled shader code we are going to use.
 */
 #include "./shaders/triangle_frag.hpp"
 #include "./shaders/triangle_vert.hpp"
+#include "./shaders/skinning_comp.hpp"
 
 Renderer::Renderer() : m_instance() {
 	initWindow();
@@ -90,18 +102,64 @@ auto Renderer::initVulkan() noexcept(false) -> void {
 	createDescriptorSetLayout();
 	createGraphicsPipeline();
 	createGraphicsCommandPool();
-	createTransferCommandPool();
+	createCommandBufferPools();
+	createStagingRing();
+	createGeometryPool();
 	createDepthResources();
 	createFramebuffers();
-	loadScene(
-		config::model_path + "obj/tarzan/Tarzan_packed/tarzan_scaled.obj",
-		config::model_path + "obj/tarzan/Tarzan_packed/Tarzan_packed_full.png");
+
+	/*
+	Every copy and layout transition of the scene goes to a single command
+	buffer, submitted once its resources are created
+	*/
+	beginUploadBatch();
+
+	const auto object_path = config::material_textures_enabled ?
+		config::model_path + "obj/tarzan/Tarzan.obj" :
+		config::model_path + "obj/tarzan/Tarzan_packed/tarzan_scaled.obj";
+	const auto texture_path = config::model_path + "obj/tarzan/Tarzan_packed/Tarzan_packed_full.png";
+
+	/*
+	The unpacked model is in centimeters with the Y axis up, the packed one
+	was exported with the Z axis up and scaled down to about 1 unit tall.
+	*/
+	if (config::material_textures_enabled) {
+		m_model_transform = glm::mat4(
+			glm::vec4(0.0f, 1.0f, 0.0f, 0.0f),
+			glm::vec4(0.0f, 0.0f, 1.0f, 0.0f),
+			glm::vec4(1.0f, 0.0f, 0.0f, 0.0f),
+			glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		m_model_transform = glm::scale(glm::mat4(1.0f), glm::vec3(0.0045f)) * m_model_transform;
+	}
+	if (config::texture_cache_enabled) {
+		m_texture_cache = std::make_unique<TextureCache>(config::texture_cache_index_path, config::texture_cache_size_cap);
+	}
+
+	/*
+	The .smd model is in centimeters with the Z axis up, facing the X axis
+	of the unpacked .obj after its axes are swapped.
+	*/
+	if (config::skinning_enabled) {
+		m_model_transform = glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		m_model_transform = glm::scale(glm::mat4(1.0f), glm::vec3(0.0045f)) * m_model_transform;
+		loadSkinnedScene(config::model_path + "obj/tarzan/Tarzan.smd");
+	}
+	else if (config::asset_streaming_enabled) {
+		streamScene(object_path, texture_path);
+	}
+	else {
+		loadScene(object_path, texture_path);
+	}
 	createTextureSampler();
-	createVertexBuffer();
-	createIndexBuffer();
+	createSceneGeometry();
 	createUniformBuffer();
 	createDescriptorPool();
 	createDescriptorSet();
+	createIndirectBuffers();
+	createSkinningPipeline();
+	createSkinnedVertexBuffers();
+	createSkinningDescriptorSets();
+	submitUploadBatch();
 	createCommandBuffers();
 	recordCommandBuffers();
 	createSemaphoresAndFences();
@@ -133,6 +191,9 @@ auto Renderer::recreateSwapChain() -> void {
 	createGraphicsPipeline();
 	createDepthResources();
 	createFramebuffers();
+	createIndirectBuffers();
+	createSkinnedVertexBuffers();
+	createSkinningDescriptorSets();
 	createCommandBuffers();
 	recordCommandBuffers();
 
@@ -143,6 +204,13 @@ auto Renderer::recreateSwapChain() -> void {
 auto Renderer::cleanup() noexcept -> void {
 	vkDeviceWaitIdle(m_device);
 
+	m_asset_streamer.reset();
+	destroyRetiredResources(true);
+
+	m_upload_batch.reset();
+	m_submitted_upload_batches.clear();
+	m_staging_ring.reset();
+
 	cleanupSwapChain();
 
 	vkDestroySampler(m_device, m_texture_sampler, nullptr);
@@ -158,8 +226,13 @@ auto Renderer::cleanup() noexcept -> void {
 	vkDestroyDescriptorSetLayout(m_device, m_descriptor_set_layout, nullptr);
 	destroyBuffer(m_uniform_buffer);
 
-	destroyBuffer(m_index_buffer);
-	destroyBuffer(m_vertex_buffer);
+	m_geometry_pool.reset();
+
+	vkDestroyPipeline(m_device, m_skinning_pipeline, nullptr);
+	vkDestroyPipelineLayout(m_device, m_skinning_pipeline_layout, nullptr);
+	vkDestroyDescriptorSetLayout(m_device, m_skinning_descriptor_set_layout, nullptr);
+	destroyBuffer(m_skinning_reference_buffer);
+	destroyBuffer(m_skinning_weight_buffer);
 
 	for (auto i = 0; i < m_command_buffers.size(); ++i) {
 		vkDestroyFence(m_device, m_command_buffer_fences[i], nullptr);
@@ -174,7 +247,8 @@ auto Renderer::cleanup() noexcept -> void {
 	}
 
 	vkDestroyCommandPool(m_device, m_graphics_command_pool, nullptr);
-	vkDestroyCommandPool(m_device, m_transfer_command_pool, nullptr);
+	m_graphics_command_buffer_pool.reset();
+	m_transfer_command_buffer_pool.reset();
 
 #ifdef VMA_USE_ALLOCATOR
 	vmaDestroyAllocator(m_vma_allocator);
@@ -208,6 +282,31 @@ auto Renderer::cleanupSwapChain() noexcept -> void {
 		gsl::narrow_cast<uint>(m_command_buffers.size()),
 		m_command_buffers.data());
 
+	for (auto& indirect_buffer : m_indirect_buffers) {
+		destroyBuffer(indirect_buffer);
+	}
+	m_indirect_buffers.clear();
+
+	for (auto& skinned_vertex_buffer : m_skinned_vertex_buffers) {
+		destroyBuffer(skinned_vertex_buffer);
+	}
+	m_skinned_vertex_buffers.clear();
+
+	for (auto& palette_buffer : m_skinning_palette_buffers) {
+		destroyBuffer(palette_buffer);
+	}
+	m_skinning_palette_buffers.clear();
+
+	/*
+	This also frees the memory of the descriptor sets it contains
+	*/
+	vkDestroyDescriptorPool(m_device, m_skinning_descriptor_pool, nullptr);
+	m_skinning_descriptor_pool = VK_NULL_HANDLE;
+	m_skinning_descriptor_sets.clear();
+
+	vkDestroyQueryPool(m_device, m_skinning_query_pool, nullptr);
+	m_skinning_query_pool = VK_NULL_HANDLE;
+
 	vkDestroyPipeline(m_device, m_pipeline, nullptr);
 	vkDestroyPipelineLayout(m_device, m_pipeline_layout, nullptr);
 
@@ -636,40 +735,31 @@ auto Renderer::findQueueFamilies(const VkPhysicalDevice& physical_device, PrintO
 	auto queue_families = std::vector<VkQueueFamilyProperties>(queue_family_count);
 	vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, queue_families.data());
 
-	auto indices = QueueFamilyIndices{};
-
 	if (print_options == PrintOptions::full)
 		std::cout << "The queue families for the physical device [" << getPhysicalDeviceName(physical_device) << "] are the following" << std::endl;
 
+	auto present_support = std::vector<bool>{};
 	{
-		auto i = 0;
+		auto i = uint{ 0 };
 		for (const VkQueueFamilyProperties& family : queue_families) {
 
 			if (print_options == PrintOptions::full)
 				std::cout << " - " << getVulkanQueueFlagNames(family.queueFlags) << std::endl;
 
-			if (family.queueCount > 0) {
-				if (family.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-					indices.graphics_family = i;
-				}
-				if (family.queueFlags & VK_QUEUE_TRANSFER_BIT) {
-					indices.transfer_family = i;
-				}
-				auto present_support = VkBool32{};
-				vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, i, m_surface, &present_support);
-				if (present_support) {
-					indices.present_family = i;
-				}
-			}
-
-			if (indices.isComplete()) break;
+			auto family_present_support = VkBool32{};
+			vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, i, m_surface, &family_present_support);
+			present_support.push_back(family_present_support == VK_TRUE);
 
 			i++;
 		}
 	}
 
-	if (print_options == PrintOptions::full)
-		std::cout << std::endl;
+	const auto indices = planQueueTopology(queue_families, present_support);
+
+	if (print_options == PrintOptions::full) {
+		std::cout << "The queue topology for the physical device [" << getPhysicalDeviceName(physical_device) << "] is the following" << std::endl;
+		std::cout << describeQueueTopology(indices, queue_families) << std::endl;
+	}
 
 	return indices;
 }
@@ -681,6 +771,21 @@ auto Renderer::createLogicalDevice() -> void {
 
 	m_queue_family_indices = findQueueFamilies(m_physical_device, PrintOptions::none);
 
+	/*
+	Report of the queues we are going to work with, whether the uploads and
+	the compute have queues of their own or share the graphics one
+	*/
+	{
+		auto queue_family_count = uint{};
+		vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &queue_family_count, nullptr);
+
+		auto queue_families = std::vector<VkQueueFamilyProperties>(queue_family_count);
+		vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &queue_family_count, queue_families.data());
+
+		std::cout << "\tQueue topology" << std::endl;
+		std::cout << describeQueueTopology(m_queue_family_indices, queue_families);
+	}
+
 	auto queue_create_infos = std::vector<VkDeviceQueueCreateInfo>{};
 	auto unique_queue_families = std::set<int>{
 		m_queue_family_indices.graphics_family,
@@ -702,6 +807,15 @@ auto Renderer::createLogicalDevice() -> void {
 	// Complete here the features that we need from the physical devices
 	auto physical_device_features = VkPhysicalDeviceFeatures{};
 	physical_device_features.samplerAnisotropy = VK_TRUE;
+	/*
+	Lets us draw every meshlet with one vkCmdDrawIndexedIndirect, without it
+	we issue one per draw command.
+	*/
+	physical_device_features.multiDrawIndirect = m_physical_device_features.multiDrawIndirect;
+	/*
+	Lets us sample the cooked textures, without it we load the source images
+	*/
+	physical_device_features.textureCompressionBC = m_physical_device_features.textureCompressionBC;
 
 	auto create_info = VkDeviceCreateInfo{};
 	create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -934,10 +1048,13 @@ auto Renderer::createSwapChain() -> void {
 	create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
 
+	/*
+	Only the graphics and present queues touch the swap chain images, the
+	transfer queue never does
+	*/
 	auto queue_family_indices = std::vector<uint>{
 		gsl::narrow<uint>(m_queue_family_indices.graphics_family) ,
-		gsl::narrow<uint>(m_queue_family_indices.present_family) ,
-		gsl::narrow<uint>(m_queue_family_indices.transfer_family)
+		gsl::narrow<uint>(m_queue_family_indices.present_family)
 	};
 
 	std::sort(queue_family_indices.begin(), queue_family_indices.end());
@@ -1244,10 +1361,15 @@ auto Renderer::createGraphicsPipeline() -> void {
 	const VkPipelineShaderStageCreateInfo shader_stages[] =
 	{ vert_shader_stage_info, frag_shader_stage_info };
 
-	/* We will modify this later when we deal with the vertex buffer */
-
-	const auto binding_descriptions = Vertex::getBindingDescription();
-	const auto attribute_descriptions = Vertex::getAttributeDescriptions();
+	/*
+	The layout of the vertex buffer depends on the vertex format chosen at load time
+	*/
+	const auto binding_descriptions = config.vertex_format == VertexFormat::compact ?
+		CompactVertex::getBindingDescription() :
+		Vertex::getBindingDescription();
+	const auto attribute_descriptions = config.vertex_format == VertexFormat::compact ?
+		CompactVertex::getAttributeDescriptions() :
+		Vertex::getAttributeDescriptions();
 
 	auto vertex_input_create_info = VkPipelineVertexInputStateCreateInfo{};
 	vertex_input_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -1493,8 +1615,11 @@ auto Renderer::createGraphicsCommandPool() ->  void {
 		VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT: If we want to rerecord command
 		buffers individually (without resetting all together).
 
+
+	We record the command buffers again one by one when the streamed assets
+	replace the ones they use.
 	*/
-	command_pool_create_info.flags = 0;
+	command_pool_create_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
 	if (vkCreateCommandPool(m_device, &command_pool_create_info, nullptr, &m_graphics_command_pool) != VK_SUCCESS) {
 		throw std::runtime_error("We couldn't create a graphics command pool");
@@ -1503,29 +1628,22 @@ auto Renderer::createGraphicsCommandPool() ->  void {
 	std::cout << "\tGraphics Command Pool Created" << std::endl << std::endl;
 }
 
-auto Renderer::createTransferCommandPool() ->  void {
-	std::cout << "Creating Transfer Command Pool " << std::endl;
-
-	auto command_pool_create_info = VkCommandPoolCreateInfo{};
-	command_pool_create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	command_pool_create_info.queueFamilyIndex = m_queue_family_indices.transfer_family;
-	/*
-	For the flags we could use:
-
-	VK_COMMAND_POOL_CREATE_TRANSIENT_BIT: If we are going to rerecord the command
-	buffer with new commands frequently
-
-	VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT: If we want to rerecord command
-	buffers individually (without resetting all together).
+auto Renderer::createCommandBufferPools() -> void {
+	std::cout << "Creating Command Buffer Pools" << std::endl;
 
-	*/
-	command_pool_create_info.flags = 0;
+	auto context = CommandBufferPoolContext{};
+	context.device = m_device;
+	context.queue = m_graphics_queue;
+	context.queue_family = gsl::narrow<uint32_t>(m_queue_family_indices.graphics_family);
+	m_graphics_command_buffer_pool = std::make_unique<CommandBufferPool>(context, config::command_buffer_pool_size);
 
-	if (vkCreateCommandPool(m_device, &command_pool_create_info, nullptr, &m_transfer_command_pool) != VK_SUCCESS) {
-		throw std::runtime_error("We couldn't create a transfer command pool");
-	}
+	context.queue = m_transfer_queue;
+	context.queue_family = gsl::narrow<uint32_t>(m_queue_family_indices.transfer_family);
+	m_transfer_command_buffer_pool = std::make_unique<CommandBufferPool>(context, config::command_buffer_pool_size);
 
-	std::cout << "\tTransfer Command Pool Created" << std::endl << std::endl;
+	std::cout << "\t" << config::command_buffer_pool_size << " command buffers for the graphics queue and "
+		<< config::command_buffer_pool_size << " for the transfer queue" << std::endl;
+	std::cout << "\tCommand Buffer Pools Created" << std::endl << std::endl;
 }
 
 auto Renderer::createImage(
@@ -1539,7 +1657,9 @@ auto Renderer::createImage(
 	AllocatedImage& image,
 	VkSharingMode sharing_mode,
 	const std::vector<uint>* queue_family_indices,
-	short samples) -> void {
+	short samples,
+	uint mip_levels,
+	uint array_layers) -> void {
 
 	auto create_info = VkImageCreateInfo{};
 	{
@@ -1548,8 +1668,8 @@ auto Renderer::createImage(
 		create_info.extent.width = gsl::narrow_cast<uint>(width);
 		create_info.extent.height = gsl::narrow_cast<uint>(height);
 		create_info.extent.depth = 1;
-		create_info.mipLevels = 1;
-		create_info.arrayLayers = 1;
+		create_info.mipLevels = mip_levels;
+		create_info.arrayLayers = array_layers;
 		create_info.format = format;
 		create_info.tiling = tiling;
 		create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -1623,107 +1743,316 @@ auto Renderer::createDepthResources() -> void {
 
 }
 
-auto Renderer::createTextureImage(std::string path)->AllocatedImage {
+auto Renderer::createTextureImage(std::string path, uint& mip_levels, VkFormat& format)->AllocatedImage {
 
-	std::cout << "Creating Texture Image" << std::endl;
+	/*
+	The cooked texture already has its compressed mip chain, we don't need
+	to decode nor filter anything.
+	*/
+	if (config::cooked_textures_enabled && m_physical_device_features.textureCompressionBC) {
+		const auto cooked_path = getCookedTexturePath(path);
+		if (std::ifstream(cooked_path).good()) {
+			try {
+				const auto texture = readCookedTexture(cooked_path);
+				auto image = createTextureImage(texture);
+				mip_levels = gsl::narrow<uint>(texture.levels.size());
+				format = texture.format;
+				return image;
+			}
+			catch (const std::exception& exception) {
+				std::cout << "\tWe couldn't use the cooked texture: " << exception.what() << std::endl;
+			}
+		}
+	}
 
-	AllocatedImage image{};
+	format = VK_FORMAT_R8G8B8A8_UNORM;
 
-	auto texture_width = 0;
-	auto texture_height = 0;
-	auto texture_channels = 0;
+	/*
+	The cache gives us the whole mip chain already decoded and filtered
+	*/
+	if (m_texture_cache) {
+		const auto texture = m_texture_cache->decode(path, config::mipmaps_enabled);
+		mip_levels = gsl::narrow<uint>(texture.levels.size());
+		std::cout << "\tTexture " << (texture.isCached() ? "read from" : "added to") << " the texture cache" << std::endl;
+
+		return createTextureImage(
+			texture.data(),
+			VkDeviceSize{ texture.size() },
+			texture.width,
+			texture.height,
+			texture.levels,
+			mip_levels);
+	}
 
-	auto pixels = stbi_load(
-		path.c_str(),
-		&texture_width,
-		&texture_height,
-		&texture_channels,
-		STBI_rgb_alpha);
+	/*
+	Without the cache the texture is decoded straight into the staging buffer
+	and its mip chain (when it is not blitted) is built right after it.
+	*/
+	auto source = MappedFile{};
+	if (!source.open(path)) {
+		throw std::runtime_error("We couldn't read the texture [" + path + "]");
+	}
 
-	if (!pixels) {
+	auto width = uint{ 0 };
+	auto height = uint{ 0 };
+	if (!readTextureSize(source, width, height)) {
 		throw std::runtime_error("Couldn't load provided texture image");
 	}
 
-	[[gsl::suppress(type.4, 6387)]]{
-	const auto image_size = VkDeviceSize{ gsl::narrow_cast<VkDeviceSize>(texture_width * texture_height * 4) };
+	mip_levels = config::mipmaps_enabled ? getMipLevelCount(width, height) : 1;
+	const auto blit_mipmaps = mip_levels > 1 && supportsLinearBlit(m_physical_device, VK_FORMAT_R8G8B8A8_UNORM);
+	const auto levels = getMipChainLevels(width, height, blit_mipmaps ? 1 : mip_levels);
+	const auto size = getMipChainSize(levels);
+
+	/*
+	A chain bigger than a chunk of the staging ring is decoded in memory and
+	uploaded in chunks. Both have a spare byte for the JPEG decoder.
+	*/
+	if (size + 1 > m_staging_ring->getMaxAllocationSize()) {
+		auto chain = std::vector<unsigned char>(gsl::narrow_cast<size_t>(size + 1));
+		decodeTextureInto(source, path, chain.data(), chain.size(), width, height);
+		writeMipChain(chain.data(), levels);
+		std::cout << "\tTexture decoded in memory, it doesn't fit in the staging ring" << std::endl;
+
+		return createTextureImage(chain.data(), size, width, height, levels, mip_levels);
+	}
 
+	const auto staging = stageUpload(size + 1);
+	const auto decoded_in_place = decodeTextureInto(source, path, staging.data, gsl::narrow<size_t>(staging.size), width, height);
+	writeMipChain(staging.data, levels);
+	std::cout << "\tTexture decoded " << (decoded_in_place ? "straight into" : "and copied into") << " the staging ring" << std::endl;
 
-	auto staging_buffer = AllocatedBuffer{};
+	return createTextureImage(width, height, levels, mip_levels, 1, [&](VkImage image) {
+		auto regions = getMipCopyRegions(levels);
+		for (auto& region : regions) {
+			region.bufferOffset += staging.offset;
+		}
+		copyBufferToImage(staging.buffer, image, regions);
+	});
+}
+
+auto Renderer::createTextureImage(const unsigned char* pixels, uint width, uint height, uint& mip_levels)->AllocatedImage {
+
+	mip_levels = config::mipmaps_enabled ? getMipLevelCount(width, height) : 1;
 
 	/*
-	We create and fill the staging buffer for the texture
+	The mip chain is blitted on the GPU when the format allows it, otherwise
+	we filter it on the CPU and upload every level from the staging buffer.
 	*/
-	{
-		createBuffer(
-			image_size,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VMA_MEMORY_USAGE_CPU_TO_GPU,
-			VMA_ALLOCATION_CREATE_MAPPED_BIT,
-			staging_buffer,
-			VK_SHARING_MODE_EXCLUSIVE,
-			nullptr);
+	const auto blit_mipmaps = mip_levels > 1 && supportsLinearBlit(m_physical_device, VK_FORMAT_R8G8B8A8_UNORM);
 
-		memcpy(
-			staging_buffer.allocation_info.pMappedData,
-			pixels,
-			gsl::narrow_cast<size_t>(image_size));
+	auto mip_chain = MipChain{};
+	if (mip_levels > 1 && !blit_mipmaps) {
+		mip_chain = generateMipChain(pixels, width, height, mip_levels);
+	}
+	else {
+		mip_chain.levels.push_back({ 0, width, height });
 	}
 
+	return createTextureImage(
+		mip_chain.pixels.empty() ? pixels : mip_chain.pixels.data(),
+		mip_chain.pixels.empty() ? VkDeviceSize{ width } * height * 4 : VkDeviceSize{ mip_chain.pixels.size() },
+		width,
+		height,
+		mip_chain.levels,
+		mip_levels);
+}
+
+auto Renderer::createTextureImage(
+	const unsigned char* data,
+	VkDeviceSize size,
+	uint width,
+	uint height,
+	const std::vector<MipLevel>& levels,
+	uint mip_levels,
+	uint layer_count)->AllocatedImage {
+
+	return createTextureImage(width, height, levels, mip_levels, layer_count, [&](VkImage image) {
+		uploadImage(image, VK_FORMAT_R8G8B8A8_UNORM, data, size, getMipCopyRegions(levels, layer_count, getMipChainSize(levels)));
+	});
+}
+
+auto Renderer::createTextureImage(
+	uint width,
+	uint height,
+	const std::vector<MipLevel>& levels,
+	uint mip_levels,
+	uint layer_count,
+	const std::function<void(VkImage)>& copy_levels)->AllocatedImage {
+
+	std::cout << "Creating Texture Image" << std::endl;
+
+	AllocatedImage image{};
 
-	stbi_image_free(pixels);
+	const auto blit_mipmaps = levels.size() < mip_levels;
 
+	[[gsl::suppress(type.4, 6387)]]{
 	/*
 	We create the image that will hold the texture
 	*/
 	{
-		auto queue_family_indices = std::vector<uint>{
-			gsl::narrow<uint>(m_queue_family_indices.graphics_family) ,
-			gsl::narrow<uint>(m_queue_family_indices.transfer_family)
-		};
+		/*
+		The blits read from the previous level so the image is also a transfer source
+		*/
+		createImage(
+			width,
+			height,
+			VK_FORMAT_R8G8B8A8_UNORM,
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | (blit_mipmaps ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0),
+			VMA_MEMORY_USAGE_GPU_ONLY,
+			0,
+			image,
+			VK_SHARING_MODE_EXCLUSIVE,
+			nullptr,
+			1,
+			mip_levels,
+			layer_count);
+	}
 
-		std::sort(queue_family_indices.begin(), queue_family_indices.end());
-		queue_family_indices.erase(
-			std::unique(queue_family_indices.begin(), queue_family_indices.end()),
-			queue_family_indices.end());
+	changeImageLayout(
+		image.image,
+		VK_FORMAT_B8G8R8A8_UNORM,
+		VK_IMAGE_LAYOUT_UNDEFINED,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		mip_levels,
+		layer_count);
+
+	copy_levels(image.image);
+
+	if (blit_mipmaps) {
+		generateMipmaps(image.image, width, height, mip_levels, layer_count);
+	}
+	else {
+		changeImageLayout(
+			image.image,
+			VK_FORMAT_B8G8R8A8_UNORM,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			mip_levels,
+			layer_count);
+	}
+	}
+	std::cout << "\t" << width << "x" << height;
+	if (layer_count > 1) {
+		std::cout << " with " << layer_count << " layers,";
+	}
+	std::cout << " with " << mip_levels << " mip levels ("
+		<< (mip_levels == 1 ? "none" : blit_mipmaps ? "blitted" : "filtered on the CPU") << ")" << std::endl;
+	std::cout << "\tTexture Image Created" << std::endl << std::endl;
+	return image;
+}
 
+auto Renderer::createTextureImage(const CookedTexture& texture) -> AllocatedImage {
+
+	std::cout << "Creating Texture Image" << std::endl;
+
+	AllocatedImage image{};
+	const auto mip_levels = gsl::narrow<uint>(texture.levels.size());
+
+	[[gsl::suppress(type.4, 6387)]]{
+	{
 		createImage(
-			texture_width,
-			texture_height,
-			VK_FORMAT_R8G8B8A8_UNORM,
+			texture.width,
+			texture.height,
+			texture.format,
 			VK_IMAGE_TILING_OPTIMAL,
 			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 			VMA_MEMORY_USAGE_GPU_ONLY,
 			0,
 			image,
-			queue_family_indices.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
-			&queue_family_indices);
+			VK_SHARING_MODE_EXCLUSIVE,
+			nullptr,
+			1,
+			mip_levels);
 	}
 
 	changeImageLayout(
 		image.image,
-		VK_FORMAT_B8G8R8A8_UNORM,
+		texture.format,
 		VK_IMAGE_LAYOUT_UNDEFINED,
-		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		mip_levels);
 
-	copyBufferToImage(
-		staging_buffer.buffer,
+	uploadImage(
 		image.image,
-		gsl::narrow_cast<uint>(texture_width),
-		gsl::narrow_cast<uint>(texture_height));
+		texture.format,
+		texture.data.data(),
+		VkDeviceSize{ texture.data.size() },
+		getMipCopyRegions(texture.levels));
 
 	changeImageLayout(
 		image.image,
-		VK_FORMAT_B8G8R8A8_UNORM,
+		texture.format,
 		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-	destroyBuffer(staging_buffer);
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		mip_levels);
 	}
+	std::cout << "\t" << texture.width << "x" << texture.height << " with " << mip_levels
+		<< " cooked mip levels (" << texture.data.size() / 1024 << " KiB)" << std::endl;
 	std::cout << "\tTexture Image Created" << std::endl << std::endl;
 	return image;
 }
 
-auto Renderer::createTextureImageView(AllocatedImage image) -> VkImageView {
+auto Renderer::createTextureImage(const std::vector<std::string>& paths, uint& mip_levels, uint& layer_count) -> AllocatedImage {
+
+	/*
+	Every layer comes with its whole mip chain, read from the texture cache or
+	decoded and filtered on the CPU by the workers of the thread pool. The
+	atlas is packed again from the size of the textures, the same layout the
+	vertices were remapped with.
+	*/
+	auto batch = decodeTextureBatch(paths, m_texture_cache.get(), config::mipmaps_enabled, &m_thread_pool);
+	const auto texture = config::texture_atlas_enabled ?
+		buildTextureAtlas(batch, packTextureAtlas(paths, config::texture_atlas_gutter), config::mipmaps_enabled) :
+		buildTextureArray(batch);
+	mip_levels = gsl::narrow<uint>(texture.levels.size());
+	layer_count = texture.layer_count;
+
+	const auto record_start = std::chrono::high_resolution_clock::now();
+	auto image = createTextureImage(texture.width, texture.height, texture.levels, mip_levels, texture.layer_count, [&](VkImage image) {
+
+		/*
+		Every layer is staged and recorded on its own so the upload of every
+		texture of an array is timed alone. The textures of an atlas share its
+		single layer, each one gets the share of the upload its texels are.
+		*/
+		const auto layer_regions = getMipCopyRegions(texture.levels);
+
+		[[gsl::suppress(bounds.1, bounds.4)]]{
+		for (auto layer = uint{ 0 }; layer < texture.layer_count; ++layer) {
+			const auto start = std::chrono::high_resolution_clock::now();
+
+			auto regions = layer_regions;
+			for (auto& region : regions) {
+				region.imageSubresource.baseArrayLayer = layer;
+			}
+			uploadImage(image, VK_FORMAT_R8G8B8A8_UNORM, texture.pixels.data() + layer * texture.layer_size, texture.layer_size, regions);
+
+			const auto upload_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			if (texture.layer_count == batch.timings.size()) {
+				batch.timings[layer].upload_milliseconds = upload_milliseconds;
+				continue;
+			}
+
+			auto texel_count = 0.0;
+			for (const auto& timing : batch.timings) {
+				texel_count += double{ timing.width } * timing.height;
+			}
+			for (auto& timing : batch.timings) {
+				timing.upload_milliseconds = texel_count > 0.0 ? upload_milliseconds * timing.width * timing.height / texel_count : 0.0;
+			}
+		}
+		}
+	});
+
+	printTextureBatchTimings(
+		batch,
+		std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - record_start).count());
+	return image;
+}
+
+auto Renderer::createTextureImageView(AllocatedImage image, uint mip_levels, VkFormat format, uint layer_count) -> VkImageView {
 
 	VkImageView image_view;
 
@@ -1731,8 +2060,11 @@ auto Renderer::createTextureImageView(AllocatedImage image) -> VkImageView {
 
 	image_view = createImageView(
 		image.image,
-		VK_FORMAT_R8G8B8A8_UNORM,
-		VK_IMAGE_ASPECT_COLOR_BIT);
+		format,
+		VK_IMAGE_ASPECT_COLOR_BIT,
+		mip_levels,
+		VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+		layer_count);
 
 	std::cout << "\tTexture Image View Created" << std::endl << std::endl;
 
@@ -1742,108 +2074,372 @@ auto Renderer::createTextureImageView(AllocatedImage image) -> VkImageView {
 
 auto Renderer::loadScene(std::string object_path, std::string texture_path) -> void {
 
-	m_scene.indices.clear();
-	m_scene.vertices.clear();
-	m_scene.m_texture_image = createTextureImage(texture_path);
-	m_scene.m_texture_image_view = createTextureImageView(m_scene.m_texture_image);
+	loadMesh(object_path, m_scene, m_thread_pool);
+	createSceneTexture(texture_path);
+}
 
-	tinyobj::attrib_t attributes;
-	std::vector<tinyobj::shape_t> shapes;
-	std::vector<tinyobj::material_t> materials;
-	std::string err;
+auto Renderer::loadSkinnedScene(std::string model_path) -> void {
 
-	if (!tinyobj::LoadObj(&attributes, &shapes, &materials, &err, object_path.c_str())) {
-		throw std::runtime_error(err);
-	}
+	std::cout << "Loading Skinned Mesh" << std::endl;
 
-	auto unique_vertices = std::unordered_map<Vertex, uint>{};
+	m_skinned_mesh = loadSkinnedMesh(model_path);
+	if (m_skinned_mesh.clip.frame_count == 0) {
+		m_skinned_mesh.clip = makeSwayClip(
+			m_skinned_mesh.skeleton,
+			m_skinned_mesh.reference_pose,
+			config::skinning_sway_frames,
+			config::skinning_frame_rate,
+			config::skinning_sway_amplitude);
+	}
+	const auto frame_count = m_skinned_mesh.clip.frame_count;
 
-	for (const auto& shape : shapes) {
-		for (const auto& index : shape.mesh.indices) {
-			auto vertex = Vertex{};
+	if (config::animation_cooking_enabled) {
+		m_cooked_clip = cookAnimationClip(m_skinned_mesh, m_skinned_mesh.clip, config::animation_skin_error);
+		m_cooked_clip_sampler = CookedClipSampler(m_cooked_clip);
+		m_skinned_mesh.clip.poses = std::vector<BonePose>{};
+	}
+	m_skinning_kernel = getBestSkinningKernel();
+	m_skinning_palette.resize(m_skinned_mesh.skeleton.boneCount());
+	m_skinning_start_time = std::chrono::high_resolution_clock::now();
 
-			vertex.pos = {
-				attributes.vertices[3 * index.vertex_index + 0],
-				attributes.vertices[3 * index.vertex_index + 1],
-				attributes.vertices[3 * index.vertex_index + 2]
-			};
+	/*
+	The dispatch is recorded in the command buffers of the graphics queue,
+	so its family has to run compute shaders too. Vulkan only guarantees
+	that some family does both.
+	*/
+	if (config::gpu_skinning_enabled) {
+		auto queue_family_count = uint{};
+		vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &queue_family_count, nullptr);
 
-			vertex.tex_coord = {
-				attributes.texcoords[2 * index.texcoord_index + 0],
-				1.0f - attributes.texcoords[2 * index.texcoord_index + 1]
-			};
+		auto queue_families = std::vector<VkQueueFamilyProperties>(queue_family_count);
+		vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &queue_family_count, queue_families.data());
 
-			if (unique_vertices.count(vertex) == 0) {
-				unique_vertices[vertex] = gsl::narrow<uint>(m_scene.vertices.size());
-				m_scene.vertices.push_back(vertex);
-			}
+		const auto& graphics_family = queue_families.at(m_queue_family_indices.graphics_family);
+		m_gpu_skinning = (graphics_family.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+		m_skinning_timestamp_valid_bits = graphics_family.timestampValidBits;
+	}
 
-			m_scene.indices.push_back(unique_vertices[vertex]);
+	/*
+	The vertices are only in the skinned vertex buffers. The bounds of the
+	reference pose are enough for the single level of detail, and the
+	vertices move so the scene has no meshlets to cull.
+	*/
+	m_scene.indices = m_skinned_mesh.indices;
+	m_scene.index_type = VK_INDEX_TYPE_UINT32;
+	m_scene.bounds = computeMeshBounds(m_skinned_mesh.vertices.data(), m_skinned_mesh.vertices.size());
+	m_scene.texture_paths = m_skinned_mesh.texture_paths;
+
+	auto sub_mesh = SubMesh{};
+	sub_mesh.index_count = gsl::narrow<uint32_t>(m_scene.indices.size());
+	sub_mesh.vertex_count = gsl::narrow<uint32_t>(m_skinned_mesh.vertices.size());
+	m_scene.sub_meshes = { sub_mesh };
+
+	auto lod = MeshLod{};
+	lod.sub_mesh_count = 1;
+	m_scene.lods = { lod };
+
+	std::cout << "\t" << m_skinned_mesh.vertices.size() << " vertices, " << m_scene.indices.size() / 3 << " triangles, "
+		<< m_skinned_mesh.skeleton.boneCount() << " bones, " << frame_count << " frames" << std::endl;
+	if (m_cooked_clip.frame_count > 0) {
+		const auto& statistics = m_cooked_clip.statistics;
+		std::cout << "\tClip cooked from " << statistics.raw_bytes / 1024 << " KB to " << statistics.cooked_bytes / 1024 << " KB, "
+			<< statistics.rotation_keys << " rotation and " << statistics.translation_keys << " translation keys of "
+			<< statistics.raw_keys << ", " << statistics.constant_tracks << " constant tracks, max skin error "
+			<< statistics.max_skin_error << std::endl;
+	}
+	if (m_gpu_skinning) {
+		std::cout << "\tSkinned by a compute shader" << std::endl;
+	}
+	else {
+		if (config::gpu_skinning_enabled) {
+			std::cout << "\tThe graphics queue can't run compute shaders, skinning on the CPU" << std::endl;
 		}
+		std::cout << "\tSkinned with the " << getSkinningKernelName(m_skinning_kernel) << " kernel on "
+			<< m_thread_pool.getThreadCount() << " threads" << std::endl;
 	}
-}
-
-auto Renderer::createTextureSampler() -> void {
+	std::cout << "\tSkinned Mesh Loaded" << std::endl << std::endl;
 
-	std::cout << "\tCreating Texture Sampler" << std::endl;
+	createSceneTexture(config::model_path + "obj/tarzan/Tarzan_packed/Tarzan_packed_full.png");
+}
 
-	auto create_info = VkSamplerCreateInfo{};
-	{
-		create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-		/*
-		We also could use VK_FILTER_NEAREST for a pixelated look
-		*/
-		create_info.magFilter = VK_FILTER_LINEAR;
-		create_info.minFilter = VK_FILTER_LINEAR;
-		/*
-		Options here are:
-			- VK_SAMPLER_ADDRESS_MODE_REPEAT: Just repeat the texture
-			- VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT: Repeat and mirroring
-			- VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE: Spread color to edges
-			- VK_SAMPLER_ADDRESS_MODE_MIRROR_CLAMP_TO_EDGE: Spread color to edges and mirror
-			- VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER: Just draw the texture and fill the rest with a color
+auto Renderer::createSceneTexture(std::string texture_path) -> void {
 
-		We pick normal VK_SAMPLER_ADDRESS_MODE_REPEAT since it is the most common
-		and usefull when tiling surfaces like floors.
-		*/
-		create_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-		create_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-		create_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	/*
+	A single material texture is loaded like any other texture, so it can be cooked
+	*/
+	if (m_scene.texture_paths.size() > 1) {
+		m_scene.m_texture_image = createTextureImage(
+			m_scene.texture_paths,
+			m_scene.m_texture_mip_levels,
+			m_scene.m_texture_layers);
+		m_scene.m_texture_format = VK_FORMAT_R8G8B8A8_UNORM;
+	}
+	else {
+		m_scene.m_texture_image = createTextureImage(
+			m_scene.texture_paths.empty() ? texture_path : m_scene.texture_paths.front(),
+			m_scene.m_texture_mip_levels,
+			m_scene.m_texture_format);
+		m_scene.m_texture_layers = 1;
+	}
 
-		create_info.anisotropyEnable = VK_TRUE;
-		create_info.maxAnisotropy = 16;
-		create_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+	m_scene.m_texture_image_view = createTextureImageView(
+		m_scene.m_texture_image,
+		m_scene.m_texture_mip_levels,
+		m_scene.m_texture_format,
+		m_scene.m_texture_layers);
+}
 
-		create_info.unnormalizedCoordinates = VK_FALSE;
+auto Renderer::streamScene(std::string object_path, std::string texture_path) -> void {
+
+	auto context = AssetStreamerContext{};
+	context.device = m_device;
+	context.allocator = m_vma_allocator;
+	context.command_buffers = m_transfer_command_buffer_pool.get();
+	context.transfer_family = gsl::narrow<uint>(m_queue_family_indices.transfer_family);
+	context.graphics_family = gsl::narrow<uint>(m_queue_family_indices.graphics_family);
+	context.staging_alignment = m_staging_alignment;
+	context.vertex_format = config.vertex_format;
+	context.index_type = m_geometry_pool->getIndexType();
+	context.thread_pool = &m_thread_pool;
+	context.geometry_pool = m_geometry_pool.get();
+	context.compact_geometry = [this]() { compactGeometryPool(); };
+	/*
+	Blits need a queue with graphics support, when the transfer family has none
+	the workers filter the mip chains on the CPU.
+	*/
+	context.blit_mipmaps =
+		m_queue_family_indices.transfer_family == m_queue_family_indices.graphics_family &&
+		supportsLinearBlit(m_physical_device, VK_FORMAT_R8G8B8A8_UNORM);
+	context.cooked_textures = config::cooked_textures_enabled && m_physical_device_features.textureCompressionBC;
+	context.texture_cache = m_texture_cache.get();
 
-		create_info.compareEnable = VK_FALSE;
-		create_info.compareOp = VK_COMPARE_OP_ALWAYS;
+	m_asset_streamer = std::make_unique<AssetStreamer>(context, config::streaming_threads);
 
-		create_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-		create_info.mipLodBias = 0.0f;
-		create_info.minLod = 0.0f;
-		create_info.maxLod = 0.0f;
+	/*
+	A single grey pixel keeps the descriptor set valid until the texture arrives
+	*/
+	const unsigned char placeholder_pixel[] = { 128, 128, 128, 255 };
+	[[gsl::suppress(bounds.3)]]{
+	m_scene.m_texture_image = createTextureImage(placeholder_pixel, 1, 1, m_scene.m_texture_mip_levels);
 	}
+	m_scene.m_texture_image_view = createTextureImageView(m_scene.m_texture_image);
 
-	if (vkCreateSampler(m_device, &create_info, nullptr, &m_texture_sampler) != VK_SUCCESS) {
-		throw std::runtime_error("We coulnd't create the texture sampler");
+	m_streamed_mesh = m_asset_streamer->requestMesh(object_path);
+	m_streamed_texture_path = texture_path;
+	if (!config::material_textures_enabled) {
+		m_streamed_texture = m_asset_streamer->requestTexture(texture_path);
 	}
-
-	std::cout << "\tTexture Sampler Created" << std::endl << std::endl;
 }
 
-auto Renderer::createBuffer(
-	VkDeviceSize size,
-	VkBufferUsageFlags usage,
-#ifdef VMA_USE_ALLOCATOR
-	VmaMemoryUsage allocation_usage,
-	VmaAllocationCreateFlags allocation_flags,
-#else
-	VkMemoryPropertyFlags properties,
-#endif
-	AllocatedBuffer& allocated_buffer,
-	VkSharingMode sharing_mode,
-	const std::vector<uint>* queue_family_indices) -> void {
+auto Renderer::updateStreaming() -> void {
+
+	if (!m_asset_streamer) {
+		return;
+	}
+
+	for (const auto handle : m_asset_streamer->poll()) {
+
+		if (m_asset_streamer->getState(handle) != AssetState::ready) {
+			continue;
+		}
+
+		if (handle == m_streamed_mesh) {
+			auto mesh = m_asset_streamer->takeMesh(handle);
+
+			const auto old_geometry = m_scene_geometry;
+			auto old_indirect_buffers = std::move(m_indirect_buffers);
+			m_indirect_buffers.clear();
+			retireResource([this, old_geometry, old_indirect_buffers]() mutable {
+				if (old_geometry != invalid_geometry) {
+					m_geometry_pool->free(old_geometry);
+				}
+				for (auto& indirect_buffer : old_indirect_buffers) {
+					destroyBuffer(indirect_buffer);
+				}
+			});
+
+			/*
+			The streamer uploaded the mesh straight into a range of the geometry
+			pool through the transfer queue, the graphics queue takes the range
+			over before the frames that draw it. Later submissions to the queue
+			are ordered after the barrier, so we don't wait for it.
+			*/
+			if (m_asset_streamer->needsOwnershipTransfer()) {
+				auto command_buffer = beginSingleTimeCommands(CommandType::graphics);
+				m_asset_streamer->recordAcquire(
+					command_buffer.buffer,
+					mesh,
+					VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+					VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT);
+				submitSingleTimeCommands(command_buffer);
+			}
+			m_scene_geometry = mesh.geometry;
+			/*
+			The scene keeps its texture, everything else comes from the streamed mesh
+			*/
+			const auto texture_image = m_scene.m_texture_image;
+			const auto texture_image_view = m_scene.m_texture_image_view;
+			const auto texture_mip_levels = m_scene.m_texture_mip_levels;
+			const auto texture_layers = m_scene.m_texture_layers;
+			const auto texture_format = m_scene.m_texture_format;
+			m_scene = std::move(mesh.scene);
+			m_scene.m_texture_image = texture_image;
+			m_scene.m_texture_image_view = texture_image_view;
+			m_scene.m_texture_mip_levels = texture_mip_levels;
+			m_scene.m_texture_layers = texture_layers;
+			m_scene.m_texture_format = texture_format;
+
+			m_current_lod = 0;
+			createIndirectBuffers();
+
+			/*
+			Now we know the textures of the materials of the mesh
+			*/
+			if (m_streamed_texture == invalid_asset) {
+				m_streamed_texture = m_asset_streamer->requestTexture(
+					m_scene.texture_paths.empty() ? std::vector<std::string>{ m_streamed_texture_path } : m_scene.texture_paths);
+			}
+		}
+		else if (handle == m_streamed_texture) {
+			auto texture = m_asset_streamer->takeTexture(handle);
+
+			/*
+			The image comes from the transfer family, the graphics queue takes
+			it over before the frames that sample it. Later submissions to the
+			queue are ordered after the barrier, so we don't wait for it.
+			*/
+			if (m_asset_streamer->needsOwnershipTransfer()) {
+				auto command_buffer = beginSingleTimeCommands(CommandType::graphics);
+				m_asset_streamer->recordAcquire(
+					command_buffer.buffer,
+					texture,
+					VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+					VK_ACCESS_SHADER_READ_BIT);
+				submitSingleTimeCommands(command_buffer);
+			}
+
+			auto old_image = m_scene.m_texture_image;
+			const auto old_image_view = m_scene.m_texture_image_view;
+			const auto old_descriptor_set = m_descriptor_set;
+			retireResource([this, old_image, old_image_view, old_descriptor_set]() mutable {
+				vkFreeDescriptorSets(m_device, m_descriptor_pool, 1, &old_descriptor_set);
+				vkDestroyImageView(m_device, old_image_view, nullptr);
+				destroyImage(old_image);
+			});
+
+			m_scene.m_texture_image = texture.image;
+			m_scene.m_texture_mip_levels = texture.mip_levels;
+			m_scene.m_texture_layers = texture.layers;
+			m_scene.m_texture_format = texture.format;
+			m_scene.m_texture_image_view = createTextureImageView(
+				texture.image,
+				texture.mip_levels,
+				texture.format,
+				texture.layers);
+
+			/*
+			The command buffers in flight still use the old set, so we
+			allocate a new one instead of updating it.
+			*/
+			createDescriptorSet();
+		}
+		else {
+			continue;
+		}
+
+		std::fill(m_command_buffer_outdated.begin(), m_command_buffer_outdated.end(), true);
+	}
+}
+
+auto Renderer::retireResource(std::function<void()> destroy) -> void {
+
+	/*
+	Every command buffer recorded before now is waited for before it is
+	recorded again, after m_command_buffers.size() frames all of them have been.
+	*/
+	m_retired_resources.emplace_back(m_frame_index + m_command_buffers.size(), std::move(destroy));
+}
+
+auto Renderer::destroyRetiredResources(bool all) noexcept -> void {
+
+	auto retired = m_retired_resources.begin();
+	while (retired != m_retired_resources.end()) {
+		if (all || retired->first <= m_frame_index) {
+			retired->second();
+			retired = m_retired_resources.erase(retired);
+		}
+		else {
+			++retired;
+		}
+	}
+}
+
+auto Renderer::createTextureSampler() -> void {
+
+	std::cout << "\tCreating Texture Sampler" << std::endl;
+
+	auto create_info = VkSamplerCreateInfo{};
+	{
+		create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		/*
+		We also could use VK_FILTER_NEAREST for a pixelated look
+		*/
+		create_info.magFilter = VK_FILTER_LINEAR;
+		create_info.minFilter = VK_FILTER_LINEAR;
+		/*
+		Options here are:
+			- VK_SAMPLER_ADDRESS_MODE_REPEAT: Just repeat the texture
+			- VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT: Repeat and mirroring
+			- VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE: Spread color to edges
+			- VK_SAMPLER_ADDRESS_MODE_MIRROR_CLAMP_TO_EDGE: Spread color to edges and mirror
+			- VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER: Just draw the texture and fill the rest with a color
+
+		We pick normal VK_SAMPLER_ADDRESS_MODE_REPEAT since it is the most common
+		and usefull when tiling surfaces like floors.
+		*/
+		create_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		create_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		create_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+
+		create_info.anisotropyEnable = VK_TRUE;
+		create_info.maxAnisotropy = 16;
+		create_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+
+		create_info.unnormalizedCoordinates = VK_FALSE;
+
+		create_info.compareEnable = VK_FALSE;
+		create_info.compareOp = VK_COMPARE_OP_ALWAYS;
+
+		/*
+		The sampler is shared by every texture so we don't clamp the level
+		of detail, each view limits it to the levels of its image.
+		*/
+		create_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		create_info.mipLodBias = 0.0f;
+		create_info.minLod = 0.0f;
+		create_info.maxLod = config::mipmaps_enabled ? VK_LOD_CLAMP_NONE : 0.0f;
+	}
+
+	if (vkCreateSampler(m_device, &create_info, nullptr, &m_texture_sampler) != VK_SUCCESS) {
+		throw std::runtime_error("We coulnd't create the texture sampler");
+	}
+
+	std::cout << "\tTexture Sampler Created" << std::endl << std::endl;
+}
+
+auto Renderer::createBuffer(
+	VkDeviceSize size,
+	VkBufferUsageFlags usage,
+#ifdef VMA_USE_ALLOCATOR
+	VmaMemoryUsage allocation_usage,
+	VmaAllocationCreateFlags allocation_flags,
+#else
+	VkMemoryPropertyFlags properties,
+#endif
+	AllocatedBuffer& allocated_buffer,
+	VkSharingMode sharing_mode,
+	const std::vector<uint>* queue_family_indices,
+	VkMemoryPropertyFlags preferred_properties) -> void {
 
 	auto buffer_create_info = VkBufferCreateInfo{};
 
@@ -1868,6 +2464,14 @@ auto Renderer::createBuffer(
 	auto allocation_info = VmaAllocationCreateInfo{};
 	allocation_info.usage = allocation_usage;
 	allocation_info.flags = allocation_flags;
+	allocation_info.preferredFlags = preferred_properties;
+
+	/*
+	We never flush the mapped buffers, cached memory has to be coherent too
+	*/
+	if (preferred_properties & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) {
+		allocation_info.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	}
 
 	vmaCreateBuffer(
 		m_vma_allocator,
@@ -1913,138 +2517,147 @@ auto Renderer::destroyBuffer(
 
 }
 
-auto Renderer::createVertexBuffer() -> void {
+auto Renderer::createGeometryPool() -> void {
 
-	std::cout << "Creating Vertex Buffer" << std::endl;
+	std::cout << "Creating Geometry Pool" << std::endl;
 
+	/*
+	The arenas are exclusive to the graphics family, the streamed meshes are
+	acquired from the transfer family and copied into them on the graphics queue
+	*/
+	auto context = GeometryPoolContext{};
+	context.allocator = m_vma_allocator;
 
-	[[gsl::suppress(type.4)]]{
+	/*
+	With the meshes split for short indices every sub-mesh fits in 16 bits
+	*/
+	context.vertex_stride = getVertexStride(config.vertex_format);
+	context.index_type = config::split_for_short_indices ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+	context.vertex_capacity = config::geometry_pool_vertex_capacity;
+	context.index_capacity = config::geometry_pool_index_capacity;
+
+	m_geometry_pool = std::make_unique<GeometryPool>(context);
+
+	std::cout << "\t" << context.vertex_capacity << " vertices of " << context.vertex_stride << " bytes and "
+		<< context.index_capacity << " indices of " << m_geometry_pool->getIndexSize() << " bytes ("
+		<< (context.vertex_stride * context.vertex_capacity + m_geometry_pool->getIndexSize() * context.index_capacity) / 1024
+		<< " KiB)" << std::endl;
+	std::cout << "\tGeometry Pool Created" << std::endl << std::endl;
+}
 
-		/*
-		Access to this buffer will be granted to both the graphics family to allow the
-		GPU to render from it and the transfer family so we can write to the buffer
-		from another one mapped to CPU memory.
-		*/
-		auto queue_family_indices = std::vector<uint>{
-			gsl::narrow<uint>(m_queue_family_indices.graphics_family) ,
-			gsl::narrow<uint>(m_queue_family_indices.transfer_family)
-		};
+auto Renderer::createSceneGeometry() -> void {
 
-		std::sort(queue_family_indices.begin(), queue_family_indices.end());
-		queue_family_indices.erase(
-			std::unique(queue_family_indices.begin(), queue_family_indices.end()),
-			queue_family_indices.end());
+	std::cout << "Creating Scene Geometry" << std::endl;
 
-		auto buffer_size = VkDeviceSize{ gsl::narrow_cast<size_t>(sizeof(m_scene.vertices[0]))*m_scene.vertices.size() };
+	/*
+	A streamed scene has no geometry until its mesh is uploaded
+	*/
+	if (m_scene.indexCount() == 0) {
+		std::cout << "\tThe scene has no indices yet" << std::endl << std::endl;
+		return;
+	}
 
-		auto staging_buffer = AllocatedBuffer{};
-		createBuffer(
-			buffer_size,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-	#ifndef VMA_USE_ALLOCATOR
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-	#else
-			VMA_MEMORY_USAGE_CPU_TO_GPU,
-			VMA_ALLOCATION_CREATE_MAPPED_BIT,
-	#endif
-			staging_buffer,
-			VK_SHARING_MODE_EXCLUSIVE,
-			nullptr);
+	if (!setIndexType(m_scene, m_geometry_pool->getIndexType())) {
+		throw std::runtime_error("The scene needs bigger indices than the ones of the geometry pool");
+	}
 
-	#ifdef VMA_USE_ALLOCATOR
-		memcpy(staging_buffer.allocation_info.pMappedData, m_scene.vertices.data(), gsl::narrow_cast<size_t>(buffer_size));
-	#else
-		void *data;
-		vkMapMemory(m_device, staging_buffer.memory, 0, buffer_size, 0, &data);
-		memcpy(data, vertices.data(), gsl::narrow_cast<size_t>(buffer_size));
-		vkUnmapMemory(m_device, staging_buffer.memory);
-	#endif
+	/*
+	A skinned scene only has its indices in the pool, the vertices are skinned
+	every frame into the skinned vertex buffers
+	*/
+	const auto skinned = !m_skinned_mesh.vertices.empty();
+	const auto vertex_count = skinned ? uint32_t{ 0 } : gsl::narrow<uint32_t>(m_scene.vertexCount());
+	const auto index_count = gsl::narrow<uint32_t>(m_scene.indexCount());
 
-		createBuffer(
-			buffer_size,
-			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-	#ifdef VMA_USE_ALLOCATOR
-			VMA_MEMORY_USAGE_GPU_ONLY,
-			0,
-	#else
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-	#endif
-			m_vertex_buffer,
-			queue_family_indices.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
-			&queue_family_indices);
+	m_scene_geometry = allocateGeometry(vertex_count, index_count);
+	const auto& range = m_geometry_pool->getRange(m_scene_geometry);
 
-		copyBuffer(staging_buffer.buffer, m_vertex_buffer.buffer, buffer_size);
+	const auto vertex_stride = m_geometry_pool->getVertexStride();
+	const auto index_size = m_geometry_pool->getIndexSize();
 
-		destroyBuffer(staging_buffer);
+	/*
+	Compact vertices are quantized and 16 bit indices narrowed straight into
+	the staging ring
+	*/
+	if (vertex_count > 0) {
+		uploadBuffer(
+			vertex_stride * vertex_count,
+			m_geometry_pool->getVertexBuffer(),
+			[this](void* data) { writeVertexBufferData(m_scene, config.vertex_format, data); },
+			vertex_stride * range.first_vertex);
+
+		std::cout << "\t" << vertex_count << " vertices of " << vertex_stride << " bytes ("
+			<< vertex_stride * vertex_count << " bytes, " << sizeof(Vertex) * vertex_count << " bytes with full vertices)" << std::endl;
 	}
-	std::cout << "\tVertex Buffer Created" << std::endl << std::endl;
 
+	uploadBuffer(
+		index_size * index_count,
+		m_geometry_pool->getIndexBuffer(),
+		[this](void* data) { writeIndexBufferData(m_scene, data); },
+		index_size * range.first_index);
+
+	std::cout << "\t" << index_count << " indices of " << index_size << " bytes in "
+		<< m_scene.sub_meshes.size() << " sub-meshes (" << index_size * index_count << " bytes, "
+		<< sizeof(uint32_t) * index_count << " bytes with 32 bit indices)" << std::endl;
+	std::cout << "\tScene Geometry Created" << std::endl << std::endl;
 }
 
-auto Renderer::createIndexBuffer() -> void {
+auto Renderer::allocateGeometry(uint32_t vertex_count, uint32_t index_count) -> GeometryHandle {
 
-	std::cout << "Creating Index Buffer" << std::endl;
+	auto handle = m_geometry_pool->allocate(vertex_count, index_count);
+	if (handle == invalid_geometry && m_geometry_pool->fitsAfterCompaction(vertex_count, index_count)) {
+		compactGeometryPool();
+		handle = m_geometry_pool->allocate(vertex_count, index_count);
+	}
 
-	[[gsl::suppress(type.4)]]{
-		/*
-		Access to this buffer will be granted to both the graphics family to allow the
-		GPU to render from it and the transfer family so we can write to the buffer
-		from another one mapped to CPU memory.
-		*/
-		auto queue_family_indices = std::vector<uint>{
-			gsl::narrow<uint>(m_queue_family_indices.graphics_family) ,
-			gsl::narrow<uint>(m_queue_family_indices.transfer_family)
-		};
+	if (handle == invalid_geometry) {
+		throw std::runtime_error("We couldn't fit a mesh in the geometry pool");
+	}
+	return handle;
+}
 
-		std::sort(queue_family_indices.begin(), queue_family_indices.end());
-		queue_family_indices.erase(
-			std::unique(queue_family_indices.begin(), queue_family_indices.end()),
-			queue_family_indices.end());
+auto Renderer::compactGeometryPool() -> void {
 
-		auto buffer_size = VkDeviceSize{ gsl::narrow_cast<size_t>(sizeof(m_scene.indices[0]))*m_scene.indices.size() };
+	std::cout << "Compacting Geometry Pool" << std::endl;
 
-		auto staging_buffer = AllocatedBuffer{};
-		createBuffer(
-			buffer_size,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-	#ifndef VMA_USE_ALLOCATOR
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-	#else
-			VMA_MEMORY_USAGE_CPU_TO_GPU,
-			VMA_ALLOCATION_CREATE_MAPPED_BIT,
-	#endif
-			staging_buffer,
-			VK_SHARING_MODE_EXCLUSIVE,
-			nullptr);
+	const auto free_ranges = m_geometry_pool->getVertices().getFreeRangeCount() + m_geometry_pool->getIndices().getFreeRangeCount();
 
-	#ifdef VMA_USE_ALLOCATOR
-		memcpy(staging_buffer.allocation_info.pMappedData, m_scene.indices.data(), gsl::narrow_cast<size_t>(buffer_size));
-	#else
-		void *data;
-		vkMapMemory(m_device, staging_buffer.memory, 0, buffer_size, 0, &data);
-		memcpy(data, indices.data(), gsl::narrow_cast<size_t>(buffer_size));
-		vkUnmapMemory(m_device, staging_buffer.memory);
-	#endif
+	auto command_buffer = beginUploadCommands();
+	auto old_arenas = m_geometry_pool->compact(command_buffer.buffer);
+	recordGeometryBarrier(command_buffer.buffer);
+	endUploadCommands(command_buffer);
 
-		createBuffer(
-			buffer_size,
-			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-	#ifdef VMA_USE_ALLOCATOR
-			VMA_MEMORY_USAGE_GPU_ONLY,
-			0,
-	#else
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-	#endif
-			m_index_buffer,
-			queue_family_indices.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
-			&queue_family_indices);
+	/*
+	The command buffers in flight still draw from the old arenas
+	*/
+	retireResource([this, old_arenas]() mutable {
+		m_geometry_pool->destroyArenas(old_arenas);
+	});
+	std::fill(m_command_buffer_outdated.begin(), m_command_buffer_outdated.end(), true);
 
-		copyBuffer(staging_buffer.buffer, m_index_buffer.buffer, buffer_size);
+	std::cout << "\t" << m_geometry_pool->getRangeCount() << " meshes moved, " << free_ranges << " free ranges merged" << std::endl;
+	std::cout << "\tGeometry Pool Compacted" << std::endl << std::endl;
+}
 
-		destroyBuffer(staging_buffer);
-	}
+auto Renderer::recordGeometryBarrier(VkCommandBuffer command_buffer) noexcept -> void {
+
+	auto barrier = VkMemoryBarrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+
+	vkCmdPipelineBarrier(
+		command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+		0,
+		1, &barrier,
+		0, nullptr,
+		0, nullptr);
+}
 
-	std::cout << "\tIndex Buffer Created" << std::endl << std::endl;
+auto Renderer::getSceneGeometry() const -> GeometryRange {
+	return m_scene_geometry == invalid_geometry ? GeometryRange{} : m_geometry_pool->getRange(m_scene_geometry);
 }
 
 auto Renderer::createUniformBuffer() -> void {
@@ -2080,22 +2693,26 @@ auto Renderer::createDescriptorPool() -> void {
 	/*
 	@NOTE: Change this to DYNAMIC if necessary
 	*/
+	/*
+	Besides the set in use there is room for the ones replaced by streamed
+	textures, they are freed once no command buffer in flight uses them.
+	*/
+	const auto max_sets = uint{ 4 };
 	pool_sizes.at(0).type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	pool_sizes.at(0).descriptorCount = 1;
+	pool_sizes.at(0).descriptorCount = max_sets;
 	pool_sizes.at(1).type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	pool_sizes.at(1).descriptorCount = 1;
+	pool_sizes.at(1).descriptorCount = max_sets;
 
 
 	auto create_info = VkDescriptorPoolCreateInfo{};
 	create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	create_info.poolSizeCount = gsl::narrow_cast<uint>(pool_sizes.size());
 	create_info.pPoolSizes = pool_sizes.data();
-	create_info.maxSets = 1;
+	create_info.maxSets = max_sets;
 	/*
-	@NOTE: Use the VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT if we
-	want to free individual descriptor sets
+	We free the retired descriptor sets individually
 	*/
-	create_info.flags = 0;
+	create_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
 
 	if (vkCreateDescriptorPool(m_device, &create_info, nullptr, &m_descriptor_pool) != VK_SUCCESS) {
 		throw std::runtime_error("We couldn't create the descriptor pool");
@@ -2201,56 +2818,640 @@ auto Renderer::findSupportedFormat(
 		}
 	}
 
-	throw std::runtime_error("We couldn't find an appropriate format");
-}
+	throw std::runtime_error("We couldn't find an appropriate format");
+}
+
+auto Renderer::findMemoryType(uint type_bits, VkMemoryPropertyFlags properties, VkBool32 *found)->uint {
+
+	auto memory_properties = VkPhysicalDeviceMemoryProperties{};
+	vkGetPhysicalDeviceMemoryProperties(m_physical_device, &memory_properties);
+
+
+	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+	{
+		if ((type_bits & 1) == 1)
+			[[gsl::suppress(bounds.2)]]
+		{
+			if ((memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+			{
+				if (found)
+				{
+					*found = true;
+				}
+				return i;
+			}
+		}
+		type_bits >>= 1;
+	}
+
+	if (found)
+	{
+		*found = false;
+		return 0;
+	}
+	else
+	{
+		throw std::runtime_error("We couldn't find an appropriate memory type");
+	}
+}
+
+auto Renderer::copyBuffer(
+	VkBuffer src,
+	VkBuffer dst,
+	VkDeviceSize size,
+	VkDeviceSize src_offset,
+	VkDeviceSize dst_offset) noexcept -> void {
+
+
+	/*
+	The buffers of the renderer are exclusive to the graphics queue, so the
+	copies run on it too. The streamed ones go through the transfer queue.
+	*/
+	auto command_buffer = beginUploadCommands();
+
+	auto copy_region = VkBufferCopy{};
+	copy_region.srcOffset = src_offset;
+	copy_region.dstOffset = dst_offset;
+	copy_region.size = size;
+	vkCmdCopyBuffer(command_buffer.buffer, src, dst, 1, &copy_region);
+
+	endUploadCommands(command_buffer);
+
+}
+
+auto Renderer::createIndirectBuffers() -> void {
+
+	std::cout << "Creating Indirect Buffers" << std::endl;
+
+	/*
+	Room for the meshlets or the sub-meshes of any level of detail, and at
+	least one command so the buffers are valid with an empty scene.
+	*/
+	m_indirect_command_count = gsl::narrow<uint>(std::max({ m_scene.meshlets.size(), m_scene.sub_meshes.size(), size_t{ 1 } }));
+
+	[[gsl::suppress(type.4)]]{
+	const auto buffer_size = VkDeviceSize{ sizeof(VkDrawIndexedIndirectCommand) * m_indirect_command_count };
+
+	m_indirect_buffers.resize(m_swap_chain_framebuffers.size());
+
+	for (auto& indirect_buffer : m_indirect_buffers) {
+		createBuffer(
+			buffer_size,
+			VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+#ifndef VMA_USE_ALLOCATOR
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+#else
+			VMA_MEMORY_USAGE_CPU_TO_GPU,
+			VMA_ALLOCATION_CREATE_MAPPED_BIT,
+#endif
+			indirect_buffer,
+			VK_SHARING_MODE_EXCLUSIVE,
+			nullptr);
+	}
+
+	/*
+	Until the first update every buffer draws the full mesh
+	*/
+	auto commands = std::vector<VkDrawIndexedIndirectCommand>(m_indirect_command_count);
+	if (!m_scene.lods.empty()) {
+		const auto geometry = getSceneGeometry();
+		writeSubMeshDraws(
+			m_scene.sub_meshes.data() + m_scene.lods[0].first_sub_mesh,
+			m_scene.lods[0].sub_mesh_count,
+			commands.data(),
+			commands.size(),
+			geometry.first_index,
+			gsl::narrow<int32_t>(geometry.first_vertex));
+	}
+
+	for (auto& indirect_buffer : m_indirect_buffers) {
+#ifdef VMA_USE_ALLOCATOR
+		memcpy(indirect_buffer.allocation_info.pMappedData, commands.data(), gsl::narrow_cast<size_t>(buffer_size));
+#else
+		void *data = nullptr;
+		vkMapMemory(m_device, indirect_buffer.memory, 0, buffer_size, 0, &data);
+		memcpy(data, commands.data(), gsl::narrow_cast<size_t>(buffer_size));
+		vkUnmapMemory(m_device, indirect_buffer.memory);
+#endif
+	}
+	}
+
+	std::cout << "\t" << m_indirect_buffers.size() << " Indirect Buffers Created with "
+		<< m_indirect_command_count << " draw commands" << std::endl << std::endl;
+}
+
+auto Renderer::updateIndirectBuffer(uint command_buffer_index) -> void {
+
+	auto& indirect_buffer = m_indirect_buffers.at(command_buffer_index);
+
+	if (m_scene.lods.empty()) {
+		return;
+	}
+
+	m_current_lod = selectLod(
+		m_scene.lods,
+		m_scene.bounds,
+		m_culling_transform.model,
+		m_culling_transform.view,
+		m_culling_transform.proj,
+		gsl::narrow_cast<float>(m_swap_chain_extent.height),
+		config::lod_error_threshold);
+
+	const auto& lod = m_scene.lods.at(m_current_lod);
+
+	/*
+	The sub-meshes and meshlets are relative to the range of the scene in the geometry pool
+	*/
+	const auto geometry = getSceneGeometry();
+	const auto vertex_offset = gsl::narrow<int32_t>(geometry.first_vertex);
+
+	auto writeDraws = [&](void* data) {
+		const auto commands = static_cast<VkDrawIndexedIndirectCommand*>(data);
+
+		if (config::meshlet_culling_enabled && lod.meshlet_count > 0) {
+			[[gsl::suppress(bounds.1)]]{
+			m_culling_statistics = cullMeshlets(
+				m_scene.meshlets.data() + lod.first_meshlet,
+				lod.meshlet_count,
+				m_culling_transform.model,
+				m_culling_transform.view,
+				m_culling_transform.proj,
+				commands,
+				m_indirect_command_count,
+				geometry.first_index,
+				vertex_offset);
+			}
+		}
+		else {
+			m_culling_statistics = MeshletCullingStatistics{};
+			[[gsl::suppress(bounds.1)]]{
+			m_culling_statistics.draw_count = writeSubMeshDraws(
+				m_scene.sub_meshes.data() + lod.first_sub_mesh,
+				lod.sub_mesh_count,
+				commands,
+				m_indirect_command_count,
+				geometry.first_index,
+				vertex_offset);
+			}
+		}
+	};
+
+#ifdef VMA_USE_ALLOCATOR
+	writeDraws(indirect_buffer.allocation_info.pMappedData);
+#else
+	const auto buffer_size = VkDeviceSize{ sizeof(VkDrawIndexedIndirectCommand) * m_indirect_command_count };
+	void *data = nullptr;
+	vkMapMemory(m_device, indirect_buffer.memory, 0, buffer_size, 0, &data);
+	writeDraws(data);
+	vkUnmapMemory(m_device, indirect_buffer.memory);
+#endif
+}
+
+auto Renderer::createSkinnedVertexBuffers() -> void {
+
+	if (m_skinned_mesh.vertices.empty()) {
+		return;
+	}
+
+	std::cout << "Creating Skinned Vertex Buffers" << std::endl;
+
+	[[gsl::suppress(type.4)]]{
+	const auto buffer_size = VkDeviceSize{ sizeof(Vertex) * m_skinned_mesh.vertices.size() };
+
+	m_skinned_vertex_buffers.resize(m_swap_chain_framebuffers.size());
+
+	for (auto& skinned_vertex_buffer : m_skinned_vertex_buffers) {
+
+		/*
+		The compute pipeline writes every vertex before the first draw
+		*/
+		if (m_gpu_skinning) {
+			createBuffer(
+				buffer_size,
+				VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+#ifdef VMA_USE_ALLOCATOR
+				VMA_MEMORY_USAGE_GPU_ONLY,
+				0,
+#else
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+#endif
+				skinned_vertex_buffer,
+				VK_SHARING_MODE_EXCLUSIVE,
+				nullptr);
+			continue;
+		}
+
+		createBuffer(
+			buffer_size,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+#ifndef VMA_USE_ALLOCATOR
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+#else
+			VMA_MEMORY_USAGE_CPU_TO_GPU,
+			VMA_ALLOCATION_CREATE_MAPPED_BIT,
+#endif
+			skinned_vertex_buffer,
+			VK_SHARING_MODE_EXCLUSIVE,
+			nullptr);
+
+#ifdef VMA_USE_ALLOCATOR
+		memcpy(skinned_vertex_buffer.allocation_info.pMappedData, m_skinned_mesh.vertices.data(), gsl::narrow_cast<size_t>(buffer_size));
+#else
+		void *data = nullptr;
+		vkMapMemory(m_device, skinned_vertex_buffer.memory, 0, buffer_size, 0, &data);
+		memcpy(data, m_skinned_mesh.vertices.data(), gsl::narrow_cast<size_t>(buffer_size));
+		vkUnmapMemory(m_device, skinned_vertex_buffer.memory);
+#endif
+	}
+
+	if (m_gpu_skinning) {
+		const auto palette_size = VkDeviceSize{ sizeof(glm::mat4) * m_skinned_mesh.skeleton.boneCount() };
+
+		m_skinning_palette_buffers.resize(m_skinned_vertex_buffers.size());
+
+		for (auto& palette_buffer : m_skinning_palette_buffers) {
+			createBuffer(
+				palette_size,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+#ifndef VMA_USE_ALLOCATOR
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+#else
+				VMA_MEMORY_USAGE_CPU_TO_GPU,
+				VMA_ALLOCATION_CREATE_MAPPED_BIT,
+#endif
+				palette_buffer,
+				VK_SHARING_MODE_EXCLUSIVE,
+				nullptr);
+		}
+	}
+
+	std::cout << "\t" << m_skinned_vertex_buffers.size() << " Skinned Vertex Buffers Created with "
+		<< buffer_size << " bytes each" << (m_gpu_skinning ? " in device local memory" : "") << std::endl << std::endl;
+	}
+}
+
+auto Renderer::createSkinningPipeline() -> void {
+
+	if (!m_gpu_skinning) {
+		return;
+	}
+
+	/*
+	The shader reads the buffers as 32 bit words with the layout of these structs
+	*/
+	static_assert(sizeof(Vertex) == 9 * sizeof(uint32_t), "skinning.comp reads a Vertex as 9 words");
+	static_assert(sizeof(SkinWeights) == 6 * sizeof(uint32_t), "skinning.comp reads a SkinWeights as 6 words");
+	static_assert(sizeof(glm::mat4) == 64, "skinning.comp reads the palette as std430 mat4");
+
+	std::cout << "Creating Skinning Pipeline" << std::endl;
+
+	auto bindings = std::array<VkDescriptorSetLayoutBinding, 4>{};
+	for (auto i = size_t{ 0 }; i < bindings.size(); ++i) {
+		bindings.at(i).binding = gsl::narrow_cast<uint>(i);
+		bindings.at(i).descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings.at(i).descriptorCount = 1;
+		bindings.at(i).stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		bindings.at(i).pImmutableSamplers = nullptr; // default value
+	}
+
+	auto layout_create_info = VkDescriptorSetLayoutCreateInfo{};
+	layout_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layout_create_info.bindingCount = gsl::narrow_cast<uint>(bindings.size());
+	layout_create_info.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(m_device, &layout_create_info, nullptr, &m_skinning_descriptor_set_layout) != VK_SUCCESS) {
+		throw std::runtime_error("We couldn't create the descriptor set layout of the skinning pipeline");
+	}
+
+	/*
+	The amount of vertices to skin, the last workgroup has invocations past it
+	*/
+	auto push_constant_range = VkPushConstantRange{};
+	push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	push_constant_range.offset = 0;
+	push_constant_range.size = sizeof(uint32_t);
+
+	auto pipeline_layout_create_info = VkPipelineLayoutCreateInfo{};
+	pipeline_layout_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipeline_layout_create_info.setLayoutCount = 1;
+	pipeline_layout_create_info.pSetLayouts = &m_skinning_descriptor_set_layout;
+	pipeline_layout_create_info.pushConstantRangeCount = 1;
+	pipeline_layout_create_info.pPushConstantRanges = &push_constant_range;
+
+	if (vkCreatePipelineLayout(m_device, &pipeline_layout_create_info, nullptr, &m_skinning_pipeline_layout) != VK_SUCCESS) {
+		throw std::runtime_error("We couldn't create the pipeline layout of the skinning pipeline");
+	}
+
+	auto comp_shader_code = readBinaryArrayToChars(skinning_comp);
+	auto comp_shader_module = createShaderModule(comp_shader_code);
+
+	auto pipeline_create_info = VkComputePipelineCreateInfo{};
+	pipeline_create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipeline_create_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipeline_create_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipeline_create_info.stage.module = comp_shader_module;
+	pipeline_create_info.stage.pName = "main";
+	pipeline_create_info.layout = m_skinning_pipeline_layout;
+	pipeline_create_info.basePipelineHandle = VK_NULL_HANDLE;
+	pipeline_create_info.basePipelineIndex = -1;
+
+	if (vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipeline_create_info, nullptr, &m_skinning_pipeline) != VK_SUCCESS) {
+		throw std::runtime_error("We couldn't create the skinning pipeline");
+	}
+
+	vkDestroyShaderModule(m_device, comp_shader_module, nullptr);
+
+	/*
+	The inputs are uploaded once like the vertex buffer of a static scene
+	*/
+	[[gsl::suppress(type.4)]]{
+		auto upload = [&](const void* source, VkDeviceSize buffer_size, AllocatedBuffer& buffer) {
+			createBuffer(
+				buffer_size,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	#ifdef VMA_USE_ALLOCATOR
+				VMA_MEMORY_USAGE_GPU_ONLY,
+				0,
+	#else
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+	#endif
+				buffer,
+				VK_SHARING_MODE_EXCLUSIVE,
+				nullptr);
+
+			uploadBuffer(buffer_size, buffer.buffer, [&](void* data) {
+				memcpy(data, source, gsl::narrow_cast<size_t>(buffer_size));
+			});
+		};
+
+		upload(
+			m_skinned_mesh.vertices.data(),
+			VkDeviceSize{ sizeof(Vertex) * m_skinned_mesh.vertices.size() },
+			m_skinning_reference_buffer);
+		upload(
+			m_skinned_mesh.weights.data(),
+			VkDeviceSize{ sizeof(SkinWeights) * m_skinned_mesh.weights.size() },
+			m_skinning_weight_buffer);
+	}
+
+	if (m_skinning_timestamp_valid_bits == 0) {
+		std::cout << "\tThe graphics queue has no timestamps, the skinning time won't be measured" << std::endl;
+	}
+
+	std::cout << "\tSkinning Pipeline Created" << std::endl << std::endl;
+}
+
+auto Renderer::createSkinningDescriptorSets() -> void {
+
+	if (!m_gpu_skinning) {
+		return;
+	}
+
+	std::cout << "Creating Skinning Descriptor Sets" << std::endl;
+
+	const auto set_count = gsl::narrow<uint>(m_skinned_vertex_buffers.size());
+
+	auto pool_size = VkDescriptorPoolSize{};
+	pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	pool_size.descriptorCount = 4 * set_count;
+
+	auto pool_create_info = VkDescriptorPoolCreateInfo{};
+	pool_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	pool_create_info.poolSizeCount = 1;
+	pool_create_info.pPoolSizes = &pool_size;
+	pool_create_info.maxSets = set_count;
+
+	if (vkCreateDescriptorPool(m_device, &pool_create_info, nullptr, &m_skinning_descriptor_pool) != VK_SUCCESS) {
+		throw std::runtime_error("We couldn't create the descriptor pool of the skinning pipeline");
+	}
+
+	const auto layouts = std::vector<VkDescriptorSetLayout>(set_count, m_skinning_descriptor_set_layout);
+	auto alloc_info = VkDescriptorSetAllocateInfo{};
+	alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	alloc_info.descriptorPool = m_skinning_descriptor_pool;
+	alloc_info.descriptorSetCount = set_count;
+	alloc_info.pSetLayouts = layouts.data();
+
+	m_skinning_descriptor_sets.resize(set_count);
+	if (vkAllocateDescriptorSets(m_device, &alloc_info, m_skinning_descriptor_sets.data()) != VK_SUCCESS) {
+		throw std::runtime_error("We couldn't allocate the descriptor sets of the skinning pipeline");
+	}
+
+	for (auto i = size_t{ 0 }; i < m_skinning_descriptor_sets.size(); ++i) {
+
+		/*
+		In the order of the bindings of skinning.comp
+		*/
+		const auto buffers = std::array<VkBuffer, 4>{
+			m_skinning_reference_buffer.buffer,
+			m_skinning_weight_buffer.buffer,
+			m_skinning_palette_buffers.at(i).buffer,
+			m_skinned_vertex_buffers.at(i).buffer
+		};
+
+		auto buffer_infos = std::array<VkDescriptorBufferInfo, 4>{};
+		auto descriptor_writes = std::array<VkWriteDescriptorSet, 4>{};
+		for (auto binding = size_t{ 0 }; binding < buffers.size(); ++binding) {
+			buffer_infos.at(binding).buffer = buffers.at(binding);
+			buffer_infos.at(binding).offset = 0;
+			buffer_infos.at(binding).range = VK_WHOLE_SIZE;
+
+			descriptor_writes.at(binding).sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptor_writes.at(binding).dstSet = m_skinning_descriptor_sets.at(i);
+			descriptor_writes.at(binding).dstBinding = gsl::narrow_cast<uint>(binding);
+			descriptor_writes.at(binding).dstArrayElement = 0;
+			descriptor_writes.at(binding).descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptor_writes.at(binding).descriptorCount = 1;
+			descriptor_writes.at(binding).pBufferInfo = &buffer_infos.at(binding);
+			descriptor_writes.at(binding).pImageInfo = nullptr; // default value
+			descriptor_writes.at(binding).pTexelBufferView = nullptr; // default value
+		}
+
+		vkUpdateDescriptorSets(
+			m_device,
+			gsl::narrow_cast<uint>(descriptor_writes.size()),
+			descriptor_writes.data(),
+			0,
+			nullptr);
+	}
+
+	/*
+	Every command buffer writes its timestamps in its own two queries, so the
+	ones of a command buffer can be read while the others are in flight.
+	*/
+	if (m_skinning_timestamp_valid_bits > 0) {
+		auto query_pool_create_info = VkQueryPoolCreateInfo{};
+		query_pool_create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		query_pool_create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		query_pool_create_info.queryCount = 2 * set_count;
+
+		if (vkCreateQueryPool(m_device, &query_pool_create_info, nullptr, &m_skinning_query_pool) != VK_SUCCESS) {
+			throw std::runtime_error("We couldn't create the timestamp queries of the skinning pipeline");
+		}
+	}
+
+	std::cout << "\t" << m_skinning_descriptor_sets.size() << " Skinning Descriptor Sets Created" << std::endl << std::endl;
+}
+
+auto Renderer::updateSkinnedVertexBuffer(uint command_buffer_index) -> void {
+
+	if (m_skinned_vertex_buffers.empty()) {
+		return;
+	}
+
+	auto& skinned_vertex_buffer = m_skinned_vertex_buffers.at(command_buffer_index);
+
+	const auto time = std::chrono::duration
+		<float, std::chrono::seconds::period>
+		(std::chrono::high_resolution_clock::now() - m_skinning_start_time).count();
+
+	if (m_cooked_clip.frame_count > 0) {
+		m_cooked_clip_sampler.sample(time, m_skinning_pose);
+	}
+	else {
+		sampleClip(m_skinned_mesh.clip, time, m_skinning_pose);
+	}
+	computeSkinningPalette(m_skinned_mesh.skeleton, m_skinning_pose, m_skinning_palette.data());
+
+	/*
+	The palette is computed in cached memory, it reads the matrices it writes
+	*/
+	if (m_gpu_skinning) {
+		auto& palette_buffer = m_skinning_palette_buffers.at(command_buffer_index);
+		const auto palette_size = sizeof(glm::mat4) * m_skinning_palette.size();
+
+#ifdef VMA_USE_ALLOCATOR
+		memcpy(palette_buffer.allocation_info.pMappedData, m_skinning_palette.data(), palette_size);
+#else
+		void *data = nullptr;
+		vkMapMemory(m_device, palette_buffer.memory, 0, palette_size, 0, &data);
+		memcpy(data, m_skinning_palette.data(), palette_size);
+		vkUnmapMemory(m_device, palette_buffer.memory);
+#endif
+		return;
+	}
+
+	auto skin = [&](void* data) {
+		skinCharacters(
+			m_skinned_mesh,
+			m_skinning_palette.data(),
+			1,
+			static_cast<Vertex*>(data),
+			&m_thread_pool,
+			m_skinning_kernel);
+	};
+
+#ifdef VMA_USE_ALLOCATOR
+	skin(skinned_vertex_buffer.allocation_info.pMappedData);
+#else
+	const auto buffer_size = VkDeviceSize{ sizeof(Vertex) * m_skinned_mesh.vertices.size() };
+	void *data = nullptr;
+	vkMapMemory(m_device, skinned_vertex_buffer.memory, 0, buffer_size, 0, &data);
+	skin(data);
+	vkUnmapMemory(m_device, skinned_vertex_buffer.memory);
+#endif
+}
+
+auto Renderer::recordSkinningDispatch(size_t index) -> void {
+
+	const auto command_buffer = m_command_buffers[index];
+	const auto first_query = gsl::narrow_cast<uint>(2 * index);
+
+	if (m_skinning_query_pool != VK_NULL_HANDLE) {
+		vkCmdResetQueryPool(command_buffer, m_skinning_query_pool, first_query, 2);
+		vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_skinning_query_pool, first_query);
+	}
+
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_skinning_pipeline);
 
-auto Renderer::findMemoryType(uint type_bits, VkMemoryPropertyFlags properties, VkBool32 *found)->uint {
+	vkCmdBindDescriptorSets(
+		command_buffer,
+		VK_PIPELINE_BIND_POINT_COMPUTE,
+		m_skinning_pipeline_layout,
+		0,
+		1,
+		&m_skinning_descriptor_sets[index],
+		0,
+		nullptr);
 
-	auto memory_properties = VkPhysicalDeviceMemoryProperties{};
-	vkGetPhysicalDeviceMemoryProperties(m_physical_device, &memory_properties);
+	const auto vertex_count = gsl::narrow<uint32_t>(m_skinned_mesh.vertices.size());
+	vkCmdPushConstants(
+		command_buffer,
+		m_skinning_pipeline_layout,
+		VK_SHADER_STAGE_COMPUTE_BIT,
+		0,
+		sizeof(vertex_count),
+		&vertex_count);
 
+	vkCmdDispatch(command_buffer, (vertex_count + skinning_workgroup_size - 1) / skinning_workgroup_size, 1, 1);
 
-	for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
-	{
-		if ((type_bits & 1) == 1)
-			[[gsl::suppress(bounds.2)]]
-		{
-			if ((memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
-			{
-				if (found)
-				{
-					*found = true;
-				}
-				return i;
-			}
-		}
-		type_bits >>= 1;
+	if (m_skinning_query_pool != VK_NULL_HANDLE) {
+		vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, m_skinning_query_pool, first_query + 1);
 	}
 
-	if (found)
-	{
-		*found = false;
-		return 0;
-	}
-	else
-	{
-		throw std::runtime_error("We couldn't find an appropriate memory type");
-	}
+	/*
+	The vertex input of the draw waits for the writes of the dispatch.
+
+	Nothing else has to wait: the previous submission of this command buffer,
+	the last one that read the skinned vertices, is over when we wait for its
+	fence, and the palette written by the host is visible to the dispatch
+	because it is written before the submission.
+	*/
+	auto barrier = VkBufferMemoryBarrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = m_skinned_vertex_buffers[index].buffer;
+	barrier.offset = 0;
+	barrier.size = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(
+		command_buffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+		0,
+		0, nullptr,
+		1, &barrier,
+		0, nullptr);
 }
 
-auto Renderer::copyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize size) noexcept -> void {
+auto Renderer::readSkinningTimestamps(uint command_buffer_index) -> void {
 
+	if (m_skinning_query_pool == VK_NULL_HANDLE) {
+		return;
+	}
 
-	auto command_buffer = beginSingleTimeCommands(CommandType::transfer);
+	auto timestamps = std::array<uint64_t, 2>{};
+	const auto result = vkGetQueryPoolResults(
+		m_device,
+		m_skinning_query_pool,
+		2 * command_buffer_index,
+		2,
+		sizeof(timestamps),
+		timestamps.data(),
+		sizeof(uint64_t),
+		VK_QUERY_RESULT_64_BIT);
 
-	auto copy_region = VkBufferCopy{};
-	copy_region.srcOffset = 0;
-	copy_region.dstOffset = 0;
-	copy_region.size = size;
-	vkCmdCopyBuffer(command_buffer.buffer, src, dst, 1, &copy_region);
+	/*
+	The fence of the command buffer has been waited for so the queries are
+	available, we don't wait for them.
+	*/
+	if (result != VK_SUCCESS) {
+		return;
+	}
 
-	endSingleTimeCommands(command_buffer);
+	/*
+	Only the valid bits of the timestamps count, the ticks are timestampPeriod nanoseconds
+	*/
+	const auto mask = m_skinning_timestamp_valid_bits >= 64 ?
+		std::numeric_limits<uint64_t>::max() :
+		(uint64_t{ 1 } << m_skinning_timestamp_valid_bits) - 1;
+	const auto ticks = (timestamps[1] - timestamps[0]) & mask;
 
+	m_skinning_gpu_milliseconds += ticks * double{ m_physical_device_properties.limits.timestampPeriod } / 1e6;
+	++m_skinning_gpu_samples;
 }
 
 auto Renderer::createCommandBuffers() ->  void {
@@ -2280,92 +3481,133 @@ auto Renderer::createCommandBuffers() ->  void {
 	m_command_buffer_submitted.resize(m_command_buffers.size());
 	std::fill(m_command_buffer_submitted.begin(), m_command_buffer_submitted.end(), false);
 
+	m_command_buffer_outdated.resize(m_command_buffers.size());
+	std::fill(m_command_buffer_outdated.begin(), m_command_buffer_outdated.end(), false);
+
 	std::cout << "\tCommand Buffers Created" << std::endl << std::endl;
 }
 
 auto Renderer::recordCommandBuffers() -> void {
 	std::cout << "Recording Command Buffers " << std::endl;
 
-
 	for (size_t i = 0; i < m_command_buffers.size(); ++i) {
-		auto begin_info = VkCommandBufferBeginInfo{};
-		begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		begin_info.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-		begin_info.pInheritanceInfo = nullptr;
+		recordCommandBuffer(i);
+	}
 
-		vkBeginCommandBuffer(m_command_buffers[i], &begin_info);
+	std::cout << "\tCommand Buffers Recorded" << std::endl << std::endl;
+}
 
-		auto render_info = VkRenderPassBeginInfo{};
-		render_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		render_info.renderPass = m_render_pass;
-		/*
-		@NOTE: This should be using m_current_swapchain_buffer if we are recording
-		before each frame.
+auto Renderer::recordCommandBuffer(size_t index) -> void {
 
-		@see m_current_swapchain_buffer
-		*/
+	auto begin_info = VkCommandBufferBeginInfo{};
+	begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+	begin_info.pInheritanceInfo = nullptr;
 
-		std::array<VkClearValue, 3> clear_values = { config::clear_color , config::clear_color , config::clear_color };
+	vkBeginCommandBuffer(m_command_buffers[index], &begin_info);
 
-		if (config.multisampling_samples == 1) {
+	auto render_info = VkRenderPassBeginInfo{};
+	render_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	render_info.renderPass = m_render_pass;
+	/*
+	@NOTE: This should be using m_current_swapchain_buffer if we are recording
+	before each frame.
 
-			clear_values[0].color = { 0.0f,0.0f,0.0f,0.0f };
-			clear_values[1].depthStencil = { 1.0f, 0 };
+	@see m_current_swapchain_buffer
+	*/
 
-			render_info.framebuffer = m_swap_chain_framebuffers[i];
-			render_info.renderArea.offset = { 0, 0 };
-			render_info.renderArea.extent = m_swap_chain_extent;
-			render_info.clearValueCount = 2;
-			render_info.pClearValues = clear_values.data();
-		}
-		else {
+	std::array<VkClearValue, 3> clear_values = { config::clear_color , config::clear_color , config::clear_color };
 
-			clear_values[0].color = { 0.0f,0.0f,0.0f,1.0f };
-			clear_values[1].color = { 0.0f,0.0f,0.0f,1.0f };
-			clear_values[2].depthStencil = { 1.0f, 0 };
-			render_info.framebuffer = m_swap_chain_framebuffers[i];
-			render_info.renderArea.offset = { 0, 0 };
-			render_info.renderArea.extent = m_swap_chain_extent;
-			render_info.clearValueCount = 3;
-			render_info.pClearValues = clear_values.data();
-		}
+	if (config.multisampling_samples == 1) {
 
-		vkCmdBeginRenderPass(m_command_buffers[i], &render_info, VK_SUBPASS_CONTENTS_INLINE);
+		clear_values[0].color = { 0.0f,0.0f,0.0f,0.0f };
+		clear_values[1].depthStencil = { 1.0f, 0 };
 
-		{
-			vkCmdBindPipeline(m_command_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+		render_info.framebuffer = m_swap_chain_framebuffers[index];
+		render_info.renderArea.offset = { 0, 0 };
+		render_info.renderArea.extent = m_swap_chain_extent;
+		render_info.clearValueCount = 2;
+		render_info.pClearValues = clear_values.data();
+	}
+	else {
 
-			const VkBuffer vertex_buffers[] = { m_vertex_buffer.buffer };
-			const VkDeviceSize offsets[] = { 0 };
+		clear_values[0].color = { 0.0f,0.0f,0.0f,1.0f };
+		clear_values[1].color = { 0.0f,0.0f,0.0f,1.0f };
+		clear_values[2].depthStencil = { 1.0f, 0 };
+		render_info.framebuffer = m_swap_chain_framebuffers[index];
+		render_info.renderArea.offset = { 0, 0 };
+		render_info.renderArea.extent = m_swap_chain_extent;
+		render_info.clearValueCount = 3;
+		render_info.pClearValues = clear_values.data();
+	}
 
-			[[gsl::suppress(bounds.3)]]{
-			vkCmdBindVertexBuffers(m_command_buffers[i], 0, 1, vertex_buffers, offsets);
-			}
+	/*
+	The skinned vertices of this command buffer are written before they are drawn
+	*/
+	if (m_gpu_skinning && !m_skinned_vertex_buffers.empty()) {
+		recordSkinningDispatch(index);
+	}
 
-			vkCmdBindIndexBuffer(m_command_buffers[i], m_index_buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+	vkCmdBeginRenderPass(m_command_buffers[index], &render_info, VK_SUBPASS_CONTENTS_INLINE);
 
-			vkCmdBindDescriptorSets(
-				m_command_buffers[i],
-				VK_PIPELINE_BIND_POINT_GRAPHICS,
-				m_pipeline_layout,
-				0,
-				1,
-				&m_descriptor_set,
-				0,
-				nullptr);
+	/*
+	Until the mesh of a streamed scene is uploaded we only clear the framebuffer
+	*/
+	if (m_scene_geometry != invalid_geometry) {
+		vkCmdBindPipeline(m_command_buffers[index], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+
+		/*
+		Every mesh is drawn from the arenas of the geometry pool, a skinned scene
+		draws the vertices skinned for this command buffer
+		*/
+		const VkBuffer vertex_buffers[] = {
+			m_skinned_vertex_buffers.empty() ? m_geometry_pool->getVertexBuffer() : m_skinned_vertex_buffers[index].buffer
+		};
+		const VkDeviceSize offsets[] = { 0 };
 
-			vkCmdDrawIndexed(m_command_buffers[i], gsl::narrow<uint>(m_scene.indices.size()), 1, 0, 0, 0);
+		[[gsl::suppress(bounds.3)]]{
+		vkCmdBindVertexBuffers(m_command_buffers[index], 0, 1, vertex_buffers, offsets);
 		}
 
-		vkCmdEndRenderPass(m_command_buffers[i]);
+		vkCmdBindIndexBuffer(m_command_buffers[index], m_geometry_pool->getIndexBuffer(), 0, m_geometry_pool->getIndexType());
+
+		vkCmdBindDescriptorSets(
+			m_command_buffers[index],
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			m_pipeline_layout,
+			0,
+			1,
+			&m_descriptor_set,
+			0,
+			nullptr);
+
+		/*
+		The draw commands are written every frame for the level of detail
+		and the meshlets we see, the ones after the last used command have
+		instanceCount 0 and draw nothing.
+
+		@see updateIndirectBuffer
+		*/
+		const auto stride = gsl::narrow<uint>(sizeof(VkDrawIndexedIndirectCommand));
 
-		if (vkEndCommandBuffer(m_command_buffers[i]) != VK_SUCCESS) {
-			throw std::runtime_error("We couldn't record a command buffer");
+		if (m_physical_device_features.multiDrawIndirect &&
+			m_indirect_command_count <= m_physical_device_properties.limits.maxDrawIndirectCount) {
+			vkCmdDrawIndexedIndirect(m_command_buffers[index], m_indirect_buffers[index].buffer, 0, m_indirect_command_count, stride);
+		}
+		else {
+			for (auto draw = uint{ 0 }; draw < m_indirect_command_count; ++draw) {
+				vkCmdDrawIndexedIndirect(m_command_buffers[index], m_indirect_buffers[index].buffer, VkDeviceSize{ draw } * stride, 1, stride);
+			}
 		}
+	}
+
+	vkCmdEndRenderPass(m_command_buffers[index]);
 
+	if (vkEndCommandBuffer(m_command_buffers[index]) != VK_SUCCESS) {
+		throw std::runtime_error("We couldn't record a command buffer");
 	}
 
-	std::cout << "\tCommand Buffers Recorded" << std::endl << std::endl;
+	m_command_buffer_outdated[index] = false;
 }
 
 
@@ -2426,7 +3668,16 @@ auto Renderer::updateRotateTestUniformBuffer() ->void {
 
 	auto ubo = UniformBufferObject{};
 
-	ubo.model = glm::rotate(glm::mat4(1.0f), time* glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	const auto model = glm::rotate(glm::mat4(1.0f), time* glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f)) * m_model_transform;
+	ubo.model = model;
+
+	/*
+	Compact vertices reach the shader normalized to [0, 1] inside the
+	bounds of the mesh, the model matrix moves them back.
+	*/
+	if (config.vertex_format == VertexFormat::compact) {
+		ubo.model = ubo.model * getDequantizationMatrix(m_scene.bounds);
+	}
 	ubo.view = glm::lookAt(
 		glm::vec3(1.0f, 0.2f, 1.2f),
 		glm::vec3(0.0f, 0.0f, 0.5f),
@@ -2438,6 +3689,9 @@ auto Renderer::updateRotateTestUniformBuffer() ->void {
 		10.0f);
 	ubo.proj[1][1] *= -1; // We compensate for the inverted Y axis in GLM (meant for OpenGL)
 
+	m_culling_transform = ubo;
+	m_culling_transform.model = model;
+
 	
 
 #ifdef VMA_USE_ALLOCATOR
@@ -2471,6 +3725,8 @@ auto Renderer::beginFrame() -> void {
 				!= VK_SUCCESS) {
 				throw std::runtime_error("We couldn't wait for the fence involving the current command buffer");
 			}
+
+			readSkinningTimestamps(m_current_command_buffer);
 		}
 
 		if (vkResetFences(m_device, 1, &m_command_buffer_fences[m_current_command_buffer])) {
@@ -2478,6 +3734,26 @@ auto Renderer::beginFrame() -> void {
 		}
 	}
 
+	/*
+	Streamed assets that finished uploading replace the ones of the scene,
+	the current command buffer is not in use so it can be recorded again
+	with them right away.
+	*/
+	updateStreaming();
+	destroyRetiredResources();
+	pollUploadBatches();
+
+	if (m_command_buffer_outdated[m_current_command_buffer]) {
+		recordCommandBuffer(m_current_command_buffer);
+	}
+
+	/*
+	The GPU is done with the current command buffer so we can write the draw
+	commands of its indirect buffer for this frame.
+	*/
+	updateIndirectBuffer(m_current_command_buffer);
+	updateSkinnedVertexBuffer(m_current_command_buffer);
+
 
 	/*
 	@TODO: Beginning of the recording of the current Command Buffer
@@ -2570,6 +3846,7 @@ auto Renderer::endFrame() -> void {
 	{
 		m_command_buffer_submitted[m_current_command_buffer] = true;
 		m_current_command_buffer = (m_current_command_buffer + 1) % m_command_buffers.size();
+		++m_frame_index;
 	}
 
 	/*
@@ -2597,6 +3874,46 @@ auto Renderer::endFrame() -> void {
 			throw std::runtime_error("We couldn't submit the presentation info to the queue");
 		}
 	}
+
+	updateFrameTime();
+}
+
+auto Renderer::updateFrameTime() -> void {
+
+	const auto now = std::chrono::high_resolution_clock::now();
+	if (m_frame_count == 0) {
+		m_frame_time_start = now;
+	}
+	++m_frame_count;
+
+	/*
+	We show the average frame time of the last second in the title of the
+	window, useful to compare different settings of the renderer.
+	*/
+	const auto elapsed = std::chrono::duration<double, std::milli>(now - m_frame_time_start).count();
+	if (elapsed >= 1000.0) {
+		auto ss = std::stringstream{};
+		ss << config::app_name << " - " << std::fixed << std::setprecision(3)
+			<< elapsed / (m_frame_count - 1) << " ms/frame";
+
+		ss << " - LOD " << m_current_lod << "/" << m_scene.lods.size();
+		if (config::meshlet_culling_enabled && m_current_lod < m_scene.lods.size()) {
+			ss << " - " << m_culling_statistics.visible_meshlets << "/" << m_scene.lods[m_current_lod].meshlet_count
+				<< " meshlets in " << m_culling_statistics.draw_count << " draws";
+		}
+		if (m_asset_streamer && m_asset_streamer->getPendingCount() > 0) {
+			ss << " - streaming " << m_asset_streamer->getPendingCount() << " assets";
+		}
+		if (m_skinning_gpu_samples > 0) {
+			ss << " - GPU skinning " << m_skinning_gpu_milliseconds / m_skinning_gpu_samples << " ms";
+		}
+		m_skinning_gpu_milliseconds = 0.0;
+		m_skinning_gpu_samples = 0;
+		glfwSetWindowTitle(m_window.get(), ss.str().c_str());
+
+		m_frame_count = 1;
+		m_frame_time_start = now;
+	}
 }
 
 auto Renderer::onWindowsResized(GLFWwindow * window, int width, int height) -> void {
@@ -2614,76 +3931,268 @@ auto Renderer::onWindowsResized(GLFWwindow * window, int width, int height) -> v
 }
 
 auto Renderer::beginSingleTimeCommands(CommandType command_type) noexcept ->WrappedCommandBuffer {
-	auto allocate_info = VkCommandBufferAllocateInfo{};
-	allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+	auto command_buffer = WrappedCommandBuffer{};
+	command_buffer.type = command_type;
+	command_buffer.buffer = getCommandBufferPool(command_type).begin();
+	command_buffer.recording = true;
+
+	return command_buffer;
+}
+
+auto Renderer::endSingleTimeCommands(WrappedCommandBuffer& command_buffer) noexcept ->void {
+
+	/*
+	Only this submission is waited for, not everything else in the queue
+	*/
+	waitForSubmission(submitSingleTimeCommands(command_buffer));
+}
+
+auto Renderer::submitSingleTimeCommands(WrappedCommandBuffer& command_buffer) -> CommandTicket {
+
+	command_buffer.recording = false;
+
+	auto ticket = CommandTicket{};
+	ticket.type = command_buffer.type;
+	ticket.value = getCommandBufferPool(command_buffer.type).submit(command_buffer.buffer);
+	return ticket;
+}
+
+auto Renderer::isSubmissionComplete(const CommandTicket& ticket) noexcept -> bool {
+	return getCommandBufferPool(ticket.type).isComplete(ticket.value);
+}
+
+auto Renderer::waitForSubmission(const CommandTicket& ticket) noexcept -> void {
+	getCommandBufferPool(ticket.type).wait(ticket.value);
+}
+
+auto Renderer::getCommandBufferPool(CommandType command_type) noexcept -> CommandBufferPool& {
 
 	switch (command_type) {
-	case CommandType::graphics: {
-		allocate_info.commandPool = m_graphics_command_pool;
-		break;
-	}
 	case CommandType::transfer: {
-		allocate_info.commandPool = m_transfer_command_pool;
-		break;
+		return *m_transfer_command_buffer_pool;
+	}
+	case CommandType::graphics:
+	default: {
+		return *m_graphics_command_buffer_pool;
+	}
 	}
+}
+
+auto Renderer::createStagingRing() -> void {
+
+	std::cout << "Creating Staging Ring" << std::endl;
+
+	/*
+	The offsets of the copies to images must be multiples of 4 and of the
+	bytes of a texel or a block, 16 covers every format we upload
+	*/
+	m_staging_alignment = std::max(VkDeviceSize{ 16 }, m_physical_device_properties.limits.optimalBufferCopyOffsetAlignment);
+	m_staging_ring = std::make_unique<StagingRing>(m_vma_allocator, config::staging_ring_size);
+
+	std::cout << "\t" << config::staging_ring_size / 1024 << " KiB mapped, uploads aligned to "
+		<< m_staging_alignment << " bytes" << std::endl;
+	std::cout << "\tStaging Ring Created" << std::endl << std::endl;
+}
+
+auto Renderer::beginUploadBatch() -> void {
+
+	auto context = UploadBatchContext{};
+	context.command_buffers = m_graphics_command_buffer_pool.get();
+	context.staging_ring = m_staging_ring.get();
+
+	m_upload_batch = std::make_unique<UploadBatch>(context);
+}
+
+auto Renderer::submitUploadBatch() -> void {
+
+	if (!m_upload_batch) {
+		return;
 	}
 
-	allocate_info.commandBufferCount = 1;
+	std::cout << "Submitting Upload Batch" << std::endl;
 
-	auto command_buffer = WrappedCommandBuffer{};
-	command_buffer.type = command_type;
-	vkAllocateCommandBuffers(m_device, &allocate_info, &command_buffer.buffer);
+	const auto start = std::chrono::high_resolution_clock::now();
+	flushUploadBatch();
+	m_upload_batch.reset();
 
-	auto begin_info = VkCommandBufferBeginInfo{};
-	begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	std::cout << "\t" << m_upload_statistics.operations << " copies and transitions in " << m_upload_statistics.submissions
+		<< (m_upload_statistics.submissions == 1 ? " submission, " : " submissions, ")
+		<< m_upload_statistics.staged_bytes / 1024 << " KiB staged through the " << m_staging_ring->getCapacity() / 1024
+		<< " KiB staging ring (" << m_staging_ring->getPeakUsage() / 1024 << " KiB at most in use, "
+		<< m_upload_statistics.ring_waits << " waits for it, "
+		<< std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count()
+		<< " ms to submit)" << std::endl;
+	std::cout << "\tUpload Batch Submitted" << std::endl << std::endl;
 
-	vkBeginCommandBuffer(command_buffer.buffer, &begin_info);
-	command_buffer.recording = true;
+	m_upload_statistics = UploadStatistics{};
+}
+
+auto Renderer::flushUploadBatch() -> void {
+
+	m_upload_batch->submit();
+
+	++m_upload_statistics.submissions;
+	m_upload_statistics.operations += m_upload_batch->getOperationCount();
+	m_upload_statistics.staged_bytes += m_upload_batch->getStagingSize();
+
+	m_submitted_upload_batches.push_back(std::move(m_upload_batch));
+	beginUploadBatch();
+}
+
+auto Renderer::pollUploadBatches() noexcept -> void {
+
+	/*
+	The batches release the staging ring in the order they took it
+	*/
+	while (!m_submitted_upload_batches.empty() && m_submitted_upload_batches.front()->isComplete()) {
+		m_submitted_upload_batches.erase(m_submitted_upload_batches.begin());
+	}
+}
 
+auto Renderer::beginUploadCommands(CommandType command_type) noexcept -> WrappedCommandBuffer {
+
+	if (!m_upload_batch) {
+		return beginSingleTimeCommands(command_type);
+	}
+
+	/*
+	The batch is recorded for the graphics queue, which also runs the transfers
+	*/
+	auto command_buffer = WrappedCommandBuffer{};
+	command_buffer.buffer = m_upload_batch->beginOperation();
+	command_buffer.type = CommandType::graphics;
+	command_buffer.recording = true;
 	return command_buffer;
 }
 
-auto Renderer::endSingleTimeCommands(WrappedCommandBuffer& command_buffer) noexcept ->void {
+auto Renderer::endUploadCommands(WrappedCommandBuffer& command_buffer) noexcept -> void {
 
-	vkEndCommandBuffer(command_buffer.buffer);
-	command_buffer.recording = false;
+	if (!m_upload_batch) {
+		endSingleTimeCommands(command_buffer);
+	}
+}
+
+auto Renderer::stageUpload(VkDeviceSize size) -> StagingAllocation {
+
+	if (!m_upload_batch) {
+		throw std::runtime_error("We can't stage an upload without an open upload batch");
+	}
+
+	/*
+	When the ring is full the batch is submitted with what it has so far and
+	we wait for the oldest batch in flight to release its part of the ring
+	*/
+	auto staging = m_upload_batch->stage(size, m_staging_alignment);
+	while (staging.data == nullptr) {
+		if (m_upload_batch->getStagingSize() > 0) {
+			flushUploadBatch();
+		}
+		if (m_submitted_upload_batches.empty()) {
+			throw std::runtime_error("We couldn't stage an upload bigger than the staging ring");
+		}
 
-	auto submit_info = VkSubmitInfo{};
-	submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submit_info.commandBufferCount = 1;
-	submit_info.pCommandBuffers = &command_buffer.buffer;
+		m_submitted_upload_batches.front()->wait();
+		m_submitted_upload_batches.erase(m_submitted_upload_batches.begin());
+		++m_upload_statistics.ring_waits;
 
-	auto command_pool = VkCommandPool{};
-	auto queue = VkQueue{};
+		staging = m_upload_batch->stage(size, m_staging_alignment);
+	}
+	return staging;
+}
 
-	switch (command_buffer.type) {
-	case CommandType::graphics: {
-		command_pool = m_graphics_command_pool;
-		queue = m_graphics_queue;
-		break;
+auto Renderer::uploadBuffer(
+	VkDeviceSize size,
+	VkBuffer destination,
+	const std::function<void(void*)>& write,
+	VkDeviceSize destination_offset) -> void {
+
+	const auto max_chunk_size = m_staging_ring->getMaxAllocationSize();
+	if (size <= max_chunk_size) {
+		const auto staging = stageUpload(size);
+		write(staging.data);
+		copyBuffer(staging.buffer, destination, size, staging.offset, destination_offset);
+		return;
 	}
-	case CommandType::transfer: {
-		command_pool = m_transfer_command_pool;
-		queue = m_transfer_queue;
-		break;
+
+	/*
+	Too big for the ring, it is written in memory and copied in chunks
+	*/
+	auto data = std::vector<unsigned char>(gsl::narrow_cast<size_t>(size));
+	write(data.data());
+
+	[[gsl::suppress(bounds.1)]]{
+	for (auto offset = VkDeviceSize{ 0 }; offset < size; offset += max_chunk_size) {
+		const auto chunk_size = std::min(max_chunk_size, size - offset);
+		const auto staging = stageUpload(chunk_size);
+		memcpy(staging.data, data.data() + offset, gsl::narrow_cast<size_t>(chunk_size));
+		copyBuffer(staging.buffer, destination, chunk_size, staging.offset, destination_offset + offset);
 	}
 	}
+}
+
+auto Renderer::uploadImage(
+	VkImage image,
+	VkFormat format,
+	const unsigned char* data,
+	VkDeviceSize size,
+	const std::vector<VkBufferImageCopy>& regions) -> void {
 
-	vkQueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE);
-	vkQueueWaitIdle(queue);
+	const auto max_chunk_size = m_staging_ring->getMaxAllocationSize();
+	if (size <= max_chunk_size) {
+		const auto staging = stageUpload(size);
+		memcpy(staging.data, data, gsl::narrow_cast<size_t>(size));
 
-	vkFreeCommandBuffers(m_device, command_pool, 1, &command_buffer.buffer);
+		auto staged_regions = regions;
+		for (auto& region : staged_regions) {
+			region.bufferOffset += staging.offset;
+		}
+		copyBufferToImage(staging.buffer, image, staged_regions);
+		return;
+	}
+
+	/*
+	Every region is copied in bands of rows that fit in a chunk, rows of 4x4
+	blocks for the BC formats and of RGBA8 texels for the rest
+	*/
+	const auto block_bytes = getBlockBytes(format);
+	const auto block_size = block_bytes > 0 ? 4u : 1u;
+	const auto texel_bytes = block_bytes > 0 ? block_bytes : 4u;
+
+	[[gsl::suppress(bounds.1)]]{
+	for (const auto& region : regions) {
+		const auto columns = (region.imageExtent.width + block_size - 1) / block_size;
+		const auto rows = (region.imageExtent.height + block_size - 1) / block_size;
+		const auto row_bytes = VkDeviceSize{ columns } * texel_bytes;
+		const auto band_rows = gsl::narrow_cast<uint>(std::max(VkDeviceSize{ 1 }, max_chunk_size / row_bytes));
+
+		for (auto row = uint{ 0 }; row < rows; row += band_rows) {
+			const auto row_count = std::min(band_rows, rows - row);
+			const auto staging = stageUpload(row_bytes * row_count);
+			memcpy(
+				staging.data,
+				data + region.bufferOffset + row * row_bytes,
+				gsl::narrow_cast<size_t>(row_bytes * row_count));
+
+			auto band = region;
+			band.bufferOffset = staging.offset;
+			band.imageOffset.y = gsl::narrow<int32_t>(row * block_size);
+			band.imageExtent.height = std::min(row_count * block_size, region.imageExtent.height - row * block_size);
+			copyBufferToImage(staging.buffer, image, std::vector<VkBufferImageCopy>{ band });
+		}
+	}
+	}
 }
 
 auto Renderer::changeImageLayout(
 	VkImage& image,
 	VkFormat format,
 	VkImageLayout old_layout,
-	VkImageLayout new_layout)->void {
+	VkImageLayout new_layout,
+	uint mip_levels,
+	uint layer_count)->void {
 
-	auto command_buffer = beginSingleTimeCommands();
+	auto command_buffer = beginUploadCommands();
 	{
 
 		auto barrier = VkImageMemoryBarrier{};
@@ -2697,9 +4206,9 @@ auto Renderer::changeImageLayout(
 			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 			barrier.image = image;
 			barrier.subresourceRange.baseMipLevel = 0;
-			barrier.subresourceRange.levelCount = 1;
+			barrier.subresourceRange.levelCount = mip_levels;
 			barrier.subresourceRange.baseArrayLayer = 0;
-			barrier.subresourceRange.layerCount = 1;
+			barrier.subresourceRange.layerCount = layer_count;
 
 			if (new_layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
 				barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
@@ -2750,7 +4259,7 @@ auto Renderer::changeImageLayout(
 		);
 
 	}
-	endSingleTimeCommands(command_buffer);
+	endUploadCommands(command_buffer);
 }
 
 auto Renderer::copyBufferToImage(
@@ -2759,43 +4268,80 @@ auto Renderer::copyBufferToImage(
 	uint width,
 	uint heigth) noexcept -> void {
 
-	auto command_buffer = beginSingleTimeCommands();
+	auto region = VkBufferImageCopy{};
 	{
+		region.bufferOffset = 0;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
 
-		auto region = VkBufferImageCopy{};
-		{
-			region.bufferOffset = 0;
-			region.bufferRowLength = 0;
-			region.bufferImageHeight = 0;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
 
-			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			region.imageSubresource.mipLevel = 0;
-			region.imageSubresource.baseArrayLayer = 0;
-			region.imageSubresource.layerCount = 1;
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = { width, heigth, 1 };
+	}
 
-			region.imageOffset = { 0, 0, 0 };
-			region.imageExtent = { width, heigth, 1 };
-		}
+	copyBufferToImage(buffer, image, std::vector<VkBufferImageCopy>{ region });
+}
+
+auto Renderer::copyBufferToImage(
+	VkBuffer buffer,
+	VkImage image,
+	const std::vector<VkBufferImageCopy>& regions) noexcept -> void {
 
+	auto command_buffer = beginUploadCommands();
+	{
 		vkCmdCopyBufferToImage(
 			command_buffer.buffer,
 			buffer,
 			image,
 			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			1,
-			&region);
+			gsl::narrow_cast<uint>(regions.size()),
+			regions.data());
+	}
+	endUploadCommands(command_buffer);
+}
+
+auto Renderer::generateMipmaps(
+	VkImage image,
+	uint width,
+	uint height,
+	uint mip_levels,
+	uint layer_count) noexcept -> void {
 
+	/*
+	Blits are only supported by queues with graphics support
+	*/
+	auto command_buffer = beginUploadCommands(CommandType::graphics);
+	{
+		recordMipBlitChain(
+			command_buffer.buffer,
+			image,
+			width,
+			height,
+			mip_levels,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT,
+			layer_count);
 	}
-	endSingleTimeCommands(command_buffer);
+	endUploadCommands(command_buffer);
 }
 
-auto Renderer::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspect_flags)->VkImageView {
+auto Renderer::createImageView(
+	VkImage image,
+	VkFormat format,
+	VkImageAspectFlags aspect_flags,
+	uint mip_levels,
+	VkImageViewType view_type,
+	uint layer_count)->VkImageView {
 
 	auto create_info = VkImageViewCreateInfo{};
 	create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 	create_info.flags;
 	create_info.image = image;
-	create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	create_info.viewType = view_type;
 	create_info.format = format;
 	create_info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
 	create_info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
@@ -2803,9 +4349,9 @@ auto Renderer::createImageView(VkImage image, VkFormat format, VkImageAspectFlag
 	create_info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
 	create_info.subresourceRange.aspectMask = aspect_flags;
 	create_info.subresourceRange.baseArrayLayer = 0;
-	create_info.subresourceRange.layerCount = 1;
+	create_info.subresourceRange.layerCount = layer_count;
 	create_info.subresourceRange.baseMipLevel = 0;
-	create_info.subresourceRange.levelCount = 1;
+	create_info.subresourceRange.levelCount = mip_levels;
 
 	auto image_view = VkImageView{};
 
@@ -5,6 +5,7 @@
 #include <functional>
 #include <memory>
 #include <vector>
+#include <chrono>
 #include <gsl/gsl>
 
 #define VK_USE_PLATFORM_WIN32_KHR
@@ -37,6 +38,30 @@ buffers and images without VMA_USE_ALLOCATOR could not be fully supported.
 #include "./RenderUtils.h"
 #include "../Configuration.h"
 #include "RenderData.h"
+#include "MeshCache.h"
+#include "ObjParser.h"
+#include "VertexDeduplicator.h"
+#include "MeshOptimizer.h"
+#include "Meshlet.h"
+#include "MeshSimplifier.h"
+#include "MeshLoader.h"
+#include "AssetStreamer.h"
+#include "MipGenerator.h"
+#include "MipBlit.h"
+#include "TextureFile.h"
+#include "TextureCache.h"
+#include "TextureAtlas.h"
+#include "TextureBatch.h"
+#include "StagingDecoder.h"
+#include "SmdParser.h"
+#include "Skinning.h"
+#include "AnimationCooker.h"
+#include "StagingRing.h"
+#include "CommandBufferPool.h"
+#include "GeometryPool.h"
+#include "UploadBatch.h"
+#include "QueueTopology.h"
+#include "../utils/ThreadPool.h"
 
 
 /**
@@ -267,8 +292,9 @@ private:
 
 	/**
 	Checks the queue families supported by the provided device and returns the indices for the
-	required ones in the struct QueueFamilyIndices (graphics and present queues right now).
+	graphics, present, transfer and compute queues planned with planQueueTopology.
 
+	@see planQueueTopology
 	@see QueueFamilyIndices
 	@see m_queue_family_indices
 	@see PrintOptions
@@ -282,12 +308,13 @@ private:
 	) const->QueueFamilyIndices;
 
 	/**
-	Creates the vulkan logical device we are going to use and retrieves the graphics and present
-	queues from it.
+	Creates the vulkan logical device we are going to use, retrieves the graphics, present
+	and transfer queues from it and reports the queue topology.
 
 	@see m_device
 	@see m_graphics_queue
 	@see m_present_queue
+	@see m_transfer_queue
 	*/
 	auto createLogicalDevice() -> void;
 
@@ -421,12 +448,14 @@ private:
 	auto createGraphicsCommandPool() ->  void;
 
 	/**
-	Creates the command pool that contains the command buffers to
-	execute transfer memory commands.
+	Creates the pools of reusable command buffers of the graphics and the
+	transfer queues, for the single time commands, the upload batches and the
+	uploads of the asset streamer.
 
-	@see m_transfer_command_pool
+	@see m_graphics_command_buffer_pool
+	@see m_transfer_command_buffer_pool
 	*/
-	auto createTransferCommandPool() ->  void;
+	auto createCommandBufferPools() -> void;
 
 	/**
 	Helper function that creates a vulkan image in a general way
@@ -442,6 +471,8 @@ private:
 	@param The sharing mode for the image (Concurrent or exclusive)
 	@param The family indices when sharing mode is concurrent (or nullptr otherwise)
 	@param The sample count for the image, 1 sample by default (used on images meant for multisampling)
+	@param The amount of mip levels of the image, 1 by default
+	@param The amount of layers of the image, 1 by default
 	*/
 	auto createImage(
 		uint width,
@@ -454,7 +485,9 @@ private:
 		AllocatedImage& image,
 		VkSharingMode sharing_mode,
 		const std::vector<uint>* queue_family_indices,
-		short samples = 1
+		short samples = 1,
+		uint mip_levels = 1,
+		uint array_layers = 1
 	) -> void;
 
 	/**
@@ -474,30 +507,178 @@ private:
 	auto createDepthResources() -> void;
 
 	/**
-	Creates a texture image with the data loaded from a file
+	Creates a texture image with the data loaded from a file, or from its
+	cooked version (see TextureFile.h) when there is one and the device
+	supports BC textures.
 
 	@param the path of th texture
+	@param Where to write the amount of mip levels of the image
+	@param Where to write the format of the image
 	@return The allocated image with the texture
 	*/
-	auto createTextureImage(std::string path) -> AllocatedImage;
+	auto createTextureImage(std::string path, uint& mip_levels, VkFormat& format) -> AllocatedImage;
 
 	/**
-	Creates a texture image view into the texture image
+	Creates a texture image with the compressed levels of a cooked texture
+
+	@param The cooked texture, with its whole mip chain
+	@return The allocated image with the texture
+	*/
+	auto createTextureImage(const CookedTexture& texture) -> AllocatedImage;
+
+	/**
+	Creates a texture array with a layer for every texture provided, they
+	must have the same size. When the atlas is enabled the textures are
+	packed into a single layer instead.
+
+	@param The path of the texture of every layer
+	@param Where to write the amount of mip levels of the image
+	@param Where to write the amount of layers of the image
+	@return The allocated image with the texture array, in VK_FORMAT_R8G8B8A8_UNORM
+	*/
+	auto createTextureImage(const std::vector<std::string>& paths, uint& mip_levels, uint& layer_count) -> AllocatedImage;
+
+	/**
+	Creates a texture image with the RGBA pixels provided and its mip chain
+	(when mipmaps are enabled)
+
+	@param The pixels of the texture, 4 bytes per pixel
+	@param Width of the texture
+	@param Height of the texture
+	@param Where to write the amount of mip levels of the image
+	@return The allocated image with the texture
+	*/
+	auto createTextureImage(const unsigned char* pixels, uint width, uint height, uint& mip_levels) -> AllocatedImage;
+
+	/**
+	Creates a texture image with some levels of its mip chain already filtered,
+	the rest (if any) are blitted from the level 0.
+
+	@param The pixels of the levels provided, 4 bytes per pixel. With several
+	layers they come one after the other, each with the levels provided.
+	@param The bytes of the levels provided, of every layer
+	@param Width of the texture
+	@param Height of the texture
+	@param The levels provided, starting with the level 0
+	@param The amount of mip levels of the image
+	@param The amount of layers of the image, 1 by default
+	@return The allocated image with the texture
+	*/
+	auto createTextureImage(
+		const unsigned char* data,
+		VkDeviceSize size,
+		uint width,
+		uint height,
+		const std::vector<MipLevel>& levels,
+		uint mip_levels,
+		uint layer_count = 1) -> AllocatedImage;
+
+	/**
+	Creates a texture image and records the copies of its levels provided,
+	the rest (if any) are blitted from the level 0.
+
+	@param Width of the texture
+	@param Height of the texture
+	@param The levels provided, starting with the level 0
+	@param The amount of mip levels of the image
+	@param The amount of layers of the image
+	@param Records the copies of the levels provided of every layer into the
+	image, in the transfer destination layout
+	@return The allocated image with the texture
+	*/
+	auto createTextureImage(
+		uint width,
+		uint height,
+		const std::vector<MipLevel>& levels,
+		uint mip_levels,
+		uint layer_count,
+		const std::function<void(VkImage)>& copy_levels) -> AllocatedImage;
+
+	/**
+	Creates a texture image view into the texture image. It is always an
+	array view, the shader samples a texture array even with a single layer.
 
 	@param The image to create the view from
+	@param The amount of mip levels of the image
+	@param The format of the image
+	@param The amount of layers of the image
 	@return An image view for the provided image.
 	*/
-	auto createTextureImageView(AllocatedImage image) -> VkImageView;
+	auto createTextureImageView(
+		AllocatedImage image,
+		uint mip_levels = 1,
+		VkFormat format = VK_FORMAT_R8G8B8A8_UNORM,
+		uint layer_count = 1) -> VkImageView;
 
 	/**
-	Loads the scene with the provided object (.obj) and texture paths
+	Loads the scene with the provided object (.obj) and texture paths. When the
+	materials of the model have textures they are loaded instead, all of them
+	in a texture array.
 
 	@param The path to the .obj model
-	@param The path to the texture for the model
+	@param The path to the texture for the model, if its materials have none
 	@see m_scene
 	*/
 	auto loadScene(std::string object_path, std::string texture_path) -> void;
 
+	/**
+	Requests the object (.obj) and texture to the asset streamer, the scene
+	is empty and uses a placeholder texture until they are uploaded. With the
+	material textures enabled the texture is requested once the mesh tells us
+	the textures of its materials.
+
+	@param The path to the .obj model
+	@param The path to the texture for the model, if its materials have none
+	@see m_asset_streamer
+	@see updateStreaming
+	*/
+	auto streamScene(std::string object_path, std::string texture_path) -> void;
+
+	/**
+	Loads the skinned mesh of an .smd file as the scene with the textures of
+	its materials. The scene has the indices and a single sub-mesh, its
+	vertices are skinned every frame into the skinned vertex buffers.
+
+	@param The path to the .smd model
+	@see m_skinned_mesh
+	@see updateSkinnedVertexBuffer
+	*/
+	auto loadSkinnedScene(std::string model_path) -> void;
+
+	/**
+	Creates the texture of the scene with the textures of its materials, or
+	with the texture provided when they have none.
+
+	@param The path to the texture for the model, if its materials have none
+	*/
+	auto createSceneTexture(std::string texture_path) -> void;
+
+	/**
+	Polls the asset streamer and replaces the mesh and the texture of the scene
+	with the ones that have been uploaded. The replaced resources are retired
+	and the command buffers marked to be recorded again.
+
+	@see m_asset_streamer
+	*/
+	auto updateStreaming() -> void;
+
+	/**
+	Keeps a resource alive until no command buffer recorded before now can
+	be executing, then destroys it.
+
+	@param The function that destroys the resource
+	@see destroyRetiredResources
+	*/
+	auto retireResource(std::function<void()> destroy) -> void;
+
+	/**
+	Destroys the retired resources that are not in use anymore.
+
+	@param Destroy all of them, only when the device is idle
+	@see m_retired_resources
+	*/
+	auto destroyRetiredResources(bool all = false) noexcept -> void;
+
 	/**
 	Creates a sampler to sample the textures
 	used in the rendering phase.
@@ -516,6 +697,8 @@ private:
 	@param The handle to the buffer to create
 	@param The sharing mode of the buffer (VK_SHARING_MODE_(EXCLUSIVE/CONCURRENT))
 	@param The family indices of the queues this buffer will be shared between if CONCURRENT, nullptr otherwise
+	@param Memory properties the allocator should prefer on top of the ones of the usage,
+	with VK_MEMORY_PROPERTY_HOST_CACHED_BIT the memory is also required to be coherent
 	*/
 	auto createBuffer(
 		VkDeviceSize size,
@@ -528,7 +711,8 @@ private:
 #endif
 		AllocatedBuffer& allocated_buffer,
 		VkSharingMode sharing_mode,
-		const std::vector<uint>* queue_family_indices
+		const std::vector<uint>* queue_family_indices,
+		VkMemoryPropertyFlags preferred_properties = 0
 	) -> void;
 
 	/**
@@ -541,18 +725,52 @@ private:
 	) noexcept -> void;
 
 	/**
-	Creates the vertex buffer that will hold the vertices to render.
+	Creates the geometry pool the vertices and indices of every mesh are
+	drawn from.
+
+	@see m_geometry_pool
+	*/
+	auto createGeometryPool() -> void;
+
+	/**
+	Takes the range of the scene from the geometry pool and uploads its
+	vertices and indices into it.
 
-	@see m_vertex_buffer
+	@see m_scene_geometry
 	*/
-	auto createVertexBuffer() -> void;
+	auto createSceneGeometry() -> void;
 
 	/**
-	Creates the index buffer that will hold the indexes in order to render.
+	Takes a range of the geometry pool, compacting it when none of its free
+	ranges is big enough.
+
+	@param The vertices of the mesh
+	@param The indices of the mesh
+	@return The handle of the range
+	@throws std::runtime_error if the pool doesn't have room even after compacting it
+	*/
+	auto allocateGeometry(uint32_t vertex_count, uint32_t index_count) -> GeometryHandle;
 
-	@see m_index_buffer
+	/**
+	Moves the meshes of the geometry pool into new arenas without holes
+	between them, the old ones are retired. The command buffers are recorded
+	again with the new arenas. The asset streamer also calls it, once none of
+	the ranges it uploads into is still pending.
 	*/
-	auto createIndexBuffer() -> void;
+	auto compactGeometryPool() -> void;
+
+	/**
+	Makes the copies into the geometry pool visible to the vertex input of
+	the later commands of the queue
+
+	@param The command buffer with the copies
+	*/
+	auto recordGeometryBarrier(VkCommandBuffer command_buffer) noexcept -> void;
+
+	/**
+	@return The range of the scene in the geometry pool, empty without one
+	*/
+	auto getSceneGeometry() const -> GeometryRange;
 
 	/**
 	Creates the uniform buffer that will hold the object data to render.
@@ -627,13 +845,98 @@ private:
 	@param The source buffer
 	@param The destination buffer
 	@param The size of the memory to be copied
+	@param Where the copy starts in the source buffer
+	@param Where the copy starts in the destination buffer
 	*/
 	auto copyBuffer(
 		VkBuffer src,
 		VkBuffer dst,
-		VkDeviceSize size
+		VkDeviceSize size,
+		VkDeviceSize src_offset = 0,
+		VkDeviceSize dst_offset = 0
 	) noexcept -> void;
 
+	/**
+	Creates one indirect buffer per command buffer with room for a draw
+	command per meshlet (or sub-mesh) of the scene.
+
+	@see m_indirect_buffers
+	*/
+	auto createIndirectBuffers() -> void;
+
+	/**
+	Selects the level of detail of the scene and culls its meshlets with the
+	last transform set, then writes the draw commands of the visible ones into
+	the indirect buffer of the command buffer provided. Without meshlet culling
+	the sub-meshes of the level are drawn. The command buffer must not be in
+	use by the GPU.
+
+	@param The index of the command buffer whose indirect buffer we update
+	@see m_culling_transform
+	*/
+	auto updateIndirectBuffer(uint command_buffer_index) -> void;
+
+	/**
+	Creates one host visible vertex buffer per command buffer for the skinned
+	vertices of the scene, with the reference pose until the first update.
+	With GPU skinning they are device local storage buffers instead and every
+	command buffer gets a host visible palette buffer too. Nothing is created
+	when the scene is not skinned.
+
+	@see m_skinned_vertex_buffers
+	*/
+	auto createSkinnedVertexBuffers() -> void;
+
+	/**
+	Creates the compute pipeline that skins the vertices on the GPU and the
+	device local buffers it reads, with the vertices in the reference pose
+	and their skin weights. Nothing is created without GPU skinning.
+
+	@see m_gpu_skinning
+	@see skinning.comp
+	*/
+	auto createSkinningPipeline() -> void;
+
+	/**
+	Creates the descriptor set of every command buffer for the compute
+	pipeline, with the palette buffer and the skinned vertex buffer of that
+	command buffer, and the timestamp queries that measure the dispatch.
+
+	@see m_skinning_descriptor_sets
+	@see m_skinning_query_pool
+	*/
+	auto createSkinningDescriptorSets() -> void;
+
+	/**
+	Samples the animation of the skinned mesh at the current time and skins
+	its vertices with the thread pool into the vertex buffer of the command
+	buffer provided. With GPU skinning only the palette of the command buffer
+	is written, its vertices are skinned when it is submitted. The command
+	buffer must not be in use by the GPU.
+
+	@param The index of the command buffer whose vertex buffer we update
+	*/
+	auto updateSkinnedVertexBuffer(uint command_buffer_index) -> void;
+
+	/**
+	Records the dispatch that skins the vertices of the command buffer on the
+	GPU and the barrier that makes them visible to the vertex input, between
+	two timestamps. It must be recorded outside of the render pass.
+
+	@param The index of the command buffer
+	*/
+	auto recordSkinningDispatch(size_t index) -> void;
+
+	/**
+	Adds the time the GPU spent skinning in the last submission of the command
+	buffer to the skinning time of the frame time. The command buffer must
+	have been submitted and not be in use by the GPU.
+
+	@param The index of the command buffer
+	@see updateFrameTime
+	*/
+	auto readSkinningTimestamps(uint command_buffer_index) -> void;
+
 	/**
 	Creates the command buffers that contain the commands to
 	draw to during render time.
@@ -649,6 +952,15 @@ private:
 	*/
 	auto recordCommandBuffers() -> void;
 
+	/**
+	Records the drawing commands into one of the command buffers, it must
+	not be in use by the GPU.
+
+	@param The index of the command buffer to record
+	@see m_command_buffers
+	*/
+	auto recordCommandBuffer(size_t index) -> void;
+
 	/**
 	Creates the semaphores and fences necessary for synchronization of
 	the rendering phase.
@@ -659,6 +971,12 @@ private:
 	*/
 	auto createSemaphoresAndFences() -> void;
 
+	/**
+	Measures the time between frames and shows the average of the
+	last second in the title of the window.
+	*/
+	auto updateFrameTime() -> void;
+
 
 	/**
 	Handles the event of resizing the window to set up the appropriate
@@ -674,7 +992,7 @@ private:
 		int heigth) -> void;
 
 	/**
-	Creates a single use command buffer and starts recording to it
+	Takes a command buffer from the pool of the queue and starts recording to it
 
 	@param the type of commands that will be used (graphics also allows transfer)
 	@return The command buffer we are recording to
@@ -684,7 +1002,8 @@ private:
 	) noexcept->WrappedCommandBuffer;
 
 	/**
-	End recording to a particulaar command buffer and submits it to the queue
+	End recording to a particulaar command buffer, submits it to the queue
+	and waits for it
 
 	@param The command buffer to submit to the queue
 	*/
@@ -692,6 +1011,136 @@ private:
 		WrappedCommandBuffer& command_buffer
 	) noexcept ->void;
 
+	/**
+	End recording to a particular command buffer and submits it to the queue
+	without waiting for it
+
+	@param The command buffer to submit to the queue
+	@return The ticket to poll or wait for the submission with
+	@throws std::runtime_error if it can't be submitted
+	*/
+	auto submitSingleTimeCommands(
+		WrappedCommandBuffer& command_buffer
+	) -> CommandTicket;
+
+	/**
+	@param A ticket of submitSingleTimeCommands
+	@return true if the submission has been executed
+	*/
+	auto isSubmissionComplete(const CommandTicket& ticket) noexcept -> bool;
+
+	/**
+	Waits until a submission has been executed, the rest of the queue keeps running
+
+	@param A ticket of submitSingleTimeCommands
+	*/
+	auto waitForSubmission(const CommandTicket& ticket) noexcept -> void;
+
+	/**
+	@param The type of the commands
+	@return The pool of command buffers of the queue that runs them
+	*/
+	auto getCommandBufferPool(CommandType command_type) noexcept -> CommandBufferPool&;
+
+	/**
+	Opens the upload batch, from now on the uploads are recorded into it
+	instead of submitted one by one.
+
+	@see m_upload_batch
+	*/
+	auto beginUploadBatch() -> void;
+
+	/**
+	Submits the open upload batch without waiting for it, its range of the
+	staging ring is released once its fence is signaled.
+
+	@see pollUploadBatches
+	*/
+	auto submitUploadBatch() -> void;
+
+	/**
+	Submits the open upload batch and opens a new one
+	*/
+	auto flushUploadBatch() -> void;
+
+	/**
+	Destroys the submitted upload batches that have been executed, in the
+	order they were submitted
+	*/
+	auto pollUploadBatches() noexcept -> void;
+
+	/**
+	Starts recording the commands of an upload, into the open upload batch or
+	into a single use command buffer when there is none.
+
+	@param the type of commands that will be used (graphics also allows transfer)
+	@return The command buffer we are recording to
+	*/
+	auto beginUploadCommands(
+		CommandType command_type = CommandType::graphics
+	) noexcept->WrappedCommandBuffer;
+
+	/**
+	Ends the commands of an upload, the single use command buffer is submitted
+	and waited for while the batch is left recording.
+
+	@param The command buffer of beginUploadCommands
+	*/
+	auto endUploadCommands(
+		WrappedCommandBuffer& command_buffer
+	) noexcept ->void;
+
+	/**
+	Creates the staging ring every upload of the scene goes through
+
+	@see m_staging_ring
+	*/
+	auto createStagingRing() -> void;
+
+	/**
+	Takes staging memory for an upload from the ring, through the open upload
+	batch. When the ring is full the batch is submitted and we wait for the
+	oldest batch in flight.
+
+	@param The bytes to stage, at most the max allocation size of the ring
+	@return The mapped range of the ring
+	@throws std::runtime_error if there is no open upload batch or the ring can't make room
+	*/
+	auto stageUpload(VkDeviceSize size) -> StagingAllocation;
+
+	/**
+	Uploads the contents of a buffer through the staging ring, in chunks
+	when they don't fit in it.
+
+	@param The bytes of the contents
+	@param The buffer to copy them to
+	@param Writes the contents to the pointer provided
+	@param Where they start in the buffer
+	*/
+	auto uploadBuffer(
+		VkDeviceSize size,
+		VkBuffer destination,
+		const std::function<void(void*)>& write,
+		VkDeviceSize destination_offset = 0) -> void;
+
+	/**
+	Uploads the levels of an image through the staging ring, split in bands
+	of rows when they don't fit in it. The image must be in the transfer
+	destination layout.
+
+	@param The image to copy to
+	@param Its format
+	@param The texels of the levels
+	@param Their bytes
+	@param The copies of the levels, with their offsets into the texels
+	*/
+	auto uploadImage(
+		VkImage image,
+		VkFormat format,
+		const unsigned char* data,
+		VkDeviceSize size,
+		const std::vector<VkBufferImageCopy>& regions) -> void;
+
 	/**
 	Helper function that changes the image layout to a new one
 
@@ -699,12 +1148,16 @@ private:
 	@param The format of the image
 	@param The old layout of the image
 	@param The new layout for the image
+	@param The amount of mip levels to transition, from the level 0
+	@param The amount of layers to transition, from the layer 0
 	*/
 	auto changeImageLayout(
 		VkImage& image,
 		VkFormat format,
 		VkImageLayout old_layout,
-		VkImageLayout new_layout)->void;
+		VkImageLayout new_layout,
+		uint mip_levels = 1,
+		uint layer_count = 1)->void;
 
 	/**
 	Helper function that copies a buffer with image data into
@@ -721,6 +1174,38 @@ private:
 		uint width,
 		uint heigth) noexcept -> void;
 
+	/**
+	Helper function that copies regions of a buffer with image data into
+	a vulkan image structure, for example every level of a mip chain.
+
+	@param The buffer to read the data from
+	@param The image to write de data into
+	@param The regions to copy
+	*/
+	auto copyBufferToImage(
+		VkBuffer buffer,
+		VkImage image,
+		const std::vector<VkBufferImageCopy>& regions) noexcept -> void;
+
+	/**
+	Fills every mip level of the image blitting each one from the previous one.
+	The levels must be in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL with the level 0
+	written, they end in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+
+	@param The image
+	@param Width of the level 0
+	@param Height of the level 0
+	@param The amount of mip levels of the image
+	@param The amount of layers of the image
+	@see recordMipBlitChain
+	*/
+	auto generateMipmaps(
+		VkImage image,
+		uint width,
+		uint height,
+		uint mip_levels,
+		uint layer_count = 1) noexcept -> void;
+
 	/**
 	Helped function that creates an image view to the
 	provided image.
@@ -728,12 +1213,18 @@ private:
 	@param The image to create a view from
 	@param The format of the view
 	@param The aspect mast to create the image view regarding its use
+	@param The amount of mip levels the view sees, 1 by default
+	@param The type of the view, 2D by default
+	@param The amount of layers the view sees, 1 by default
 	@return An image view into the provided image
 	*/
 	auto createImageView(
 		VkImage image,
 		VkFormat format,
-		VkImageAspectFlags aspect_flags
+		VkImageAspectFlags aspect_flags,
+		uint mip_levels = 1,
+		VkImageViewType view_type = VK_IMAGE_VIEW_TYPE_2D,
+		uint layer_count = 1
 	)->VkImageView;
 
 	/**
@@ -770,6 +1261,8 @@ private:
 
 	RenderConfiguration config{};
 
+	ThreadPool m_thread_pool{};
+
 #ifdef VMA_USE_ALLOCATOR
 	VmaAllocator m_vma_allocator{};
 #endif
@@ -830,14 +1323,47 @@ private:
 
 	VkCommandPool m_graphics_command_pool{};
 
-	VkCommandPool m_transfer_command_pool{};
+	/*
+	Reusable command buffers of the single time commands and the upload
+	batches, one pool per queue
+	*/
+	std::unique_ptr<CommandBufferPool> m_graphics_command_buffer_pool{};
+
+	/*
+	Also records and submits the uploads of the asset streamer
+	*/
+	std::unique_ptr<CommandBufferPool> m_transfer_command_buffer_pool{};
 
-	AllocatedBuffer m_vertex_buffer{};
+	/*
+	Vertex and index arenas every mesh is drawn from
+	*/
+	std::unique_ptr<GeometryPool> m_geometry_pool{};
 
-	AllocatedBuffer m_index_buffer{};
+	/*
+	Range of the scene in the geometry pool, invalid until its mesh is uploaded
+	*/
+	GeometryHandle m_scene_geometry{ invalid_geometry };
 
 	AllocatedBuffer m_uniform_buffer{};
 
+	/*
+	Draw commands of the visible meshlets, one buffer per command buffer
+	so we never write the one the GPU may be reading.
+	*/
+	std::vector<AllocatedBuffer> m_indirect_buffers{};
+
+	uint m_indirect_command_count{};
+
+	/*
+	The transform of the last uniform buffer update without the dequantization
+	of compact vertices, the meshlet bounds are relative to the full vertices.
+	*/
+	UniformBufferObject m_culling_transform{};
+
+	MeshletCullingStatistics m_culling_statistics{};
+
+	uint m_current_lod{};
+
 	AllocatedImage m_depth_image{};
 
 	VkImageView m_depth_image_view{};
@@ -854,11 +1380,160 @@ private:
 
 	std::vector<bool> m_command_buffer_submitted{};
 
+	/*
+	Command buffers recorded with resources that have been replaced since,
+	they are recorded again the next time we use them.
+	*/
+	std::vector<bool> m_command_buffer_outdated{};
+
 	std::vector<VkSemaphore> m_image_available_semaphores{};
 
 	std::vector<VkSemaphore> m_render_finished_semaphores{};
 
 	std::vector<VkFence> m_command_buffer_fences{};
 
+	std::chrono::high_resolution_clock::time_point m_frame_time_start{};
+
+	uint m_frame_count{};
+
+	/*
+	Frames begun since the start, used to know when a retired resource is
+	not referenced by any command buffer in flight.
+	*/
+	uint64_t m_frame_index{};
+
+	/*
+	Replaced resources with the frame from which they can be destroyed
+	*/
+	std::vector<std::pair<uint64_t, std::function<void()>>> m_retired_resources{};
+
+	/*
+	Batch the uploads are recorded into while the scene is created, null
+	the rest of the time (the uploads are then submitted one by one).
+	*/
+	std::unique_ptr<UploadBatch> m_upload_batch{};
+
+	/*
+	Batches submitted whose fence has not been seen signaled yet, oldest
+	first. They hold the ranges of the staging ring of their uploads.
+	*/
+	std::vector<std::unique_ptr<UploadBatch>> m_submitted_upload_batches{};
+
+	/*
+	What has gone through the upload batches since the last submitUploadBatch
+	*/
+	struct UploadStatistics {
+		size_t submissions{};
+		size_t operations{};
+		VkDeviceSize staged_bytes{};
+		size_t ring_waits{};
+	} m_upload_statistics{};
+
+	/*
+	Persistently mapped staging memory of every upload of the scene, the
+	batches release their ranges once their fences are signaled
+	*/
+	std::unique_ptr<StagingRing> m_staging_ring{};
+
+	/*
+	Alignment of the ranges of the staging ring
+	*/
+	VkDeviceSize m_staging_alignment{ 16 };
+
+	/*
+	Decoded textures kept on disk between launches, null when it is disabled.
+	The asset streamer uses it so it has to outlive it.
+	*/
+	std::unique_ptr<TextureCache> m_texture_cache{};
+
+	std::unique_ptr<AssetStreamer> m_asset_streamer{};
+
+	AssetHandle m_streamed_mesh{ invalid_asset };
+
+	AssetHandle m_streamed_texture{ invalid_asset };
+
+	/*
+	Texture requested for the streamed mesh when its materials have none
+	*/
+	std::string m_streamed_texture_path{};
+
+	/*
+	Moves the model into the place the camera looks at, before it is rotated
+	*/
+	glm::mat4 m_model_transform{ 1.0f };
+
+	/*
+	Mesh, skeleton and animation of the skinned scene, empty when the
+	scene is static.
+	*/
+	SkinnedMesh m_skinned_mesh{};
+
+	SkinningKernel m_skinning_kernel{ SkinningKernel::scalar };
+
+	/*
+	The clip of the skinned mesh cooked, its raw poses are freed. Empty
+	when cooking is disabled and the raw clip is sampled instead.
+	*/
+	CookedClip m_cooked_clip{};
+
+	CookedClipSampler m_cooked_clip_sampler{};
+
+	std::vector<BonePose> m_skinning_pose{};
+
+	std::vector<glm::mat4> m_skinning_palette{};
+
+	std::chrono::high_resolution_clock::time_point m_skinning_start_time{};
+
+	/*
+	Skinned vertices of every command buffer, written by the CPU every
+	frame before the command buffer is submitted again, or by the compute
+	pipeline at the start of the command buffer with GPU skinning.
+	*/
+	std::vector<AllocatedBuffer> m_skinned_vertex_buffers{};
+
+	/*
+	The vertices are skinned by the compute pipeline, set when the scene is
+	skinned and the graphics queue can run compute shaders.
+	*/
+	bool m_gpu_skinning{ false };
+
+	/*
+	Inputs of the compute pipeline that never change, the vertices in the
+	reference pose and their skin weights.
+	*/
+	AllocatedBuffer m_skinning_reference_buffer{};
+
+	AllocatedBuffer m_skinning_weight_buffer{};
+
+	/*
+	Palette of every command buffer, written by the CPU every frame
+	*/
+	std::vector<AllocatedBuffer> m_skinning_palette_buffers{};
+
+	VkDescriptorSetLayout m_skinning_descriptor_set_layout{};
+
+	VkPipelineLayout m_skinning_pipeline_layout{};
+
+	VkPipeline m_skinning_pipeline{};
+
+	VkDescriptorPool m_skinning_descriptor_pool{};
+
+	std::vector<VkDescriptorSet> m_skinning_descriptor_sets{};
+
+	/*
+	Two timestamps per command buffer around the dispatch, null when the
+	graphics queue has no timestamps.
+	*/
+	VkQueryPool m_skinning_query_pool{};
+
+	uint m_skinning_timestamp_valid_bits{};
+
+	/*
+	Time the GPU spent skinning since the frame time was last shown
+	*/
+	double m_skinning_gpu_milliseconds{};
+
+	uint m_skinning_gpu_samples{};
+
 };
 
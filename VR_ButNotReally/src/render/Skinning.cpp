@@ -0,0 +1,553 @@
+#include "Skinning.h"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+#include <unordered_map>
+#include <gsl/gsl>
+
+#include "SmdParser.h"
+#include "../utils/ThreadPool.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define SKINNING_SSE2
+#include <emmintrin.h>
+#endif
+
+/*
+MSVC compiles the AVX2 intrinsics without /arch:AVX2, the kernel is only
+called after checking the CPU. Other compilers need the target flags.
+*/
+#if defined(_M_X64) || (defined(__AVX2__) && defined(__FMA__))
+#define SKINNING_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+	auto getDirectory(const std::string& path) -> std::string {
+		const auto separator = path.find_last_of("/\\");
+		return separator == std::string::npos ? std::string{} : path.substr(0, separator + 1);
+	}
+
+	auto makeBonePose(const SmdBonePose& pose) -> BonePose {
+
+		/*
+		The Euler angles of the .smd files rotate around X, then Y and then Z
+		*/
+		auto bone_pose = BonePose{};
+		bone_pose.translation = pose.position;
+		bone_pose.rotation =
+			glm::angleAxis(pose.rotation.z, glm::vec3(0.0f, 0.0f, 1.0f)) *
+			glm::angleAxis(pose.rotation.y, glm::vec3(0.0f, 1.0f, 0.0f)) *
+			glm::angleAxis(pose.rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
+		return bone_pose;
+	}
+
+	auto makeBoneMatrix(const BonePose& pose) noexcept -> glm::mat4 {
+		auto matrix = glm::mat4_cast(pose.rotation);
+		matrix[3] = glm::vec4(pose.translation, 1.0f);
+		return matrix;
+	}
+
+	/**
+	A vertex is only shared by the corners with the same attributes and bones
+	*/
+	struct SkinnedVertexKey {
+		Vertex vertex{};
+		SkinWeights weights{};
+
+		auto operator==(const SkinnedVertexKey& other) const noexcept -> bool {
+			return vertex == other.vertex && weights.bones == other.weights.bones && weights.weights == other.weights.weights;
+		}
+	};
+
+	struct SkinnedVertexKeyHash {
+		auto operator()(const SkinnedVertexKey& key) const noexcept -> size_t {
+			auto hash = hashVertex(key.vertex);
+			for (auto i = size_t{ 0 }; i < max_bone_influences; ++i) {
+				hash = (hash ^ key.weights.bones[i]) * 0x100000001b3ull;
+			}
+			return gsl::narrow_cast<size_t>(hash);
+		}
+	};
+
+	auto skinScalar(
+		const SkinnedMesh& mesh,
+		const glm::mat4* palette,
+		Vertex* destination,
+		size_t begin,
+		size_t end) noexcept -> void {
+
+		[[gsl::suppress(bounds.1)]]{
+		for (auto i = begin; i < end; ++i) {
+			const auto& weights = mesh.weights[i];
+
+			auto matrix = palette[weights.bones[0]] * weights.weights[0];
+			for (auto influence = size_t{ 1 }; influence < max_bone_influences && weights.weights[influence] > 0.0f; ++influence) {
+				matrix = matrix + palette[weights.bones[influence]] * weights.weights[influence];
+			}
+
+			auto vertex = mesh.vertices[i];
+			vertex.pos = glm::vec3(matrix * glm::vec4(vertex.pos, 1.0f));
+			destination[i] = vertex;
+		}
+		}
+	}
+
+#ifdef SKINNING_SSE2
+	static_assert(offsetof(Vertex, pos) == 0 && offsetof(Vertex, color) == 3 * sizeof(float), "The SIMD kernels store the position with the red of the color");
+
+	auto skinSse(
+		const SkinnedMesh& mesh,
+		const glm::mat4* palette,
+		Vertex* destination,
+		size_t begin,
+		size_t end) noexcept -> void {
+
+		[[gsl::suppress(bounds.1)]][[gsl::suppress(type.1)]]{
+		for (auto i = begin; i < end; ++i) {
+			const auto& weights = mesh.weights[i];
+
+			/*
+			The 4 columns of the blended matrix
+			*/
+			auto matrix = reinterpret_cast<const float*>(&palette[weights.bones[0]]);
+			auto weight = _mm_set1_ps(weights.weights[0]);
+			auto column_0 = _mm_mul_ps(_mm_loadu_ps(matrix + 0), weight);
+			auto column_1 = _mm_mul_ps(_mm_loadu_ps(matrix + 4), weight);
+			auto column_2 = _mm_mul_ps(_mm_loadu_ps(matrix + 8), weight);
+			auto column_3 = _mm_mul_ps(_mm_loadu_ps(matrix + 12), weight);
+
+			for (auto influence = size_t{ 1 }; influence < max_bone_influences && weights.weights[influence] > 0.0f; ++influence) {
+				matrix = reinterpret_cast<const float*>(&palette[weights.bones[influence]]);
+				weight = _mm_set1_ps(weights.weights[influence]);
+				column_0 = _mm_add_ps(column_0, _mm_mul_ps(_mm_loadu_ps(matrix + 0), weight));
+				column_1 = _mm_add_ps(column_1, _mm_mul_ps(_mm_loadu_ps(matrix + 4), weight));
+				column_2 = _mm_add_ps(column_2, _mm_mul_ps(_mm_loadu_ps(matrix + 8), weight));
+				column_3 = _mm_add_ps(column_3, _mm_mul_ps(_mm_loadu_ps(matrix + 12), weight));
+			}
+
+			/*
+			The first 16 bytes of the vertex are the position and the red of its
+			color, the red goes back to the last lane before storing them.
+			*/
+			const auto source = reinterpret_cast<const float*>(&mesh.vertices[i]);
+			const auto loaded = _mm_loadu_ps(source);
+			const auto position = _mm_add_ps(
+				_mm_add_ps(
+					_mm_mul_ps(column_0, _mm_shuffle_ps(loaded, loaded, _MM_SHUFFLE(0, 0, 0, 0))),
+					_mm_mul_ps(column_1, _mm_shuffle_ps(loaded, loaded, _MM_SHUFFLE(1, 1, 1, 1)))),
+				_mm_add_ps(
+					_mm_mul_ps(column_2, _mm_shuffle_ps(loaded, loaded, _MM_SHUFFLE(2, 2, 2, 2))),
+					column_3));
+			const auto z_red = _mm_shuffle_ps(position, loaded, _MM_SHUFFLE(3, 3, 2, 2));
+
+			const auto target = reinterpret_cast<float*>(&destination[i]);
+			_mm_storeu_ps(target, _mm_shuffle_ps(position, z_red, _MM_SHUFFLE(2, 0, 1, 0)));
+			memcpy(target + 4, source + 4, sizeof(Vertex) - 4 * sizeof(float));
+		}
+		}
+	}
+#endif
+
+#ifdef SKINNING_AVX2
+	auto supportsAvx2() noexcept -> bool {
+#ifdef _MSC_VER
+		int info[4]{};
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return false;
+		}
+
+		/*
+		FMA, OSXSAVE and AVX, and the OS must save the YMM registers
+		*/
+		__cpuidex(info, 1, 0);
+		constexpr auto required = (1 << 12) | (1 << 27) | (1 << 28);
+		if ((info[2] & required) != required || (_xgetbv(0) & 6) != 6) {
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+	}
+
+	/**
+	@return The amount of bones of the vertex with a weight
+	*/
+	auto getInfluenceCount(const SkinWeights& weights) noexcept -> size_t {
+		auto count = size_t{ 1 };
+		while (count < max_bone_influences && weights.weights[count] > 0.0f) {
+			++count;
+		}
+		return count;
+	}
+
+	auto skinAvx2(
+		const SkinnedMesh& mesh,
+		const glm::mat4* palette,
+		Vertex* destination,
+		size_t begin,
+		size_t end) noexcept -> void {
+
+		[[gsl::suppress(bounds.1)]][[gsl::suppress(type.1)]]{
+
+		/*
+		Two vertices at a time, the first one in the lower half of the registers
+		and the second one in the upper half. The column k of both blended
+		matrices is in column_k.
+		*/
+		auto i = begin;
+		for (; i + 1 < end; i += 2) {
+			const auto& weights_0 = mesh.weights[i];
+			const auto& weights_1 = mesh.weights[i + 1];
+
+			auto column_0 = _mm256_setzero_ps();
+			auto column_1 = _mm256_setzero_ps();
+			auto column_2 = _mm256_setzero_ps();
+			auto column_3 = _mm256_setzero_ps();
+
+			/*
+			The bones after the last one of a vertex have weight 0 and add nothing
+			*/
+			const auto influence_count = std::max(getInfluenceCount(weights_0), getInfluenceCount(weights_1));
+			for (auto influence = size_t{ 0 }; influence < influence_count; ++influence) {
+				const auto matrix_0 = reinterpret_cast<const float*>(&palette[weights_0.bones[influence]]);
+				const auto matrix_1 = reinterpret_cast<const float*>(&palette[weights_1.bones[influence]]);
+				const auto weight = _mm256_insertf128_ps(
+					_mm256_castps128_ps256(_mm_broadcast_ss(&weights_0.weights[influence])),
+					_mm_broadcast_ss(&weights_1.weights[influence]),
+					1);
+
+				column_0 = _mm256_fmadd_ps(_mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(matrix_0 + 0)), _mm_loadu_ps(matrix_1 + 0), 1), weight, column_0);
+				column_1 = _mm256_fmadd_ps(_mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(matrix_0 + 4)), _mm_loadu_ps(matrix_1 + 4), 1), weight, column_1);
+				column_2 = _mm256_fmadd_ps(_mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(matrix_0 + 8)), _mm_loadu_ps(matrix_1 + 8), 1), weight, column_2);
+				column_3 = _mm256_fmadd_ps(_mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(matrix_0 + 12)), _mm_loadu_ps(matrix_1 + 12), 1), weight, column_3);
+			}
+
+			const auto source_0 = reinterpret_cast<const float*>(&mesh.vertices[i]);
+			const auto source_1 = reinterpret_cast<const float*>(&mesh.vertices[i + 1]);
+			const auto loaded = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(source_0)), _mm_loadu_ps(source_1), 1);
+			const auto positions = _mm256_fmadd_ps(
+				column_0,
+				_mm256_permute_ps(loaded, _MM_SHUFFLE(0, 0, 0, 0)),
+				_mm256_fmadd_ps(
+					column_1,
+					_mm256_permute_ps(loaded, _MM_SHUFFLE(1, 1, 1, 1)),
+					_mm256_fmadd_ps(column_2, _mm256_permute_ps(loaded, _MM_SHUFFLE(2, 2, 2, 2)), column_3)));
+
+			/*
+			Like skinSse, the red of the colors goes back to the last lane of every half
+			*/
+			const auto merged = _mm256_blend_ps(positions, loaded, 0x88);
+			const auto target_0 = reinterpret_cast<float*>(&destination[i]);
+			const auto target_1 = reinterpret_cast<float*>(&destination[i + 1]);
+			_mm_storeu_ps(target_0, _mm256_castps256_ps128(merged));
+			memcpy(target_0 + 4, source_0 + 4, sizeof(Vertex) - 4 * sizeof(float));
+			_mm_storeu_ps(target_1, _mm256_extractf128_ps(merged, 1));
+			memcpy(target_1 + 4, source_1 + 4, sizeof(Vertex) - 4 * sizeof(float));
+		}
+
+		if (i < end) {
+			skinSse(mesh, palette, destination, i, end);
+		}
+		}
+	}
+#endif
+}
+
+auto loadSkinnedMesh(const std::string& path) -> SkinnedMesh {
+
+	const auto model = parseSmd(path);
+	if (model.triangles.empty()) {
+		throw std::runtime_error("The .smd file [" + path + "] has no triangles");
+	}
+
+	const auto bone_count = model.nodes.size();
+	if (bone_count > std::numeric_limits<uint16_t>::max() + size_t{ 1 }) {
+		throw std::runtime_error("The .smd file [" + path + "] has more bones than we can skin");
+	}
+
+	auto mesh = SkinnedMesh{};
+
+	/*
+	The first frame is the reference pose the triangles are in
+	*/
+	mesh.skeleton.names.reserve(bone_count);
+	mesh.skeleton.parents.reserve(bone_count);
+	mesh.reference_pose.resize(bone_count);
+	for (auto bone = size_t{ 0 }; bone < bone_count; ++bone) {
+		mesh.skeleton.names.push_back(model.nodes[bone].name);
+		mesh.skeleton.parents.push_back(model.nodes[bone].parent);
+		if (!model.frames.empty()) {
+			mesh.reference_pose[bone] = makeBonePose(model.frames.front().bones[bone]);
+		}
+	}
+
+	/*
+	With the identity as inverse bind matrices the palette of the reference
+	pose is the model transform of every bone, the bind matrices.
+	*/
+	mesh.skeleton.inverse_bind.assign(bone_count, glm::mat4(1.0f));
+	auto bind = std::vector<glm::mat4>(bone_count);
+	computeSkinningPalette(mesh.skeleton, mesh.reference_pose, bind.data());
+	for (auto bone = size_t{ 0 }; bone < bone_count; ++bone) {
+		mesh.skeleton.inverse_bind[bone] = glm::inverse(bind[bone]);
+	}
+
+	if (model.frames.size() > 1) {
+		mesh.clip.frame_count = gsl::narrow<uint32_t>(model.frames.size());
+		mesh.clip.poses.reserve(model.frames.size() * bone_count);
+		for (const auto& frame : model.frames) {
+			for (const auto& pose : frame.bones) {
+				mesh.clip.poses.push_back(makeBonePose(pose));
+			}
+		}
+	}
+
+	const auto directory = getDirectory(path);
+	for (const auto& material : model.materials) {
+		mesh.texture_paths.push_back(directory + material);
+	}
+
+	auto unique_vertices = std::unordered_map<SkinnedVertexKey, uint32_t, SkinnedVertexKeyHash>{};
+	unique_vertices.reserve(model.triangles.size() * 3);
+	mesh.indices.reserve(model.triangles.size() * 3);
+
+	for (const auto& triangle : model.triangles) {
+		for (const auto& corner : triangle.vertices) {
+			auto key = SkinnedVertexKey{};
+			key.vertex.pos = corner.position;
+			key.vertex.tex_coord = { corner.tex_coord.x, 1.0f - corner.tex_coord.y };
+			key.vertex.texture_layer = triangle.material;
+			for (auto link = size_t{ 0 }; link < corner.link_count; ++link) {
+				key.weights.bones[link] = gsl::narrow_cast<uint16_t>(corner.links[link].bone);
+				key.weights.weights[link] = corner.links[link].weight;
+			}
+
+			const auto inserted = unique_vertices.emplace(key, gsl::narrow<uint32_t>(mesh.vertices.size()));
+			if (inserted.second) {
+				mesh.vertices.push_back(key.vertex);
+				mesh.weights.push_back(key.weights);
+			}
+			mesh.indices.push_back(inserted.first->second);
+		}
+	}
+
+	return mesh;
+}
+
+auto makeSwayClip(
+	const Skeleton& skeleton,
+	const std::vector<BonePose>& reference_pose,
+	uint32_t frame_count,
+	float frame_rate,
+	float amplitude) -> AnimationClip {
+
+	const auto bone_count = skeleton.boneCount();
+
+	auto depths = std::vector<uint32_t>(bone_count);
+	for (auto bone = size_t{ 0 }; bone < bone_count; ++bone) {
+		const auto parent = skeleton.parents[bone];
+		depths[bone] = parent < 0 ? 0 : depths[parent] + 1;
+	}
+
+	auto clip = AnimationClip{};
+	clip.frame_rate = frame_rate;
+	clip.frame_count = frame_count;
+	clip.poses.reserve(size_t{ frame_count } * bone_count);
+
+	constexpr auto two_pi = 6.28318530718f;
+	constexpr auto phase_per_level = 0.4f;
+
+	for (auto frame = uint32_t{ 0 }; frame < frame_count; ++frame) {
+		const auto phase = two_pi * frame / frame_count;
+
+		for (auto bone = size_t{ 0 }; bone < bone_count; ++bone) {
+			auto pose = reference_pose[bone];
+
+			/*
+			The roots stay still so the model doesn't float away
+			*/
+			if (skeleton.parents[bone] >= 0) {
+				const auto angle = amplitude * std::sin(phase - phase_per_level * depths[bone]);
+				pose.rotation = glm::angleAxis(angle, glm::vec3(0.0f, 0.0f, 1.0f)) * pose.rotation;
+			}
+			clip.poses.push_back(pose);
+		}
+	}
+
+	return clip;
+}
+
+auto sampleClip(const AnimationClip& clip, float time, std::vector<BonePose>& pose) -> void {
+
+	const auto bone_count = clip.poses.size() / clip.frame_count;
+	pose.resize(bone_count);
+
+	auto position = std::fmod(time * clip.frame_rate, gsl::narrow_cast<float>(clip.frame_count));
+	if (position < 0.0f) {
+		position += clip.frame_count;
+	}
+
+	const auto frame_0 = std::min(gsl::narrow_cast<uint32_t>(position), clip.frame_count - 1);
+	const auto frame_1 = (frame_0 + 1) % clip.frame_count;
+	const auto t = position - frame_0;
+
+	const auto poses_0 = clip.poses.begin() + size_t{ frame_0 } * bone_count;
+	const auto poses_1 = clip.poses.begin() + size_t{ frame_1 } * bone_count;
+
+	for (auto bone = size_t{ 0 }; bone < bone_count; ++bone) {
+		const auto& pose_0 = poses_0[bone];
+		const auto& pose_1 = poses_1[bone];
+
+		/*
+		Normalized linear interpolation through the shortest arc, the
+		frames are close enough for it to be as good as a slerp.
+		*/
+		const auto rotation_1 = glm::dot(pose_0.rotation, pose_1.rotation) < 0.0f ? -pose_1.rotation : pose_1.rotation;
+
+		pose[bone].translation = pose_0.translation + (pose_1.translation - pose_0.translation) * t;
+		pose[bone].rotation = glm::normalize(pose_0.rotation * (1.0f - t) + rotation_1 * t);
+	}
+}
+
+auto computeSkinningPalette(const Skeleton& skeleton, const std::vector<BonePose>& pose, glm::mat4* palette) noexcept -> void {
+
+	const auto bone_count = skeleton.boneCount();
+
+	/*
+	The model transform of every bone first, the parents come before their
+	children so theirs is always ready.
+	*/
+	[[gsl::suppress(bounds.1)]]{
+	for (auto bone = size_t{ 0 }; bone < bone_count; ++bone) {
+		const auto parent = skeleton.parents[bone];
+		palette[bone] = parent < 0 ?
+			makeBoneMatrix(pose[bone]) :
+			palette[parent] * makeBoneMatrix(pose[bone]);
+	}
+
+	for (auto bone = size_t{ 0 }; bone < bone_count; ++bone) {
+		palette[bone] = palette[bone] * skeleton.inverse_bind[bone];
+	}
+	}
+}
+
+auto getBestSkinningKernel() noexcept -> SkinningKernel {
+	if (isSkinningKernelSupported(SkinningKernel::avx2)) {
+		return SkinningKernel::avx2;
+	}
+	if (isSkinningKernelSupported(SkinningKernel::sse)) {
+		return SkinningKernel::sse;
+	}
+	return SkinningKernel::scalar;
+}
+
+auto isSkinningKernelSupported(SkinningKernel kernel) noexcept -> bool {
+	switch (kernel) {
+#ifdef SKINNING_SSE2
+	case SkinningKernel::sse:
+		return true;
+#endif
+#ifdef SKINNING_AVX2
+	case SkinningKernel::avx2: {
+		static const auto supported = supportsAvx2();
+		return supported;
+	}
+#endif
+	case SkinningKernel::scalar:
+		return true;
+	default:
+		return false;
+	}
+}
+
+auto getSkinningKernelName(SkinningKernel kernel) noexcept -> const char* {
+	switch (kernel) {
+	case SkinningKernel::sse:
+		return "SSE";
+	case SkinningKernel::avx2:
+		return "AVX2";
+	default:
+		return "scalar";
+	}
+}
+
+auto skinVertices(
+	const SkinnedMesh& mesh,
+	const glm::mat4* palette,
+	Vertex* destination,
+	size_t begin,
+	size_t end,
+	SkinningKernel kernel) noexcept -> void {
+
+	switch (kernel) {
+#ifdef SKINNING_AVX2
+	case SkinningKernel::avx2:
+		skinAvx2(mesh, palette, destination, begin, end);
+		break;
+#endif
+#ifdef SKINNING_SSE2
+	case SkinningKernel::sse:
+		skinSse(mesh, palette, destination, begin, end);
+		break;
+#endif
+	default:
+		skinScalar(mesh, palette, destination, begin, end);
+		break;
+	}
+}
+
+auto skinCharacters(
+	const SkinnedMesh& mesh,
+	const glm::mat4* palettes,
+	size_t character_count,
+	Vertex* destination,
+	ThreadPool* thread_pool,
+	SkinningKernel kernel) -> void {
+
+	const auto vertex_count = mesh.vertices.size();
+	const auto bone_count = mesh.skeleton.boneCount();
+	if (vertex_count == 0) {
+		return;
+	}
+
+	/*
+	A block may end in the middle of a character and start in the middle of
+	another one, it is split at the characters it crosses.
+	*/
+	auto skinBlock = [&](size_t begin, size_t end) {
+		while (begin < end) {
+			const auto character = begin / vertex_count;
+			const auto first = begin - character * vertex_count;
+			const auto last = std::min(end - character * vertex_count, vertex_count);
+
+			[[gsl::suppress(bounds.1)]]{
+			skinVertices(
+				mesh,
+				palettes + character * bone_count,
+				destination + character * vertex_count,
+				first,
+				last,
+				kernel);
+			}
+			begin = character * vertex_count + last;
+		}
+	};
+
+	if (thread_pool) {
+		thread_pool->parallelFor(character_count * vertex_count, skinBlock);
+	}
+	else {
+		skinBlock(0, character_count * vertex_count);
+	}
+}
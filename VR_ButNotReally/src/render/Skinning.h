@@ -0,0 +1,205 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include "RenderData.h"
+
+class ThreadPool;
+
+/*
+Skeletal animation of the .smd models, skinned on the CPU.
+
+loadSkinnedMesh turns the triangles of an .smd file into an indexed mesh with
+its vertices in the reference pose, like loadMesh does with an .obj file, and
+keeps the bones and weights of every vertex, the skeleton and the animation.
+
+Every frame the animation is sampled into a pose (the translation and rotation
+of every bone relative to its parent), the pose becomes the skinning palette
+(the matrix of every bone from the reference pose to the current one, in model
+space) and the vertices are transformed with the palette into the vertex
+buffer of the frame:
+
+	skinned = (weight_0 * palette[bone_0] + ... + weight_3 * palette[bone_3]) * reference
+
+The matrices are blended before transforming, so every vertex does a single
+matrix transform whatever its amount of bones, and the blend stops at the
+first bone with weight 0 (most vertices of Tarzan.smd have a single bone).
+With SSE the 4 columns of the matrix are 4 registers, with AVX2 two registers
+of two columns each so the blend does half the instructions. The kernel is
+picked at runtime, AVX2 needs the cpuid bits of AVX2 and FMA and the support
+of the OS for the YMM registers.
+
+Characters share the mesh but not their palette, skinCharacters splits the
+vertices of all of them in contiguous blocks, one per worker of the thread
+pool, so every worker writes its own part of the destination and the cost
+scales with the cores.
+
+Only the positions are skinned, our vertices have no normals.
+
+The renderer can skin on the GPU instead (config::gpu_skinning_enabled), then
+the CPU only computes the palette and the compute shader skinning.comp does
+the transform of every vertex, reading the same Vertex and SkinWeights.
+*/
+
+constexpr auto max_bone_influences = size_t{ 4 };
+
+/*
+Vertices skinned by every workgroup of skinning.comp, the compute shader
+that skins them on the GPU with the same layout of Vertex and SkinWeights.
+*/
+constexpr auto skinning_workgroup_size = uint32_t{ 64 };
+
+/**
+Bones of a skeleton, every bone comes after its parent
+*/
+struct Skeleton {
+	std::vector<std::string> names{};
+	std::vector<int32_t> parents{};			// -1 for the roots
+	std::vector<glm::mat4> inverse_bind{};	// From model space to the space of the bone in the reference pose
+
+	auto boneCount() const noexcept -> size_t { return parents.size(); }
+};
+
+/**
+Transform of a bone relative to its parent
+*/
+struct BonePose {
+	glm::vec3 translation{};
+	glm::quat rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+};
+
+struct AnimationClip {
+	float frame_rate{ 30.0f };
+	uint32_t frame_count{};
+	std::vector<BonePose> poses{};	// frame_count * bone count, the bones of a frame after the bones of the previous one
+
+	auto duration() const noexcept -> float { return frame_count / frame_rate; }
+};
+
+/**
+Bones that move a vertex, sorted from the heaviest. The weights add up to 1
+and the unused ones are 0.
+*/
+struct SkinWeights {
+	std::array<uint16_t, max_bone_influences> bones{};
+	std::array<float, max_bone_influences> weights{};
+};
+
+struct SkinnedMesh {
+	std::vector<Vertex> vertices{};			// In the reference pose
+	std::vector<SkinWeights> weights{};		// One per vertex
+	std::vector<uint32_t> indices{};
+	std::vector<std::string> texture_paths{};	// Texture of every layer the vertices use
+	Skeleton skeleton{};
+	std::vector<BonePose> reference_pose{};	// One per bone
+	AnimationClip clip{};					// Empty if the file only has the reference pose
+};
+
+enum class SkinningKernel {
+	scalar,
+	sse,
+	avx2
+};
+
+/**
+Loads the mesh, skeleton and animation of an .smd file. The vertices are
+deduplicated and every different material becomes a layer of the texture
+array, the material names are the texture paths relative to the file.
+
+@param The path of the .smd file
+@return The skinned mesh
+@throws std::runtime_error if the file can't be read or it has no triangles
+*/
+auto loadSkinnedMesh(const std::string& path) -> SkinnedMesh;
+
+/**
+Creates a looping clip that sways every bone around the Z axis of its parent
+with a phase that grows along the chains, for models without an animation.
+
+@param The skeleton
+@param The reference pose the clip starts from
+@param The amount of frames of the clip
+@param The frames per second
+@param The biggest rotation of a bone, in radians
+@return The clip
+*/
+auto makeSwayClip(
+	const Skeleton& skeleton,
+	const std::vector<BonePose>& reference_pose,
+	uint32_t frame_count,
+	float frame_rate,
+	float amplitude) -> AnimationClip;
+
+/**
+Samples a looping clip, interpolating between the two closest frames.
+
+@param The clip, with at least one frame
+@param The time in seconds, it wraps around the duration of the clip
+@param Where to write the pose, one per bone
+*/
+auto sampleClip(const AnimationClip& clip, float time, std::vector<BonePose>& pose) -> void;
+
+/**
+Computes the matrix that moves the vertices of every bone from the reference
+pose to the pose provided.
+
+@param The skeleton
+@param The pose of every bone, relative to its parent
+@param Where to write the palette, one matrix per bone
+*/
+auto computeSkinningPalette(const Skeleton& skeleton, const std::vector<BonePose>& pose, glm::mat4* palette) noexcept -> void;
+
+/**
+@return The fastest kernel the CPU supports
+*/
+auto getBestSkinningKernel() noexcept -> SkinningKernel;
+
+/**
+@return true if the CPU (and the build) can run the kernel
+*/
+auto isSkinningKernelSupported(SkinningKernel kernel) noexcept -> bool;
+
+auto getSkinningKernelName(SkinningKernel kernel) noexcept -> const char*;
+
+/**
+Skins the vertices [begin, end) of the mesh. The skinned vertices are written
+in order and whole, so the destination can be write combined memory.
+
+@param The mesh
+@param The palette of the character, one matrix per bone
+@param Where to write the vertices, the vertex begin is written at destination[begin]
+@param The first vertex
+@param One past the last vertex
+@param The kernel, it must be supported
+*/
+auto skinVertices(
+	const SkinnedMesh& mesh,
+	const glm::mat4* palette,
+	Vertex* destination,
+	size_t begin,
+	size_t end,
+	SkinningKernel kernel) noexcept -> void;
+
+/**
+Skins the whole mesh once for every character, the vertices of every
+character after the ones of the previous character.
+
+@param The mesh the characters share
+@param The palettes of the characters, one after the other
+@param The amount of characters
+@param Where to write the vertices, room for character count * vertex count
+@param The thread pool that skins them, null skins them in this thread
+@param The kernel, it must be supported
+*/
+auto skinCharacters(
+	const SkinnedMesh& mesh,
+	const glm::mat4* palettes,
+	size_t character_count,
+	Vertex* destination,
+	ThreadPool* thread_pool,
+	SkinningKernel kernel) -> void;
@@ -0,0 +1,227 @@
+#include "SmdParser.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <gsl/gsl>
+
+namespace {
+
+	enum class SmdBlock {
+		none,
+		nodes,
+		skeleton,
+		triangles
+	};
+
+	auto trim(const std::string& text) -> std::string {
+		const auto first = text.find_first_not_of(" \t\r");
+		if (first == std::string::npos) {
+			return {};
+		}
+		return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+	}
+
+	auto makeError(const std::string& path, size_t line_number, const std::string& message) -> std::runtime_error {
+		return std::runtime_error("We couldn't parse the .smd file [" + path + "] at line " + std::to_string(line_number) + ": " + message);
+	}
+
+	/**
+	Keeps the heaviest links of the vertex, gives the weight they are missing
+	to the parent bone and normalizes them.
+	*/
+	auto addLinks(SmdVertex& vertex, uint32_t parent, std::vector<SmdLink>& links) -> void {
+
+		auto total = 0.0f;
+		for (const auto& link : links) {
+			total += link.weight;
+		}
+		if (total < 1.0f - 1e-4f) {
+			links.push_back({ parent, 1.0f - total });
+		}
+
+		/*
+		The same bone may be linked more than once
+		*/
+		std::sort(links.begin(), links.end(), [](const SmdLink& a, const SmdLink& b) { return a.bone < b.bone; });
+		auto merged = size_t{ 0 };
+		for (const auto& link : links) {
+			if (merged > 0 && links[merged - 1].bone == link.bone) {
+				links[merged - 1].weight += link.weight;
+			}
+			else {
+				links[merged++] = link;
+			}
+		}
+		links.resize(merged);
+
+		std::sort(links.begin(), links.end(), [](const SmdLink& a, const SmdLink& b) { return a.weight > b.weight; });
+		vertex.link_count = gsl::narrow_cast<uint32_t>(std::min(links.size(), smd_max_links));
+
+		auto kept = 0.0f;
+		for (auto i = size_t{ 0 }; i < vertex.link_count; ++i) {
+			kept += links[i].weight;
+		}
+		for (auto i = size_t{ 0 }; i < vertex.link_count; ++i) {
+			vertex.links[i] = { links[i].bone, kept > 0.0f ? links[i].weight / kept : 1.0f / vertex.link_count };
+		}
+	}
+}
+
+auto parseSmd(const std::string& path) -> SmdModel {
+
+	auto file = std::ifstream(path);
+	if (!file.is_open()) {
+		throw std::runtime_error("We couldn't read the .smd file [" + path + "]");
+	}
+
+	auto model = SmdModel{};
+	auto block = SmdBlock::none;
+	auto line = std::string{};
+	auto line_number = size_t{ 0 };
+
+	/*
+	A triangle is its material line followed by the lines of its 3 vertices
+	*/
+	auto triangle = SmdTriangle{};
+	auto triangle_vertices = size_t{ 3 };
+	auto links = std::vector<SmdLink>{};
+
+	while (std::getline(file, line)) {
+		++line_number;
+
+		const auto content = trim(line);
+		if (content.empty() || content.compare(0, 2, "//") == 0) {
+			continue;
+		}
+
+		if (block == SmdBlock::none) {
+			if (content == "nodes") {
+				block = SmdBlock::nodes;
+			}
+			else if (content == "skeleton") {
+				block = SmdBlock::skeleton;
+			}
+			else if (content == "triangles") {
+				block = SmdBlock::triangles;
+			}
+			/*
+			"version 1" and the blocks we don't use (vertexanimation) are skipped
+			*/
+			continue;
+		}
+
+		if (content == "end") {
+			if (block == SmdBlock::triangles && triangle_vertices != 3) {
+				throw makeError(path, line_number, "the last triangle is incomplete");
+			}
+			block = SmdBlock::none;
+			continue;
+		}
+
+		auto stream = std::istringstream{ content };
+
+		if (block == SmdBlock::nodes) {
+			auto id = 0;
+			auto node = SmdNode{};
+			if (!(stream >> id)) {
+				throw makeError(path, line_number, "expected the id of a node");
+			}
+
+			const auto name_begin = content.find('"');
+			const auto name_end = content.find('"', name_begin + 1);
+			if (name_begin == std::string::npos || name_end == std::string::npos) {
+				throw makeError(path, line_number, "expected the name of the node between quotes");
+			}
+			node.name = content.substr(name_begin + 1, name_end - name_begin - 1);
+
+			auto parent_stream = std::istringstream{ content.substr(name_end + 1) };
+			if (!(parent_stream >> node.parent)) {
+				throw makeError(path, line_number, "expected the parent of the node");
+			}
+
+			if (id != gsl::narrow_cast<int>(model.nodes.size())) {
+				throw makeError(path, line_number, "the nodes must be numbered in order");
+			}
+			if (node.parent >= id || node.parent < -1) {
+				throw makeError(path, line_number, "the parent of a node must come before it");
+			}
+			model.nodes.push_back(std::move(node));
+		}
+		else if (block == SmdBlock::skeleton) {
+			auto keyword = std::string{};
+			if (content.compare(0, 4, "time") == 0) {
+				auto frame = SmdFrame{};
+				stream >> keyword >> frame.time;
+				frame.bones = model.frames.empty() ?
+					std::vector<SmdBonePose>(model.nodes.size()) :
+					model.frames.back().bones;
+				model.frames.push_back(std::move(frame));
+				continue;
+			}
+
+			if (model.frames.empty()) {
+				throw makeError(path, line_number, "a bone pose outside of a frame");
+			}
+
+			auto id = 0;
+			auto pose = SmdBonePose{};
+			if (!(stream >> id >> pose.position.x >> pose.position.y >> pose.position.z >> pose.rotation.x >> pose.rotation.y >> pose.rotation.z)) {
+				throw makeError(path, line_number, "expected a bone id, its position and its rotation");
+			}
+			if (id < 0 || id >= gsl::narrow_cast<int>(model.nodes.size())) {
+				throw makeError(path, line_number, "the bone " + std::to_string(id) + " is not a node");
+			}
+			model.frames.back().bones[id] = pose;
+		}
+		else if (block == SmdBlock::triangles) {
+			if (triangle_vertices == 3) {
+				const auto found = std::find(model.materials.begin(), model.materials.end(), content);
+				triangle.material = gsl::narrow<uint32_t>(found - model.materials.begin());
+				if (found == model.materials.end()) {
+					model.materials.push_back(content);
+				}
+				triangle_vertices = 0;
+				continue;
+			}
+
+			auto& vertex = triangle.vertices[triangle_vertices];
+			auto parent = 0;
+			if (!(stream >> parent
+				>> vertex.position.x >> vertex.position.y >> vertex.position.z
+				>> vertex.normal.x >> vertex.normal.y >> vertex.normal.z
+				>> vertex.tex_coord.x >> vertex.tex_coord.y)) {
+				throw makeError(path, line_number, "expected the parent, position, normal and texture coordinates of a vertex");
+			}
+
+			const auto bone_count = gsl::narrow_cast<int>(model.nodes.size());
+			if (parent < 0 || parent >= bone_count) {
+				throw makeError(path, line_number, "the parent of the vertex is not a node");
+			}
+
+			links.clear();
+			auto link_count = 0;
+			if (stream >> link_count) {
+				for (auto link = 0; link < link_count; ++link) {
+					auto bone = 0;
+					auto weight = 0.0f;
+					if (!(stream >> bone >> weight) || bone < 0 || bone >= bone_count) {
+						throw makeError(path, line_number, "expected " + std::to_string(link_count) + " links to nodes");
+					}
+					links.push_back({ gsl::narrow_cast<uint32_t>(bone), std::max(weight, 0.0f) });
+				}
+			}
+			addLinks(vertex, gsl::narrow_cast<uint32_t>(parent), links);
+
+			if (++triangle_vertices == 3) {
+				model.triangles.push_back(triangle);
+			}
+		}
+	}
+
+	if (model.nodes.empty()) {
+		throw std::runtime_error("The .smd file [" + path + "] has no nodes");
+	}
+
+	return model;
+}
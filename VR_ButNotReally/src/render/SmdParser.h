@@ -0,0 +1,84 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <array>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+/*
+Parser of the Valve StudioMDL Data (.smd) files.
+
+An .smd file has up to three blocks:
+
+	nodes		One line per bone: id "name" parent_id, the roots have parent -1
+	skeleton	For every frame a "time N" line followed by the pose of the bones
+				that changed: id px py pz rx ry rz. The rotation is in Euler
+				angles (radians) applied X first, then Y, then Z, relative to the
+				parent bone.
+	triangles	For every triangle the material followed by 3 vertices:
+				parent px py pz nx ny nz u v [links (bone weight)*]
+
+Positions and normals of the triangles are in model space in the reference
+pose (the first frame). When a vertex has no links it follows its parent
+bone, when the weights of its links add up to less than 1 the rest goes to
+its parent bone too, like StudioMDL does.
+
+The skinning uses at most smd_max_links bones per vertex, only the heaviest
+links are kept and their weights are normalized.
+*/
+
+constexpr auto smd_max_links = size_t{ 4 };
+
+struct SmdNode {
+	std::string name{};
+	int32_t parent{ -1 };
+};
+
+struct SmdBonePose {
+	glm::vec3 position{};
+	glm::vec3 rotation{};	// Euler angles in radians, applied X, Y and then Z
+};
+
+/**
+Pose of every bone in a frame, the bones not listed in the file for that
+frame keep the pose they had in the previous one.
+*/
+struct SmdFrame {
+	int32_t time{};
+	std::vector<SmdBonePose> bones{};	// One per node
+};
+
+struct SmdLink {
+	uint32_t bone{};
+	float weight{};
+};
+
+struct SmdVertex {
+	glm::vec3 position{};
+	glm::vec3 normal{};
+	glm::vec2 tex_coord{};
+	std::array<SmdLink, smd_max_links> links{};
+	uint32_t link_count{};		// At least 1, the weights add up to 1
+};
+
+struct SmdTriangle {
+	uint32_t material{};		// Index in SmdModel::materials
+	std::array<SmdVertex, 3> vertices{};
+};
+
+struct SmdModel {
+	std::vector<SmdNode> nodes{};
+	std::vector<SmdFrame> frames{};			// In the order of the file, one per time line
+	std::vector<std::string> materials{};	// In the order the triangles use them for the first time
+	std::vector<SmdTriangle> triangles{};
+};
+
+/**
+Parses an .smd file.
+
+@param The path of the .smd file
+@return The bones, frames and triangles of the file
+@throws std::runtime_error if the file can't be read or it is malformed
+*/
+auto parseSmd(const std::string& path) -> SmdModel;
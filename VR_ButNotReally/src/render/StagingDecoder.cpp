@@ -0,0 +1,150 @@
+#include "StagingDecoder.h"
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <gsl/gsl>
+
+#pragma warning(push)
+#include <CppCoreCheck/Warnings.h>
+#pragma warning(disable: ALL_CPPCORECHECK_WARNINGS)
+#include <stb_image.h>
+#pragma warning(pop)
+
+namespace {
+
+	constexpr auto bytes_per_pixel = size_t{ 4 };
+
+	/**
+	Destination of the decoding in progress in this thread
+	*/
+	struct StagingTarget {
+		void* memory{ nullptr };
+		size_t size{};				// Bytes of the decoded pixels
+		size_t capacity{};			// Bytes available at the memory
+		bool handed_out{ false };	// Given to stb_image, it is not handed out twice
+	};
+
+	thread_local auto staging_target = StagingTarget{};
+
+	/**
+	Sets the target of the thread for the lifetime of the object
+	*/
+	struct ScopedStagingTarget {
+		ScopedStagingTarget(void* memory, size_t size, size_t capacity) noexcept { staging_target = { memory, size, capacity, false }; }
+		ScopedStagingTarget(const ScopedStagingTarget&) = delete;
+		ScopedStagingTarget& operator=(const ScopedStagingTarget&) = delete;
+		~ScopedStagingTarget() { staging_target = {}; }
+	};
+}
+
+auto readTextureSize(const MappedFile& source, uint32_t& width, uint32_t& height) -> bool {
+
+	auto texture_width = 0;
+	auto texture_height = 0;
+	auto texture_channels = 0;
+
+	[[gsl::suppress(type.1)]]{
+	if (!stbi_info_from_memory(
+		reinterpret_cast<const stbi_uc*>(source.data()),
+		gsl::narrow<int>(source.size()),
+		&texture_width,
+		&texture_height,
+		&texture_channels)) {
+		return false;
+	}
+	}
+
+	width = gsl::narrow_cast<uint32_t>(texture_width);
+	height = gsl::narrow_cast<uint32_t>(texture_height);
+	return width > 0 && height > 0;
+}
+
+auto decodeTextureInto(
+	const MappedFile& source,
+	const std::string& path,
+	unsigned char* destination,
+	size_t capacity,
+	uint32_t width,
+	uint32_t height) -> bool {
+
+	const auto size = size_t{ width } * height * bytes_per_pixel;
+
+	auto texture_width = 0;
+	auto texture_height = 0;
+	auto texture_channels = 0;
+	auto pixels = static_cast<stbi_uc*>(nullptr);
+	{
+		const auto target = ScopedStagingTarget{ destination, size, capacity };
+
+		[[gsl::suppress(type.1)]]{
+		pixels = stbi_load_from_memory(
+			reinterpret_cast<const stbi_uc*>(source.data()),
+			gsl::narrow<int>(source.size()),
+			&texture_width,
+			&texture_height,
+			&texture_channels,
+			STBI_rgb_alpha);
+		}
+	}
+
+	if (!pixels) {
+		throw std::runtime_error("We couldn't load the texture [" + path + "]: " + stbi_failure_reason());
+	}
+
+	/*
+	The target of the thread is gone, the destination must not reach stbi_image_free
+	*/
+	if (pixels == destination) {
+		return true;
+	}
+
+	if (gsl::narrow_cast<uint32_t>(texture_width) != width || gsl::narrow_cast<uint32_t>(texture_height) != height) {
+		stbi_image_free(pixels);
+		throw std::runtime_error("The texture [" + path + "] doesn't have the size its header says");
+	}
+
+	memcpy(destination, pixels, size);
+	stbi_image_free(pixels);
+	return false;
+}
+
+auto stagingDecoderMalloc(size_t size) -> void* {
+
+	/*
+	The JPEG decoder allocates its output with one spare byte
+	*/
+	const auto fits = size == staging_target.size || (size == staging_target.size + 1 && size <= staging_target.capacity);
+	if (staging_target.memory && !staging_target.handed_out && fits) {
+		staging_target.handed_out = true;
+		return staging_target.memory;
+	}
+	return malloc(size);
+}
+
+auto stagingDecoderRealloc(void* pointer, size_t size) -> void* {
+
+	if (!pointer || pointer != staging_target.memory) {
+		return realloc(pointer, size);
+	}
+
+	/*
+	The destination can't grow, the contents move to the heap and the
+	destination is not used again
+	*/
+	auto moved = malloc(size);
+	if (moved) {
+		memcpy(moved, pointer, std::min(size, staging_target.size));
+	}
+	staging_target.memory = nullptr;
+	return moved;
+}
+
+auto stagingDecoderFree(void* pointer) -> void {
+
+	if (pointer && pointer == staging_target.memory) {
+		staging_target.memory = nullptr;
+		return;
+	}
+	free(pointer);
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "../utils/MappedFile.h"
+
+/*
+Decoding of textures straight into a mapped staging buffer.
+
+stb_image always returns the pixels in a buffer it allocates itself, so a
+texture used to be decoded into the heap and then copied into the staging
+buffer, writing every pixel twice. Its IO callbacks don't help here, they only
+change where the encoded file is read from and we already read it from a
+mapped file.
+
+Instead, stb_image allocates through the hooks below (STBI_MALLOC,
+STBI_REALLOC and STBI_FREE are defined to them where its implementation is
+compiled). Before decoding we read the size of the image from its header,
+create the staging buffer and give its memory to the hooks of the decoding
+thread. The first allocation of the size of the decoded RGBA8 image gets that
+memory. For PNG and JPEG that is the buffer the pixels are decoded into and
+returned in, so nothing is copied. The JPEG decoder asks for one byte more
+than the pixels, so the destination must have room for it or JPEG textures
+are copied.
+
+If stb_image returns a different buffer anyway (a format that converts its
+output into a new one, or an intermediate buffer that happened to have the
+same size) the pixels are copied like before. The result is always right, at
+worst the copy is not saved.
+
+The decoders read back rows they already wrote (the PNG filters read the
+previous row) and so does the mip chain built in place, so these staging
+buffers should prefer HOST_CACHED memory. Reading write-combined memory is
+very slow.
+
+Only the textures that are neither cooked, nor read from the texture cache,
+nor layers of an array are decoded this way, by the renderer and by the
+streamer. With the default configuration (texture cache and material arrays
+enabled) no texture goes through here, see config::texture_cache_enabled.
+*/
+
+/**
+Reads the size of a texture from its header, without decoding it.
+
+@param The source file (.png, .jpg...) already mapped in memory
+@param Where to write the width
+@param Where to write the height
+@return false if stb_image doesn't understand the file
+*/
+auto readTextureSize(const MappedFile& source, uint32_t& width, uint32_t& height) -> bool;
+
+/**
+Decodes the level 0 of a texture as RGBA8 into the memory provided.
+
+@param The source file (.png, .jpg...) already mapped in memory
+@param The path of the texture, for the errors
+@param Where to write the pixels
+@param The bytes available at the destination, at least width * height * 4, one more lets JPEG decode in place
+@param The width read with readTextureSize
+@param The height read with readTextureSize
+@return true if stb_image decoded straight into the destination, false if the pixels had to be copied
+@throws std::runtime_error if the texture can't be decoded or its size is not the one provided
+*/
+auto decodeTextureInto(
+	const MappedFile& source,
+	const std::string& path,
+	unsigned char* destination,
+	size_t capacity,
+	uint32_t width,
+	uint32_t height) -> bool;
+
+/**
+Allocation hooks of stb_image, they hand out the destination of the current
+decodeTextureInto of the calling thread and use malloc otherwise.
+*/
+auto stagingDecoderMalloc(size_t size) -> void*;
+auto stagingDecoderRealloc(void* pointer, size_t size) -> void*;
+auto stagingDecoderFree(void* pointer) -> void;
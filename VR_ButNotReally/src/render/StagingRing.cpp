@@ -0,0 +1,82 @@
+#include "StagingRing.h"
+#include <stdexcept>
+#include <algorithm>
+
+StagingRing::StagingRing(VmaAllocator allocator, VkDeviceSize capacity) : m_allocator(allocator), m_capacity(capacity) {
+
+	auto buffer_create_info = VkBufferCreateInfo{};
+	buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	buffer_create_info.size = capacity;
+	buffer_create_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	auto allocation_create_info = VmaAllocationCreateInfo{};
+	allocation_create_info.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+	allocation_create_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+	/*
+	The ring is never flushed, the memory has to be coherent. Cached memory is
+	preferred, the mip chains built in place read the previous level.
+	*/
+	allocation_create_info.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	allocation_create_info.preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+	if (vmaCreateBuffer(
+		m_allocator,
+		&buffer_create_info,
+		&allocation_create_info,
+		&m_buffer.buffer,
+		&m_buffer.allocation,
+		&m_buffer.allocation_info) != VK_SUCCESS) {
+		throw std::runtime_error("We couldn't create the buffer of the staging ring");
+	}
+}
+
+StagingRing::~StagingRing() {
+	vmaDestroyBuffer(m_allocator, m_buffer.buffer, m_buffer.allocation);
+}
+
+auto StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment) noexcept -> StagingAllocation {
+
+	if (size == 0 || size > getMaxAllocationSize()) {
+		return {};
+	}
+
+	/*
+	An empty ring starts again from its beginning, so a range as big as it
+	can be allocated whatever the position of the head
+	*/
+	if (m_head == m_tail) {
+		m_head = m_tail = (m_head + m_capacity - 1) / m_capacity * m_capacity;
+	}
+
+	const auto head_offset = m_head % m_capacity;
+	auto offset = (head_offset + alignment - 1) & ~(alignment - 1);
+	if (offset + size > m_capacity) {
+		offset = 0;
+	}
+
+	/*
+	The bytes skipped before the offset are used too, until the range is released
+	*/
+	const auto end = m_head + (offset >= head_offset ? offset - head_offset : m_capacity - head_offset + offset) + size;
+	if (end - m_tail > m_capacity) {
+		return {};
+	}
+
+	m_head = end;
+	m_peak_usage = std::max(m_peak_usage, VkDeviceSize{ m_head - m_tail });
+
+	auto allocation = StagingAllocation{};
+	allocation.buffer = m_buffer.buffer;
+	allocation.offset = offset;
+	allocation.size = size;
+	[[gsl::suppress(type.1, bounds.1)]]{
+	allocation.data = static_cast<unsigned char*>(m_buffer.allocation_info.pMappedData) + offset;
+	}
+	return allocation;
+}
+
+auto StagingRing::release(uint64_t position) noexcept -> void {
+	m_tail = std::min(std::max(m_tail, position), m_head);
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+
+#include "RenderData.h"
+
+/*
+Persistent staging memory for the uploads.
+
+A single host visible buffer, created and mapped once, that the uploads take
+their staging memory from one after the other, wrapping around at the end.
+Instead of creating and destroying a buffer per upload, a range is taken from
+the head of the ring and released from its tail once the GPU is done copying
+from it, so the staging memory has a fixed upper bound and never goes
+through the allocator again.
+
+The positions are bytes since the creation of the ring, they only grow. The
+owner of the ranges (an UploadBatch, or a frame) remembers the head after its
+last range and releases up to it when its fence is signaled, the ranges are
+released in the order they were taken.
+
+An allocation that doesn't fit before the end of the ring starts again at
+its beginning, the bytes skipped are released with it. The ring never waits,
+a failed allocation is empty and its owner has to release some ranges
+(submitting and waiting for their fences) before trying again. Uploads bigger
+than getMaxAllocationSize() have to be split in chunks.
+*/
+
+/**
+Range of the staging ring, mapped. Empty (a null data) when the allocation
+failed.
+*/
+struct StagingAllocation {
+	VkBuffer buffer{};
+	VkDeviceSize offset{};		// From the start of the buffer
+	VkDeviceSize size{};
+	unsigned char* data{ nullptr };
+};
+
+class StagingRing {
+public:
+
+	/**
+	Creates and maps the buffer of the ring.
+
+	@param The allocator to create the buffer with
+	@param The bytes of the ring
+	@throws std::runtime_error if the buffer can't be created
+	*/
+	StagingRing(VmaAllocator allocator, VkDeviceSize capacity);
+
+	StagingRing(const StagingRing&) = delete;
+	StagingRing& operator=(const StagingRing&) = delete;
+	StagingRing(StagingRing&&) = delete;
+	StagingRing& operator=(StagingRing&&) = delete;
+
+	/**
+	Destroys the buffer, the GPU must be done with every range.
+	*/
+	~StagingRing();
+
+	/**
+	Takes a range from the head of the ring.
+
+	@param The bytes of the range, at most getMaxAllocationSize()
+	@param The alignment of its offset, a power of two
+	@return The range, empty if the ring doesn't have room for it until some ranges are released
+	*/
+	auto allocate(VkDeviceSize size, VkDeviceSize alignment) noexcept -> StagingAllocation;
+
+	/**
+	Releases every range taken before the position provided.
+
+	@param A position returned by getHead()
+	*/
+	auto release(uint64_t position) noexcept -> void;
+
+	/**
+	@return The position after the last range taken
+	*/
+	auto getHead() const noexcept -> uint64_t { return m_head; }
+
+	auto getCapacity() const noexcept -> VkDeviceSize { return m_capacity; }
+
+	/**
+	Half the ring, so a range can be filled while the previous one is copied
+	*/
+	auto getMaxAllocationSize() const noexcept -> VkDeviceSize { return m_capacity / 2; }
+
+	/**
+	@return The most bytes that have been in use at the same time
+	*/
+	auto getPeakUsage() const noexcept -> VkDeviceSize { return m_peak_usage; }
+
+private:
+
+	VmaAllocator m_allocator{};
+
+	AllocatedBuffer m_buffer{};
+
+	VkDeviceSize m_capacity{};
+
+	uint64_t m_head{};
+	uint64_t m_tail{};
+
+	VkDeviceSize m_peak_usage{};
+};
@@ -0,0 +1,338 @@
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <stdexcept>
+#include <cstring>
+#include <gsl/gsl>
+
+#include "MipGenerator.h"
+#include "TextureBatch.h"
+
+#pragma warning(push)
+#include <CppCoreCheck/Warnings.h>
+#pragma warning(disable: ALL_CPPCORECHECK_WARNINGS)
+#include <stb_image.h>
+#pragma warning(pop)
+
+namespace {
+
+	constexpr auto bytes_per_pixel = size_t{ 4 };
+	constexpr auto no_fit = std::numeric_limits<uint32_t>::max();
+
+	/**
+	Horizontal piece of the top edge of the rectangles placed so far. The
+	segments are sorted by x and cover the whole width of the atlas.
+	*/
+	struct SkylineSegment {
+		uint32_t x{};
+		uint32_t y{};
+		uint32_t width{};
+	};
+
+	auto alignUp(uint32_t value, uint32_t alignment) noexcept -> uint32_t {
+		return alignment <= 1 ? value : (value + alignment - 1) / alignment * alignment;
+	}
+
+	/**
+	@return The lowest y a rectangle of the width provided can be placed at
+	with its left edge on the segment provided, no_fit if it goes past the
+	right edge of the atlas.
+	*/
+	auto findSkylineY(
+		const std::vector<SkylineSegment>& skyline,
+		size_t segment,
+		uint32_t width,
+		uint32_t atlas_width) noexcept -> uint32_t {
+
+		[[gsl::suppress(bounds.4)]]{
+		if (skyline[segment].x + width > atlas_width) {
+			return no_fit;
+		}
+
+		auto y = uint32_t{ 0 };
+		auto remaining = width;
+		for (auto i = segment; remaining > 0 && i < skyline.size(); ++i) {
+			y = std::max(y, skyline[i].y);
+			remaining -= std::min(remaining, skyline[i].width);
+		}
+		return y;
+		}
+	}
+
+	/**
+	Places a rectangle on top of the skyline, the segments it covers are cut
+	and the neighbours at the same height merged.
+	*/
+	auto addSkylineLevel(
+		std::vector<SkylineSegment>& skyline,
+		size_t segment,
+		uint32_t x,
+		uint32_t y,
+		uint32_t width,
+		uint32_t height) -> void {
+
+		skyline.insert(skyline.begin() + segment, SkylineSegment{ x, y + height, width });
+
+		const auto right = x + width;
+		auto next = segment + 1;
+		[[gsl::suppress(bounds.4)]]{
+		while (next < skyline.size() && skyline[next].x < right) {
+			const auto overlap = right - skyline[next].x;
+			if (overlap >= skyline[next].width) {
+				skyline.erase(skyline.begin() + next);
+				continue;
+			}
+			skyline[next].x += overlap;
+			skyline[next].width -= overlap;
+			break;
+		}
+
+		for (auto i = size_t{ 0 }; i + 1 < skyline.size();) {
+			if (skyline[i].y == skyline[i + 1].y) {
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+			}
+			else {
+				++i;
+			}
+		}
+		}
+	}
+
+	/**
+	Packs the slots with the atlas width provided, writing the position of
+	every slot and the height the atlas needs.
+
+	@return false if a slot is wider than the atlas
+	*/
+	auto packSlots(
+		const std::vector<std::pair<uint32_t, uint32_t>>& slots,
+		const std::vector<size_t>& order,
+		uint32_t atlas_width,
+		std::vector<std::pair<uint32_t, uint32_t>>& positions,
+		uint32_t& atlas_height) -> bool {
+
+		auto skyline = std::vector<SkylineSegment>{ { 0, 0, atlas_width } };
+		positions.assign(slots.size(), {});
+		atlas_height = 0;
+
+		[[gsl::suppress(bounds.4)]]{
+		for (const auto index : order) {
+			const auto width = slots[index].first;
+			const auto height = slots[index].second;
+
+			/*
+			Bottom-left: the lowest top, then the leftmost position
+			*/
+			auto best_segment = skyline.size();
+			auto best_y = no_fit;
+			for (auto segment = size_t{ 0 }; segment < skyline.size(); ++segment) {
+				const auto y = findSkylineY(skyline, segment, width, atlas_width);
+				if (y < best_y) {
+					best_y = y;
+					best_segment = segment;
+				}
+			}
+
+			if (best_y == no_fit) {
+				return false;
+			}
+
+			const auto x = skyline[best_segment].x;
+			positions[index] = { x, best_y };
+			addSkylineLevel(skyline, best_segment, x, best_y, width, height);
+			atlas_height = std::max(atlas_height, best_y + height);
+		}
+		}
+
+		return true;
+	}
+}
+
+auto packSkyline(
+	const std::vector<std::pair<uint32_t, uint32_t>>& sizes,
+	uint32_t gutter,
+	uint32_t max_size) -> TextureAtlasLayout {
+
+	/*
+	Every slot holds a rectangle and its gutter on every side, aligned to the
+	gutter so the rectangles start on a texel of every safe mip level.
+	*/
+	auto slots = std::vector<std::pair<uint32_t, uint32_t>>{};
+	auto widest_slot = uint32_t{ 1 };
+	for (const auto& size : sizes) {
+		slots.emplace_back(alignUp(size.first + 2 * gutter, gutter), alignUp(size.second + 2 * gutter, gutter));
+		widest_slot = std::max(widest_slot, slots.back().first);
+	}
+
+	auto order = std::vector<size_t>(slots.size());
+	std::iota(order.begin(), order.end(), size_t{ 0 });
+	std::stable_sort(order.begin(), order.end(), [&slots](size_t a, size_t b) {
+		return slots[a].second != slots[b].second ?
+			slots[a].second > slots[b].second :
+			slots[a].first > slots[b].first;
+	});
+
+	auto layout = TextureAtlasLayout{};
+	auto best_positions = std::vector<std::pair<uint32_t, uint32_t>>{};
+	auto best_area = std::numeric_limits<uint64_t>::max();
+
+	auto positions = std::vector<std::pair<uint32_t, uint32_t>>{};
+	for (auto width = uint32_t{ 1 }; width <= max_size; width *= 2) {
+		auto height = uint32_t{ 0 };
+		if (width < widest_slot || !packSlots(slots, order, width, positions, height)) {
+			continue;
+		}
+
+		height = alignUp(std::max(height, uint32_t{ 1 }), gutter);
+		const auto area = uint64_t{ width } * height;
+		if (height <= max_size && area < best_area) {
+			best_area = area;
+			best_positions = positions;
+			layout.width = width;
+			layout.height = height;
+		}
+	}
+
+	if (best_area == std::numeric_limits<uint64_t>::max()) {
+		throw std::runtime_error("The textures don't fit in an atlas of " + std::to_string(max_size) + "x" + std::to_string(max_size));
+	}
+
+	layout.gutter = gutter;
+	layout.rects.reserve(sizes.size());
+	[[gsl::suppress(bounds.4)]]{
+	for (auto i = size_t{ 0 }; i < sizes.size(); ++i) {
+		layout.rects.push_back({
+			best_positions[i].first + gutter,
+			best_positions[i].second + gutter,
+			sizes[i].first,
+			sizes[i].second });
+	}
+	}
+
+	return layout;
+}
+
+auto readTextureSize(const std::string& path) noexcept -> std::pair<uint32_t, uint32_t> {
+
+	auto width = 0;
+	auto height = 0;
+	auto channels = 0;
+	if (!stbi_info(path.c_str(), &width, &height, &channels) || width <= 0 || height <= 0) {
+		return { 0, 0 };
+	}
+	return { gsl::narrow_cast<uint32_t>(width), gsl::narrow_cast<uint32_t>(height) };
+}
+
+auto packTextureAtlas(const std::vector<std::string>& paths, uint32_t gutter) -> TextureAtlasLayout {
+
+	auto sizes = std::vector<std::pair<uint32_t, uint32_t>>{};
+	for (const auto& path : paths) {
+		sizes.push_back(readTextureSize(path));
+		if (sizes.back().first == 0) {
+			throw std::runtime_error("We couldn't read the size of the texture [" + path + "]: " + stbi_failure_reason());
+		}
+	}
+
+	return packSkyline(sizes, gutter, config::texture_atlas_max_size);
+}
+
+auto getAtlasMipLevelCount(const TextureAtlasLayout& layout) noexcept -> uint32_t {
+
+	auto safe_levels = uint32_t{ 1 };
+	for (auto gutter = layout.gutter; gutter > 1; gutter /= 2) {
+		++safe_levels;
+	}
+	return std::min(safe_levels, getMipLevelCount(layout.width, layout.height));
+}
+
+auto remapToAtlas(std::vector<Vertex>& vertices, const TextureAtlasLayout& layout) noexcept -> void {
+
+	const auto atlas_size = glm::vec2(gsl::narrow_cast<float>(layout.width), gsl::narrow_cast<float>(layout.height));
+
+	for (auto& vertex : vertices) {
+		if (vertex.texture_layer >= layout.rects.size()) {
+			continue;
+		}
+
+		[[gsl::suppress(bounds.4)]]{
+		const auto& rect = layout.rects[vertex.texture_layer];
+		const auto offset = glm::vec2(gsl::narrow_cast<float>(rect.x), gsl::narrow_cast<float>(rect.y));
+		const auto size = glm::vec2(gsl::narrow_cast<float>(rect.width), gsl::narrow_cast<float>(rect.height));
+		vertex.tex_coord = (offset + glm::clamp(vertex.tex_coord, 0.0f, 1.0f) * size) / atlas_size;
+		}
+		vertex.texture_layer = 0;
+	}
+}
+
+auto decodeTextureAtlas(
+	const std::vector<std::string>& paths,
+	const TextureAtlasLayout& layout,
+	TextureCache* texture_cache,
+	bool mip_chain,
+	ThreadPool* thread_pool) -> TextureArray {
+
+	return buildTextureAtlas(decodeTextureBatch(paths, texture_cache, mip_chain, thread_pool), layout, mip_chain);
+}
+
+auto buildTextureAtlas(const TextureBatch& batch, const TextureAtlasLayout& layout, bool mip_chain) -> TextureArray {
+
+	auto pixels = std::vector<unsigned char>(size_t{ layout.width } * layout.height * bytes_per_pixel, 0);
+
+	/*
+	The whole slot of the texture is written, the gutter repeats the closest texel
+	*/
+	auto copyToSlot = [&pixels, &layout](const std::string& path, const AtlasRect& rect, const unsigned char* source, uint32_t width, uint32_t height) {
+		if (width != rect.width || height != rect.height) {
+			throw std::runtime_error("The texture [" + path + "] doesn't have the size it had when the atlas was packed");
+		}
+
+		const auto slot_x = rect.x - layout.gutter;
+		const auto slot_y = rect.y - layout.gutter;
+		const auto slot_right = std::min(layout.width, slot_x + alignUp(rect.width + 2 * layout.gutter, layout.gutter));
+		const auto slot_bottom = std::min(layout.height, slot_y + alignUp(rect.height + 2 * layout.gutter, layout.gutter));
+
+		[[gsl::suppress(bounds.1)]]{
+		for (auto y = slot_y; y < slot_bottom; ++y) {
+			const auto source_y = std::min(y < rect.y ? 0 : y - rect.y, rect.height - 1);
+			const auto source_row = source + size_t{ source_y } * rect.width * bytes_per_pixel;
+			auto destination = pixels.data() + (size_t{ y } * layout.width + slot_x) * bytes_per_pixel;
+
+			for (auto x = slot_x; x < rect.x; ++x, destination += bytes_per_pixel) {
+				memcpy(destination, source_row, bytes_per_pixel);
+			}
+			memcpy(destination, source_row, rect.width * bytes_per_pixel);
+			destination += rect.width * bytes_per_pixel;
+			for (auto x = rect.x + rect.width; x < slot_right; ++x, destination += bytes_per_pixel) {
+				memcpy(destination, source_row + (rect.width - 1) * bytes_per_pixel, bytes_per_pixel);
+			}
+		}
+		}
+	};
+
+	[[gsl::suppress(bounds.4)]]{
+	for (auto i = size_t{ 0 }; i < batch.textures.size() && i < layout.rects.size(); ++i) {
+		const auto& texture = batch.textures[i];
+		copyToSlot(batch.timings[i].path, layout.rects[i], texture.data(), texture.width, texture.height);
+	}
+	}
+
+	auto atlas = TextureArray{};
+	atlas.width = layout.width;
+	atlas.height = layout.height;
+	atlas.layer_count = 1;
+
+	if (mip_chain) {
+		auto chain = generateMipChain(pixels.data(), layout.width, layout.height, getAtlasMipLevelCount(layout));
+		atlas.pixels = std::move(chain.pixels);
+		atlas.levels = std::move(chain.levels);
+	}
+	else {
+		atlas.pixels = std::move(pixels);
+		atlas.levels = { MipLevel{ 0, layout.width, layout.height } };
+	}
+	atlas.layer_size = VkDeviceSize{ atlas.pixels.size() };
+
+	return atlas;
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "RenderData.h"
+#include "TextureCache.h"
+
+/*
+Automatic texture atlas.
+
+Instead of a texture array, the textures of the materials of a model can be
+packed into a single texture at load time, the same thing Tarzan_packed/ did
+by hand. The texture coordinates of the vertices are moved into the rectangle
+of their material in the atlas and their layer set to 0.
+
+The rectangles are placed with a skyline bottom-left packer: the top edge of
+the placed rectangles is kept as a list of horizontal segments and every new
+rectangle goes where its top ends lowest. The rectangles are placed from the
+tallest to the shortest, and several power of two widths are tried, keeping
+the one with the smallest area.
+
+Mip safe gutters: every texture is surrounded by a gutter that repeats its
+border texels, and the slots of the textures have their position and size
+aligned to the gutter. Halving the atlas halves the gutters too, so the
+levels down to the one where the gutter is 1 texel wide never mix two
+textures. The mip chain of the atlas stops there.
+
+The layout only depends on the size of the textures so it is rebuilt when
+the texture is created, and it always matches the texture coordinates the
+vertices got when the mesh was loaded (or cached).
+*/
+
+/**
+Position of a texture in the atlas, without its gutter
+*/
+struct AtlasRect {
+	uint32_t x{};
+	uint32_t y{};
+	uint32_t width{};
+	uint32_t height{};
+};
+
+struct TextureAtlasLayout {
+	uint32_t width{};
+	uint32_t height{};
+	uint32_t gutter{};
+	std::vector<AtlasRect> rects{};		// One per texture, in the order they were provided
+};
+
+/**
+Packs rectangles of the sizes provided into an atlas.
+
+@param Width and height of every rectangle
+@param Width of the gutter around every rectangle, a power of two
+@param The maximum width and height of the atlas
+@return The layout of the atlas
+@throws std::runtime_error if the rectangles don't fit in the maximum size
+*/
+auto packSkyline(
+	const std::vector<std::pair<uint32_t, uint32_t>>& sizes,
+	uint32_t gutter,
+	uint32_t max_size) -> TextureAtlasLayout;
+
+/**
+Reads the size of a texture from the header of its file.
+
+@param The path of the texture
+@return Width and height of the texture, 0 x 0 if it can't be read
+*/
+auto readTextureSize(const std::string& path) noexcept -> std::pair<uint32_t, uint32_t>;
+
+/**
+Packs the textures provided reading only their size from the headers of the files.
+
+@param The path of every texture
+@param Width of the gutter around every texture, a power of two
+@return The layout of the atlas
+@throws std::runtime_error if a texture can't be read or they don't fit
+*/
+auto packTextureAtlas(const std::vector<std::string>& paths, uint32_t gutter) -> TextureAtlasLayout;
+
+/**
+@param The layout of the atlas
+@return The amount of mip levels whose gutters keep the textures apart
+*/
+auto getAtlasMipLevelCount(const TextureAtlasLayout& layout) noexcept -> uint32_t;
+
+/**
+Moves the texture coordinates of every vertex into the rectangle of the
+texture of its layer and sets the layer to 0. Coordinates outside [0, 1] are
+clamped, an atlas can't repeat its textures.
+
+@param The vertices to remap
+@param The layout of the atlas, with a rectangle for every layer
+*/
+auto remapToAtlas(std::vector<Vertex>& vertices, const TextureAtlasLayout& layout) noexcept -> void;
+
+/**
+Decodes the textures, through the cache if there is one, and copies them
+into the atlas with their gutters. Then builds its mip chain.
+
+@param The path of every texture
+@param The layout of the atlas, built from the same textures
+@param The cache to decode the textures with, nullptr to decode them with stb_image
+@param If the mip chain has to be built or only the level 0
+@param The thread pool to decode the textures in parallel with, nullptr to decode them one after another
+@return The atlas as a texture array with a single layer
+@throws std::runtime_error if a texture can't be read or its size doesn't match the layout
+*/
+auto decodeTextureAtlas(
+	const std::vector<std::string>& paths,
+	const TextureAtlasLayout& layout,
+	TextureCache* texture_cache,
+	bool mip_chain,
+	ThreadPool* thread_pool = nullptr) -> TextureArray;
+
+/**
+Copies the textures of a batch into the atlas with their gutters, in the
+order of the batch. Then builds its mip chain.
+
+@param The decoded textures
+@param The layout of the atlas, built from the same textures
+@param If the mip chain has to be built or only the level 0
+@return The atlas as a texture array with a single layer
+@throws std::runtime_error if the size of a texture doesn't match the layout
+*/
+auto buildTextureAtlas(const TextureBatch& batch, const TextureAtlasLayout& layout, bool mip_chain) -> TextureArray;
@@ -0,0 +1,111 @@
+#include "TextureBatch.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <future>
+#include <algorithm>
+#include <gsl/gsl>
+
+namespace {
+
+	auto getMillisecondsSince(std::chrono::high_resolution_clock::time_point start) -> double {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	auto decodeTimed(
+		const std::string& path,
+		TextureCache* texture_cache,
+		bool mip_chain,
+		DecodedTexture& texture,
+		TextureTiming& timing) -> void {
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		texture = texture_cache ? texture_cache->decode(path, mip_chain) : decodeTexture(path, mip_chain);
+		timing.decode_milliseconds = getMillisecondsSince(start);
+
+		timing.width = texture.width;
+		timing.height = texture.height;
+		timing.cached = texture.isCached();
+	}
+}
+
+auto decodeTextureBatch(
+	const std::vector<std::string>& paths,
+	TextureCache* texture_cache,
+	bool mip_chain,
+	ThreadPool* thread_pool) -> TextureBatch {
+
+	auto batch = TextureBatch{};
+	batch.textures.resize(paths.size());
+	batch.timings.resize(paths.size());
+	batch.thread_count = thread_pool ? std::min(thread_pool->getThreadCount(), paths.size()) : 1;
+
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	[[gsl::suppress(bounds.4)]]{
+	for (auto i = size_t{ 0 }; i < paths.size(); ++i) {
+		batch.timings[i].path = paths[i];
+	}
+
+	if (!thread_pool || paths.size() <= 1) {
+		for (auto i = size_t{ 0 }; i < paths.size(); ++i) {
+			decodeTimed(paths[i], texture_cache, mip_chain, batch.textures[i], batch.timings[i]);
+		}
+	}
+	else {
+		/*
+		One task per texture so a big texture doesn't hold back a whole block
+		of small ones. Every task writes only its own slot of the batch.
+		*/
+		auto pending = std::vector<std::future<void>>{};
+		pending.reserve(paths.size());
+		for (auto i = size_t{ 0 }; i < paths.size(); ++i) {
+			pending.push_back(thread_pool->enqueue([&paths, &batch, texture_cache, mip_chain, i]() {
+				decodeTimed(paths[i], texture_cache, mip_chain, batch.textures[i], batch.timings[i]);
+			}));
+		}
+
+		/*
+		The tasks reference the batch so we wait for all of them before
+		rethrowing the first exception (if any).
+		*/
+		for (auto& texture : pending) {
+			texture.wait();
+		}
+		for (auto& texture : pending) {
+			texture.get();
+		}
+	}
+	}
+
+	batch.decode_milliseconds = getMillisecondsSince(start);
+	return batch;
+}
+
+auto printTextureBatchTimings(const TextureBatch& batch, double record_milliseconds) -> void {
+
+	auto decode_sum = 0.0;
+	auto upload_sum = 0.0;
+
+	std::cout << std::fixed << std::setprecision(2);
+	for (const auto& timing : batch.timings) {
+		std::cout << "\t[" << timing.path << "] " << timing.width << "x" << timing.height
+			<< (timing.cached ? " read from the texture cache in " : " decoded in ")
+			<< timing.decode_milliseconds << " ms, uploaded in " << timing.upload_milliseconds << " ms" << std::endl;
+		decode_sum += timing.decode_milliseconds;
+		upload_sum += timing.upload_milliseconds;
+	}
+
+	/*
+	The speedup is the time a single thread would have needed against the
+	time the batch took
+	*/
+	std::cout << "\t" << batch.timings.size() << " textures decoded in " << batch.decode_milliseconds
+		<< " ms with " << batch.thread_count << " threads (" << decode_sum << " ms of decoding, "
+		<< (batch.decode_milliseconds > 0.0 ? decode_sum / batch.decode_milliseconds : 1.0) << "x)" << std::endl;
+	std::cout << "\tUploads recorded in " << record_milliseconds << " ms";
+	if (upload_sum > 0.0) {
+		std::cout << " (" << upload_sum << " ms uploading the textures)";
+	}
+	std::cout << std::endl;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "TextureCache.h"
+#include "../utils/ThreadPool.h"
+
+/*
+Parallel decoding of a batch of textures.
+
+Decoding a texture (or reading it from the texture cache) and filtering its
+mip chain doesn't touch Vulkan, so the textures of a batch are decoded by the
+workers of a thread pool, one task per texture. The uploads are left to the
+thread that asked for the batch, the only one that records command buffers.
+
+Every texture keeps the time it took to decode it and the time its upload
+took to stage and record, written by whoever uploads it. Comparing the wall
+time of the whole decoding with the sum of the times of every texture shows
+how well the decoding scales with the cores.
+*/
+
+struct TextureTiming {
+	std::string path{};
+	uint32_t width{};
+	uint32_t height{};
+	bool cached{ false };			// Read from the texture cache instead of decoded
+	double decode_milliseconds{};
+	double upload_milliseconds{};	// Staging and recording of its copies, its share of them when it shares a layer
+};
+
+struct TextureBatch {
+	std::vector<DecodedTexture> textures{};		// In the order of the paths
+	std::vector<TextureTiming> timings{};		// One per texture
+	size_t thread_count{ 1 };
+	double decode_milliseconds{};				// Wall time of the decoding of the whole batch
+};
+
+/**
+Decodes the textures provided, in parallel when there is a thread pool.
+
+It must not be called from a task of the same pool, see ThreadPool::parallelFor.
+
+@param The path of every texture
+@param The cache to decode the textures with, nullptr to decode them with stb_image
+@param If the whole mip chain has to be built or only the level 0
+@param The thread pool to decode the textures with, nullptr to decode them in the calling thread
+@return The textures with their timings
+@throws std::runtime_error if a texture can't be read nor decoded, once every other texture is done
+*/
+auto decodeTextureBatch(
+	const std::vector<std::string>& paths,
+	TextureCache* texture_cache,
+	bool mip_chain,
+	ThreadPool* thread_pool) -> TextureBatch;
+
+/**
+Prints the timings of every texture of the batch and the totals.
+
+@param The batch
+@param Wall time of the staging and recording of the uploads of the whole batch
+*/
+auto printTextureBatchTimings(const TextureBatch& batch, double record_milliseconds) -> void;
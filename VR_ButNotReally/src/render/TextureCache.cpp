@@ -0,0 +1,396 @@
+#include "TextureCache.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <gsl/gsl>
+
+#include "TextureBatch.h"
+#include "../utils/Utils.h"
+
+#pragma warning(push)
+#include <CppCoreCheck/Warnings.h>
+#pragma warning(disable: ALL_CPPCORECHECK_WARNINGS)
+#include <stb_image.h>
+#pragma warning(pop)
+
+namespace {
+
+	constexpr auto texture_cache_alignment = uint64_t{ 64 };
+
+	auto alignOffset(uint64_t offset) noexcept -> uint64_t {
+		return (offset + texture_cache_alignment - 1) & ~(texture_cache_alignment - 1);
+	}
+
+	auto writePadding(std::ofstream& file, uint64_t offset) -> void {
+		const auto padding = std::vector<char>(gsl::narrow_cast<size_t>(alignOffset(offset) - offset), 0);
+		if (!padding.empty()) {
+			file.write(padding.data(), padding.size());
+		}
+	}
+
+	auto getTextureCachePath(const std::string& path) -> std::string {
+		return path + ".texcache";
+	}
+}
+
+auto DecodedTexture::data() const noexcept -> const unsigned char* {
+	if (m_cached_file.isOpen()) {
+		[[gsl::suppress(type.1, bounds.1)]]{
+		return reinterpret_cast<const unsigned char*>(m_cached_file.data() + m_cached_offset);
+		}
+	}
+	return m_pixels.data();
+}
+
+auto DecodedTexture::size() const noexcept -> size_t {
+	if (m_cached_file.isOpen()) {
+		return m_cached_file.size() - gsl::narrow_cast<size_t>(m_cached_offset);
+	}
+	return m_pixels.size();
+}
+
+auto makeTextureCacheKey(const MappedFile& source, bool mip_chain) noexcept -> TextureCacheKey {
+
+	/*
+	The filter of the mip chain is part of the version of the cache, if it
+	changes the version has to change too.
+	*/
+	const uint64_t options[] = { texture_cache_version, mip_chain ? 1u : 0u };
+
+	auto key = TextureCacheKey{};
+	key.source_hash = hashBytes(source.data(), source.size());
+	key.source_size = source.size();
+	key.options_hash = hashBytes(options, sizeof(options));
+	return key;
+}
+
+auto decodeTexture(const MappedFile& source, const std::string& path, bool mip_chain) -> DecodedTexture {
+
+	auto texture = DecodedTexture{};
+
+	auto texture_width = 0;
+	auto texture_height = 0;
+	auto texture_channels = 0;
+
+	[[gsl::suppress(type.1)]]{
+	auto pixels = stbi_load_from_memory(
+		reinterpret_cast<const stbi_uc*>(source.data()),
+		gsl::narrow<int>(source.size()),
+		&texture_width,
+		&texture_height,
+		&texture_channels,
+		STBI_rgb_alpha);
+
+	if (!pixels) {
+		throw std::runtime_error("We couldn't load the texture [" + path + "]: " + stbi_failure_reason());
+	}
+
+	texture.width = gsl::narrow_cast<uint32_t>(texture_width);
+	texture.height = gsl::narrow_cast<uint32_t>(texture_height);
+
+	try {
+		if (mip_chain) {
+			auto chain = generateMipChain(pixels, texture.width, texture.height, getMipLevelCount(texture.width, texture.height));
+			texture.m_pixels = std::move(chain.pixels);
+			texture.levels = std::move(chain.levels);
+		}
+		else {
+			[[gsl::suppress(bounds.1)]]{
+			texture.m_pixels.assign(pixels, pixels + size_t{ texture.width } * texture.height * 4);
+			}
+			texture.levels = { MipLevel{ 0, texture.width, texture.height } };
+		}
+	}
+	catch (...) {
+		stbi_image_free(pixels);
+		throw;
+	}
+	stbi_image_free(pixels);
+	}
+
+	return texture;
+}
+
+auto decodeTexture(const std::string& path, bool mip_chain) -> DecodedTexture {
+
+	auto source = MappedFile{};
+	if (!source.open(path)) {
+		throw std::runtime_error("We couldn't read the texture [" + path + "]");
+	}
+	return decodeTexture(source, path, mip_chain);
+}
+
+TextureCache::TextureCache(std::string index_path, uint64_t size_cap) :
+	m_index_path(std::move(index_path)),
+	m_size_cap(size_cap) {
+
+	/*
+	Every line of the index is "<last use> <size> <path of the cache file>"
+	*/
+	auto file = std::ifstream(m_index_path);
+	auto line = std::string{};
+	while (std::getline(file, line)) {
+		auto stream = std::istringstream{ line };
+		auto entry = Entry{};
+		if (stream >> entry.last_use >> entry.size && std::getline(stream >> std::ws, entry.path) && !entry.path.empty()) {
+			m_clock = std::max(m_clock, entry.last_use);
+			m_entries.push_back(std::move(entry));
+		}
+	}
+}
+
+auto TextureCache::decode(const std::string& path, bool mip_chain) -> DecodedTexture {
+
+	auto source = MappedFile{};
+	if (!source.open(path)) {
+		throw std::runtime_error("We couldn't read the texture [" + path + "]");
+	}
+
+	const auto key = makeTextureCacheKey(source, mip_chain);
+	const auto cache_path = getTextureCachePath(path);
+
+	auto texture = DecodedTexture{};
+	if (load(cache_path, key, texture)) {
+		auto lock = std::unique_lock<std::mutex>(m_mutex);
+		touch(cache_path, texture.m_cached_file.size());
+		saveIndex();
+		return texture;
+	}
+
+	texture = decodeTexture(source, path, mip_chain);
+
+	/*
+	A failed write only means the next launch decodes the texture again
+	*/
+	auto lock = std::unique_lock<std::mutex>(m_mutex);
+	if (write(cache_path, key, texture)) {
+		std::cout << "\tTexture cache written to [" << cache_path << "]" << std::endl;
+	}
+
+	return texture;
+}
+
+auto TextureCache::getSize() const -> uint64_t {
+
+	auto lock = std::unique_lock<std::mutex>(m_mutex);
+
+	auto size = uint64_t{ 0 };
+	for (const auto& entry : m_entries) {
+		size += entry.size;
+	}
+	return size;
+}
+
+auto TextureCache::load(const std::string& cache_path, const TextureCacheKey& key, DecodedTexture& texture) -> bool {
+
+	auto file = MappedFile{};
+	if (!file.open(cache_path) || file.size() < sizeof(TextureCacheHeader)) {
+		return false;
+	}
+
+	auto header = TextureCacheHeader{};
+	memcpy(&header, file.data(), sizeof(header));
+
+	if (header.magic != texture_cache_magic ||
+		header.version != texture_cache_version ||
+		header.key.source_hash != key.source_hash ||
+		header.key.source_size != key.source_size ||
+		header.key.options_hash != key.options_hash) {
+		std::cout << "\tThe texture cache [" << cache_path << "] is stale and will be rebuilt" << std::endl;
+		return false;
+	}
+
+	const auto levels_end = header.levels_offset + header.level_count * sizeof(MipLevel);
+
+	if (header.levels_offset < sizeof(TextureCacheHeader) ||
+		header.level_count == 0 ||
+		header.pixels_offset < levels_end ||
+		header.pixels_offset + header.pixels_size != file.size()) {
+		std::cout << "\tThe texture cache [" << cache_path << "] is corrupted and will be rebuilt" << std::endl;
+		return false;
+	}
+
+	texture.levels.resize(gsl::narrow<size_t>(header.level_count));
+	[[gsl::suppress(bounds.1)]]{
+	memcpy(texture.levels.data(), file.data() + header.levels_offset, texture.levels.size() * sizeof(MipLevel));
+	}
+
+	for (const auto& level : texture.levels) {
+		if (level.offset + uint64_t{ level.width } * level.height * 4 > header.pixels_size) {
+			std::cout << "\tThe texture cache [" << cache_path << "] is corrupted and will be rebuilt" << std::endl;
+			texture.levels.clear();
+			return false;
+		}
+	}
+
+	texture.width = header.width;
+	texture.height = header.height;
+	texture.m_cached_offset = header.pixels_offset;
+	texture.m_cached_file = std::move(file);
+
+	return true;
+}
+
+auto TextureCache::write(const std::string& cache_path, const TextureCacheKey& key, const DecodedTexture& texture) -> bool {
+
+	auto header = TextureCacheHeader{};
+	header.key = key;
+	header.width = texture.width;
+	header.height = texture.height;
+	header.level_count = texture.levels.size();
+	header.levels_offset = alignOffset(sizeof(TextureCacheHeader));
+	header.pixels_offset = alignOffset(header.levels_offset + header.level_count * sizeof(MipLevel));
+	header.pixels_size = texture.size();
+
+	const auto file_size = header.pixels_offset + header.pixels_size;
+	if (file_size > m_size_cap) {
+		return false;
+	}
+
+	const auto temporary_path = cache_path + ".tmp";
+	{
+		auto file = std::ofstream(temporary_path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		[[gsl::suppress(type.1)]]{
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		writePadding(file, sizeof(header));
+
+		file.write(
+			reinterpret_cast<const char*>(texture.levels.data()),
+			gsl::narrow<std::streamsize>(header.level_count * sizeof(MipLevel)));
+		writePadding(file, header.levels_offset + header.level_count * sizeof(MipLevel));
+
+		file.write(
+			reinterpret_cast<const char*>(texture.data()),
+			gsl::narrow<std::streamsize>(header.pixels_size));
+		}
+
+		if (!file.good()) {
+			return false;
+		}
+	}
+
+	std::remove(cache_path.c_str());
+	if (std::rename(temporary_path.c_str(), cache_path.c_str()) != 0) {
+		std::remove(temporary_path.c_str());
+		return false;
+	}
+
+	touch(cache_path, file_size);
+	evict(cache_path);
+	saveIndex();
+	return true;
+}
+
+auto TextureCache::touch(const std::string& cache_path, uint64_t size) -> void {
+
+	const auto entry = std::find_if(m_entries.begin(), m_entries.end(), [&cache_path](const Entry& entry) {
+		return entry.path == cache_path;
+	});
+
+	if (entry == m_entries.end()) {
+		m_entries.push_back({ cache_path, size, ++m_clock });
+	}
+	else {
+		entry->size = size;
+		entry->last_use = ++m_clock;
+	}
+}
+
+auto TextureCache::evict(const std::string& keep_path) -> void {
+
+	std::sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) {
+		return a.last_use < b.last_use;
+	});
+
+	auto size = uint64_t{ 0 };
+	for (const auto& entry : m_entries) {
+		size += entry.size;
+	}
+
+	auto entry = m_entries.begin();
+	while (size > m_size_cap && entry != m_entries.end()) {
+		if (entry->path == keep_path) {
+			++entry;
+			continue;
+		}
+
+		std::cout << "\tEvicting the texture cache [" << entry->path << "]" << std::endl;
+		std::remove(entry->path.c_str());
+		size -= entry->size;
+		entry = m_entries.erase(entry);
+	}
+}
+
+auto TextureCache::saveIndex() const -> void {
+
+	const auto temporary_path = m_index_path + ".tmp";
+	{
+		auto file = std::ofstream(temporary_path, std::ios::trunc);
+		if (!file.is_open()) {
+			return;
+		}
+
+		for (const auto& entry : m_entries) {
+			file << entry.last_use << " " << entry.size << " " << entry.path << "\n";
+		}
+
+		if (!file.good()) {
+			return;
+		}
+	}
+
+	std::remove(m_index_path.c_str());
+	if (std::rename(temporary_path.c_str(), m_index_path.c_str()) != 0) {
+		std::remove(temporary_path.c_str());
+	}
+}
+
+auto decodeTextureArray(
+	const std::vector<std::string>& paths,
+	TextureCache* texture_cache,
+	bool mip_chain,
+	ThreadPool* thread_pool) -> TextureArray {
+
+	return buildTextureArray(decodeTextureBatch(paths, texture_cache, mip_chain, thread_pool));
+}
+
+auto buildTextureArray(const TextureBatch& batch) -> TextureArray {
+
+	auto array = TextureArray{};
+	array.layer_count = gsl::narrow<uint32_t>(batch.textures.size());
+
+	[[gsl::suppress(bounds.4)]]{
+	for (auto layer = size_t{ 0 }; layer < batch.textures.size(); ++layer) {
+		const auto& texture = batch.textures[layer];
+		const auto& path = batch.timings[layer].path;
+
+		if (array.pixels.empty()) {
+			array.width = texture.width;
+			array.height = texture.height;
+			array.levels = texture.levels;
+			array.layer_size = texture.levels.back().offset + VkDeviceSize{ texture.levels.back().width } * texture.levels.back().height * 4;
+			array.pixels.reserve(gsl::narrow<size_t>(array.layer_size * batch.textures.size()));
+		}
+		else if (texture.width != array.width || texture.height != array.height || texture.levels.size() != array.levels.size()) {
+			throw std::runtime_error(
+				"The layers of a texture array must have the same size, [" + path + "] is " +
+				std::to_string(texture.width) + "x" + std::to_string(texture.height) + " and the first one " +
+				std::to_string(array.width) + "x" + std::to_string(array.height));
+		}
+
+		[[gsl::suppress(bounds.1)]]{
+		array.pixels.insert(array.pixels.end(), texture.data(), texture.data() + array.layer_size);
+		}
+	}
+	}
+
+	return array;
+}
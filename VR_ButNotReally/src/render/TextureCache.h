@@ -0,0 +1,228 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+#include "MipGenerator.h"
+#include "../utils/MappedFile.h"
+
+class ThreadPool;
+struct TextureBatch;
+
+/*
+Persistent cache of decoded textures.
+
+Decoding a .png or a .jpg and filtering its mip chain happens on every launch
+even though the result never changes, so the first time we load a texture we
+store its RGBA8 mip chain in a raw file next to it. The following launches map
+that file and copy the levels straight into the staging buffer, stb_image is
+not called at all.
+
+Layout of the file (all values little endian):
+
+	TextureCacheHeader
+	padding up to TextureCacheHeader::levels_offset
+	MipLevel[level_count]
+	padding up to TextureCacheHeader::pixels_offset
+	The pixels of every level, as described by its MipLevel
+
+The cache is only used when the hash of the source file and the load options
+(whether the mip chain is built) match the ones stored in the header.
+
+The cache files take as much space as the uncompressed textures, so their
+total size is capped. An index file keeps the size and the last use of every
+cache file and the least recently used ones are deleted when a new one does
+not fit.
+*/
+
+constexpr auto texture_cache_magic = uint32_t{ 0x43545256 }; // "VRTC"
+constexpr auto texture_cache_version = uint32_t{ 1 };
+
+/**
+Identifies the contents a texture cache was built from
+*/
+struct TextureCacheKey {
+	uint64_t source_hash{};
+	uint64_t source_size{};
+	uint64_t options_hash{};	// Hash of the load options, see makeTextureCacheKey
+};
+
+/**
+Header at the beginning of every texture cache file
+*/
+struct TextureCacheHeader {
+	uint32_t magic{ texture_cache_magic };
+	uint32_t version{ texture_cache_version };
+	TextureCacheKey key{};
+	uint32_t width{};
+	uint32_t height{};
+	uint64_t level_count{};
+	uint64_t levels_offset{};
+	uint64_t pixels_offset{};
+	uint64_t pixels_size{};
+};
+
+/**
+RGBA8 texture with its mip chain, either mapped from its cache file or decoded
+*/
+class DecodedTexture {
+public:
+	uint32_t width{};
+	uint32_t height{};
+	std::vector<MipLevel> levels{};		// Offsets relative to data()
+
+	/**
+	@return The pixels of every level
+	*/
+	auto data() const noexcept -> const unsigned char*;
+
+	/**
+	@return The bytes of every level
+	*/
+	auto size() const noexcept -> size_t;
+
+	/**
+	@return true if the pixels have been read from the cache
+	*/
+	auto isCached() const noexcept -> bool { return m_cached_file.isOpen(); }
+
+private:
+	friend class TextureCache;
+	friend auto decodeTexture(const MappedFile& source, const std::string& path, bool mip_chain) -> DecodedTexture;
+
+	MappedFile m_cached_file{};
+	uint64_t m_cached_offset{};
+	std::vector<unsigned char> m_pixels{};
+};
+
+/**
+@param The source file (.png, .jpg...) already mapped in memory
+@param If the whole mip chain is built or only the level 0
+@return The key for the texture cache of that source file
+*/
+auto makeTextureCacheKey(const MappedFile& source, bool mip_chain) noexcept -> TextureCacheKey;
+
+/**
+Decodes a texture with stb_image, without going through the cache.
+
+@param The source file (.png, .jpg...) already mapped in memory
+@param The path of the texture, for the errors
+@param If the whole mip chain has to be built or only the level 0
+@return The texture
+@throws std::runtime_error if the texture can't be decoded
+*/
+auto decodeTexture(const MappedFile& source, const std::string& path, bool mip_chain) -> DecodedTexture;
+
+/**
+Reads and decodes a texture with stb_image, without going through the cache.
+
+@param The path of the texture
+@param If the whole mip chain has to be built or only the level 0
+@return The texture
+@throws std::runtime_error if the texture can't be read nor decoded
+*/
+auto decodeTexture(const std::string& path, bool mip_chain) -> DecodedTexture;
+
+/**
+Decodes textures through the cache. It can be used from several threads at once.
+*/
+class TextureCache {
+public:
+
+	/**
+	Reads the index of the cache, an empty cache is started if it doesn't exist.
+
+	@param The path of the index file
+	@param The maximum amount of bytes of all the cache files together
+	*/
+	TextureCache(std::string index_path, uint64_t size_cap);
+
+	/**
+	Loads a texture from its cache file, or decodes it with stb_image and
+	writes its cache file when there is none (or it is stale).
+
+	@param The path of the texture
+	@param If the whole mip chain has to be built or only the level 0
+	@return The texture
+	@throws std::runtime_error if the texture can't be read nor decoded
+	*/
+	auto decode(const std::string& path, bool mip_chain) -> DecodedTexture;
+
+	/**
+	@return The bytes of all the cache files together
+	*/
+	auto getSize() const -> uint64_t;
+
+private:
+
+	struct Entry {
+		std::string path{};
+		uint64_t size{};
+		uint64_t last_use{};
+	};
+
+	auto load(const std::string& cache_path, const TextureCacheKey& key, DecodedTexture& texture) -> bool;
+
+	auto write(const std::string& cache_path, const TextureCacheKey& key, const DecodedTexture& texture) -> bool;
+
+	/**
+	Marks the cache file as just used, adding it to the index if it is not there
+	*/
+	auto touch(const std::string& cache_path, uint64_t size) -> void;
+
+	/**
+	Deletes the least recently used cache files until the total size fits the
+	cap, the one provided is never deleted.
+	*/
+	auto evict(const std::string& keep_path) -> void;
+
+	auto saveIndex() const -> void;
+
+
+	std::string m_index_path{};
+	uint64_t m_size_cap{};
+
+	mutable std::mutex m_mutex{};
+	std::vector<Entry> m_entries{};
+	uint64_t m_clock{ 0 };	// Incremented on every use, orders the entries by last use
+};
+
+/**
+RGBA8 texture array, the layers one after the other with the same mip chain
+*/
+struct TextureArray {
+	uint32_t width{};
+	uint32_t height{};
+	uint32_t layer_count{};
+	VkDeviceSize layer_size{};		// Bytes of the whole mip chain of one layer
+	std::vector<MipLevel> levels{};		// Offsets relative to the start of every layer
+	std::vector<unsigned char> pixels{};
+};
+
+/**
+Decodes the textures of the layers of a texture array, through the cache if
+there is one. All the textures must have the same size.
+
+@param The path of the texture of every layer
+@param The cache to decode the textures with, nullptr to decode them with stb_image
+@param If the whole mip chain has to be built or only the level 0
+@param The thread pool to decode the textures in parallel with, nullptr to decode them one after another
+@return The texture array
+@throws std::runtime_error if a texture can't be read nor decoded or their sizes don't match
+*/
+auto decodeTextureArray(
+	const std::vector<std::string>& paths,
+	TextureCache* texture_cache,
+	bool mip_chain,
+	ThreadPool* thread_pool = nullptr) -> TextureArray;
+
+/**
+Copies the textures of a batch into the layers of a texture array, in the
+order of the batch. All the textures must have the same size.
+
+@param The decoded textures
+@return The texture array
+@throws std::runtime_error if their sizes don't match
+*/
+auto buildTextureArray(const TextureBatch& batch) -> TextureArray;
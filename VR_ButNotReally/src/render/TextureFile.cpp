@@ -0,0 +1,301 @@
+#include "TextureFile.h"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <gsl/gsl>
+
+#include "../utils/MappedFile.h"
+
+namespace {
+
+	constexpr unsigned char ktx2_identifier[12] = {
+		0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+	};
+
+	/**
+	Identifier, header and index of a KTX2 file
+	*/
+	struct Ktx2Header {
+		unsigned char identifier[12]{};
+		uint32_t vk_format{};
+		uint32_t type_size{};
+		uint32_t pixel_width{};
+		uint32_t pixel_height{};
+		uint32_t pixel_depth{};
+		uint32_t layer_count{};
+		uint32_t face_count{};
+		uint32_t level_count{};
+		uint32_t supercompression_scheme{};
+		uint32_t dfd_byte_offset{};
+		uint32_t dfd_byte_length{};
+		uint32_t kvd_byte_offset{};
+		uint32_t kvd_byte_length{};
+		uint64_t sgd_byte_offset{};
+		uint64_t sgd_byte_length{};
+	};
+
+	static_assert(sizeof(Ktx2Header) == 80, "The KTX2 header must not have padding");
+
+	struct Ktx2LevelIndex {
+		uint64_t byte_offset{};
+		uint64_t byte_length{};
+		uint64_t uncompressed_byte_length{};
+	};
+
+	/*
+	Khronos data format descriptor values of the BC formats
+	*/
+	constexpr auto dfd_model_bc1a = uint32_t{ 128 };
+	constexpr auto dfd_model_bc3 = uint32_t{ 130 };
+	constexpr auto dfd_model_bc7 = uint32_t{ 134 };
+	constexpr auto dfd_channel_color = uint32_t{ 0 };
+	constexpr auto dfd_channel_bc1a_alpha_present = uint32_t{ 1 };
+	constexpr auto dfd_channel_bc3_alpha = uint32_t{ 15 };
+	constexpr auto dfd_sample_linear = uint32_t{ 0x10 };
+	constexpr auto dfd_primaries_bt709 = uint32_t{ 1 };
+	constexpr auto dfd_transfer_linear = uint32_t{ 1 };
+
+	auto alignOffset(uint64_t offset, uint64_t alignment) noexcept -> uint64_t {
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	auto makeDfdSample(uint32_t bit_offset, uint32_t bit_length, uint32_t channel) -> std::vector<uint32_t> {
+		return {
+			bit_offset | ((bit_length - 1) << 16) | (channel << 24),
+			0,				// Sample position
+			0,				// Lower value
+			0xFFFFFFFF		// Upper value
+		};
+	}
+
+	/**
+	Builds the data format descriptor of a BC format: its total size followed
+	by a basic descriptor block with one sample per compressed channel.
+	*/
+	auto makeDataFormatDescriptor(VkFormat format) -> std::vector<uint32_t> {
+
+		auto model = uint32_t{};
+		auto samples = std::vector<uint32_t>{};
+
+		switch (format) {
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK: {
+			model = dfd_model_bc1a;
+			samples = makeDfdSample(0, 64, dfd_channel_color);
+			break;
+		}
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK: {
+			model = dfd_model_bc1a;
+			samples = makeDfdSample(0, 64, dfd_channel_bc1a_alpha_present);
+			break;
+		}
+		case VK_FORMAT_BC3_UNORM_BLOCK: {
+			model = dfd_model_bc3;
+			samples = makeDfdSample(0, 64, dfd_channel_bc3_alpha | dfd_sample_linear);
+			const auto color = makeDfdSample(64, 64, dfd_channel_color);
+			samples.insert(samples.end(), color.begin(), color.end());
+			break;
+		}
+		default: {
+			model = dfd_model_bc7;
+			samples = makeDfdSample(0, 128, dfd_channel_color);
+			break;
+		}
+		}
+
+		const auto block_size = gsl::narrow_cast<uint32_t>(24 + samples.size() * sizeof(uint32_t));
+		const auto block_dimension = uint32_t{ 3 | (3 << 8) };	// 4x4x1x1, stored minus one
+
+		auto descriptor = std::vector<uint32_t>{
+			gsl::narrow_cast<uint32_t>(sizeof(uint32_t) + block_size),
+			0,											// Khronos vendor, basic descriptor type
+			2 | (block_size << 16),						// Version 2
+			model | (dfd_primaries_bt709 << 8) | (dfd_transfer_linear << 16),
+			block_dimension,
+			getBlockBytes(format),						// Bytes of the only plane
+			0
+		};
+		descriptor.insert(descriptor.end(), samples.begin(), samples.end());
+		return descriptor;
+	}
+}
+
+auto getBlockBytes(VkFormat format) noexcept -> uint32_t {
+	switch (format) {
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		return 8;
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+auto getCompressedLevelBytes(VkFormat format, uint32_t width, uint32_t height) noexcept -> uint64_t {
+	const auto blocks_x = uint64_t{ (width + 3) / 4 };
+	const auto blocks_y = uint64_t{ (height + 3) / 4 };
+	return blocks_x * blocks_y * getBlockBytes(format);
+}
+
+auto getCookedTexturePath(const std::string& path) -> std::string {
+
+	const auto extension = path.find_last_of('.');
+	const auto separator = path.find_last_of("/\\");
+
+	if (extension == std::string::npos || (separator != std::string::npos && extension < separator)) {
+		return path + ".ktx2";
+	}
+	return path.substr(0, extension) + ".ktx2";
+}
+
+auto readCookedTexture(const std::string& path) -> CookedTexture {
+
+	auto file = MappedFile{ path };
+
+	if (file.size() < sizeof(Ktx2Header)) {
+		throw std::runtime_error("The cooked texture [" + path + "] is too small");
+	}
+
+	auto header = Ktx2Header{};
+	memcpy(&header, file.data(), sizeof(header));
+
+	if (memcmp(header.identifier, ktx2_identifier, sizeof(ktx2_identifier)) != 0) {
+		throw std::runtime_error("The file [" + path + "] is not a KTX2 texture");
+	}
+
+	auto texture = CookedTexture{};
+	texture.format = static_cast<VkFormat>(header.vk_format);
+	texture.width = header.pixel_width;
+	texture.height = header.pixel_height;
+
+	if (getBlockBytes(texture.format) == 0 ||
+		header.pixel_depth > 1 ||
+		header.layer_count > 1 ||
+		header.face_count != 1 ||
+		header.level_count == 0 ||
+		header.supercompression_scheme != 0 ||
+		texture.width == 0 ||
+		texture.height == 0) {
+		throw std::runtime_error("The cooked texture [" + path + "] is not a 2D BC texture with its mip chain");
+	}
+
+	if (sizeof(Ktx2Header) + uint64_t{ header.level_count } * sizeof(Ktx2LevelIndex) > file.size()) {
+		throw std::runtime_error("The cooked texture [" + path + "] is corrupted");
+	}
+
+	auto level_indices = std::vector<Ktx2LevelIndex>(header.level_count);
+	[[gsl::suppress(bounds.1)]]{
+	memcpy(level_indices.data(), file.data() + sizeof(Ktx2Header), level_indices.size() * sizeof(Ktx2LevelIndex));
+	}
+
+	/*
+	We store the levels in the order they are uploaded, starting with the level 0
+	*/
+	auto total_bytes = uint64_t{ 0 };
+	for (auto level = uint32_t{ 0 }; level < header.level_count; ++level) {
+		const auto width = std::max(texture.width >> level, 1u);
+		const auto height = std::max(texture.height >> level, 1u);
+		const auto& index = level_indices[level];
+
+		if (index.byte_length != getCompressedLevelBytes(texture.format, width, height) ||
+			index.byte_offset + index.byte_length > file.size()) {
+			throw std::runtime_error("The cooked texture [" + path + "] is corrupted");
+		}
+
+		texture.levels.push_back({ total_bytes, width, height });
+		total_bytes += index.byte_length;
+	}
+
+	texture.data.resize(gsl::narrow<size_t>(total_bytes));
+	[[gsl::suppress(bounds.1)]]{
+	for (auto level = size_t{ 0 }; level < texture.levels.size(); ++level) {
+		memcpy(
+			texture.data.data() + texture.levels[level].offset,
+			file.data() + level_indices[level].byte_offset,
+			gsl::narrow_cast<size_t>(level_indices[level].byte_length));
+	}
+	}
+
+	return texture;
+}
+
+auto writeCookedTexture(const std::string& path, const CookedTexture& texture) -> bool {
+
+	const auto block_bytes = getBlockBytes(texture.format);
+	if (block_bytes == 0 || texture.levels.empty()) {
+		return false;
+	}
+
+	const auto descriptor = makeDataFormatDescriptor(texture.format);
+
+	auto header = Ktx2Header{};
+	memcpy(header.identifier, ktx2_identifier, sizeof(ktx2_identifier));
+	header.vk_format = gsl::narrow_cast<uint32_t>(texture.format);
+	header.type_size = 1;
+	header.pixel_width = texture.width;
+	header.pixel_height = texture.height;
+	header.face_count = 1;
+	header.level_count = gsl::narrow<uint32_t>(texture.levels.size());
+	header.dfd_byte_offset = gsl::narrow<uint32_t>(sizeof(Ktx2Header) + texture.levels.size() * sizeof(Ktx2LevelIndex));
+	header.dfd_byte_length = gsl::narrow<uint32_t>(descriptor.size() * sizeof(uint32_t));
+
+	/*
+	The smallest levels go first, so a reader that streams the file gets a
+	usable (blurry) texture as soon as possible.
+	*/
+	auto level_indices = std::vector<Ktx2LevelIndex>(texture.levels.size());
+	auto offset = uint64_t{ header.dfd_byte_offset } + header.dfd_byte_length;
+	for (auto level = texture.levels.size(); level-- > 0;) {
+		const auto& mip_level = texture.levels[level];
+		offset = alignOffset(offset, block_bytes);
+		level_indices[level].byte_offset = offset;
+		level_indices[level].byte_length = getCompressedLevelBytes(texture.format, mip_level.width, mip_level.height);
+		level_indices[level].uncompressed_byte_length = level_indices[level].byte_length;
+		offset += level_indices[level].byte_length;
+	}
+
+	const auto temporary_path = path + ".tmp";
+	{
+		auto file = std::ofstream(temporary_path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		[[gsl::suppress(type.1, bounds.1)]]{
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(
+			reinterpret_cast<const char*>(level_indices.data()),
+			gsl::narrow<std::streamsize>(level_indices.size() * sizeof(Ktx2LevelIndex)));
+		file.write(
+			reinterpret_cast<const char*>(descriptor.data()),
+			gsl::narrow<std::streamsize>(descriptor.size() * sizeof(uint32_t)));
+
+		auto written = uint64_t{ header.dfd_byte_offset } + header.dfd_byte_length;
+		for (auto level = texture.levels.size(); level-- > 0;) {
+			const auto padding = std::vector<char>(gsl::narrow_cast<size_t>(level_indices[level].byte_offset - written), 0);
+			file.write(padding.data(), gsl::narrow<std::streamsize>(padding.size()));
+
+			file.write(
+				reinterpret_cast<const char*>(texture.data.data() + texture.levels[level].offset),
+				gsl::narrow<std::streamsize>(level_indices[level].byte_length));
+			written = level_indices[level].byte_offset + level_indices[level].byte_length;
+		}
+		}
+
+		if (!file.good()) {
+			return false;
+		}
+	}
+
+	std::remove(path.c_str());
+	if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+		std::remove(temporary_path.c_str());
+		return false;
+	}
+
+	return true;
+}
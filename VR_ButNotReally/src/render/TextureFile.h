@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+#include "MipGenerator.h"
+
+/*
+Cooked textures.
+
+The TextureCooker tool compresses the textures offline in BC1, BC3 or BC7
+blocks with the whole mip chain already built, so loading them is a copy of
+the file into a staging buffer with no decoding and no filtering, and they take
+4 (BC3, BC7) or 8 (BC1) times less memory than RGBA8 on the GPU.
+
+The files follow the KTX2 layout (identifier, header, index, level index and a
+basic data format descriptor) without supercompression nor key/value data:
+
+	Ktx2Header
+	Ktx2LevelIndex[level_count], starting with the level 0
+	Data format descriptor
+	Level data, starting with the smallest level, every level aligned to the block size
+
+The cooked version of a texture is stored next to it with the .ktx2 extension
+and is used instead of it when the device supports BC textures.
+*/
+
+/**
+Texture read from (or to be written to) a cooked file
+*/
+struct CookedTexture {
+	VkFormat format{ VK_FORMAT_UNDEFINED };
+	uint32_t width{};
+	uint32_t height{};
+	std::vector<unsigned char> data{};		// Every level right after the previous one, starting with the level 0
+	std::vector<MipLevel> levels{};
+};
+
+/**
+@param The format of the texture
+@return The bytes of every 4x4 block of the format, 0 if the format is not a supported BC format
+*/
+auto getBlockBytes(VkFormat format) noexcept -> uint32_t;
+
+/**
+@param The format of the level, a supported BC format
+@param Width of the level
+@param Height of the level
+@return The bytes of the compressed level, partial blocks included
+*/
+auto getCompressedLevelBytes(VkFormat format, uint32_t width, uint32_t height) noexcept -> uint64_t;
+
+/**
+@param The path of the source texture (.png, .jpg...)
+@return The path of its cooked version, the same one with the .ktx2 extension
+*/
+auto getCookedTexturePath(const std::string& path) -> std::string;
+
+/**
+Reads a cooked texture, with every level in memory.
+
+@param The path of the .ktx2 file
+@return The texture
+@throws std::runtime_error if the file can't be read or is not a texture we can load
+*/
+auto readCookedTexture(const std::string& path) -> CookedTexture;
+
+/**
+Writes a cooked texture into a .ktx2 file.
+
+@param The path of the .ktx2 file
+@param The texture, with every level of its mip chain
+@return true if the file has been written, false otherwise
+*/
+auto writeCookedTexture(const std::string& path, const CookedTexture& texture) -> bool;
@@ -0,0 +1,89 @@
+#include "UploadBatch.h"
+#include <stdexcept>
+
+UploadBatch::UploadBatch(const UploadBatchContext& context) :
+	m_context(context),
+	m_command_buffer(context.command_buffers->begin()) {
+}
+
+UploadBatch::~UploadBatch() {
+
+	/*
+	A batch that was never submitted has nothing in flight
+	*/
+	if (m_ticket == 0) {
+		m_context.command_buffers->discard(m_command_buffer);
+	}
+	else {
+		wait();
+	}
+	releaseStagingMemory();
+}
+
+auto UploadBatch::beginOperation() noexcept -> VkCommandBuffer {
+	++m_operation_count;
+	return m_command_buffer;
+}
+
+auto UploadBatch::stage(VkDeviceSize size, VkDeviceSize alignment) noexcept -> StagingAllocation {
+
+	const auto allocation = m_context.staging_ring->allocate(size, alignment);
+	if (allocation.data != nullptr) {
+		m_staging_end = m_context.staging_ring->getHead();
+		m_staging_size += size;
+	}
+	return allocation;
+}
+
+auto UploadBatch::submit() -> void {
+
+	if (m_ticket != 0) {
+		throw std::runtime_error("We can't submit an upload batch twice");
+	}
+
+	/*
+	The copies and blits write through the transfer stage, whatever reads
+	the resources next in this queue waits for them
+	*/
+	auto barrier = VkMemoryBarrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+	vkCmdPipelineBarrier(
+		m_command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+		0,
+		1, &barrier,
+		0, nullptr,
+		0, nullptr);
+
+	m_ticket = m_context.command_buffers->submit(m_command_buffer);
+}
+
+auto UploadBatch::isComplete() noexcept -> bool {
+
+	if (m_ticket == 0 || !m_context.command_buffers->isComplete(m_ticket)) {
+		return false;
+	}
+	releaseStagingMemory();
+	return true;
+}
+
+auto UploadBatch::wait() noexcept -> void {
+
+	if (m_ticket == 0) {
+		return;
+	}
+	m_context.command_buffers->wait(m_ticket);
+	releaseStagingMemory();
+}
+
+auto UploadBatch::releaseStagingMemory() noexcept -> void {
+
+	if (m_staging_end > 0) {
+		m_context.staging_ring->release(m_staging_end);
+		m_staging_end = 0;
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "RenderData.h"
+#include "StagingRing.h"
+#include "CommandBufferPool.h"
+
+/*
+Uploads recorded together and submitted once.
+
+Every texture used to take three single time command buffers (the layout
+transition to the transfer destination, the copy and the transition to be
+sampled) and every buffer of the scene another one, each of them allocated,
+submitted and waited for with vkQueueWaitIdle. An UploadBatch records all
+those commands into a single command buffer of a CommandBufferPool instead
+and submits it once, without waiting for it.
+
+The commands read from ranges of the staging ring taken through the batch,
+which releases them once its submission has been executed (polled with
+isComplete(), or waited for in the destructor). When the ring is full the owner of the batch
+submits it and waits for the oldest batch in flight before staging more.
+
+submit() ends the batch with a memory barrier from the transfers to every
+later command of the queue, so the submissions that come after it in the same
+queue can use the uploaded resources right away. The queue must support
+graphics: the layout transitions wait for the fragment shader and the mip
+chains are blitted.
+*/
+
+/**
+Vulkan objects the batch works with, owned by the renderer
+*/
+struct UploadBatchContext {
+	CommandBufferPool* command_buffers{ nullptr };	// Of a graphics queue
+	StagingRing* staging_ring{ nullptr };
+};
+
+class UploadBatch {
+public:
+
+	/**
+	Takes the command buffer of the batch from the pool and starts recording.
+
+	@param The Vulkan objects to record and submit with
+	*/
+	explicit UploadBatch(const UploadBatchContext& context);
+
+	UploadBatch(const UploadBatch&) = delete;
+	UploadBatch& operator=(const UploadBatch&) = delete;
+	UploadBatch(UploadBatch&&) = delete;
+	UploadBatch& operator=(UploadBatch&&) = delete;
+
+	/**
+	Waits for the batch if it was submitted, releases its staging memory and
+	gives back the command buffer if it wasn't.
+	*/
+	~UploadBatch();
+
+	/**
+	Starts an operation of the batch, a copy or a layout transition.
+
+	@return The command buffer to record the operation into, until submit()
+	*/
+	auto beginOperation() noexcept -> VkCommandBuffer;
+
+	/**
+	Takes staging memory from the ring for the commands of the batch, it is
+	released once the batch is complete.
+
+	@param The bytes to stage, at most the max allocation size of the ring
+	@param The alignment of the offset, a power of two
+	@return The range, empty if the ring is full
+	*/
+	auto stage(VkDeviceSize size, VkDeviceSize alignment) noexcept -> StagingAllocation;
+
+	/**
+	Ends the command buffer with the barrier for the later commands of the
+	queue and submits it. It doesn't wait.
+
+	@throws std::runtime_error if it can't be submitted
+	*/
+	auto submit() -> void;
+
+	/**
+	Checks whether a submitted batch has been executed and releases its
+	staging memory the first time it has.
+
+	@return true if the batch has been executed
+	*/
+	auto isComplete() noexcept -> bool;
+
+	/**
+	Waits until the submitted batch has been executed and releases its
+	staging memory.
+	*/
+	auto wait() noexcept -> void;
+
+	auto getOperationCount() const noexcept -> size_t { return m_operation_count; }
+
+	/**
+	@return The ticket of the submission in the pool, 0 before submit()
+	*/
+	auto getTicket() const noexcept -> uint64_t { return m_ticket; }
+
+	/**
+	@return The bytes staged, also after they are released
+	*/
+	auto getStagingSize() const noexcept -> VkDeviceSize { return m_staging_size; }
+
+private:
+
+	auto releaseStagingMemory() noexcept -> void;
+
+
+	UploadBatchContext m_context{};
+
+	VkCommandBuffer m_command_buffer{};
+
+	uint64_t m_ticket{};
+
+	/*
+	Position of the ring after the last range of the batch, 0 when it staged nothing
+	*/
+	uint64_t m_staging_end{};
+
+	size_t m_operation_count{};
+
+	VkDeviceSize m_staging_size{};
+};
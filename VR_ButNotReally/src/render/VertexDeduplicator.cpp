@@ -0,0 +1,280 @@
+#include "VertexDeduplicator.h"
+#include <algorithm>
+#include <future>
+
+namespace {
+
+	/*
+	The table grows when it is more than 3/4 full, linear probing
+	gets slow quickly after that.
+	*/
+	constexpr auto max_load_numerator = size_t{ 3 };
+	constexpr auto max_load_denominator = size_t{ 4 };
+	constexpr auto min_capacity = size_t{ 16 };
+
+	/*
+	In the parallel mode the shapes bigger than this are split in several
+	ranges so a model made of a single big shape still uses every worker.
+	*/
+	constexpr auto min_range_corners = size_t{ 4096 };
+
+	/**
+	Contiguous range of corners of one shape deduplicated by one task
+	*/
+	struct CornerRange {
+		size_t shape{};
+		size_t begin{};
+		size_t end{};
+		size_t offset{};	// Position of the first corner in the final index buffer
+		std::vector<Vertex> vertices{};
+		std::vector<uint32_t> remap{};
+		DeduplicationStatistics statistics{};
+	};
+
+	auto addStatistics(DeduplicationStatistics& total, const DeduplicationStatistics& other) noexcept -> void {
+		total.probes += other.probes;
+		total.collisions += other.collisions;
+		total.longest_probe = std::max(total.longest_probe, other.longest_probe);
+		total.capacity += other.capacity;
+	}
+
+	/**
+	Texture layer of the material of the triangle a corner belongs to, 0 when
+	the triangle has no material or its material has no layer.
+	*/
+	auto getCornerLayer(const ObjShape& shape, size_t corner, const std::vector<uint32_t>& material_layers) noexcept -> uint32_t {
+		const auto triangle = corner / 3;
+		if (triangle >= shape.material_ids.size()) {
+			return 0;
+		}
+		[[gsl::suppress(bounds.4)]]{
+		const auto material = shape.material_ids[triangle];
+		if (material < 0 || gsl::narrow_cast<size_t>(material) >= material_layers.size()) {
+			return 0;
+		}
+		return material_layers[material];
+		}
+	}
+}
+
+VertexDeduplicator::VertexDeduplicator(size_t expected_vertices) {
+
+	auto capacity = min_capacity;
+	while (capacity * max_load_numerator / max_load_denominator < expected_vertices) {
+		capacity *= 2;
+	}
+
+	m_slots.resize(capacity);
+	m_mask = capacity - 1;
+	m_max_vertices = capacity * max_load_numerator / max_load_denominator;
+	m_statistics.capacity = capacity;
+}
+
+auto VertexDeduplicator::insert(const Vertex& vertex) -> uint32_t {
+
+	if (m_vertices.size() >= m_max_vertices) {
+		grow();
+	}
+
+	const auto hash = hashVertex(vertex);
+	const auto tag = static_cast<uint32_t>(hash >> 32);
+	auto position = static_cast<size_t>(hash) & m_mask;
+	auto probes = size_t{ 1 };
+
+	[[gsl::suppress(bounds.4)]]{
+	while (true) {
+		auto& slot = m_slots[position];
+
+		if (slot.index == empty_slot) {
+			slot.hash = tag;
+			slot.index = gsl::narrow<uint32_t>(m_vertices.size());
+			m_vertices.push_back(vertex);
+			++m_statistics.unique_vertices;
+			break;
+		}
+
+		if (slot.hash == tag && m_vertices[slot.index] == vertex) {
+			break;
+		}
+
+		++m_statistics.collisions;
+		++probes;
+		position = (position + 1) & m_mask;
+	}
+
+	++m_statistics.corners;
+	m_statistics.probes += probes;
+	m_statistics.longest_probe = std::max(m_statistics.longest_probe, probes);
+
+	return m_slots[position].index;
+	}
+}
+
+auto VertexDeduplicator::grow() -> void {
+
+	const auto capacity = m_slots.size() * 2;
+
+	m_slots.assign(capacity, Slot{});
+	m_mask = capacity - 1;
+	m_max_vertices = capacity * max_load_numerator / max_load_denominator;
+	m_statistics.capacity = capacity;
+
+	/*
+	Every vertex is unique so we only need to find an empty slot for it
+	*/
+	[[gsl::suppress(bounds.4)]]{
+	for (auto i = size_t{ 0 }; i < m_vertices.size(); ++i) {
+		const auto hash = hashVertex(m_vertices[i]);
+		auto position = static_cast<size_t>(hash) & m_mask;
+
+		while (m_slots[position].index != empty_slot) {
+			position = (position + 1) & m_mask;
+		}
+
+		m_slots[position].hash = static_cast<uint32_t>(hash >> 32);
+		m_slots[position].index = gsl::narrow<uint32_t>(i);
+	}
+	}
+}
+
+auto makeVertex(const ObjAttributes& attributes, const ObjIndex& index, uint32_t texture_layer) noexcept -> Vertex {
+
+	auto vertex = Vertex{};
+	vertex.texture_layer = texture_layer;
+
+	[[gsl::suppress(bounds.4)]]{
+	vertex.pos = {
+		attributes.vertices[3 * index.vertex_index + 0],
+		attributes.vertices[3 * index.vertex_index + 1],
+		attributes.vertices[3 * index.vertex_index + 2]
+	};
+
+	vertex.tex_coord = {
+		attributes.texcoords[2 * index.texcoord_index + 0],
+		1.0f - attributes.texcoords[2 * index.texcoord_index + 1]
+	};
+	}
+
+	return vertex;
+}
+
+auto deduplicateVertices(
+	const ObjModel& model,
+	ThreadPool* thread_pool,
+	const std::vector<uint32_t>& material_layers) -> DeduplicatedMesh {
+
+	auto mesh = DeduplicatedMesh{};
+
+	auto corner_count = size_t{ 0 };
+	for (const auto& shape : model.shapes) {
+		corner_count += shape.indices.size();
+	}
+	mesh.indices.resize(corner_count);
+
+	/*
+	Serial mode, one table for the whole model
+	*/
+	if (thread_pool == nullptr || thread_pool->getThreadCount() <= 1) {
+		auto deduplicator = VertexDeduplicator(corner_count);
+		auto next_index = mesh.indices.begin();
+
+		for (const auto& shape : model.shapes) {
+			for (auto corner = size_t{ 0 }; corner < shape.indices.size(); ++corner) {
+				*next_index++ = deduplicator.insert(makeVertex(
+					model.attributes,
+					shape.indices[corner],
+					getCornerLayer(shape, corner, material_layers)));
+			}
+		}
+
+		mesh.statistics = deduplicator.getStatistics();
+		mesh.vertices = deduplicator.takeVertices();
+		return mesh;
+	}
+
+	/*
+	Parallel mode. Every range writes the local indices of its vertices in its
+	part of the index buffer and keeps its unique vertices.
+	*/
+	const auto range_size = std::max(min_range_corners, corner_count / (thread_pool->getThreadCount() * 2) + 1);
+	auto ranges = std::vector<CornerRange>{};
+	auto offset = size_t{ 0 };
+
+	for (auto shape = size_t{ 0 }; shape < model.shapes.size(); ++shape) {
+		const auto shape_corners = model.shapes[shape].indices.size();
+		for (auto begin = size_t{ 0 }; begin < shape_corners; begin += range_size) {
+			auto range = CornerRange{};
+			range.shape = shape;
+			range.begin = begin;
+			range.end = std::min(begin + range_size, shape_corners);
+			range.offset = offset;
+			offset += range.end - range.begin;
+			ranges.push_back(std::move(range));
+		}
+	}
+
+	auto pending = std::vector<std::future<void>>{};
+	pending.reserve(ranges.size());
+
+	for (auto& range : ranges) {
+		pending.push_back(thread_pool->enqueue([&model, &mesh, &range, &material_layers]() {
+			const auto& shape = model.shapes[range.shape];
+			auto deduplicator = VertexDeduplicator(range.end - range.begin);
+
+			for (auto i = range.begin; i < range.end; ++i) {
+				mesh.indices[range.offset + i - range.begin] = deduplicator.insert(makeVertex(
+					model.attributes,
+					shape.indices[i],
+					getCornerLayer(shape, i, material_layers)));
+			}
+
+			range.statistics = deduplicator.getStatistics();
+			range.vertices = deduplicator.takeVertices();
+		}));
+	}
+
+	for (auto& range : pending) {
+		range.wait();
+	}
+	for (auto& range : pending) {
+		range.get();
+	}
+
+	/*
+	Merge the unique vertices of every range in order, so the vertices are
+	numbered in the same order as in the serial mode.
+	*/
+	auto local_vertex_count = size_t{ 0 };
+	for (const auto& range : ranges) {
+		local_vertex_count += range.vertices.size();
+	}
+
+	auto deduplicator = VertexDeduplicator(local_vertex_count);
+	for (auto& range : ranges) {
+		range.remap.reserve(range.vertices.size());
+		for (const auto& vertex : range.vertices) {
+			range.remap.push_back(deduplicator.insert(vertex));
+		}
+		range.vertices = std::vector<Vertex>{};
+	}
+
+	thread_pool->parallelFor(ranges.size(), [&mesh, &ranges](size_t begin, size_t end) {
+		for (auto i = begin; i < end; ++i) {
+			const auto& range = ranges[i];
+			const auto first = mesh.indices.begin() + range.offset;
+			std::transform(first, first + (range.end - range.begin), first,
+				[&range](uint32_t index) { return range.remap[index]; });
+		}
+	});
+
+	mesh.statistics = DeduplicationStatistics{};
+	mesh.statistics.corners = corner_count;
+	mesh.statistics.unique_vertices = deduplicator.getStatistics().unique_vertices;
+	addStatistics(mesh.statistics, deduplicator.getStatistics());
+	for (const auto& range : ranges) {
+		addStatistics(mesh.statistics, range.statistics);
+	}
+
+	mesh.vertices = deduplicator.takeVertices();
+	return mesh;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "RenderData.h"
+#include "ObjParser.h"
+#include "../utils/ThreadPool.h"
+
+/*
+Vertex deduplication.
+
+Every corner of every face of a model becomes a Vertex and equal vertices must
+share the same index. Instead of a node based std::unordered_map we use a flat
+open addressing table with linear probing that stores, for every slot, part of
+the hash and the index of the vertex. Finding or inserting a vertex is a single
+probe sequence and the full vertex is only compared when the stored part of
+the hash matches.
+*/
+
+/**
+Information about how the deduplication table behaved
+*/
+struct DeduplicationStatistics {
+	size_t corners{};			// Vertices inserted
+	size_t unique_vertices{};	// Vertices that were not already in the table
+	size_t probes{};			// Slots inspected
+	size_t collisions{};		// Slots inspected that held a different vertex
+	size_t longest_probe{};		// Most slots inspected for one insertion
+	size_t capacity{};			// Slots of the table (summed for every table used)
+};
+
+/**
+Vertices and indices of a deduplicated mesh
+*/
+struct DeduplicatedMesh {
+	std::vector<Vertex> vertices{};
+	std::vector<uint32_t> indices{};
+	DeduplicationStatistics statistics{};
+};
+
+class VertexDeduplicator {
+public:
+
+	/**
+	Creates the table with room for the amount of vertices provided without
+	growing. Usually that is the amount of corners we are going to insert.
+
+	@param The maximum amount of unique vertices we expect
+	*/
+	explicit VertexDeduplicator(size_t expected_vertices);
+
+	/**
+	Finds the vertex in the table or adds it if it is not there yet.
+
+	@param The vertex to insert
+	@return The index of the vertex in getVertices()
+	*/
+	auto insert(const Vertex& vertex) -> uint32_t;
+
+	auto getVertices() const noexcept -> const std::vector<Vertex>& { return m_vertices; }
+
+	/**
+	Moves the unique vertices out of the deduplicator, it should not be used afterwards.
+	*/
+	auto takeVertices() noexcept -> std::vector<Vertex> { return std::move(m_vertices); }
+
+	auto getStatistics() const noexcept -> const DeduplicationStatistics& { return m_statistics; }
+
+private:
+
+	static constexpr auto empty_slot = UINT32_MAX;
+
+	/*
+	Upper 32 bits of the hash of the vertex and its index
+	*/
+	struct Slot {
+		uint32_t hash{};
+		uint32_t index{ empty_slot };
+	};
+
+	auto grow() -> void;
+
+	std::vector<Slot> m_slots{};
+	size_t m_mask{};
+	size_t m_max_vertices{};
+	std::vector<Vertex> m_vertices{};
+	DeduplicationStatistics m_statistics{};
+};
+
+/**
+Builds the vertex of one corner of an .obj face, flipping the
+v texture coordinate to Vulkan's convention.
+
+@param The attributes of the model
+@param The indices of the corner
+@param The texture layer of the material of the corner
+@return The vertex of that corner
+*/
+auto makeVertex(const ObjAttributes& attributes, const ObjIndex& index, uint32_t texture_layer = 0) noexcept -> Vertex;
+
+/**
+Creates the vertex and index buffers of the model deduplicating its vertices.
+
+When a thread pool is provided every shape is deduplicated on its own in
+parallel and the unique vertices of every shape are merged afterwards. The
+result is exactly the same as the serial one, vertices are numbered in the
+order in which they first appear.
+
+@param The parsed .obj model
+@param The thread pool for the parallel mode, nullptr for the serial one
+@param The texture layer of every material of the model, the vertices of
+triangles without a material (or past the end of the vector) use the layer 0
+@return The unique vertices, the indices and the statistics of the tables
+*/
+auto deduplicateVertices(
+	const ObjModel& model,
+	ThreadPool* thread_pool,
+	const std::vector<uint32_t>& material_layers = {}) -> DeduplicatedMesh;
@@ -3,7 +3,7 @@ echo Compiling and embedding shaders...
 
 
 @echo off
-	set types=vert tesc tese geom frag conf
+	set types=vert tesc tese geom frag comp
 	(for %%t in (%types%) do (  
 		for /R "./" %%f in (*.%%t) do (
 
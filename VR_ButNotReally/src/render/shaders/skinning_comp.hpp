@@ -0,0 +1,194 @@
+std::array<wchar_t, 1912> skinning_comp = {
+0x302, 0x2307, 0x00, 0x100, 0x00, 0x00, 0x9900, 0x00, 0x00, 0x00, 
+0x1100, 0x200, 0x100, 0x00, 0xe00, 0x300, 0x00, 0x00, 0x100, 0x00, 
+0xf00, 0x600, 0x500, 0x00, 0x100, 0x00, 0x6d61, 0x696e, 0x00, 0x00, 
+0x200, 0x00, 0x1000, 0x600, 0x100, 0x00, 0x1100, 0x00, 0x4000, 0x00, 
+0x100, 0x00, 0x100, 0x00, 0x300, 0x300, 0x200, 0x00, 0xc201, 0x00, 
+0x500, 0x400, 0x100, 0x00, 0x6d61, 0x696e, 0x00, 0x00, 0x500, 0x800, 
+0x200, 0x00, 0x676c, 0x5f47, 0x6c6f, 0x6261, 0x6c49, 0x6e76, 0x6f63, 0x6174, 
+0x696f, 0x6e49, 0x4400, 0x00, 0x500, 0x700, 0xd00, 0x00, 0x5265, 0x6665, 
+0x7265, 0x6e63, 0x6556, 0x6572, 0x7469, 0x6365, 0x7300, 0x00, 0x600, 0x800, 
+0xd00, 0x00, 0x00, 0x00, 0x7265, 0x6665, 0x7265, 0x6e63, 0x655f, 0x7665, 
+0x7274, 0x6963, 0x6573, 0x00, 0x500, 0x500, 0xe00, 0x00, 0x536b, 0x696e, 
+0x5765, 0x6967, 0x6874, 0x7300, 0x600, 0x700, 0xe00, 0x00, 0x00, 0x00, 
+0x736b, 0x696e, 0x5f77, 0x6569, 0x6768, 0x7473, 0x00, 0x00, 0x500, 0x600, 
+0xf00, 0x00, 0x536b, 0x696e, 0x6e69, 0x6e67, 0x5061, 0x6c65, 0x7474, 0x6500, 
+0x600, 0x500, 0xf00, 0x00, 0x00, 0x00, 0x7061, 0x6c65, 0x7474, 0x6500, 
+0x500, 0x600, 0x1000, 0x00, 0x536b, 0x696e, 0x6e65, 0x6456, 0x6572, 0x7469, 
+0x6365, 0x7300, 0x600, 0x800, 0x1000, 0x00, 0x00, 0x00, 0x736b, 0x696e, 
+0x6e65, 0x645f, 0x7665, 0x7274, 0x6963, 0x6573, 0x00, 0x00, 0x500, 0x700, 
+0x1100, 0x00, 0x536b, 0x696e, 0x6e69, 0x6e67, 0x436f, 0x6e73, 0x7461, 0x6e74, 
+0x7300, 0x00, 0x600, 0x700, 0x1100, 0x00, 0x00, 0x00, 0x7665, 0x7274, 
+0x6578, 0x5f63, 0x6f75, 0x6e74, 0x00, 0x00, 0x500, 0x300, 0x2900, 0x00, 
+0x00, 0x00, 0x500, 0x300, 0x2a00, 0x00, 0x00, 0x00, 0x500, 0x300, 
+0x2b00, 0x00, 0x00, 0x00, 0x500, 0x300, 0x2c00, 0x00, 0x00, 0x00, 
+0x500, 0x500, 0x2d00, 0x00, 0x636f, 0x6e73, 0x7461, 0x6e74, 0x7300, 0x00, 
+0x4700, 0x400, 0x200, 0x00, 0xb00, 0x00, 0x1c00, 0x00, 0x4700, 0x400, 
+0xb00, 0x00, 0x600, 0x00, 0x400, 0x00, 0x4700, 0x400, 0xc00, 0x00, 
+0x600, 0x00, 0x4000, 0x00, 0x4700, 0x300, 0xd00, 0x00, 0x300, 0x00, 
+0x4800, 0x500, 0xd00, 0x00, 0x00, 0x00, 0x2300, 0x00, 0x00, 0x00, 
+0x4800, 0x400, 0xd00, 0x00, 0x00, 0x00, 0x1800, 0x00, 0x4700, 0x300, 
+0xe00, 0x00, 0x300, 0x00, 0x4800, 0x500, 0xe00, 0x00, 0x00, 0x00, 
+0x2300, 0x00, 0x00, 0x00, 0x4800, 0x400, 0xe00, 0x00, 0x00, 0x00, 
+0x1800, 0x00, 0x4700, 0x300, 0xf00, 0x00, 0x300, 0x00, 0x4800, 0x500, 
+0xf00, 0x00, 0x00, 0x00, 0x2300, 0x00, 0x00, 0x00, 0x4800, 0x400, 
+0xf00, 0x00, 0x00, 0x00, 0x1800, 0x00, 0x4800, 0x400, 0xf00, 0x00, 
+0x00, 0x00, 0x500, 0x00, 0x4800, 0x500, 0xf00, 0x00, 0x00, 0x00, 
+0x700, 0x00, 0x1000, 0x00, 0x4700, 0x300, 0x1000, 0x00, 0x300, 0x00, 
+0x4800, 0x500, 0x1000, 0x00, 0x00, 0x00, 0x2300, 0x00, 0x00, 0x00, 
+0x4700, 0x300, 0x1100, 0x00, 0x200, 0x00, 0x4800, 0x500, 0x1100, 0x00, 
+0x00, 0x00, 0x2300, 0x00, 0x00, 0x00, 0x4700, 0x400, 0x2900, 0x00, 
+0x2200, 0x00, 0x00, 0x00, 0x4700, 0x400, 0x2900, 0x00, 0x2100, 0x00, 
+0x00, 0x00, 0x4700, 0x400, 0x2a00, 0x00, 0x2200, 0x00, 0x00, 0x00, 
+0x4700, 0x400, 0x2a00, 0x00, 0x2100, 0x00, 0x100, 0x00, 0x4700, 0x400, 
+0x2b00, 0x00, 0x2200, 0x00, 0x00, 0x00, 0x4700, 0x400, 0x2b00, 0x00, 
+0x2100, 0x00, 0x200, 0x00, 0x4700, 0x400, 0x2c00, 0x00, 0x2200, 0x00, 
+0x00, 0x00, 0x4700, 0x400, 0x2c00, 0x00, 0x2100, 0x00, 0x300, 0x00, 
+0x1300, 0x200, 0x300, 0x00, 0x2100, 0x300, 0x400, 0x00, 0x300, 0x00, 
+0x1400, 0x200, 0x500, 0x00, 0x1500, 0x400, 0x600, 0x00, 0x2000, 0x00, 
+0x00, 0x00, 0x1600, 0x300, 0x700, 0x00, 0x2000, 0x00, 0x1700, 0x400, 
+0x800, 0x00, 0x600, 0x00, 0x300, 0x00, 0x1700, 0x400, 0x900, 0x00, 
+0x700, 0x00, 0x400, 0x00, 0x1800, 0x400, 0xa00, 0x00, 0x900, 0x00, 
+0x400, 0x00, 0x1d00, 0x300, 0xb00, 0x00, 0x600, 0x00, 0x1d00, 0x300, 
+0xc00, 0x00, 0xa00, 0x00, 0x1e00, 0x300, 0xd00, 0x00, 0xb00, 0x00, 
+0x1e00, 0x300, 0xe00, 0x00, 0xb00, 0x00, 0x1e00, 0x300, 0xf00, 0x00, 
+0xc00, 0x00, 0x1e00, 0x300, 0x1000, 0x00, 0xb00, 0x00, 0x1e00, 0x300, 
+0x1100, 0x00, 0x600, 0x00, 0x2000, 0x400, 0x1200, 0x00, 0x200, 0x00, 
+0xd00, 0x00, 0x2000, 0x400, 0x1300, 0x00, 0x200, 0x00, 0xe00, 0x00, 
+0x2000, 0x400, 0x1400, 0x00, 0x200, 0x00, 0xf00, 0x00, 0x2000, 0x400, 
+0x1500, 0x00, 0x200, 0x00, 0x1000, 0x00, 0x2000, 0x400, 0x1600, 0x00, 
+0x900, 0x00, 0x1100, 0x00, 0x2000, 0x400, 0x1700, 0x00, 0x100, 0x00, 
+0x800, 0x00, 0x2000, 0x400, 0x1800, 0x00, 0x100, 0x00, 0x600, 0x00, 
+0x2000, 0x400, 0x1900, 0x00, 0x200, 0x00, 0x600, 0x00, 0x2000, 0x400, 
+0x1a00, 0x00, 0x200, 0x00, 0xa00, 0x00, 0x2000, 0x400, 0x1b00, 0x00, 
+0x900, 0x00, 0x600, 0x00, 0x2b00, 0x400, 0x600, 0x00, 0x1c00, 0x00, 
+0x00, 0x00, 0x2b00, 0x400, 0x600, 0x00, 0x1d00, 0x00, 0x100, 0x00, 
+0x2b00, 0x400, 0x600, 0x00, 0x1e00, 0x00, 0x200, 0x00, 0x2b00, 0x400, 
+0x600, 0x00, 0x1f00, 0x00, 0x300, 0x00, 0x2b00, 0x400, 0x600, 0x00, 
+0x2000, 0x00, 0x400, 0x00, 0x2b00, 0x400, 0x600, 0x00, 0x2100, 0x00, 
+0x500, 0x00, 0x2b00, 0x400, 0x600, 0x00, 0x2200, 0x00, 0x600, 0x00, 
+0x2b00, 0x400, 0x600, 0x00, 0x2300, 0x00, 0x700, 0x00, 0x2b00, 0x400, 
+0x600, 0x00, 0x2400, 0x00, 0x800, 0x00, 0x2b00, 0x400, 0x600, 0x00, 
+0x2500, 0x00, 0x900, 0x00, 0x2b00, 0x400, 0x600, 0x00, 0x2600, 0x00, 
+0x1000, 0x00, 0x2b00, 0x400, 0x600, 0x00, 0x2700, 0x00, 0xffff, 0x00, 
+0x2b00, 0x400, 0x700, 0x00, 0x2800, 0x00, 0x00, 0x803f, 0x3b00, 0x400, 
+0x1200, 0x00, 0x2900, 0x00, 0x200, 0x00, 0x3b00, 0x400, 0x1300, 0x00, 
+0x2a00, 0x00, 0x200, 0x00, 0x3b00, 0x400, 0x1400, 0x00, 0x2b00, 0x00, 
+0x200, 0x00, 0x3b00, 0x400, 0x1500, 0x00, 0x2c00, 0x00, 0x200, 0x00, 
+0x3b00, 0x400, 0x1600, 0x00, 0x2d00, 0x00, 0x900, 0x00, 0x3b00, 0x400, 
+0x1700, 0x00, 0x200, 0x00, 0x100, 0x00, 0x3600, 0x500, 0x300, 0x00, 
+0x100, 0x00, 0x00, 0x00, 0x400, 0x00, 0xf800, 0x200, 0x2e00, 0x00, 
+0x4100, 0x500, 0x1800, 0x00, 0x3100, 0x00, 0x200, 0x00, 0x1c00, 0x00, 
+0x3d00, 0x400, 0x600, 0x00, 0x3200, 0x00, 0x3100, 0x00, 0x4100, 0x500, 
+0x1b00, 0x00, 0x3300, 0x00, 0x2d00, 0x00, 0x1c00, 0x00, 0x3d00, 0x400, 
+0x600, 0x00, 0x3400, 0x00, 0x3300, 0x00, 0xb000, 0x500, 0x500, 0x00, 
+0x3500, 0x00, 0x3200, 0x00, 0x3400, 0x00, 0xf700, 0x300, 0x3000, 0x00, 
+0x00, 0x00, 0xfa00, 0x400, 0x3500, 0x00, 0x2f00, 0x00, 0x3000, 0x00, 
+0xf800, 0x200, 0x2f00, 0x00, 0x8400, 0x500, 0x600, 0x00, 0x3600, 0x00, 
+0x3200, 0x00, 0x2500, 0x00, 0x8400, 0x500, 0x600, 0x00, 0x3700, 0x00, 
+0x3200, 0x00, 0x2200, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x3800, 0x00, 
+0x2a00, 0x00, 0x1c00, 0x00, 0x3700, 0x00, 0x3d00, 0x400, 0x600, 0x00, 
+0x3900, 0x00, 0x3800, 0x00, 0x8000, 0x500, 0x600, 0x00, 0x3a00, 0x00, 
+0x3700, 0x00, 0x1d00, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x3b00, 0x00, 
+0x2a00, 0x00, 0x1c00, 0x00, 0x3a00, 0x00, 0x3d00, 0x400, 0x600, 0x00, 
+0x3c00, 0x00, 0x3b00, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x3d00, 0x00, 
+0x2900, 0x00, 0x1c00, 0x00, 0x3600, 0x00, 0x3d00, 0x400, 0x600, 0x00, 
+0x3e00, 0x00, 0x3d00, 0x00, 0x7c00, 0x400, 0x700, 0x00, 0x3f00, 0x00, 
+0x3e00, 0x00, 0x8000, 0x500, 0x600, 0x00, 0x4000, 0x00, 0x3600, 0x00, 
+0x1d00, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x4100, 0x00, 0x2900, 0x00, 
+0x1c00, 0x00, 0x4000, 0x00, 0x3d00, 0x400, 0x600, 0x00, 0x4200, 0x00, 
+0x4100, 0x00, 0x7c00, 0x400, 0x700, 0x00, 0x4300, 0x00, 0x4200, 0x00, 
+0x8000, 0x500, 0x600, 0x00, 0x4400, 0x00, 0x3600, 0x00, 0x1e00, 0x00, 
+0x4100, 0x600, 0x1900, 0x00, 0x4500, 0x00, 0x2900, 0x00, 0x1c00, 0x00, 
+0x4400, 0x00, 0x3d00, 0x400, 0x600, 0x00, 0x4600, 0x00, 0x4500, 0x00, 
+0x7c00, 0x400, 0x700, 0x00, 0x4700, 0x00, 0x4600, 0x00, 0x5000, 0x700, 
+0x900, 0x00, 0x4800, 0x00, 0x3f00, 0x00, 0x4300, 0x00, 0x4700, 0x00, 
+0x2800, 0x00, 0xc700, 0x500, 0x600, 0x00, 0x4900, 0x00, 0x3900, 0x00, 
+0x2700, 0x00, 0xc200, 0x500, 0x600, 0x00, 0x4a00, 0x00, 0x3900, 0x00, 
+0x2600, 0x00, 0xc700, 0x500, 0x600, 0x00, 0x4b00, 0x00, 0x3c00, 0x00, 
+0x2700, 0x00, 0xc200, 0x500, 0x600, 0x00, 0x4c00, 0x00, 0x3c00, 0x00, 
+0x2600, 0x00, 0x4100, 0x600, 0x1a00, 0x00, 0x4d00, 0x00, 0x2b00, 0x00, 
+0x1c00, 0x00, 0x4900, 0x00, 0x3d00, 0x400, 0xa00, 0x00, 0x4e00, 0x00, 
+0x4d00, 0x00, 0x9100, 0x500, 0x900, 0x00, 0x4f00, 0x00, 0x4e00, 0x00, 
+0x4800, 0x00, 0x8000, 0x500, 0x600, 0x00, 0x5000, 0x00, 0x3700, 0x00, 
+0x1e00, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x5100, 0x00, 0x2a00, 0x00, 
+0x1c00, 0x00, 0x5000, 0x00, 0x3d00, 0x400, 0x600, 0x00, 0x5200, 0x00, 
+0x5100, 0x00, 0x7c00, 0x400, 0x700, 0x00, 0x5300, 0x00, 0x5200, 0x00, 
+0x8e00, 0x500, 0x900, 0x00, 0x5400, 0x00, 0x4f00, 0x00, 0x5300, 0x00, 
+0x4100, 0x600, 0x1a00, 0x00, 0x5500, 0x00, 0x2b00, 0x00, 0x1c00, 0x00, 
+0x4a00, 0x00, 0x3d00, 0x400, 0xa00, 0x00, 0x5600, 0x00, 0x5500, 0x00, 
+0x9100, 0x500, 0x900, 0x00, 0x5700, 0x00, 0x5600, 0x00, 0x4800, 0x00, 
+0x8000, 0x500, 0x600, 0x00, 0x5800, 0x00, 0x3700, 0x00, 0x1f00, 0x00, 
+0x4100, 0x600, 0x1900, 0x00, 0x5900, 0x00, 0x2a00, 0x00, 0x1c00, 0x00, 
+0x5800, 0x00, 0x3d00, 0x400, 0x600, 0x00, 0x5a00, 0x00, 0x5900, 0x00, 
+0x7c00, 0x400, 0x700, 0x00, 0x5b00, 0x00, 0x5a00, 0x00, 0x8e00, 0x500, 
+0x900, 0x00, 0x5c00, 0x00, 0x5700, 0x00, 0x5b00, 0x00, 0x4100, 0x600, 
+0x1a00, 0x00, 0x5d00, 0x00, 0x2b00, 0x00, 0x1c00, 0x00, 0x4b00, 0x00, 
+0x3d00, 0x400, 0xa00, 0x00, 0x5e00, 0x00, 0x5d00, 0x00, 0x9100, 0x500, 
+0x900, 0x00, 0x5f00, 0x00, 0x5e00, 0x00, 0x4800, 0x00, 0x8000, 0x500, 
+0x600, 0x00, 0x6000, 0x00, 0x3700, 0x00, 0x2000, 0x00, 0x4100, 0x600, 
+0x1900, 0x00, 0x6100, 0x00, 0x2a00, 0x00, 0x1c00, 0x00, 0x6000, 0x00, 
+0x3d00, 0x400, 0x600, 0x00, 0x6200, 0x00, 0x6100, 0x00, 0x7c00, 0x400, 
+0x700, 0x00, 0x6300, 0x00, 0x6200, 0x00, 0x8e00, 0x500, 0x900, 0x00, 
+0x6400, 0x00, 0x5f00, 0x00, 0x6300, 0x00, 0x4100, 0x600, 0x1a00, 0x00, 
+0x6500, 0x00, 0x2b00, 0x00, 0x1c00, 0x00, 0x4c00, 0x00, 0x3d00, 0x400, 
+0xa00, 0x00, 0x6600, 0x00, 0x6500, 0x00, 0x9100, 0x500, 0x900, 0x00, 
+0x6700, 0x00, 0x6600, 0x00, 0x4800, 0x00, 0x8000, 0x500, 0x600, 0x00, 
+0x6800, 0x00, 0x3700, 0x00, 0x2100, 0x00, 0x4100, 0x600, 0x1900, 0x00, 
+0x6900, 0x00, 0x2a00, 0x00, 0x1c00, 0x00, 0x6800, 0x00, 0x3d00, 0x400, 
+0x600, 0x00, 0x6a00, 0x00, 0x6900, 0x00, 0x7c00, 0x400, 0x700, 0x00, 
+0x6b00, 0x00, 0x6a00, 0x00, 0x8e00, 0x500, 0x900, 0x00, 0x6c00, 0x00, 
+0x6700, 0x00, 0x6b00, 0x00, 0x8100, 0x500, 0x900, 0x00, 0x6d00, 0x00, 
+0x5400, 0x00, 0x5c00, 0x00, 0x8100, 0x500, 0x900, 0x00, 0x6e00, 0x00, 
+0x6d00, 0x00, 0x6400, 0x00, 0x8100, 0x500, 0x900, 0x00, 0x6f00, 0x00, 
+0x6e00, 0x00, 0x6c00, 0x00, 0x5100, 0x500, 0x700, 0x00, 0x7000, 0x00, 
+0x6f00, 0x00, 0x00, 0x00, 0x7c00, 0x400, 0x600, 0x00, 0x7100, 0x00, 
+0x7000, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x7200, 0x00, 0x2c00, 0x00, 
+0x1c00, 0x00, 0x3600, 0x00, 0x3e00, 0x300, 0x7200, 0x00, 0x7100, 0x00, 
+0x5100, 0x500, 0x700, 0x00, 0x7300, 0x00, 0x6f00, 0x00, 0x100, 0x00, 
+0x7c00, 0x400, 0x600, 0x00, 0x7400, 0x00, 0x7300, 0x00, 0x8000, 0x500, 
+0x600, 0x00, 0x7500, 0x00, 0x3600, 0x00, 0x1d00, 0x00, 0x4100, 0x600, 
+0x1900, 0x00, 0x7600, 0x00, 0x2c00, 0x00, 0x1c00, 0x00, 0x7500, 0x00, 
+0x3e00, 0x300, 0x7600, 0x00, 0x7400, 0x00, 0x5100, 0x500, 0x700, 0x00, 
+0x7700, 0x00, 0x6f00, 0x00, 0x200, 0x00, 0x7c00, 0x400, 0x600, 0x00, 
+0x7800, 0x00, 0x7700, 0x00, 0x8000, 0x500, 0x600, 0x00, 0x7900, 0x00, 
+0x3600, 0x00, 0x1e00, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x7a00, 0x00, 
+0x2c00, 0x00, 0x1c00, 0x00, 0x7900, 0x00, 0x3e00, 0x300, 0x7a00, 0x00, 
+0x7800, 0x00, 0x8000, 0x500, 0x600, 0x00, 0x7b00, 0x00, 0x3600, 0x00, 
+0x1f00, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x7c00, 0x00, 0x2900, 0x00, 
+0x1c00, 0x00, 0x7b00, 0x00, 0x3d00, 0x400, 0x600, 0x00, 0x7d00, 0x00, 
+0x7c00, 0x00, 0x8000, 0x500, 0x600, 0x00, 0x7e00, 0x00, 0x3600, 0x00, 
+0x1f00, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x7f00, 0x00, 0x2c00, 0x00, 
+0x1c00, 0x00, 0x7e00, 0x00, 0x3e00, 0x300, 0x7f00, 0x00, 0x7d00, 0x00, 
+0x8000, 0x500, 0x600, 0x00, 0x8000, 0x00, 0x3600, 0x00, 0x2000, 0x00, 
+0x4100, 0x600, 0x1900, 0x00, 0x8100, 0x00, 0x2900, 0x00, 0x1c00, 0x00, 
+0x8000, 0x00, 0x3d00, 0x400, 0x600, 0x00, 0x8200, 0x00, 0x8100, 0x00, 
+0x8000, 0x500, 0x600, 0x00, 0x8300, 0x00, 0x3600, 0x00, 0x2000, 0x00, 
+0x4100, 0x600, 0x1900, 0x00, 0x8400, 0x00, 0x2c00, 0x00, 0x1c00, 0x00, 
+0x8300, 0x00, 0x3e00, 0x300, 0x8400, 0x00, 0x8200, 0x00, 0x8000, 0x500, 
+0x600, 0x00, 0x8500, 0x00, 0x3600, 0x00, 0x2100, 0x00, 0x4100, 0x600, 
+0x1900, 0x00, 0x8600, 0x00, 0x2900, 0x00, 0x1c00, 0x00, 0x8500, 0x00, 
+0x3d00, 0x400, 0x600, 0x00, 0x8700, 0x00, 0x8600, 0x00, 0x8000, 0x500, 
+0x600, 0x00, 0x8800, 0x00, 0x3600, 0x00, 0x2100, 0x00, 0x4100, 0x600, 
+0x1900, 0x00, 0x8900, 0x00, 0x2c00, 0x00, 0x1c00, 0x00, 0x8800, 0x00, 
+0x3e00, 0x300, 0x8900, 0x00, 0x8700, 0x00, 0x8000, 0x500, 0x600, 0x00, 
+0x8a00, 0x00, 0x3600, 0x00, 0x2200, 0x00, 0x4100, 0x600, 0x1900, 0x00, 
+0x8b00, 0x00, 0x2900, 0x00, 0x1c00, 0x00, 0x8a00, 0x00, 0x3d00, 0x400, 
+0x600, 0x00, 0x8c00, 0x00, 0x8b00, 0x00, 0x8000, 0x500, 0x600, 0x00, 
+0x8d00, 0x00, 0x3600, 0x00, 0x2200, 0x00, 0x4100, 0x600, 0x1900, 0x00, 
+0x8e00, 0x00, 0x2c00, 0x00, 0x1c00, 0x00, 0x8d00, 0x00, 0x3e00, 0x300, 
+0x8e00, 0x00, 0x8c00, 0x00, 0x8000, 0x500, 0x600, 0x00, 0x8f00, 0x00, 
+0x3600, 0x00, 0x2300, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x9000, 0x00, 
+0x2900, 0x00, 0x1c00, 0x00, 0x8f00, 0x00, 0x3d00, 0x400, 0x600, 0x00, 
+0x9100, 0x00, 0x9000, 0x00, 0x8000, 0x500, 0x600, 0x00, 0x9200, 0x00, 
+0x3600, 0x00, 0x2300, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x9300, 0x00, 
+0x2c00, 0x00, 0x1c00, 0x00, 0x9200, 0x00, 0x3e00, 0x300, 0x9300, 0x00, 
+0x9100, 0x00, 0x8000, 0x500, 0x600, 0x00, 0x9400, 0x00, 0x3600, 0x00, 
+0x2400, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x9500, 0x00, 0x2900, 0x00, 
+0x1c00, 0x00, 0x9400, 0x00, 0x3d00, 0x400, 0x600, 0x00, 0x9600, 0x00, 
+0x9500, 0x00, 0x8000, 0x500, 0x600, 0x00, 0x9700, 0x00, 0x3600, 0x00, 
+0x2400, 0x00, 0x4100, 0x600, 0x1900, 0x00, 0x9800, 0x00, 0x2c00, 0x00, 
+0x1c00, 0x00, 0x9700, 0x00, 0x3e00, 0x300, 0x9800, 0x00, 0x9600, 0x00, 
+0xf900, 0x200, 0x3000, 0x00, 0xf800, 0x200, 0x3000, 0x00, 0xfd00, 0x100, 
+0x3800, 0x100, };
+
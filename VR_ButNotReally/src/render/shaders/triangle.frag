@@ -1,16 +1,18 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(binding = 1) uniform sampler2D texSampler;
+// Every material of the model has its texture in a layer of the array
+layout(binding = 1) uniform sampler2DArray texSampler;
 
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in float fragTextureLayer;
 
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = texture(texSampler, fragTexCoord);
+    outColor = texture(texSampler, vec3(fragTexCoord, fragTextureLayer));
 	if(outColor.w < 1.0 ){
 	outColor = vec4(fragColor, 0.2);
 	}
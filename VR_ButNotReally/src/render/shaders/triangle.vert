@@ -9,14 +9,24 @@ layout(binding = 0) uniform UniformBufferObject {
 } ubo;
 
 // This is the per vertex input data
+//
+// With compact vertices (CompactVertex) the position arrives as 16 bit
+// normalized values in [0, 1] relative to the bounds of the mesh. The
+// renderer folds the dequantization (scale and offset by the bounds) into
+// ubo.model so the same code handles both vertex formats.
+//
+// The texture layer is the layer of the texture array with the texture of
+// the material of the vertex.
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in uint inTextureLayer;
 
 
 // And this is the per vertex output data
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out float fragTextureLayer;
 
 out gl_PerVertex {
     vec4 gl_Position;
@@ -31,4 +41,5 @@ void main() {
     gl_Position =  ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
     fragColor = inColor;
 	fragTexCoord = inTexCoord;
+	fragTextureLayer = float(inTextureLayer);
 }
\ No newline at end of file
@@ -1,26 +1,29 @@
-std::array<wchar_t, 502> triangle_frag = {
-0x302, 0x2307, 0x00, 0x100, 0x200, 0x800, 0x2700, 0x00, 0x00, 0x00, 
+std::array<wchar_t, 566> triangle_frag = {
+0x302, 0x2307, 0x00, 0x100, 0x200, 0x800, 0x2b00, 0x00, 0x00, 0x00, 
 0x1100, 0x200, 0x100, 0x00, 0xb00, 0x600, 0x100, 0x00, 0x474c, 0x534c, 
 0x2e73, 0x7464, 0x2e34, 0x3530, 0x00, 0x00, 0xe00, 0x300, 0x00, 0x00, 
-0x100, 0x00, 0xf00, 0x800, 0x400, 0x00, 0x400, 0x00, 0x6d61, 0x696e, 
-0x00, 0x00, 0x900, 0x00, 0x1100, 0x00, 0x2000, 0x00, 0x1000, 0x300, 
-0x400, 0x00, 0x700, 0x00, 0x300, 0x300, 0x200, 0x00, 0xc201, 0x00, 
-0x400, 0x900, 0x474c, 0x5f41, 0x5242, 0x5f73, 0x6570, 0x6172, 0x6174, 0x655f, 
-0x7368, 0x6164, 0x6572, 0x5f6f, 0x626a, 0x6563, 0x7473, 0x00, 0x500, 0x400, 
-0x400, 0x00, 0x6d61, 0x696e, 0x00, 0x00, 0x500, 0x500, 0x900, 0x00, 
-0x6f75, 0x7443, 0x6f6c, 0x6f72, 0x00, 0x00, 0x500, 0x500, 0xd00, 0x00, 
-0x7465, 0x7853, 0x616d, 0x706c, 0x6572, 0x00, 0x500, 0x600, 0x1100, 0x00, 
-0x6672, 0x6167, 0x5465, 0x7843, 0x6f6f, 0x7264, 0x00, 0x00, 0x500, 0x500, 
-0x2000, 0x00, 0x6672, 0x6167, 0x436f, 0x6c6f, 0x7200, 0x00, 0x4700, 0x400, 
-0x900, 0x00, 0x1e00, 0x00, 0x00, 0x00, 0x4700, 0x400, 0xd00, 0x00, 
-0x2200, 0x00, 0x00, 0x00, 0x4700, 0x400, 0xd00, 0x00, 0x2100, 0x00, 
-0x100, 0x00, 0x4700, 0x400, 0x1100, 0x00, 0x1e00, 0x00, 0x100, 0x00, 
-0x4700, 0x400, 0x2000, 0x00, 0x1e00, 0x00, 0x00, 0x00, 0x1300, 0x200, 
+0x100, 0x00, 0xf00, 0x900, 0x400, 0x00, 0x400, 0x00, 0x6d61, 0x696e, 
+0x00, 0x00, 0x900, 0x00, 0x1100, 0x00, 0x2000, 0x00, 0x2800, 0x00, 
+0x1000, 0x300, 0x400, 0x00, 0x700, 0x00, 0x300, 0x300, 0x200, 0x00, 
+0xc201, 0x00, 0x400, 0x900, 0x474c, 0x5f41, 0x5242, 0x5f73, 0x6570, 0x6172, 
+0x6174, 0x655f, 0x7368, 0x6164, 0x6572, 0x5f6f, 0x626a, 0x6563, 0x7473, 0x00, 
+0x500, 0x400, 0x400, 0x00, 0x6d61, 0x696e, 0x00, 0x00, 0x500, 0x500, 
+0x900, 0x00, 0x6f75, 0x7443, 0x6f6c, 0x6f72, 0x00, 0x00, 0x500, 0x500, 
+0xd00, 0x00, 0x7465, 0x7853, 0x616d, 0x706c, 0x6572, 0x00, 0x500, 0x600, 
+0x1100, 0x00, 0x6672, 0x6167, 0x5465, 0x7843, 0x6f6f, 0x7264, 0x00, 0x00, 
+0x500, 0x500, 0x2000, 0x00, 0x6672, 0x6167, 0x436f, 0x6c6f, 0x7200, 0x00, 
+0x500, 0x700, 0x2800, 0x00, 0x6672, 0x6167, 0x5465, 0x7874, 0x7572, 0x654c, 
+0x6179, 0x6572, 0x00, 0x00, 0x4700, 0x400, 0x900, 0x00, 0x1e00, 0x00, 
+0x00, 0x00, 0x4700, 0x400, 0xd00, 0x00, 0x2200, 0x00, 0x00, 0x00, 
+0x4700, 0x400, 0xd00, 0x00, 0x2100, 0x00, 0x100, 0x00, 0x4700, 0x400, 
+0x1100, 0x00, 0x1e00, 0x00, 0x100, 0x00, 0x4700, 0x400, 0x2000, 0x00, 
+0x1e00, 0x00, 0x00, 0x00, 0x4700, 0x400, 0x2800, 0x00, 0x1e00, 0x00, 
+0x200, 0x00, 0x4700, 0x300, 0x2800, 0x00, 0xe00, 0x00, 0x1300, 0x200, 
 0x200, 0x00, 0x2100, 0x300, 0x300, 0x00, 0x200, 0x00, 0x1600, 0x300, 
 0x600, 0x00, 0x2000, 0x00, 0x1700, 0x400, 0x700, 0x00, 0x600, 0x00, 
 0x400, 0x00, 0x2000, 0x400, 0x800, 0x00, 0x300, 0x00, 0x700, 0x00, 
 0x3b00, 0x400, 0x800, 0x00, 0x900, 0x00, 0x300, 0x00, 0x1900, 0x900, 
-0xa00, 0x00, 0x600, 0x00, 0x100, 0x00, 0x00, 0x00, 0x00, 0x00, 
+0xa00, 0x00, 0x600, 0x00, 0x100, 0x00, 0x00, 0x00, 0x100, 0x00, 
 0x00, 0x00, 0x100, 0x00, 0x00, 0x00, 0x1b00, 0x300, 0xb00, 0x00, 
 0xa00, 0x00, 0x2000, 0x400, 0xc00, 0x00, 0x00, 0x00, 0xb00, 0x00, 
 0x3b00, 0x400, 0xc00, 0x00, 0xd00, 0x00, 0x00, 0x00, 0x1700, 0x400, 
@@ -33,21 +36,24 @@ std::array<wchar_t, 502> triangle_frag = {
 0x1e00, 0x00, 0x600, 0x00, 0x300, 0x00, 0x2000, 0x400, 0x1f00, 0x00, 
 0x100, 0x00, 0x1e00, 0x00, 0x3b00, 0x400, 0x1f00, 0x00, 0x2000, 0x00, 
 0x100, 0x00, 0x2b00, 0x400, 0x600, 0x00, 0x2200, 0x00, 0xcdcc, 0x4c3e, 
-0x3600, 0x500, 0x200, 0x00, 0x400, 0x00, 0x00, 0x00, 0x300, 0x00, 
-0xf800, 0x200, 0x500, 0x00, 0x3d00, 0x400, 0xb00, 0x00, 0xe00, 0x00, 
-0xd00, 0x00, 0x3d00, 0x400, 0xf00, 0x00, 0x1200, 0x00, 0x1100, 0x00, 
-0x5700, 0x500, 0x700, 0x00, 0x1300, 0x00, 0xe00, 0x00, 0x1200, 0x00, 
-0x3e00, 0x300, 0x900, 0x00, 0x1300, 0x00, 0x4100, 0x500, 0x1600, 0x00, 
-0x1700, 0x00, 0x900, 0x00, 0x1500, 0x00, 0x3d00, 0x400, 0x600, 0x00, 
-0x1800, 0x00, 0x1700, 0x00, 0xb800, 0x500, 0x1a00, 0x00, 0x1b00, 0x00, 
-0x1800, 0x00, 0x1900, 0x00, 0xf700, 0x300, 0x1d00, 0x00, 0x00, 0x00, 
-0xfa00, 0x400, 0x1b00, 0x00, 0x1c00, 0x00, 0x1d00, 0x00, 0xf800, 0x200, 
-0x1c00, 0x00, 0x3d00, 0x400, 0x1e00, 0x00, 0x2100, 0x00, 0x2000, 0x00, 
-0x5100, 0x500, 0x600, 0x00, 0x2300, 0x00, 0x2100, 0x00, 0x00, 0x00, 
-0x5100, 0x500, 0x600, 0x00, 0x2400, 0x00, 0x2100, 0x00, 0x100, 0x00, 
-0x5100, 0x500, 0x600, 0x00, 0x2500, 0x00, 0x2100, 0x00, 0x200, 0x00, 
-0x5000, 0x700, 0x700, 0x00, 0x2600, 0x00, 0x2300, 0x00, 0x2400, 0x00, 
-0x2500, 0x00, 0x2200, 0x00, 0x3e00, 0x300, 0x900, 0x00, 0x2600, 0x00, 
-0xf900, 0x200, 0x1d00, 0x00, 0xf800, 0x200, 0x1d00, 0x00, 0xfd00, 0x100, 
-0x3800, 0x100, };
+0x2000, 0x400, 0x2700, 0x00, 0x100, 0x00, 0x600, 0x00, 0x3b00, 0x400, 
+0x2700, 0x00, 0x2800, 0x00, 0x100, 0x00, 0x3600, 0x500, 0x200, 0x00, 
+0x400, 0x00, 0x00, 0x00, 0x300, 0x00, 0xf800, 0x200, 0x500, 0x00, 
+0x3d00, 0x400, 0xb00, 0x00, 0xe00, 0x00, 0xd00, 0x00, 0x3d00, 0x400, 
+0xf00, 0x00, 0x1200, 0x00, 0x1100, 0x00, 0x3d00, 0x400, 0x600, 0x00, 
+0x2900, 0x00, 0x2800, 0x00, 0x5000, 0x500, 0x1e00, 0x00, 0x2a00, 0x00, 
+0x1200, 0x00, 0x2900, 0x00, 0x5700, 0x500, 0x700, 0x00, 0x1300, 0x00, 
+0xe00, 0x00, 0x2a00, 0x00, 0x3e00, 0x300, 0x900, 0x00, 0x1300, 0x00, 
+0x4100, 0x500, 0x1600, 0x00, 0x1700, 0x00, 0x900, 0x00, 0x1500, 0x00, 
+0x3d00, 0x400, 0x600, 0x00, 0x1800, 0x00, 0x1700, 0x00, 0xb800, 0x500, 
+0x1a00, 0x00, 0x1b00, 0x00, 0x1800, 0x00, 0x1900, 0x00, 0xf700, 0x300, 
+0x1d00, 0x00, 0x00, 0x00, 0xfa00, 0x400, 0x1b00, 0x00, 0x1c00, 0x00, 
+0x1d00, 0x00, 0xf800, 0x200, 0x1c00, 0x00, 0x3d00, 0x400, 0x1e00, 0x00, 
+0x2100, 0x00, 0x2000, 0x00, 0x5100, 0x500, 0x600, 0x00, 0x2300, 0x00, 
+0x2100, 0x00, 0x00, 0x00, 0x5100, 0x500, 0x600, 0x00, 0x2400, 0x00, 
+0x2100, 0x00, 0x100, 0x00, 0x5100, 0x500, 0x600, 0x00, 0x2500, 0x00, 
+0x2100, 0x00, 0x200, 0x00, 0x5000, 0x700, 0x700, 0x00, 0x2600, 0x00, 
+0x2300, 0x00, 0x2400, 0x00, 0x2500, 0x00, 0x2200, 0x00, 0x3e00, 0x300, 
+0x900, 0x00, 0x2600, 0x00, 0xf900, 0x200, 0x1d00, 0x00, 0xf800, 0x200, 
+0x1d00, 0x00, 0xfd00, 0x100, 0x3800, 0x100, };
 
@@ -1,26 +1,29 @@
-std::array<wchar_t, 800> triangle_vert = {
-0x302, 0x2307, 0x00, 0x100, 0x200, 0x800, 0x3200, 0x00, 0x00, 0x00, 
+std::array<wchar_t, 914> triangle_vert = {
+0x302, 0x2307, 0x00, 0x100, 0x200, 0x800, 0x3900, 0x00, 0x00, 0x00, 
 0x1100, 0x200, 0x100, 0x00, 0xb00, 0x600, 0x100, 0x00, 0x474c, 0x534c, 
 0x2e73, 0x7464, 0x2e34, 0x3530, 0x00, 0x00, 0xe00, 0x300, 0x00, 0x00, 
-0x100, 0x00, 0xf00, 0xb00, 0x00, 0x00, 0x400, 0x00, 0x6d61, 0x696e, 
+0x100, 0x00, 0xf00, 0xd00, 0x00, 0x00, 0x400, 0x00, 0x6d61, 0x696e, 
 0x00, 0x00, 0xa00, 0x00, 0x1e00, 0x00, 0x2900, 0x00, 0x2a00, 0x00, 
-0x2e00, 0x00, 0x3000, 0x00, 0x300, 0x300, 0x200, 0x00, 0xc201, 0x00, 
-0x400, 0x900, 0x474c, 0x5f41, 0x5242, 0x5f73, 0x6570, 0x6172, 0x6174, 0x655f, 
-0x7368, 0x6164, 0x6572, 0x5f6f, 0x626a, 0x6563, 0x7473, 0x00, 0x500, 0x400, 
-0x400, 0x00, 0x6d61, 0x696e, 0x00, 0x00, 0x500, 0x600, 0x800, 0x00, 
-0x676c, 0x5f50, 0x6572, 0x5665, 0x7274, 0x6578, 0x00, 0x00, 0x600, 0x600, 
-0x800, 0x00, 0x00, 0x00, 0x676c, 0x5f50, 0x6f73, 0x6974, 0x696f, 0x6e00, 
-0x500, 0x300, 0xa00, 0x00, 0x00, 0x00, 0x500, 0x700, 0xe00, 0x00, 
-0x556e, 0x6966, 0x6f72, 0x6d42, 0x7566, 0x6665, 0x724f, 0x626a, 0x6563, 0x7400, 
-0x600, 0x500, 0xe00, 0x00, 0x00, 0x00, 0x6d6f, 0x6465, 0x6c00, 0x00, 
-0x600, 0x500, 0xe00, 0x00, 0x100, 0x00, 0x7669, 0x6577, 0x00, 0x00, 
-0x600, 0x500, 0xe00, 0x00, 0x200, 0x00, 0x7072, 0x6f6a, 0x00, 0x00, 
-0x500, 0x300, 0x1000, 0x00, 0x7562, 0x6f00, 0x500, 0x500, 0x1e00, 0x00, 
-0x696e, 0x506f, 0x7369, 0x7469, 0x6f6e, 0x00, 0x500, 0x500, 0x2900, 0x00, 
-0x6672, 0x6167, 0x436f, 0x6c6f, 0x7200, 0x00, 0x500, 0x400, 0x2a00, 0x00, 
-0x696e, 0x436f, 0x6c6f, 0x7200, 0x500, 0x600, 0x2e00, 0x00, 0x6672, 0x6167, 
-0x5465, 0x7843, 0x6f6f, 0x7264, 0x00, 0x00, 0x500, 0x500, 0x3000, 0x00, 
-0x696e, 0x5465, 0x7843, 0x6f6f, 0x7264, 0x00, 0x4800, 0x500, 0x800, 0x00, 
+0x2e00, 0x00, 0x3000, 0x00, 0x3400, 0x00, 0x3600, 0x00, 0x300, 0x300, 
+0x200, 0x00, 0xc201, 0x00, 0x400, 0x900, 0x474c, 0x5f41, 0x5242, 0x5f73, 
+0x6570, 0x6172, 0x6174, 0x655f, 0x7368, 0x6164, 0x6572, 0x5f6f, 0x626a, 0x6563, 
+0x7473, 0x00, 0x500, 0x400, 0x400, 0x00, 0x6d61, 0x696e, 0x00, 0x00, 
+0x500, 0x600, 0x800, 0x00, 0x676c, 0x5f50, 0x6572, 0x5665, 0x7274, 0x6578, 
+0x00, 0x00, 0x600, 0x600, 0x800, 0x00, 0x00, 0x00, 0x676c, 0x5f50, 
+0x6f73, 0x6974, 0x696f, 0x6e00, 0x500, 0x300, 0xa00, 0x00, 0x00, 0x00, 
+0x500, 0x700, 0xe00, 0x00, 0x556e, 0x6966, 0x6f72, 0x6d42, 0x7566, 0x6665, 
+0x724f, 0x626a, 0x6563, 0x7400, 0x600, 0x500, 0xe00, 0x00, 0x00, 0x00, 
+0x6d6f, 0x6465, 0x6c00, 0x00, 0x600, 0x500, 0xe00, 0x00, 0x100, 0x00, 
+0x7669, 0x6577, 0x00, 0x00, 0x600, 0x500, 0xe00, 0x00, 0x200, 0x00, 
+0x7072, 0x6f6a, 0x00, 0x00, 0x500, 0x300, 0x1000, 0x00, 0x7562, 0x6f00, 
+0x500, 0x500, 0x1e00, 0x00, 0x696e, 0x506f, 0x7369, 0x7469, 0x6f6e, 0x00, 
+0x500, 0x500, 0x2900, 0x00, 0x6672, 0x6167, 0x436f, 0x6c6f, 0x7200, 0x00, 
+0x500, 0x400, 0x2a00, 0x00, 0x696e, 0x436f, 0x6c6f, 0x7200, 0x500, 0x600, 
+0x2e00, 0x00, 0x6672, 0x6167, 0x5465, 0x7843, 0x6f6f, 0x7264, 0x00, 0x00, 
+0x500, 0x500, 0x3000, 0x00, 0x696e, 0x5465, 0x7843, 0x6f6f, 0x7264, 0x00, 
+0x500, 0x600, 0x3400, 0x00, 0x696e, 0x5465, 0x7874, 0x7572, 0x654c, 0x6179, 
+0x6572, 0x00, 0x500, 0x700, 0x3600, 0x00, 0x6672, 0x6167, 0x5465, 0x7874, 
+0x7572, 0x654c, 0x6179, 0x6572, 0x00, 0x00, 0x4800, 0x500, 0x800, 0x00, 
 0x00, 0x00, 0xb00, 0x00, 0x00, 0x00, 0x4700, 0x300, 0x800, 0x00, 
 0x200, 0x00, 0x4800, 0x400, 0xe00, 0x00, 0x00, 0x00, 0x500, 0x00, 
 0x4800, 0x500, 0xe00, 0x00, 0x00, 0x00, 0x2300, 0x00, 0x00, 0x00, 
@@ -36,48 +39,56 @@ std::array<wchar_t, 800> triangle_vert = {
 0x1e00, 0x00, 0x1e00, 0x00, 0x00, 0x00, 0x4700, 0x400, 0x2900, 0x00, 
 0x1e00, 0x00, 0x00, 0x00, 0x4700, 0x400, 0x2a00, 0x00, 0x1e00, 0x00, 
 0x100, 0x00, 0x4700, 0x400, 0x2e00, 0x00, 0x1e00, 0x00, 0x100, 0x00, 
-0x4700, 0x400, 0x3000, 0x00, 0x1e00, 0x00, 0x200, 0x00, 0x1300, 0x200, 
-0x200, 0x00, 0x2100, 0x300, 0x300, 0x00, 0x200, 0x00, 0x1600, 0x300, 
-0x600, 0x00, 0x2000, 0x00, 0x1700, 0x400, 0x700, 0x00, 0x600, 0x00, 
-0x400, 0x00, 0x1e00, 0x300, 0x800, 0x00, 0x700, 0x00, 0x2000, 0x400, 
-0x900, 0x00, 0x300, 0x00, 0x800, 0x00, 0x3b00, 0x400, 0x900, 0x00, 
-0xa00, 0x00, 0x300, 0x00, 0x1500, 0x400, 0xb00, 0x00, 0x2000, 0x00, 
-0x100, 0x00, 0x2b00, 0x400, 0xb00, 0x00, 0xc00, 0x00, 0x00, 0x00, 
-0x1800, 0x400, 0xd00, 0x00, 0x700, 0x00, 0x400, 0x00, 0x1e00, 0x500, 
-0xe00, 0x00, 0xd00, 0x00, 0xd00, 0x00, 0xd00, 0x00, 0x2000, 0x400, 
-0xf00, 0x00, 0x200, 0x00, 0xe00, 0x00, 0x3b00, 0x400, 0xf00, 0x00, 
-0x1000, 0x00, 0x200, 0x00, 0x2b00, 0x400, 0xb00, 0x00, 0x1100, 0x00, 
-0x200, 0x00, 0x2000, 0x400, 0x1200, 0x00, 0x200, 0x00, 0xd00, 0x00, 
-0x2b00, 0x400, 0xb00, 0x00, 0x1500, 0x00, 0x100, 0x00, 0x1700, 0x400, 
-0x1c00, 0x00, 0x600, 0x00, 0x300, 0x00, 0x2000, 0x400, 0x1d00, 0x00, 
-0x100, 0x00, 0x1c00, 0x00, 0x3b00, 0x400, 0x1d00, 0x00, 0x1e00, 0x00, 
-0x100, 0x00, 0x2b00, 0x400, 0x600, 0x00, 0x2000, 0x00, 0x00, 0x803f, 
-0x2000, 0x400, 0x2600, 0x00, 0x300, 0x00, 0x700, 0x00, 0x2000, 0x400, 
-0x2800, 0x00, 0x300, 0x00, 0x1c00, 0x00, 0x3b00, 0x400, 0x2800, 0x00, 
-0x2900, 0x00, 0x300, 0x00, 0x3b00, 0x400, 0x1d00, 0x00, 0x2a00, 0x00, 
-0x100, 0x00, 0x1700, 0x400, 0x2c00, 0x00, 0x600, 0x00, 0x200, 0x00, 
-0x2000, 0x400, 0x2d00, 0x00, 0x300, 0x00, 0x2c00, 0x00, 0x3b00, 0x400, 
-0x2d00, 0x00, 0x2e00, 0x00, 0x300, 0x00, 0x2000, 0x400, 0x2f00, 0x00, 
-0x100, 0x00, 0x2c00, 0x00, 0x3b00, 0x400, 0x2f00, 0x00, 0x3000, 0x00, 
-0x100, 0x00, 0x3600, 0x500, 0x200, 0x00, 0x400, 0x00, 0x00, 0x00, 
-0x300, 0x00, 0xf800, 0x200, 0x500, 0x00, 0x4100, 0x500, 0x1200, 0x00, 
-0x1300, 0x00, 0x1000, 0x00, 0x1100, 0x00, 0x3d00, 0x400, 0xd00, 0x00, 
-0x1400, 0x00, 0x1300, 0x00, 0x4100, 0x500, 0x1200, 0x00, 0x1600, 0x00, 
-0x1000, 0x00, 0x1500, 0x00, 0x3d00, 0x400, 0xd00, 0x00, 0x1700, 0x00, 
-0x1600, 0x00, 0x9200, 0x500, 0xd00, 0x00, 0x1800, 0x00, 0x1400, 0x00, 
-0x1700, 0x00, 0x4100, 0x500, 0x1200, 0x00, 0x1900, 0x00, 0x1000, 0x00, 
-0xc00, 0x00, 0x3d00, 0x400, 0xd00, 0x00, 0x1a00, 0x00, 0x1900, 0x00, 
-0x9200, 0x500, 0xd00, 0x00, 0x1b00, 0x00, 0x1800, 0x00, 0x1a00, 0x00, 
-0x3d00, 0x400, 0x1c00, 0x00, 0x1f00, 0x00, 0x1e00, 0x00, 0x5100, 0x500, 
-0x600, 0x00, 0x2100, 0x00, 0x1f00, 0x00, 0x00, 0x00, 0x5100, 0x500, 
-0x600, 0x00, 0x2200, 0x00, 0x1f00, 0x00, 0x100, 0x00, 0x5100, 0x500, 
-0x600, 0x00, 0x2300, 0x00, 0x1f00, 0x00, 0x200, 0x00, 0x5000, 0x700, 
-0x700, 0x00, 0x2400, 0x00, 0x2100, 0x00, 0x2200, 0x00, 0x2300, 0x00, 
-0x2000, 0x00, 0x9100, 0x500, 0x700, 0x00, 0x2500, 0x00, 0x1b00, 0x00, 
-0x2400, 0x00, 0x4100, 0x500, 0x2600, 0x00, 0x2700, 0x00, 0xa00, 0x00, 
-0xc00, 0x00, 0x3e00, 0x300, 0x2700, 0x00, 0x2500, 0x00, 0x3d00, 0x400, 
-0x1c00, 0x00, 0x2b00, 0x00, 0x2a00, 0x00, 0x3e00, 0x300, 0x2900, 0x00, 
-0x2b00, 0x00, 0x3d00, 0x400, 0x2c00, 0x00, 0x3100, 0x00, 0x3000, 0x00, 
-0x3e00, 0x300, 0x2e00, 0x00, 0x3100, 0x00, 0xfd00, 0x100, 0x3800, 0x100, 
-};
+0x4700, 0x400, 0x3000, 0x00, 0x1e00, 0x00, 0x200, 0x00, 0x4700, 0x400, 
+0x3400, 0x00, 0x1e00, 0x00, 0x300, 0x00, 0x4700, 0x300, 0x3600, 0x00, 
+0xe00, 0x00, 0x4700, 0x400, 0x3600, 0x00, 0x1e00, 0x00, 0x200, 0x00, 
+0x1300, 0x200, 0x200, 0x00, 0x2100, 0x300, 0x300, 0x00, 0x200, 0x00, 
+0x1600, 0x300, 0x600, 0x00, 0x2000, 0x00, 0x1700, 0x400, 0x700, 0x00, 
+0x600, 0x00, 0x400, 0x00, 0x1e00, 0x300, 0x800, 0x00, 0x700, 0x00, 
+0x2000, 0x400, 0x900, 0x00, 0x300, 0x00, 0x800, 0x00, 0x3b00, 0x400, 
+0x900, 0x00, 0xa00, 0x00, 0x300, 0x00, 0x1500, 0x400, 0xb00, 0x00, 
+0x2000, 0x00, 0x100, 0x00, 0x2b00, 0x400, 0xb00, 0x00, 0xc00, 0x00, 
+0x00, 0x00, 0x1800, 0x400, 0xd00, 0x00, 0x700, 0x00, 0x400, 0x00, 
+0x1e00, 0x500, 0xe00, 0x00, 0xd00, 0x00, 0xd00, 0x00, 0xd00, 0x00, 
+0x2000, 0x400, 0xf00, 0x00, 0x200, 0x00, 0xe00, 0x00, 0x3b00, 0x400, 
+0xf00, 0x00, 0x1000, 0x00, 0x200, 0x00, 0x2b00, 0x400, 0xb00, 0x00, 
+0x1100, 0x00, 0x200, 0x00, 0x2000, 0x400, 0x1200, 0x00, 0x200, 0x00, 
+0xd00, 0x00, 0x2b00, 0x400, 0xb00, 0x00, 0x1500, 0x00, 0x100, 0x00, 
+0x1700, 0x400, 0x1c00, 0x00, 0x600, 0x00, 0x300, 0x00, 0x2000, 0x400, 
+0x1d00, 0x00, 0x100, 0x00, 0x1c00, 0x00, 0x3b00, 0x400, 0x1d00, 0x00, 
+0x1e00, 0x00, 0x100, 0x00, 0x2b00, 0x400, 0x600, 0x00, 0x2000, 0x00, 
+0x00, 0x803f, 0x2000, 0x400, 0x2600, 0x00, 0x300, 0x00, 0x700, 0x00, 
+0x2000, 0x400, 0x2800, 0x00, 0x300, 0x00, 0x1c00, 0x00, 0x3b00, 0x400, 
+0x2800, 0x00, 0x2900, 0x00, 0x300, 0x00, 0x3b00, 0x400, 0x1d00, 0x00, 
+0x2a00, 0x00, 0x100, 0x00, 0x1700, 0x400, 0x2c00, 0x00, 0x600, 0x00, 
+0x200, 0x00, 0x2000, 0x400, 0x2d00, 0x00, 0x300, 0x00, 0x2c00, 0x00, 
+0x3b00, 0x400, 0x2d00, 0x00, 0x2e00, 0x00, 0x300, 0x00, 0x2000, 0x400, 
+0x2f00, 0x00, 0x100, 0x00, 0x2c00, 0x00, 0x3b00, 0x400, 0x2f00, 0x00, 
+0x3000, 0x00, 0x100, 0x00, 0x1500, 0x400, 0x3200, 0x00, 0x2000, 0x00, 
+0x00, 0x00, 0x2000, 0x400, 0x3300, 0x00, 0x100, 0x00, 0x3200, 0x00, 
+0x3b00, 0x400, 0x3300, 0x00, 0x3400, 0x00, 0x100, 0x00, 0x2000, 0x400, 
+0x3500, 0x00, 0x300, 0x00, 0x600, 0x00, 0x3b00, 0x400, 0x3500, 0x00, 
+0x3600, 0x00, 0x300, 0x00, 0x3600, 0x500, 0x200, 0x00, 0x400, 0x00, 
+0x00, 0x00, 0x300, 0x00, 0xf800, 0x200, 0x500, 0x00, 0x4100, 0x500, 
+0x1200, 0x00, 0x1300, 0x00, 0x1000, 0x00, 0x1100, 0x00, 0x3d00, 0x400, 
+0xd00, 0x00, 0x1400, 0x00, 0x1300, 0x00, 0x4100, 0x500, 0x1200, 0x00, 
+0x1600, 0x00, 0x1000, 0x00, 0x1500, 0x00, 0x3d00, 0x400, 0xd00, 0x00, 
+0x1700, 0x00, 0x1600, 0x00, 0x9200, 0x500, 0xd00, 0x00, 0x1800, 0x00, 
+0x1400, 0x00, 0x1700, 0x00, 0x4100, 0x500, 0x1200, 0x00, 0x1900, 0x00, 
+0x1000, 0x00, 0xc00, 0x00, 0x3d00, 0x400, 0xd00, 0x00, 0x1a00, 0x00, 
+0x1900, 0x00, 0x9200, 0x500, 0xd00, 0x00, 0x1b00, 0x00, 0x1800, 0x00, 
+0x1a00, 0x00, 0x3d00, 0x400, 0x1c00, 0x00, 0x1f00, 0x00, 0x1e00, 0x00, 
+0x5100, 0x500, 0x600, 0x00, 0x2100, 0x00, 0x1f00, 0x00, 0x00, 0x00, 
+0x5100, 0x500, 0x600, 0x00, 0x2200, 0x00, 0x1f00, 0x00, 0x100, 0x00, 
+0x5100, 0x500, 0x600, 0x00, 0x2300, 0x00, 0x1f00, 0x00, 0x200, 0x00, 
+0x5000, 0x700, 0x700, 0x00, 0x2400, 0x00, 0x2100, 0x00, 0x2200, 0x00, 
+0x2300, 0x00, 0x2000, 0x00, 0x9100, 0x500, 0x700, 0x00, 0x2500, 0x00, 
+0x1b00, 0x00, 0x2400, 0x00, 0x4100, 0x500, 0x2600, 0x00, 0x2700, 0x00, 
+0xa00, 0x00, 0xc00, 0x00, 0x3e00, 0x300, 0x2700, 0x00, 0x2500, 0x00, 
+0x3d00, 0x400, 0x1c00, 0x00, 0x2b00, 0x00, 0x2a00, 0x00, 0x3e00, 0x300, 
+0x2900, 0x00, 0x2b00, 0x00, 0x3d00, 0x400, 0x2c00, 0x00, 0x3100, 0x00, 
+0x3000, 0x00, 0x3e00, 0x300, 0x2e00, 0x00, 0x3100, 0x00, 0x3d00, 0x400, 
+0x3200, 0x00, 0x3700, 0x00, 0x3400, 0x00, 0x7000, 0x400, 0x600, 0x00, 
+0x3800, 0x00, 0x3700, 0x00, 0x3e00, 0x300, 0x3600, 0x00, 0x3800, 0x00, 
+0xfd00, 0x100, 0x3800, 0x100, };
 
@@ -0,0 +1,148 @@
+#include "./MappedFile.h"
+#include <stdexcept>
+#include <sstream>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+	if (!open(path)) {
+		auto ss = std::stringstream{};
+		ss << "We could not map the file [" << path << "]";
+		throw std::runtime_error(ss.str());
+	}
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		close();
+		std::swap(m_data, other.m_data);
+		std::swap(m_size, other.m_size);
+#if defined(_WIN32)
+		std::swap(m_file, other.m_file);
+		std::swap(m_mapping, other.m_mapping);
+#else
+		std::swap(m_descriptor, other.m_descriptor);
+#endif
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#if defined(_WIN32)
+
+auto MappedFile::open(const std::string& path) noexcept -> bool {
+	close();
+
+	auto file = CreateFileA(
+		path.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		nullptr);
+
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	m_file = file;
+
+	auto file_size = LARGE_INTEGER{};
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+		close();
+		return false;
+	}
+
+	m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr) {
+		close();
+		return false;
+	}
+
+	m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr) {
+		close();
+		return false;
+	}
+
+	m_size = static_cast<size_t>(file_size.QuadPart);
+	return true;
+}
+
+auto MappedFile::close() noexcept -> void {
+	if (m_data != nullptr) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping != nullptr) {
+		CloseHandle(m_mapping);
+	}
+	if (m_file != nullptr) {
+		CloseHandle(m_file);
+	}
+	m_data = nullptr;
+	m_size = 0;
+	m_mapping = nullptr;
+	m_file = nullptr;
+}
+
+#else
+
+auto MappedFile::open(const std::string& path) noexcept -> bool {
+	close();
+
+	m_descriptor = ::open(path.c_str(), O_RDONLY);
+	if (m_descriptor < 0) {
+		return false;
+	}
+
+	struct stat file_stats {};
+	if (fstat(m_descriptor, &file_stats) != 0 || file_stats.st_size == 0) {
+		close();
+		return false;
+	}
+
+	auto mapping = mmap(nullptr, static_cast<size_t>(file_stats.st_size), PROT_READ, MAP_PRIVATE, m_descriptor, 0);
+	if (mapping == MAP_FAILED) {
+		close();
+		return false;
+	}
+
+	m_data = static_cast<const char*>(mapping);
+	m_size = static_cast<size_t>(file_stats.st_size);
+	return true;
+}
+
+auto MappedFile::close() noexcept -> void {
+	if (m_data != nullptr) {
+		munmap(const_cast<char*>(m_data), m_size);
+	}
+	if (m_descriptor >= 0) {
+		::close(m_descriptor);
+	}
+	m_data = nullptr;
+	m_size = 0;
+	m_descriptor = -1;
+}
+
+#endif
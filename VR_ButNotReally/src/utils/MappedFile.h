@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+/**
+Read only view of a whole file mapped into the address space of the process.
+
+The mapping is released when the object goes out of scope. Copying is not
+allowed since the object owns the operating system handles, but it can be moved.
+*/
+class MappedFile {
+public:
+	MappedFile() = default;
+
+	/**
+	Maps the whole file provided.
+
+	@param The path of the file to map
+	@throws std::runtime_error if the file can't be opened or mapped
+	*/
+	explicit MappedFile(const std::string& path);
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	~MappedFile();
+
+	/**
+	Tries to map the whole file provided, releasing any previous mapping.
+
+	@param The path of the file to map
+	@return true if the file has been mapped, false otherwise
+	*/
+	auto open(const std::string& path) noexcept -> bool;
+
+	/**
+	Releases the mapping and the handles of the file (if any).
+	*/
+	auto close() noexcept -> void;
+
+	auto data() const noexcept -> const char* { return m_data; }
+
+	auto size() const noexcept -> size_t { return m_size; }
+
+	auto isOpen() const noexcept -> bool { return m_data != nullptr; }
+
+private:
+	const char* m_data{ nullptr };
+	size_t m_size{ 0 };
+
+#if defined(_WIN32)
+	void* m_file{ nullptr };
+	void* m_mapping{ nullptr };
+#else
+	int m_descriptor{ -1 };
+#endif
+};
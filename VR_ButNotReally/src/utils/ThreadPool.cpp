@@ -0,0 +1,45 @@
+#include "./ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t thread_count) {
+
+	if (thread_count == 0) {
+		thread_count = std::max(size_t{ 1 }, size_t{ std::thread::hardware_concurrency() });
+	}
+
+	m_workers.reserve(thread_count);
+	for (auto i = size_t{ 0 }; i < thread_count; ++i) {
+		m_workers.emplace_back([this]() { workerLoop(); });
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		auto lock = std::unique_lock<std::mutex>(m_mutex);
+		m_stopping = true;
+	}
+	m_condition.notify_all();
+
+	for (auto& worker : m_workers) {
+		worker.join();
+	}
+}
+
+auto ThreadPool::workerLoop() -> void {
+
+	while (true) {
+		auto task = std::function<void()>{};
+		{
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+
+			if (m_tasks.empty()) {
+				return;
+			}
+
+			task = std::move(m_tasks.front());
+			m_tasks.pop();
+		}
+		task();
+	}
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <cstddef>
+#include <algorithm>
+
+/**
+Fixed set of worker threads that execute the tasks pushed to a shared queue.
+
+The workers are started on construction and joined on destruction, every task
+still in the queue at that point is executed before the workers finish.
+*/
+class ThreadPool {
+public:
+
+	/**
+	Starts the worker threads.
+
+	@param The amount of workers, 0 uses one worker per hardware thread
+	*/
+	explicit ThreadPool(size_t thread_count = 0);
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	ThreadPool(ThreadPool&&) = delete;
+	ThreadPool& operator=(ThreadPool&&) = delete;
+	~ThreadPool();
+
+	/**
+	Pushes a task to the queue.
+
+	@param The callable to execute in one of the workers
+	@return A future with the result of the task, exceptions thrown
+	by the task are rethrown when calling get() on it
+	*/
+	template<typename Function>
+	auto enqueue(Function&& function) -> std::future<std::invoke_result_t<Function>> {
+
+		using Result = std::invoke_result_t<Function>;
+
+		/*
+		std::function needs a copyable callable so we keep the packaged
+		task (which is move only) behind a shared pointer.
+		*/
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+		auto result = task->get_future();
+		{
+			auto lock = std::unique_lock<std::mutex>(m_mutex);
+			m_tasks.emplace([task]() { (*task)(); });
+		}
+		m_condition.notify_one();
+
+		return result;
+	}
+
+	/**
+	Splits the range [0, count) in contiguous blocks, one per worker, and calls
+	function(begin, end) for every block. Returns once every block is done.
+
+	It must not be called from a task of this same pool, the calling worker
+	would wait for blocks that may need that worker to run.
+
+	@param The size of the range
+	@param The callable that processes one block of the range
+	*/
+	template<typename Function>
+	auto parallelFor(size_t count, Function&& function) -> void {
+
+		const auto block_count = std::min(count, getThreadCount());
+		if (block_count <= 1) {
+			if (count > 0) {
+				function(size_t{ 0 }, count);
+			}
+			return;
+		}
+
+		auto pending = std::vector<std::future<void>>{};
+		pending.reserve(block_count);
+
+		for (auto block = size_t{ 0 }; block < block_count; ++block) {
+			const auto begin = count * block / block_count;
+			const auto end = count * (block + 1) / block_count;
+			pending.push_back(enqueue([&function, begin, end]() { function(begin, end); }));
+		}
+
+		/*
+		Every block references the function so we wait for all of them
+		before rethrowing the first exception (if any).
+		*/
+		for (auto& block : pending) {
+			block.wait();
+		}
+		for (auto& block : pending) {
+			block.get();
+		}
+	}
+
+	auto getThreadCount() const noexcept -> size_t { return m_workers.size(); }
+
+private:
+
+	auto workerLoop() -> void;
+
+	std::vector<std::thread> m_workers{};
+	std::queue<std::function<void()>> m_tasks{};
+	std::mutex m_mutex{};
+	std::condition_variable m_condition{};
+	bool m_stopping{ false };
+};
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cstring>
 #include <gsl/gsl>
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
@@ -32,4 +33,42 @@ auto readFileToChars(const std::string& name)->std::vector<char> {
 	return buffer;
 }
 
+auto hashBytes(const void* data, size_t size, uint64_t seed) noexcept -> uint64_t {
 
+	constexpr auto multiplier = uint64_t{ 0x9E3779B97F4A7C15ull };
+
+	/*
+	Murmur3 finalizer, it spreads every input bit over the whole output.
+	*/
+	auto mix = [](uint64_t value) noexcept {
+		value ^= value >> 33;
+		value *= 0xFF51AFD7ED558CCDull;
+		value ^= value >> 33;
+		value *= 0xC4CEB9FE1A85EC53ull;
+		value ^= value >> 33;
+		return value;
+	};
+
+	auto hash = seed ^ (size * multiplier);
+	const auto bytes = static_cast<const unsigned char*>(data);
+
+	/*
+	We consume the memory 8 bytes at a time and the tail byte by byte.
+	*/
+	auto offset = size_t{ 0 };
+	[[gsl::suppress(bounds.1)]]{
+	for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+		auto word = uint64_t{};
+		memcpy(&word, bytes + offset, sizeof(word));
+		hash = (hash ^ mix(word)) * multiplier;
+	}
+
+	auto tail = uint64_t{};
+	for (auto shift = 0; offset < size; ++offset, shift += 8) {
+		tail |= uint64_t{ bytes[offset] } << shift;
+	}
+	hash = (hash ^ mix(tail)) * multiplier;
+	}
+
+	return mix(hash);
+}
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <cstdint>
 
 
 /**
@@ -15,6 +16,17 @@ auto pressToContinue() noexcept -> void;
 
 auto readFileToChars(const std::string& name)->std::vector<char>;
 
+/**
+Calculates a well mixed 64 bit hash of a block of memory. It is not meant
+for cryptographic use, only to identify contents (cache keys and similar).
+
+@param Pointer to the beginning of the memory to hash
+@param The size in bytes of the memory to hash
+@param Seed to start the hash from, useful to chain several blocks
+@return The 64 bit hash of the memory
+*/
+auto hashBytes(const void* data, size_t size, uint64_t seed = 0) noexcept -> uint64_t;
+
 template<typename T>
 auto readBinaryArrayToChars(T arr)->std::vector<char> {
 